@@ -0,0 +1,64 @@
+#include "Async/ParallelFor.h"
+#include <atomic>
+#include "HAL/UnrealMemory.h"
+#include "ProfilingDebugging/CoreTrace.h"
+
+int32 GetParallelForNumThreads()
+{
+	static const int32 NumThreads = FMath::Clamp<int32>(GetNumTaskWorkers() + 1, 1, PARALLELFOR_MAX_THREADS);
+	return NumThreads;
+}
+
+void ParallelFor(int32 Num, TFunctionRef<void(int32)> Body, bool bForceSingleThread)
+{
+	TRACE_CPU_SCOPE(ParallelFor);
+	const int32 NumThreads = bForceSingleThread ? 1 : FMath::Min(Num, GetParallelForNumThreads());
+	if (NumThreads <= 1)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Body(Index);
+		}
+		return;
+	}
+
+	std::atomic<int32> NextIndex{ 0 };
+	auto DoWork = [&NextIndex, Num, NumThreads, &Body]()
+	{
+		for (;;)
+		{
+			const int32 Remaining = Num - NextIndex.load(std::memory_order_relaxed);
+			if (Remaining <= 0)
+			{
+				break;
+			}
+
+			const int32 BatchSize = FMath::Max(1, Remaining / (NumThreads * PARALLELFOR_BATCHES_PER_THREAD));
+			const int32 Begin = NextIndex.fetch_add(BatchSize, std::memory_order_relaxed);
+			const int32 End = FMath::Min(Begin + BatchSize, Num);
+			for (int32 Index = Begin; Index < End; ++Index)
+			{
+				Body(Index);
+			}
+		}
+	};
+
+	// Helpers that only start once the work is gone return right away, the wait below runs them if nobody else did.
+	FTask Helpers[PARALLELFOR_MAX_THREADS - 1];
+	for (int32 HelperIndex = 0; HelperIndex < NumThreads - 1; ++HelperIndex)
+	{
+		Helpers[HelperIndex] = LaunchTask([&DoWork]() { DoWork(); });
+	}
+
+	DoWork();
+
+	FTask::WaitAll(TArrayView<const FTask>(Helpers, NumThreads - 1));
+}
+
+FTask LaunchParallelFor(int32 Num, TFunction<void(int32)> Body, TArrayView<const FTask> Prerequisites, ETaskPriority Priority)
+{
+	return LaunchTask([Num, Body = MoveTemp(Body)]()
+	{
+		ParallelFor(Num, Body);
+	}, Prerequisites, Priority);
+}
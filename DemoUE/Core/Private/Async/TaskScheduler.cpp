@@ -0,0 +1,392 @@
+#include "Async/TaskScheduler.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Async/WorkStealingDeque.h"
+#include "Containers/Array.h"
+#include "Containers/BoundedMPMCQueue.h"
+#include "HAL/UnrealMemory.h"
+#include "ProfilingDebugging/CoreTrace.h"
+
+namespace UE::Tasks::Private
+{
+	class FTaskBase
+	{
+	public:
+		FTaskBase(TFunction<void()>&& InBody, ETaskPriority InPriority)
+			: Body(MoveTemp(InBody))
+			, Priority(InPriority)
+		{
+		}
+
+		FORCEINLINE void AddRef()
+		{
+			RefCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		FORCEINLINE void Release()
+		{
+			if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete this;
+			}
+		}
+
+		std::atomic<int32> RefCount{ 1 };
+
+		/** Prerequisites not completed yet, plus one held by LaunchTask until it is done adding them. */
+		std::atomic<int32> NumBlockers{ 1 };
+
+		std::atomic<bool> bCompleted{ false };
+
+		TFunction<void()> Body;
+		ETaskPriority Priority;
+
+		/** Guards the subsequents, closed once the task completed so later ones do not wait for it. */
+		std::mutex Mutex;
+		TArray<FTaskBase*> Subsequents;
+		bool bClosed = false;
+	};
+
+	struct FTaskHandleAccess
+	{
+		static FTaskBase* Get(const FTask& Task)
+		{
+			return Task.Task;
+		}
+
+		static FTask Make(FTaskBase* Task)
+		{
+			return FTask(Task);
+		}
+	};
+
+	struct alignas(64) FWorker
+	{
+		TWorkStealingDeque<FTaskBase*> Deque;
+	};
+
+	/** Index of the worker the thread is, INDEX_NONE on every other thread. */
+	static thread_local int32 ThreadWorkerIndex = INDEX_NONE;
+	static thread_local uint32 ThreadStealSeed = 0;
+
+	class FScheduler
+	{
+	public:
+		FScheduler()
+			: HighPriorityQueue(TASK_SCHEDULER_QUEUE_CAPACITY)
+			, NormalQueue(TASK_SCHEDULER_QUEUE_CAPACITY)
+		{
+			NumWorkers = FMath::Clamp<int32>((int32)std::thread::hardware_concurrency() - 1, 1, TASK_SCHEDULER_MAX_WORKERS);
+			Workers = new FWorker[NumWorkers];
+
+			// Never joined, the scheduler lives as long as the process.
+			for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; ++WorkerIndex)
+			{
+				std::thread([this, WorkerIndex]() { WorkerMain(WorkerIndex); }).detach();
+			}
+		}
+
+		int32 GetNumWorkers() const
+		{
+			return NumWorkers;
+		}
+
+		/** Queues a task whose prerequisites completed, taking over a reference to it. */
+		void Schedule(FTaskBase* Task)
+		{
+			if (Task->Priority == ETaskPriority::High)
+			{
+				Enqueue(HighPriorityQueue, Task);
+			}
+			else if (ThreadWorkerIndex != INDEX_NONE)
+			{
+				Workers[ThreadWorkerIndex].Deque.Push(Task);
+			}
+			else
+			{
+				Enqueue(NormalQueue, Task);
+			}
+			NotifyWork();
+		}
+
+		/** Runs one queued task on the calling thread. @return false if there was none to find */
+		bool TryRunOne()
+		{
+			FTaskBase* Task = nullptr;
+			FWorker* Own = ThreadWorkerIndex != INDEX_NONE ? &Workers[ThreadWorkerIndex] : nullptr;
+			if (HighPriorityQueue.TryDequeue(Task)
+				|| (Own && Own->Deque.Pop(Task))
+				|| NormalQueue.TryDequeue(Task)
+				|| TrySteal(Task))
+			{
+				Execute(Task);
+				return true;
+			}
+			return false;
+		}
+
+		void Wait(FTaskBase& Task)
+		{
+			while (!Task.bCompleted.load(std::memory_order_acquire))
+			{
+				const uint64 Epoch = WorkEpoch.load(std::memory_order_seq_cst);
+				if (TryRunOne())
+				{
+					continue;
+				}
+
+				std::unique_lock<std::mutex> Lock(SleepMutex);
+				NumSleeping.fetch_add(1, std::memory_order_seq_cst);
+				NumBlockedWaiters.fetch_add(1, std::memory_order_seq_cst);
+				SleepCondition.wait(Lock, [this, &Task, Epoch]()
+				{
+					return Task.bCompleted.load(std::memory_order_seq_cst) || WorkEpoch.load(std::memory_order_seq_cst) != Epoch;
+				});
+				NumBlockedWaiters.fetch_sub(1, std::memory_order_relaxed);
+				NumSleeping.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+	private:
+		void Enqueue(TBoundedMPMCQueue<FTaskBase*>& Queue, FTaskBase* Task)
+		{
+			// A full queue is drained by helping, it only holds ready tasks.
+			while (!Queue.TryEnqueue(Task))
+			{
+				TryRunOne();
+			}
+		}
+
+		bool TrySteal(FTaskBase*& OutTask)
+		{
+			uint32 Seed = ThreadStealSeed ? ThreadStealSeed : (uint32)(UPTRINT)&ThreadStealSeed | 1;
+			Seed ^= Seed << 13;
+			Seed ^= Seed >> 17;
+			Seed ^= Seed << 5;
+			ThreadStealSeed = Seed;
+
+			// From a random victim on, so thieves do not all hammer the first worker.
+			const int32 FirstVictim = (int32)(Seed % (uint32)NumWorkers);
+			for (int32 Offset = 0; Offset < NumWorkers; ++Offset)
+			{
+				const int32 Victim = (FirstVictim + Offset) % NumWorkers;
+				if (Victim != ThreadWorkerIndex && Workers[Victim].Deque.Steal(OutTask))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void Execute(FTaskBase* Task)
+		{
+			{
+				TRACE_CPU_SCOPE(TaskExecute);
+				Task->Body();
+			}
+
+			// Whatever the body captured goes away now, not when the last handle does.
+			Task->Body = nullptr;
+
+			TArray<FTaskBase*> Subsequents;
+			{
+				std::lock_guard<std::mutex> Lock(Task->Mutex);
+				Task->bClosed = true;
+				Subsequents = MoveTemp(Task->Subsequents);
+			}
+			Task->bCompleted.store(true, std::memory_order_seq_cst);
+
+			for (FTaskBase* Subsequent : Subsequents)
+			{
+				if (Subsequent->NumBlockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					Schedule(Subsequent);
+				}
+				else
+				{
+					Subsequent->Release();
+				}
+			}
+
+			if (NumBlockedWaiters.load(std::memory_order_seq_cst) > 0)
+			{
+				// Any of them may be waiting for this one.
+				std::lock_guard<std::mutex> Lock(SleepMutex);
+				SleepCondition.notify_all();
+			}
+
+			// The reference of the queue.
+			Task->Release();
+		}
+
+		void NotifyWork()
+		{
+			WorkEpoch.fetch_add(1, std::memory_order_seq_cst);
+			if (NumSleeping.load(std::memory_order_seq_cst) > 0)
+			{
+				std::lock_guard<std::mutex> Lock(SleepMutex);
+				SleepCondition.notify_one();
+			}
+		}
+
+		void WorkerMain(int32 WorkerIndex)
+		{
+			ThreadWorkerIndex = WorkerIndex;
+			FMemory::SetupTLSCachesOnCurrentThread();
+
+			for (;;)
+			{
+				// Read before looking for work, whatever is queued after that changes it and keeps us awake.
+				const uint64 Epoch = WorkEpoch.load(std::memory_order_seq_cst);
+				if (TryRunOne())
+				{
+					continue;
+				}
+
+				std::unique_lock<std::mutex> Lock(SleepMutex);
+				NumSleeping.fetch_add(1, std::memory_order_seq_cst);
+				SleepCondition.wait(Lock, [this, Epoch]()
+				{
+					return WorkEpoch.load(std::memory_order_seq_cst) != Epoch;
+				});
+				NumSleeping.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		int32 NumWorkers;
+		FWorker* Workers;
+
+		TBoundedMPMCQueue<FTaskBase*> HighPriorityQueue;
+		TBoundedMPMCQueue<FTaskBase*> NormalQueue;
+
+		/** Bumped by every task queued, sleepers compare it with what they saw before they last looked for work. */
+		alignas(64) std::atomic<uint64> WorkEpoch{ 0 };
+
+		/** Idle workers and blocked waiters, and the waiters alone, which also need to hear about completions. */
+		alignas(64) std::atomic<int32> NumSleeping{ 0 };
+		std::atomic<int32> NumBlockedWaiters{ 0 };
+
+		std::mutex SleepMutex;
+		std::condition_variable SleepCondition;
+	};
+
+	static FScheduler& GetScheduler()
+	{
+		// Never destroyed, the workers outlive static destruction.
+		static FScheduler* Scheduler = new FScheduler();
+		return *Scheduler;
+	}
+}
+
+using namespace UE::Tasks::Private;
+
+FTask::FTask(const FTask& Other)
+	: Task(Other.Task)
+{
+	if (Task)
+	{
+		Task->AddRef();
+	}
+}
+
+FTask::FTask(FTask&& Other)
+	: Task(Other.Task)
+{
+	Other.Task = nullptr;
+}
+
+FTask& FTask::operator=(const FTask& Other)
+{
+	if (Other.Task)
+	{
+		Other.Task->AddRef();
+	}
+	if (Task)
+	{
+		Task->Release();
+	}
+	Task = Other.Task;
+	return *this;
+}
+
+FTask& FTask::operator=(FTask&& Other)
+{
+	if (this != &Other)
+	{
+		if (Task)
+		{
+			Task->Release();
+		}
+		Task = Other.Task;
+		Other.Task = nullptr;
+	}
+	return *this;
+}
+
+FTask::~FTask()
+{
+	if (Task)
+	{
+		Task->Release();
+	}
+}
+
+bool FTask::IsCompleted() const
+{
+	return !Task || Task->bCompleted.load(std::memory_order_acquire);
+}
+
+void FTask::Wait() const
+{
+	if (Task)
+	{
+		GetScheduler().Wait(*Task);
+	}
+}
+
+FTask LaunchTask(TFunction<void()> Body, TArrayView<const FTask> Prerequisites, ETaskPriority Priority)
+{
+	FScheduler& Scheduler = GetScheduler();
+	FTaskBase* Task = new FTaskBase(MoveTemp(Body), Priority);
+
+	for (const FTask& Prerequisite : Prerequisites)
+	{
+		FTaskBase* PrerequisiteTask = FTaskHandleAccess::Get(Prerequisite);
+		if (!PrerequisiteTask)
+		{
+			continue;
+		}
+
+		std::lock_guard<std::mutex> Lock(PrerequisiteTask->Mutex);
+		if (!PrerequisiteTask->bClosed)
+		{
+			// The prerequisite holds a reference until it schedules or lets go of the task.
+			Task->NumBlockers.fetch_add(1, std::memory_order_relaxed);
+			Task->AddRef();
+			PrerequisiteTask->Subsequents.Add(Task);
+		}
+	}
+
+	// One reference for the handle, one for the queue.
+	Task->AddRef();
+	if (Task->NumBlockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Scheduler.Schedule(Task);
+	}
+	else
+	{
+		Task->Release();
+	}
+	return FTaskHandleAccess::Make(Task);
+}
+
+int32 GetNumTaskWorkers()
+{
+	return GetScheduler().GetNumWorkers();
+}
+
+bool IsInTaskWorkerThread()
+{
+	return ThreadWorkerIndex != INDEX_NONE;
+}
@@ -0,0 +1,239 @@
+#include "Compression/LZ4BlockCodec.h"
+#include "HAL/UnrealMemory.h"
+
+namespace UE::Compression::LZ4Block
+{
+	/** Shortest match the format can encode. */
+	static constexpr int64 MinMatch = 4;
+
+	/** The last match must start at least this many bytes before the end of the input. */
+	static constexpr int64 MatchFindLimit = 12;
+
+	/** The last this many bytes of the input are always literals. */
+	static constexpr int64 LastLiterals = 5;
+
+	static constexpr int64 MaxOffset = 65535;
+
+	static constexpr uint32 HashLog = 12;
+
+	/** Bytes skipped between match attempts grow by one every 2^SkipTrigger bytes without a match. */
+	static constexpr uint32 SkipTrigger = 6;
+
+	static FORCEINLINE uint32 Read32(const uint8* Ptr)
+	{
+		return FPlatformMemory::ReadUnaligned<uint32>(Ptr);
+	}
+
+	static FORCEINLINE uint32 Hash(uint32 Sequence)
+	{
+		return (Sequence * 2654435761u) >> (32 - HashLog);
+	}
+
+	/** Writes the 255 valued continuation bytes of a length that overflowed its token nibble. */
+	static FORCEINLINE uint8* WriteLength(uint8* Out, int64 Length)
+	{
+		for (; Length >= 255; Length -= 255)
+		{
+			*Out++ = 255;
+		}
+		*Out++ = (uint8)Length;
+		return Out;
+	}
+
+	/** Reads the continuation bytes of a length whose token nibble was 15. */
+	static FORCEINLINE bool ReadLength(const uint8*& In, const uint8* InEnd, int64& Length)
+	{
+		uint8 Byte;
+		do
+		{
+			if (In >= InEnd)
+			{
+				return false;
+			}
+			Byte = *In++;
+			Length += Byte;
+		}
+		while (Byte == 255);
+		return true;
+	}
+
+	/** @return an upper bound of the encoded size of a sequence, to check the output capacity before writing it */
+	static FORCEINLINE int64 GetMaxSequenceSize(int64 NumLiterals, int64 MatchLength)
+	{
+		return 1 + NumLiterals / 255 + 1 + NumLiterals + 2 + MatchLength / 255 + 1;
+	}
+
+	int64 GetMaxCompressedSize(int64 SourceSize)
+	{
+		return SourceSize + SourceSize / 255 + 16;
+	}
+
+	int64 Compress(const void* Source, int64 SourceSize, void* Dest, int64 DestCapacity)
+	{
+		const uint8* const Begin = (const uint8*)Source;
+		const uint8* const End = Begin + SourceSize;
+		uint8* Out = (uint8*)Dest;
+		uint8* const OutEnd = Out + DestCapacity;
+
+		const uint8* Anchor = Begin;
+		if (SourceSize > MatchFindLimit)
+		{
+			const uint8* const MatchStartLimit = End - MatchFindLimit;
+			const uint8* const MatchEndLimit = End - LastLiterals;
+
+			// Positions relative to Begin. Stale or zero entries are harmless, every candidate is verified.
+			uint32 HashTable[1 << HashLog] = {};
+
+			const uint8* In = Begin + 1;
+			while (In < MatchStartLimit)
+			{
+				const uint32 Sequence = Read32(In);
+				const uint32 HashIndex = Hash(Sequence);
+				const uint8* Candidate = Begin + HashTable[HashIndex];
+				HashTable[HashIndex] = (uint32)(In - Begin);
+
+				if (Candidate >= In || In - Candidate > MaxOffset || Read32(Candidate) != Sequence)
+				{
+					In += 1 + ((In - Anchor) >> SkipTrigger);
+					continue;
+				}
+
+				// Grow the match backwards over literals that also match, then forwards.
+				while (In > Anchor && Candidate > Begin && In[-1] == Candidate[-1])
+				{
+					--In;
+					--Candidate;
+				}
+				const uint8* MatchEnd = In + MinMatch;
+				const uint8* CandidateEnd = Candidate + MinMatch;
+				while (MatchEnd < MatchEndLimit && *MatchEnd == *CandidateEnd)
+				{
+					++MatchEnd;
+					++CandidateEnd;
+				}
+
+				const int64 NumLiterals = In - Anchor;
+				const int64 MatchLength = MatchEnd - In;
+				if (GetMaxSequenceSize(NumLiterals, MatchLength) > OutEnd - Out)
+				{
+					return 0;
+				}
+
+				uint8* Token = Out++;
+				*Token = (uint8)((NumLiterals >= 15 ? 15 : NumLiterals) << 4);
+				if (NumLiterals >= 15)
+				{
+					Out = WriteLength(Out, NumLiterals - 15);
+				}
+				FMemory::Memcpy(Out, Anchor, NumLiterals);
+				Out += NumLiterals;
+
+				const uint16 Offset = (uint16)(In - Candidate);
+				*Out++ = (uint8)Offset;
+				*Out++ = (uint8)(Offset >> 8);
+
+				const int64 ExtraMatchLength = MatchLength - MinMatch;
+				*Token |= (uint8)(ExtraMatchLength >= 15 ? 15 : ExtraMatchLength);
+				if (ExtraMatchLength >= 15)
+				{
+					Out = WriteLength(Out, ExtraMatchLength - 15);
+				}
+
+				In = MatchEnd;
+				Anchor = In;
+				if (In < MatchStartLimit)
+				{
+					// Seeding the table with a position inside the match helps the next search a lot.
+					HashTable[Hash(Read32(In - 2))] = (uint32)(In - 2 - Begin);
+				}
+			}
+		}
+
+		// The block always ends with a literal only sequence, possibly empty.
+		const int64 NumLiterals = End - Anchor;
+		if (1 + NumLiterals / 255 + 1 + NumLiterals > OutEnd - Out)
+		{
+			return 0;
+		}
+		*Out++ = (uint8)((NumLiterals >= 15 ? 15 : NumLiterals) << 4);
+		if (NumLiterals >= 15)
+		{
+			Out = WriteLength(Out, NumLiterals - 15);
+		}
+		FMemory::Memcpy(Out, Anchor, NumLiterals);
+		Out += NumLiterals;
+
+		return Out - (uint8*)Dest;
+	}
+
+	bool Decompress(const void* Source, int64 SourceSize, void* Dest, int64 DestSize)
+	{
+		const uint8* In = (const uint8*)Source;
+		const uint8* const InEnd = In + SourceSize;
+		uint8* const OutBegin = (uint8*)Dest;
+		uint8* Out = OutBegin;
+		uint8* const OutEnd = Out + DestSize;
+
+		while (In < InEnd)
+		{
+			const uint8 Token = *In++;
+
+			int64 NumLiterals = Token >> 4;
+			if (NumLiterals == 15 && !ReadLength(In, InEnd, NumLiterals))
+			{
+				return false;
+			}
+			if (NumLiterals > InEnd - In || NumLiterals > OutEnd - Out)
+			{
+				return false;
+			}
+			FMemory::Memcpy(Out, In, NumLiterals);
+			Out += NumLiterals;
+			In += NumLiterals;
+
+			if (In == InEnd)
+			{
+				break;
+			}
+
+			if (InEnd - In < 2)
+			{
+				return false;
+			}
+			const int64 Offset = In[0] | (In[1] << 8);
+			In += 2;
+			if (Offset == 0 || Offset > Out - OutBegin)
+			{
+				return false;
+			}
+
+			int64 MatchLength = Token & 15;
+			if (MatchLength == 15 && !ReadLength(In, InEnd, MatchLength))
+			{
+				return false;
+			}
+			MatchLength += MinMatch;
+			if (MatchLength > OutEnd - Out)
+			{
+				return false;
+			}
+
+			const uint8* Match = Out - Offset;
+			if (Offset >= MatchLength)
+			{
+				FMemory::Memcpy(Out, Match, MatchLength);
+				Out += MatchLength;
+			}
+			else
+			{
+				// Overlapping matches repeat the last Offset bytes, they have to be copied in order.
+				for (uint8* MatchOutEnd = Out + MatchLength; Out < MatchOutEnd; )
+				{
+					*Out++ = *Match++;
+				}
+			}
+		}
+
+		return Out == OutEnd;
+	}
+}
@@ -0,0 +1,508 @@
+#include "GenericPlatform/GenericPlatformMemory.h"
+#include "HAL/UnrealMemory.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+#include <cstdio>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PLATFORMMEMORY_USE_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define PLATFORMMEMORY_USE_NEON 1
+	#include <arm_neon.h>
+#endif
+
+/** Smallest slice of a ParallelMemcpy handed to one thread. */
+#define PARALLEL_MEMCPY_MIN_SLICE_SIZE (256 * 1024)
+
+#ifndef PLATFORMMEMORY_USE_SSE2
+	#define PLATFORMMEMORY_USE_SSE2 0
+#endif
+#ifndef PLATFORMMEMORY_USE_NEON
+	#define PLATFORMMEMORY_USE_NEON 0
+#endif
+
+namespace UE::Core::Private::PlatformMemory
+{
+#if PLATFORMMEMORY_USE_SSE2
+	typedef __m128i FVector;
+
+	FORCEINLINE FVector LoadAligned(const void* Ptr) { return _mm_load_si128((const __m128i*)Ptr); }
+	FORCEINLINE FVector Load(const void* Ptr) { return _mm_loadu_si128((const __m128i*)Ptr); }
+	FORCEINLINE void Store(void* Ptr, FVector Value) { _mm_storeu_si128((__m128i*)Ptr, Value); }
+	FORCEINLINE FVector Or(FVector A, FVector B) { return _mm_or_si128(A, B); }
+	FORCEINLINE bool IsZero(FVector Value) { return _mm_movemask_epi8(_mm_cmpeq_epi8(Value, _mm_setzero_si128())) == 0xFFFF; }
+#elif PLATFORMMEMORY_USE_NEON
+	typedef uint8x16_t FVector;
+
+	FORCEINLINE FVector LoadAligned(const void* Ptr) { return vld1q_u8((const uint8*)Ptr); }
+	FORCEINLINE FVector Load(const void* Ptr) { return vld1q_u8((const uint8*)Ptr); }
+	FORCEINLINE void Store(void* Ptr, FVector Value) { vst1q_u8((uint8*)Ptr, Value); }
+	FORCEINLINE FVector Or(FVector A, FVector B) { return vorrq_u8(A, B); }
+	FORCEINLINE bool IsZero(FVector Value) { return vmaxvq_u32(vreinterpretq_u32_u8(Value)) == 0; }
+#else
+	/** Word sized fallback for targets without a vector unit we know about. */
+	struct FVector
+	{
+		uint64 Words[2];
+	};
+
+	FORCEINLINE FVector Load(const void* Ptr) { FVector Result; memcpy(&Result, Ptr, sizeof(Result)); return Result; }
+	FORCEINLINE FVector LoadAligned(const void* Ptr) { return *(const FVector*)Ptr; }
+	FORCEINLINE void Store(void* Ptr, FVector Value) { memcpy(Ptr, &Value, sizeof(Value)); }
+	FORCEINLINE FVector Or(FVector A, FVector B) { return FVector{ { A.Words[0] | B.Words[0], A.Words[1] | B.Words[1] } }; }
+	FORCEINLINE bool IsZero(FVector Value) { return (Value.Words[0] | Value.Words[1]) == 0; }
+#endif
+
+	constexpr SIZE_T VectorSize = 16;
+
+	/** Bytes tested between early outs. Big enough to keep several loads in flight, small enough to stop soon after a non zero byte. */
+	constexpr SIZE_T ZeroCheckBlockSize = 4 * VectorSize;
+
+	/** Bytes swapped per iteration of the main Memswap loop. */
+	constexpr SIZE_T SwapBlockSize = 4 * VectorSize;
+
+	/** Bytes copied per iteration of the StreamingMemcpy loop, one cache line. */
+	constexpr SIZE_T StreamBlockSize = 4 * VectorSize;
+
+	FORCEINLINE bool IsZeroBytes(const uint8* Ptr, SIZE_T Count)
+	{
+		uint64 Bits = 0;
+		for (; Count >= sizeof(uint64); Ptr += sizeof(uint64), Count -= sizeof(uint64))
+		{
+			Bits |= FGenericPlatformMemory::ReadUnaligned<uint64>(Ptr);
+		}
+		for (; Count; ++Ptr, --Count)
+		{
+			Bits |= *Ptr;
+		}
+		return Bits == 0;
+	}
+}
+
+bool FGenericPlatformMemory::MemIsZero(const void* Ptr, SIZE_T Count)
+{
+	using namespace UE::Core::Private::PlatformMemory;
+
+	const uint8* Bytes = (const uint8*)Ptr;
+	if (Count < ZeroCheckBlockSize)
+	{
+		return IsZeroBytes(Bytes, Count);
+	}
+
+	// One unaligned load covers the head, then everything up to the tail is read with aligned loads.
+	if (!IsZero(Load(Bytes)))
+	{
+		return false;
+	}
+	const uint8* End = Bytes + Count;
+	const uint8* Aligned = (const uint8*)(((UPTRINT)Bytes + VectorSize) & ~(UPTRINT)(VectorSize - 1));
+
+	for (; Aligned + ZeroCheckBlockSize <= End; Aligned += ZeroCheckBlockSize)
+	{
+		const FVector Block = Or(Or(LoadAligned(Aligned), LoadAligned(Aligned + VectorSize)),
+			Or(LoadAligned(Aligned + 2 * VectorSize), LoadAligned(Aligned + 3 * VectorSize)));
+		if (!IsZero(Block))
+		{
+			return false;
+		}
+	}
+	for (; Aligned + VectorSize <= End; Aligned += VectorSize)
+	{
+		if (!IsZero(LoadAligned(Aligned)))
+		{
+			return false;
+		}
+	}
+
+	// The last vector overlaps bytes already tested, which is cheaper than a byte loop.
+	return Aligned == End || IsZero(Load(End - VectorSize));
+}
+
+void FGenericPlatformMemory::MemswapGreaterThan8(void* Ptr1, void* Ptr2, SIZE_T Size)
+{
+	using namespace UE::Core::Private::PlatformMemory;
+
+	uint8* A = (uint8*)Ptr1;
+	uint8* B = (uint8*)Ptr2;
+
+	for (; Size >= SwapBlockSize; A += SwapBlockSize, B += SwapBlockSize, Size -= SwapBlockSize)
+	{
+		const FVector A0 = Load(A);
+		const FVector A1 = Load(A + VectorSize);
+		const FVector A2 = Load(A + 2 * VectorSize);
+		const FVector A3 = Load(A + 3 * VectorSize);
+		const FVector B0 = Load(B);
+		const FVector B1 = Load(B + VectorSize);
+		const FVector B2 = Load(B + 2 * VectorSize);
+		const FVector B3 = Load(B + 3 * VectorSize);
+		Store(A, B0);
+		Store(A + VectorSize, B1);
+		Store(A + 2 * VectorSize, B2);
+		Store(A + 3 * VectorSize, B3);
+		Store(B, A0);
+		Store(B + VectorSize, A1);
+		Store(B + 2 * VectorSize, A2);
+		Store(B + 3 * VectorSize, A3);
+	}
+	for (; Size >= VectorSize; A += VectorSize, B += VectorSize, Size -= VectorSize)
+	{
+		const FVector Temp = Load(A);
+		Store(A, Load(B));
+		Store(B, Temp);
+	}
+	for (; Size >= sizeof(uint64); A += sizeof(uint64), B += sizeof(uint64), Size -= sizeof(uint64))
+	{
+		const uint64 Temp = ReadUnaligned<uint64>(A);
+		memcpy(A, B, sizeof(uint64));
+		memcpy(B, &Temp, sizeof(uint64));
+	}
+	for (; Size; ++A, ++B, --Size)
+	{
+		const uint8 Temp = *A;
+		*A = *B;
+		*B = Temp;
+	}
+}
+
+FGenericPlatformMemory::FMappedFileRegion* FGenericPlatformMemory::MapFileRegion(const TCHAR* Filename)
+{
+	// Platforms that can map files override this.
+	return nullptr;
+}
+
+bool FGenericPlatformMemory::UnmapFileRegion(FMappedFileRegion* MappedRegion)
+{
+	delete MappedRegion;
+	return false;
+}
+
+void* FGenericPlatformMemory::StreamingMemcpy(void* Dest, const void* Src, SIZE_T Count)
+{
+#if PLATFORMMEMORY_USE_SSE2
+	using namespace UE::Core::Private::PlatformMemory;
+
+	if (Count < 4 * StreamBlockSize)
+	{
+		return memcpy(Dest, Src, Count);
+	}
+
+	// Non-temporal stores need an aligned destination; the few head bytes go through the cache.
+	uint8* Out = (uint8*)Dest;
+	const uint8* In = (const uint8*)Src;
+	const SIZE_T HeadSize = (VectorSize - ((UPTRINT)Out & (VectorSize - 1))) & (VectorSize - 1);
+	memcpy(Out, In, HeadSize);
+	Out += HeadSize;
+	In += HeadSize;
+	Count -= HeadSize;
+
+	for (; Count >= StreamBlockSize; Out += StreamBlockSize, In += StreamBlockSize, Count -= StreamBlockSize)
+	{
+		const __m128i V0 = _mm_loadu_si128((const __m128i*)In);
+		const __m128i V1 = _mm_loadu_si128((const __m128i*)(In + VectorSize));
+		const __m128i V2 = _mm_loadu_si128((const __m128i*)(In + 2 * VectorSize));
+		const __m128i V3 = _mm_loadu_si128((const __m128i*)(In + 3 * VectorSize));
+		_mm_stream_si128((__m128i*)Out, V0);
+		_mm_stream_si128((__m128i*)(Out + VectorSize), V1);
+		_mm_stream_si128((__m128i*)(Out + 2 * VectorSize), V2);
+		_mm_stream_si128((__m128i*)(Out + 3 * VectorSize), V3);
+	}
+	memcpy(Out, In, Count);
+
+	// Streaming stores are weakly ordered, make them visible before anyone is told the copy is done.
+	_mm_sfence();
+	return Dest;
+#else
+	return memcpy(Dest, Src, Count);
+#endif
+}
+
+void* FGenericPlatformMemory::ParallelMemcpy(void* Dest, const void* Src, SIZE_T Count, EMemcpyCachePolicy Policy)
+{
+	const bool bUncached = Policy == EMemcpyCachePolicy::StoreUncached;
+	const int32 NumSlices = Count < PARALLEL_MEMCPY_MIN_SIZE ? 1 : (int32)FMath::Min<SIZE_T>(Count / PARALLEL_MEMCPY_MIN_SLICE_SIZE, GetParallelForNumThreads());
+	if (NumSlices <= 1)
+	{
+		return bUncached ? StreamingMemcpy(Dest, Src, Count) : memcpy(Dest, Src, Count);
+	}
+
+	// Slices past the first start on cache line boundaries of the destination so no two threads write to the same line,
+	// the first one also takes the bytes before the first boundary and the last one the bytes after the last.
+	const SIZE_T Head = (SIZE_T)(0 - (UPTRINT)Dest) & (PLATFORM_CACHE_LINE_SIZE - 1);
+	const SIZE_T SliceSize = ((Count / NumSlices) + PLATFORM_CACHE_LINE_SIZE - 1) & ~(SIZE_T)(PLATFORM_CACHE_LINE_SIZE - 1);
+	ParallelFor(NumSlices, [Dest, Src, Count, Head, SliceSize, NumSlices, bUncached](int32 Slice)
+	{
+		const SIZE_T Begin = Slice == 0 ? 0 : FMath::Min(Count, Head + Slice * SliceSize);
+		const SIZE_T End = Slice == NumSlices - 1 ? Count : FMath::Min(Count, Head + (Slice + 1) * SliceSize);
+		uint8* SliceDest = (uint8*)Dest + Begin;
+		const uint8* SliceSrc = (const uint8*)Src + Begin;
+		if (bUncached)
+		{
+			StreamingMemcpy(SliceDest, SliceSrc, End - Begin);
+		}
+		else
+		{
+			memcpy(SliceDest, SliceSrc, End - Begin);
+		}
+	});
+	return Dest;
+}
+
+namespace UE::Core::Private::PlatformMemory
+{
+	template <SIZE_T ElementSize>
+	FORCEINLINE void ByteSwapElement(uint8* Dest, const uint8* Src)
+	{
+		uint8 Temp[ElementSize];
+		for (SIZE_T Index = 0; Index < ElementSize; ++Index)
+		{
+			Temp[Index] = Src[ElementSize - 1 - Index];
+		}
+		memcpy(Dest, Temp, ElementSize);
+	}
+
+#if PLATFORMMEMORY_USE_SSE2
+	/** Plain SSE2: 16 bit lanes are swapped with shifts, wider lanes first swap their 16 or 32 bit halves with shuffles. */
+	template <SIZE_T ElementSize>
+	FORCEINLINE FVector ByteSwapVector(FVector Value)
+	{
+		if constexpr (ElementSize == 8)
+		{
+			Value = _mm_shuffle_epi32(Value, _MM_SHUFFLE(2, 3, 0, 1));
+		}
+		if constexpr (ElementSize >= 4)
+		{
+			Value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Value, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		}
+		return _mm_or_si128(_mm_slli_epi16(Value, 8), _mm_srli_epi16(Value, 8));
+	}
+#elif PLATFORMMEMORY_USE_NEON
+	template <SIZE_T ElementSize>
+	FORCEINLINE FVector ByteSwapVector(FVector Value)
+	{
+		if constexpr (ElementSize == 2)
+		{
+			return vrev16q_u8(Value);
+		}
+		else if constexpr (ElementSize == 4)
+		{
+			return vrev32q_u8(Value);
+		}
+		else
+		{
+			return vrev64q_u8(Value);
+		}
+	}
+#endif
+
+	template <SIZE_T ElementSize>
+	void ByteSwapCopyElements(uint8* Dest, const uint8* Src, SIZE_T Num)
+	{
+		SIZE_T Count = Num * ElementSize;
+#if PLATFORMMEMORY_USE_SSE2 || PLATFORMMEMORY_USE_NEON
+		for (; Count >= 2 * VectorSize; Dest += 2 * VectorSize, Src += 2 * VectorSize, Count -= 2 * VectorSize)
+		{
+			const FVector V0 = Load(Src);
+			const FVector V1 = Load(Src + VectorSize);
+			Store(Dest, ByteSwapVector<ElementSize>(V0));
+			Store(Dest + VectorSize, ByteSwapVector<ElementSize>(V1));
+		}
+		for (; Count >= VectorSize; Dest += VectorSize, Src += VectorSize, Count -= VectorSize)
+		{
+			Store(Dest, ByteSwapVector<ElementSize>(Load(Src)));
+		}
+#endif
+		for (; Count; Dest += ElementSize, Src += ElementSize, Count -= ElementSize)
+		{
+			ByteSwapElement<ElementSize>(Dest, Src);
+		}
+	}
+}
+
+void FGenericPlatformMemory::ByteSwapCopy(void* Dest, const void* Src, SIZE_T ElementSize, SIZE_T Num)
+{
+	using namespace UE::Core::Private::PlatformMemory;
+
+	uint8* Out = (uint8*)Dest;
+	const uint8* In = (const uint8*)Src;
+	switch (ElementSize)
+	{
+	case 0:
+	case 1:
+		if (Out != In)
+		{
+			memcpy(Out, In, ElementSize * Num);
+		}
+		break;
+	case 2:
+		ByteSwapCopyElements<2>(Out, In, Num);
+		break;
+	case 4:
+		ByteSwapCopyElements<4>(Out, In, Num);
+		break;
+	case 8:
+		ByteSwapCopyElements<8>(Out, In, Num);
+		break;
+	default:
+		for (SIZE_T Index = 0; Index < Num; ++Index, Out += ElementSize, In += ElementSize)
+		{
+			// Read both ends before writing either, so swapping in place works.
+			for (SIZE_T Low = 0, High = ElementSize - 1; Low <= High; ++Low, --High)
+			{
+				const uint8 Temp = In[Low];
+				Out[Low] = In[High];
+				Out[High] = Temp;
+			}
+		}
+		break;
+	}
+}
+
+namespace UE::Core::Private::PlatformMemory
+{
+	std::atomic<uint8> GOSAllocationFlags{ 0 };
+
+	struct FOSAllocationCounters
+	{
+		std::atomic<uint64> BytesInUse[(uint8)EOSPageSize::Num];
+		std::atomic<uint64> NodeBytesInUse[OS_ALLOCATION_MAX_NUMA_NODES];
+		std::atomic<uint64> LargePageFallbacks;
+	};
+
+	/** Zero initialized before any allocation can happen. */
+	static FOSAllocationCounters GOSAllocationCounters;
+
+	FORCEINLINE uint32 GetStatsNode(int8 NumaNode)
+	{
+		return FMath::Min<uint32>((uint32)NumaNode, OS_ALLOCATION_MAX_NUMA_NODES - 1);
+	}
+}
+
+void* FGenericPlatformMemory::BinnedAllocFromOS(SIZE_T Size, int32 NumaNode, FOSAllocationInfo& OutInfo)
+{
+	// Nothing to place on a generic platform.
+	OutInfo = FOSAllocationInfo();
+	void* Ptr = FPlatformMemory::BinnedAllocFromOS(Size);
+	if (Ptr)
+	{
+		TrackOSAllocation(Size, OutInfo);
+	}
+	return Ptr;
+}
+
+void FGenericPlatformMemory::BinnedFreeToOS(void* Ptr, SIZE_T Size, const FOSAllocationInfo& Info)
+{
+	TrackOSFree(Size, Info);
+	FPlatformMemory::BinnedFreeToOS(Ptr, Size);
+}
+
+EOSAllocationFlags FGenericPlatformMemory::ConfigureOSAllocations(EOSAllocationFlags Flags)
+{
+	SetOSAllocationFlags(EOSAllocationFlags::None);
+	return EOSAllocationFlags::None;
+}
+
+EOSAllocationFlags FGenericPlatformMemory::GetOSAllocationFlags()
+{
+	return (EOSAllocationFlags)UE::Core::Private::PlatformMemory::GOSAllocationFlags.load(std::memory_order_relaxed);
+}
+
+void FGenericPlatformMemory::SetOSAllocationFlags(EOSAllocationFlags Flags)
+{
+	UE::Core::Private::PlatformMemory::GOSAllocationFlags.store((uint8)Flags, std::memory_order_relaxed);
+}
+
+SIZE_T FGenericPlatformMemory::GetLargePageSize()
+{
+	return 0;
+}
+
+uint32 FGenericPlatformMemory::GetNumNumaNodes()
+{
+	return 1;
+}
+
+int32 FGenericPlatformMemory::GetCurrentNumaNode()
+{
+	return 0;
+}
+
+void FGenericPlatformMemory::TrackOSAllocation(SIZE_T Bytes, const FOSAllocationInfo& Info)
+{
+	using namespace UE::Core::Private::PlatformMemory;
+
+	GOSAllocationCounters.BytesInUse[(uint8)Info.PageSize].fetch_add(Bytes, std::memory_order_relaxed);
+	if (Info.NumaNode != INDEX_NONE)
+	{
+		GOSAllocationCounters.NodeBytesInUse[GetStatsNode(Info.NumaNode)].fetch_add(Bytes, std::memory_order_relaxed);
+	}
+}
+
+void FGenericPlatformMemory::TrackOSFree(SIZE_T Bytes, const FOSAllocationInfo& Info)
+{
+	using namespace UE::Core::Private::PlatformMemory;
+
+	GOSAllocationCounters.BytesInUse[(uint8)Info.PageSize].fetch_sub(Bytes, std::memory_order_relaxed);
+	if (Info.NumaNode != INDEX_NONE)
+	{
+		GOSAllocationCounters.NodeBytesInUse[GetStatsNode(Info.NumaNode)].fetch_sub(Bytes, std::memory_order_relaxed);
+	}
+}
+
+void FGenericPlatformMemory::TrackLargePageFallback()
+{
+	UE::Core::Private::PlatformMemory::GOSAllocationCounters.LargePageFallbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+FOSAllocationStats FGenericPlatformMemory::GetOSAllocationStats()
+{
+	using namespace UE::Core::Private::PlatformMemory;
+
+	FOSAllocationStats Stats;
+	for (uint8 PageSize = 0; PageSize < (uint8)EOSPageSize::Num; ++PageSize)
+	{
+		Stats.BytesInUse[PageSize] = GOSAllocationCounters.BytesInUse[PageSize].load(std::memory_order_relaxed);
+	}
+	for (uint32 Node = 0; Node < OS_ALLOCATION_MAX_NUMA_NODES; ++Node)
+	{
+		Stats.NodeBytesInUse[Node] = GOSAllocationCounters.NodeBytesInUse[Node].load(std::memory_order_relaxed);
+	}
+	Stats.LargePageFallbacks = GOSAllocationCounters.LargePageFallbacks.load(std::memory_order_relaxed);
+	Stats.LargePageSize = FPlatformMemory::GetLargePageSize();
+	Stats.HugePageSize = !!(FPlatformMemory::GetOSAllocationFlags() & EOSAllocationFlags::HugePages) ? 1024ull * 1024 * 1024 : 0;
+	Stats.NumNumaNodes = FPlatformMemory::GetNumNumaNodes();
+	Stats.Flags = FPlatformMemory::GetOSAllocationFlags();
+	return Stats;
+}
+
+bool FGenericPlatformMemory::GetResidentMemorySharing(uint64& OutSharedBytes, uint64& OutPrivateBytes)
+{
+	OutSharedBytes = 0;
+	OutPrivateBytes = 0;
+#if PLATFORM_LINUX
+	// The rollup sums every mapping in one read, without walking smaps mapping by mapping.
+	FILE* File = fopen("/proc/self/smaps_rollup", "r");
+	if (!File)
+	{
+		return false;
+	}
+
+	char Line[256];
+	while (fgets(Line, sizeof(Line), File))
+	{
+		unsigned long long KiloBytes;
+		if (sscanf(Line, "Shared_Clean: %llu kB", &KiloBytes) == 1 || sscanf(Line, "Shared_Dirty: %llu kB", &KiloBytes) == 1)
+		{
+			OutSharedBytes += KiloBytes * 1024;
+		}
+		else if (sscanf(Line, "Private_Clean: %llu kB", &KiloBytes) == 1 || sscanf(Line, "Private_Dirty: %llu kB", &KiloBytes) == 1)
+		{
+			OutPrivateBytes += KiloBytes * 1024;
+		}
+	}
+	fclose(File);
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,1053 @@
+#include "HAL/MallocBinned.h"
+#include "HAL/UnrealMemory.h"
+#include "HAL/MemoryMisc.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Parse.h"
+
+thread_local FMallocBinned::FPerThreadCache* FMallocBinned::ThreadCache = nullptr;
+thread_local int8 FMallocBinned::ThreadNumaNode = INDEX_NONE;
+
+#if BINNED_TAG_STATS
+thread_local uint8 FMallocBinned::CurrentTag = FMemory::Default;
+#endif
+
+namespace UE::MallocBinned::Private
+{
+	/** Size classes, each a multiple of BINNED_MINIMUM_ALIGNMENT. Steps double every four classes past 128 bytes to bound internal fragmentation to 25%. */
+	static constexpr uint32 SmallBlockSizes[BINNED_SMALL_POOL_COUNT] =
+	{
+		16,   32,   48,   64,   80,   96,   112,  128,
+		160,  192,  224,  256,  320,  384,  448,  512,
+		640,  768,  896,  1024, 1280, 1536, 1792, 2048,
+		2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192
+	};
+	static_assert(SmallBlockSizes[BINNED_SMALL_POOL_COUNT - 1] == BINNED_MAX_SMALL_POOL_SIZE, "Last size class must match BINNED_MAX_SMALL_POOL_SIZE");
+	static_assert(BINNED_POOL_REGION_SIZE % BINNED_SLICE_SIZE == 0, "Pool regions must be made of whole slices");
+
+	FORCEINLINE SIZE_T AlignUp(SIZE_T Value, SIZE_T Alignment)
+	{
+		return (Value + Alignment - 1) & ~(Alignment - 1);
+	}
+
+	/** Regions fill whole large pages when those are on, so pools get them too. */
+	FORCEINLINE SIZE_T GetPoolRegionSize()
+	{
+		return AlignUp(FMath::Max<SIZE_T>(BINNED_POOL_REGION_SIZE, FPlatformMemory::GetLargePageSize()), BINNED_SLICE_SIZE);
+	}
+
+	static_assert(FMemory::Max <= BINNED_MAX_TAGS, "Every allocation hint needs a tag");
+
+	struct FTagRegistry
+	{
+		std::mutex Mutex;
+		const TCHAR* Names[BINNED_MAX_TAGS] = { TEXT("Default"), TEXT("Temporary"), TEXT("SmallPool") };
+		uint32 NumTags = FMemory::Max;
+	};
+
+	static FTagRegistry& GetTagRegistry()
+	{
+		// Never destroyed, allocations are tagged until the process goes away.
+		static FTagRegistry* Registry = new FTagRegistry();
+		return *Registry;
+	}
+
+	FORCEINLINE double GetPercent(uint64 Part, uint64 Total)
+	{
+		return Total ? 100.0 * (double)Part / (double)Total : 0.0;
+	}
+
+	FORCEINLINE double ToMB(int64 Bytes)
+	{
+		return (double)Bytes / (1024.0 * 1024.0);
+	}
+}
+
+void FMallocBinned::FBundleStack::Push(FFreeBlock* Bundle)
+{
+	uint64 OldTop = TaggedTop.load(std::memory_order_relaxed);
+	uint64 NewTop;
+	do
+	{
+		Bundle->NextBundle = (FFreeBlock*)(UPTRINT)(OldTop & PointerMask);
+		NewTop = (UPTRINT)Bundle | (((OldTop >> TagShift) + 1) << TagShift);
+	}
+	while (!TaggedTop.compare_exchange_weak(OldTop, NewTop, std::memory_order_release, std::memory_order_relaxed));
+}
+
+FMallocBinned::FFreeBlock* FMallocBinned::FBundleStack::Pop()
+{
+	uint64 OldTop = TaggedTop.load(std::memory_order_acquire);
+	for (;;)
+	{
+		FFreeBlock* Bundle = (FFreeBlock*)(UPTRINT)(OldTop & PointerMask);
+		if (!Bundle)
+		{
+			return nullptr;
+		}
+
+		// Pool memory is never returned to the OS, so reading a stale bundle here is safe; the tag makes the exchange fail.
+		const uint64 NewTop = (UPTRINT)Bundle->NextBundle | (((OldTop >> TagShift) + 1) << TagShift);
+		if (TaggedTop.compare_exchange_weak(OldTop, NewTop, std::memory_order_acquire, std::memory_order_acquire))
+		{
+			return Bundle;
+		}
+	}
+}
+
+FMallocBinned::FMallocBinned()
+{
+	using namespace UE::MallocBinned::Private;
+
+	checkf(FPlatformMemory::GetConstants().OsAllocationGranularity >= BINNED_SLICE_SIZE, TEXT("FMallocBinned requires the OS to hand out %d byte aligned memory"), BINNED_SLICE_SIZE);
+
+	for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+	{
+		FSmallPool& Pool = SmallPools[PoolIndex];
+		Pool.BlockSize = SmallBlockSizes[PoolIndex];
+		Pool.BundleBlockCount = FMath::Clamp<uint32>(BINNED_PER_BUNDLE_MAX_BYTES / Pool.BlockSize, 2, BINNED_PER_BUNDLE_MAX_COUNT);
+	}
+
+	uint32 PoolIndex = 0;
+	for (uint32 Index = 0; Index <= BINNED_MAX_SMALL_POOL_SIZE / BINNED_MINIMUM_ALIGNMENT; ++Index)
+	{
+		const uint32 Size = Index * BINNED_MINIMUM_ALIGNMENT;
+		while (SmallBlockSizes[PoolIndex] < Size)
+		{
+			++PoolIndex;
+		}
+		SizeToPoolIndex[Index] = (uint8)PoolIndex;
+	}
+}
+
+FMallocBinned::~FMallocBinned()
+{
+	// The allocator lives until the process goes away; pools are reclaimed by the OS.
+}
+
+int8 FMallocBinned::ComputeThreadNumaNode()
+{
+	if (!(FPlatformMemory::GetOSAllocationFlags() & EOSAllocationFlags::NumaLocal))
+	{
+		return 0;
+	}
+	return (int8)(FPlatformMemory::GetCurrentNumaNode() % BINNED_MAX_NUMA_NODES);
+}
+
+uint32 FMallocBinned::GetAlignedPoolIndex(uint32 PoolIndex, uint32 Alignment) const
+{
+	// Slice headers are 64 bytes, so any size class that is a multiple of the alignment yields aligned blocks up to that.
+	if (Alignment > sizeof(FSliceHeader))
+	{
+		return BINNED_SMALL_POOL_COUNT;
+	}
+	while (PoolIndex < BINNED_SMALL_POOL_COUNT && (SmallPools[PoolIndex].BlockSize & (Alignment - 1)) != 0)
+	{
+		++PoolIndex;
+	}
+	return PoolIndex;
+}
+
+void* FMallocBinned::Malloc(SIZE_T Size, uint32 Alignment)
+{
+	const uint32 PoolIndex = GetPoolIndex(Size, Alignment);
+	if (PoolIndex < BINNED_SMALL_POOL_COUNT)
+	{
+		if (FPerThreadCache* Cache = GetThreadCache())
+		{
+			if (FFreeBlock* Block = Cache->Lists[PoolIndex])
+			{
+				Cache->Lists[PoolIndex] = Block->Next;
+				--Cache->Counts[PoolIndex];
+				TrackCachedMalloc(*Cache, Block, PoolIndex);
+				return Block;
+			}
+			return MallocSmallCached(*Cache, PoolIndex);
+		}
+		return MallocSmallUncached(PoolIndex);
+	}
+	return MallocOS(Size, Alignment);
+}
+
+void* FMallocBinned::Realloc(void* Ptr, SIZE_T NewSize, uint32 Alignment)
+{
+	if (!Ptr)
+	{
+		return NewSize ? Malloc(NewSize, Alignment) : nullptr;
+	}
+	if (NewSize == 0)
+	{
+		Free(Ptr);
+		return nullptr;
+	}
+
+	SIZE_T OldSize = 0;
+	verify(GetAllocationSize(Ptr, OldSize));
+
+	// Stay in place only when the request still lands in the same bin, any other size moves so shrinking frees memory.
+	const SIZE_T NewQuantizedSize = QuantizeSize(NewSize, Alignment);
+	const bool bIsAligned = Alignment <= BINNED_MINIMUM_ALIGNMENT || ((UPTRINT)Ptr & (Alignment - 1)) == 0;
+	if (bIsAligned && NewQuantizedSize == OldSize)
+	{
+		return Ptr;
+	}
+
+	void* Result = Malloc(NewSize, Alignment);
+	FMemory::Memcpy(Result, Ptr, FMath::Min<SIZE_T>(NewSize, OldSize));
+	Free(Ptr);
+	return Result;
+}
+
+void FMallocBinned::Free(void* Ptr)
+{
+	if (!Ptr)
+	{
+		return;
+	}
+
+	FSliceHeader* Header = GetSliceHeader(Ptr);
+	if (Header->Magic == FSliceHeader::SmallPoolMagic)
+	{
+		const uint32 PoolIndex = Header->PoolIndex;
+		FFreeBlock* Block = (FFreeBlock*)Ptr;
+		if (UNLIKELY(Header->ForkGeneration != ForkGeneration))
+		{
+			FreeFrozen(Block, PoolIndex);
+			return;
+		}
+		FPerThreadCache* Cache = GetThreadCache();
+		if (Cache && Header->NumaNode == Cache->NumaNode)
+		{
+			TrackCachedFree(*Cache, Block, PoolIndex);
+			Block->Next = Cache->Lists[PoolIndex];
+			Cache->Lists[PoolIndex] = Block;
+			if (++Cache->Counts[PoolIndex] >= SmallPools[PoolIndex].BundleBlockCount)
+			{
+				FreeSmallCached(*Cache, Block, PoolIndex);
+			}
+			return;
+		}
+		FreeSmallUncached(Block, PoolIndex, Header->NumaNode);
+		return;
+	}
+
+	checkf(Header->Magic == FSliceHeader::OSAllocationMagic, TEXT("FMallocBinned::Free called on a pointer it does not own: %p"), Ptr);
+	FreeOS(Header);
+}
+
+SIZE_T FMallocBinned::QuantizeSize(SIZE_T Count, uint32 Alignment)
+{
+	using namespace UE::MallocBinned::Private;
+
+	const uint32 PoolIndex = GetPoolIndex(Count, Alignment);
+	if (PoolIndex < BINNED_SMALL_POOL_COUNT)
+	{
+		return SmallPools[PoolIndex].BlockSize;
+	}
+
+	const SIZE_T UserOffset = FMath::Max<SIZE_T>(sizeof(FSliceHeader), Alignment);
+	return AlignUp(Count + UserOffset, FPlatformMemory::GetConstants().PageSize) - UserOffset;
+}
+
+bool FMallocBinned::GetAllocationSize(void* Original, SIZE_T& SizeOut)
+{
+	if (!Original)
+	{
+		return false;
+	}
+
+	FSliceHeader* Header = GetSliceHeader(Original);
+	if (Header->Magic == FSliceHeader::SmallPoolMagic)
+	{
+		SizeOut = SmallPools[Header->PoolIndex].BlockSize;
+		return true;
+	}
+	if (Header->Magic == FSliceHeader::OSAllocationMagic)
+	{
+		SizeOut = Header->OSAllocationSize - Header->UserOffset;
+		return true;
+	}
+	return false;
+}
+
+void* FMallocBinned::MallocSmallCached(FPerThreadCache& Cache, uint32 PoolIndex)
+{
+	FSmallPool& Pool = SmallPools[PoolIndex];
+	FNodePool& Node = Pool.Nodes[Cache.NumaNode];
+
+	if (Cache.TrimEpoch != TrimEpoch.load(std::memory_order_relaxed))
+	{
+		FlushThreadCache(Cache);
+	}
+
+	FFreeBlock* Bundle = Node.Bundles.Pop();
+	if (!Bundle)
+	{
+		std::lock_guard<std::mutex> Lock(Node.Mutex);
+		if (Node.FreeList)
+		{
+			Bundle = Node.FreeList;
+			Node.FreeList = nullptr;
+		}
+		else
+		{
+			Bundle = CarveBlocks(Pool, Node, PoolIndex, Cache.NumaNode, Pool.BundleBlockCount);
+		}
+	}
+
+	// The bundle may be shorter than BundleBlockCount; overestimating only makes the next hand over happen a little earlier.
+	Cache.Lists[PoolIndex] = Bundle->Next;
+	Cache.Counts[PoolIndex] = Pool.BundleBlockCount - 1;
+#if UPDATE_MALLOC_STATS
+	BumpStat<uint64>(Cache.Stats.MallocMisses[PoolIndex], 1);
+#endif
+	TrackCachedMalloc(Cache, Bundle, PoolIndex);
+	return Bundle;
+}
+
+void FMallocBinned::FreeSmallCached(FPerThreadCache& Cache, FFreeBlock* Block, uint32 PoolIndex)
+{
+	// The list just filled up, hand it over to the other threads as one bundle.
+	check(Cache.Lists[PoolIndex] == Block);
+	SmallPools[PoolIndex].Nodes[Cache.NumaNode].Bundles.Push(Block);
+	Cache.Lists[PoolIndex] = nullptr;
+	Cache.Counts[PoolIndex] = 0;
+#if UPDATE_MALLOC_STATS
+	BumpStat<uint64>(Cache.Stats.FreeHandovers[PoolIndex], 1);
+#endif
+
+	if (Cache.TrimEpoch != TrimEpoch.load(std::memory_order_relaxed))
+	{
+		FlushThreadCache(Cache);
+	}
+}
+
+void* FMallocBinned::MallocSmallUncached(uint32 PoolIndex)
+{
+	const uint32 NumaNode = GetThreadNumaNode();
+	FSmallPool& Pool = SmallPools[PoolIndex];
+	FNodePool& Node = Pool.Nodes[NumaNode];
+	std::lock_guard<std::mutex> Lock(Node.Mutex);
+
+	if (!Node.FreeList)
+	{
+		Node.FreeList = Node.Bundles.Pop();
+		if (!Node.FreeList)
+		{
+			Node.FreeList = CarveBlocks(Pool, Node, PoolIndex, NumaNode, 1);
+		}
+	}
+
+	FFreeBlock* Block = Node.FreeList;
+	Node.FreeList = Block->Next;
+#if UPDATE_MALLOC_STATS
+	BumpStat<uint64>(Node.UncachedMallocs, 1);
+#if BINNED_TAG_STATS
+	const uint8 Tag = CurrentTag;
+	GetBlockTag(Block) = Tag;
+	SharedTagBytes[Tag].fetch_add(Pool.BlockSize, std::memory_order_relaxed);
+#endif
+#endif
+	return Block;
+}
+
+void FMallocBinned::FreeSmallUncached(FFreeBlock* Block, uint32 PoolIndex, uint32 NumaNode)
+{
+	FSmallPool& Pool = SmallPools[PoolIndex];
+	FNodePool& Node = Pool.Nodes[NumaNode];
+	std::lock_guard<std::mutex> Lock(Node.Mutex);
+
+	Block->Next = Node.FreeList;
+	Node.FreeList = Block;
+#if UPDATE_MALLOC_STATS
+	BumpStat<uint64>(Node.UncachedFrees, 1);
+#if BINNED_TAG_STATS
+	SharedTagBytes[GetBlockTag(Block)].fetch_sub(Pool.BlockSize, std::memory_order_relaxed);
+#endif
+#endif
+}
+
+FMallocBinned::FFreeBlock* FMallocBinned::CarveBlocks(FSmallPool& Pool, FNodePool& Node, uint32 PoolIndex, uint32 NumaNode, uint32 Count)
+{
+	using namespace UE::MallocBinned::Private;
+
+	FFreeBlock* Head = nullptr;
+	FFreeBlock** Tail = &Head;
+
+	uint32 Carved = 0;
+	for (; Carved < Count; ++Carved)
+	{
+		if (Node.CarveCursor + Pool.BlockSize > Node.CarveEnd)
+		{
+			if (Carved > 0)
+			{
+				// Return what we have rather than starting a new slice for a partial bundle.
+				break;
+			}
+
+			if (Node.NextSlice == Node.RegionEnd)
+			{
+				// Pool regions are never freed, the placement of their pages does not need to be remembered.
+				const SIZE_T RegionSize = GetPoolRegionSize();
+				const bool bNumaLocal = !!(FPlatformMemory::GetOSAllocationFlags() & EOSAllocationFlags::NumaLocal);
+				FOSAllocationInfo Info;
+				Node.NextSlice = (uint8*)FPlatformMemory::BinnedAllocFromOS(RegionSize, bNumaLocal ? (int32)NumaNode : INDEX_NONE, Info);
+				if (!Node.NextSlice)
+				{
+					FPlatformMemory::OnOutOfMemory(RegionSize, BINNED_SLICE_SIZE);
+				}
+				checkf(((UPTRINT)Node.NextSlice & (BINNED_SLICE_SIZE - 1)) == 0, TEXT("BinnedAllocFromOS returned memory that is not %d byte aligned"), BINNED_SLICE_SIZE);
+				Node.RegionEnd = Node.NextSlice + RegionSize;
+#if UPDATE_MALLOC_STATS
+				OSCommits.fetch_add(1, std::memory_order_relaxed);
+				OSCommittedBytes.fetch_add(RegionSize, std::memory_order_relaxed);
+#endif
+			}
+
+			FSliceHeader* Header = (FSliceHeader*)Node.NextSlice;
+			Header->Magic = FSliceHeader::SmallPoolMagic;
+			Header->PoolIndex = PoolIndex;
+			Header->OSAllocationSize = 0;
+			Header->UserOffset = 0;
+			Header->Tag = 0;
+			Header->NumaNode = (uint8)NumaNode;
+			Header->OSAllocationInfo = FOSAllocationInfo();
+			Header->ForkGeneration = ForkGeneration;
+
+			Node.CarveCursor = Node.NextSlice + SliceBlocksOffset;
+			Node.CarveEnd = Node.NextSlice + BINNED_SLICE_SIZE;
+			Node.NextSlice += BINNED_SLICE_SIZE;
+		}
+
+		FFreeBlock* Block = (FFreeBlock*)Node.CarveCursor;
+		Node.CarveCursor += Pool.BlockSize;
+		*Tail = Block;
+		Tail = &Block->Next;
+	}
+
+	*Tail = nullptr;
+#if UPDATE_MALLOC_STATS
+	BumpStat<uint64>(Node.BlocksCarved, Carved);
+#endif
+	return Head;
+}
+
+void* FMallocBinned::MallocOS(SIZE_T Size, uint32 Alignment)
+{
+	using namespace UE::MallocBinned::Private;
+
+	checkf(Alignment <= BINNED_MAX_ALIGNMENT, TEXT("FMallocBinned does not support %u byte alignment"), Alignment);
+
+	const SIZE_T UserOffset = FMath::Max<SIZE_T>(sizeof(FSliceHeader), Alignment);
+	const SIZE_T OSAllocationSize = AlignUp(Size + UserOffset, FPlatformMemory::GetConstants().PageSize);
+
+	FOSAllocationInfo Info;
+	FSliceHeader* Header = (FSliceHeader*)FPlatformMemory::BinnedAllocFromOS(OSAllocationSize, INDEX_NONE, Info);
+	if (!Header)
+	{
+		FPlatformMemory::OnOutOfMemory(OSAllocationSize, Alignment);
+	}
+	checkf(((UPTRINT)Header & (BINNED_SLICE_SIZE - 1)) == 0, TEXT("BinnedAllocFromOS returned memory that is not %d byte aligned"), BINNED_SLICE_SIZE);
+
+	Header->Magic = FSliceHeader::OSAllocationMagic;
+	Header->PoolIndex = BINNED_SMALL_POOL_COUNT;
+	Header->OSAllocationSize = OSAllocationSize;
+	Header->UserOffset = UserOffset;
+	Header->Tag = 0;
+	Header->NumaNode = 0;
+	Header->OSAllocationInfo = Info;
+	Header->ForkGeneration = ForkGeneration;
+#if UPDATE_MALLOC_STATS
+	OSCommits.fetch_add(1, std::memory_order_relaxed);
+	OSCommittedBytes.fetch_add(OSAllocationSize, std::memory_order_relaxed);
+	LargeAllocationsInUse.fetch_add(1, std::memory_order_relaxed);
+	LargeBytesInUse.fetch_add(OSAllocationSize, std::memory_order_relaxed);
+#if BINNED_TAG_STATS
+	Header->Tag = CurrentTag;
+	SharedTagBytes[Header->Tag].fetch_add(OSAllocationSize, std::memory_order_relaxed);
+#endif
+#endif
+	return (uint8*)Header + UserOffset;
+}
+
+void FMallocBinned::FreeOS(FSliceHeader* Header)
+{
+	const SIZE_T OSAllocationSize = Header->OSAllocationSize;
+	const FOSAllocationInfo Info = Header->OSAllocationInfo;
+#if UPDATE_MALLOC_STATS
+	OSDecommits.fetch_add(1, std::memory_order_relaxed);
+	OSDecommittedBytes.fetch_add(OSAllocationSize, std::memory_order_relaxed);
+	LargeAllocationsInUse.fetch_sub(1, std::memory_order_relaxed);
+	LargeBytesInUse.fetch_sub(OSAllocationSize, std::memory_order_relaxed);
+#if BINNED_TAG_STATS
+	SharedTagBytes[Header->Tag].fetch_sub(OSAllocationSize, std::memory_order_relaxed);
+#endif
+#endif
+	if (Header->ForkGeneration == ForkGeneration)
+	{
+		// A frozen header is shared with the parent, no need to copy its page just before it is unmapped.
+		Header->Magic = 0;
+	}
+	FPlatformMemory::BinnedFreeToOS(Header, OSAllocationSize, Info);
+}
+
+void FMallocBinned::FreeFrozen(void* Block, uint32 PoolIndex)
+{
+#if UPDATE_MALLOC_STATS
+	SmallPools[PoolIndex].FrozenFrees.fetch_add(1, std::memory_order_relaxed);
+#if BINNED_TAG_STATS
+	SharedTagBytes[GetBlockTag(Block)].fetch_sub(SmallPools[PoolIndex].BlockSize, std::memory_order_relaxed);
+#endif
+#endif
+}
+
+#if UPDATE_MALLOC_STATS
+void FMallocBinned::RetireThreadStats(const FThreadStats& ThreadStats)
+{
+	for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+	{
+		BumpStat(RetiredStats.Mallocs[PoolIndex], ThreadStats.Mallocs[PoolIndex].load(std::memory_order_relaxed));
+		BumpStat(RetiredStats.Frees[PoolIndex], ThreadStats.Frees[PoolIndex].load(std::memory_order_relaxed));
+		BumpStat(RetiredStats.MallocMisses[PoolIndex], ThreadStats.MallocMisses[PoolIndex].load(std::memory_order_relaxed));
+		BumpStat(RetiredStats.FreeHandovers[PoolIndex], ThreadStats.FreeHandovers[PoolIndex].load(std::memory_order_relaxed));
+	}
+#if BINNED_TAG_STATS
+	for (uint32 Tag = 0; Tag < BINNED_MAX_TAGS; ++Tag)
+	{
+		BumpStat(RetiredStats.TagBytes[Tag], ThreadStats.TagBytes[Tag].load(std::memory_order_relaxed));
+	}
+#endif
+}
+#endif
+
+void FMallocBinned::FlushThreadCache(FPerThreadCache& Cache)
+{
+	for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+	{
+		if (FFreeBlock* List = Cache.Lists[PoolIndex])
+		{
+			SmallPools[PoolIndex].Nodes[Cache.NumaNode].Bundles.Push(List);
+			Cache.Lists[PoolIndex] = nullptr;
+			Cache.Counts[PoolIndex] = 0;
+		}
+	}
+	Cache.TrimEpoch = TrimEpoch.load(std::memory_order_relaxed);
+}
+
+void FMallocBinned::Trim(bool bTrimThreadCaches)
+{
+	if (bTrimThreadCaches)
+	{
+		// Other threads notice the new epoch and flush themselves the next time they leave the fast path.
+		TrimEpoch.fetch_add(1, std::memory_order_relaxed);
+		if (FPerThreadCache* Cache = GetThreadCache())
+		{
+			FlushThreadCache(*Cache);
+		}
+	}
+
+	// Small pool slices stay mapped: their blocks are scattered over thread caches and bundles, and the
+	// lock-free bundle stack relies on pool memory staying readable.
+}
+
+void FMallocBinned::LockForFork()
+{
+	using namespace UE::MallocBinned::Private;
+
+	GetTagRegistry().Mutex.lock();
+#if UPDATE_MALLOC_STATS
+	StatsMutex.lock();
+#endif
+	RegistrationMutex.lock();
+	for (FSmallPool& Pool : SmallPools)
+	{
+		for (FNodePool& Node : Pool.Nodes)
+		{
+			Node.Mutex.lock();
+		}
+	}
+}
+
+void FMallocBinned::UnlockAfterFork()
+{
+	using namespace UE::MallocBinned::Private;
+
+	for (int32 PoolIndex = BINNED_SMALL_POOL_COUNT - 1; PoolIndex >= 0; --PoolIndex)
+	{
+		for (int32 NumaNode = BINNED_MAX_NUMA_NODES - 1; NumaNode >= 0; --NumaNode)
+		{
+			SmallPools[PoolIndex].Nodes[NumaNode].Mutex.unlock();
+		}
+	}
+	RegistrationMutex.unlock();
+#if UPDATE_MALLOC_STATS
+	StatsMutex.unlock();
+#endif
+	GetTagRegistry().Mutex.unlock();
+}
+
+void FMallocBinned::OnPreFork()
+{
+	// The children start from fresh pools, the parent keeps its free lists. Hand the blocks cached by this thread back so
+	// the parent can reuse them from any thread once it carries on. The other threads keep their caches.
+	if (FPerThreadCache* Cache = GetThreadCache())
+	{
+		FlushThreadCache(*Cache);
+	}
+	LockForFork();
+}
+
+void FMallocBinned::OnPostForkParent()
+{
+	UnlockAfterFork();
+}
+
+void FMallocBinned::OnPostFork()
+{
+	// Only the forking thread made it into the child, nothing else can be using the allocator.
+	++ForkGeneration;
+
+	for (FSmallPool& Pool : SmallPools)
+	{
+		for (FNodePool& Node : Pool.Nodes)
+		{
+			// Dropping the lists leaks their blocks, which is what keeps the pages they sit on shared.
+			Node.Bundles.Reset();
+			Node.FreeList = nullptr;
+			Node.CarveCursor = nullptr;
+			Node.CarveEnd = nullptr;
+			Node.NextSlice = nullptr;
+			Node.RegionEnd = nullptr;
+		}
+	}
+
+	FPerThreadCache* ForkingCache = GetThreadCache();
+	if (ForkingCache)
+	{
+		for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+		{
+			ForkingCache->Lists[PoolIndex] = nullptr;
+			ForkingCache->Counts[PoolIndex] = 0;
+		}
+	}
+
+	// The caches of the threads that stayed behind in the parent are unreachable, keep their counts and forget them.
+	// Their memory is left alone, freeing it would write to the heap of the parent. RegistrationMutex is still held
+	// from OnPreFork.
+	for (FPerThreadCache* Cache = RegisteredCaches; Cache; Cache = Cache->NextRegistered)
+	{
+		if (Cache == ForkingCache)
+		{
+			continue;
+		}
+#if UPDATE_MALLOC_STATS
+		RetireThreadStats(Cache->Stats);
+#endif
+	}
+	RegisteredCaches = ForkingCache;
+	if (ForkingCache)
+	{
+		ForkingCache->NextRegistered = nullptr;
+	}
+
+#if UPDATE_MALLOC_STATS
+	FrozenBytes = OSCommittedBytes.load(std::memory_order_relaxed) - OSDecommittedBytes.load(std::memory_order_relaxed);
+#endif
+
+	// Taken by the forking thread in OnPreFork, which is the one thread of the child.
+	UnlockAfterFork();
+}
+
+void FMallocBinned::SetupTLSCachesOnCurrentThread()
+{
+	if (GetThreadCache())
+	{
+		return;
+	}
+
+	FPerThreadCache* Cache = (FPerThreadCache*)FMemory::SystemMalloc(sizeof(FPerThreadCache));
+	FMemory::Memzero(Cache, sizeof(FPerThreadCache));
+	Cache->Owner = this;
+	Cache->TrimEpoch = TrimEpoch.load(std::memory_order_relaxed);
+	Cache->NumaNode = GetThreadNumaNode();
+
+	{
+		std::lock_guard<std::mutex> Lock(RegistrationMutex);
+		Cache->NextRegistered = RegisteredCaches;
+		RegisteredCaches = Cache;
+	}
+
+	ThreadCache = Cache;
+}
+
+void FMallocBinned::ClearAndDisableTLSCachesOnCurrentThread()
+{
+	FPerThreadCache* Cache = GetThreadCache();
+	if (!Cache)
+	{
+		return;
+	}
+
+	FlushThreadCache(*Cache);
+	ThreadCache = nullptr;
+
+	{
+		std::lock_guard<std::mutex> Lock(RegistrationMutex);
+		for (FPerThreadCache** Link = &RegisteredCaches; *Link; Link = &(*Link)->NextRegistered)
+		{
+			if (*Link == Cache)
+			{
+				*Link = Cache->NextRegistered;
+				break;
+			}
+		}
+
+#if UPDATE_MALLOC_STATS
+		// Keep the counts of the thread, its blocks may live on and be freed by others.
+		RetireThreadStats(Cache->Stats);
+#endif
+	}
+
+	FMemory::SystemFree(Cache);
+}
+
+bool FMallocBinned::ValidateHeap()
+{
+	// Other threads own their caches, so only the calling thread's lists and the shared lists can be walked safely.
+	if (FPerThreadCache* Cache = GetThreadCache())
+	{
+		for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+		{
+			for (FFreeBlock* Block = Cache->Lists[PoolIndex]; Block; Block = Block->Next)
+			{
+				FSliceHeader* Header = GetSliceHeader(Block);
+				if (Header->Magic != FSliceHeader::SmallPoolMagic || Header->PoolIndex != PoolIndex || Header->NumaNode != Cache->NumaNode)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+	{
+		for (uint32 NumaNode = 0; NumaNode < BINNED_MAX_NUMA_NODES; ++NumaNode)
+		{
+			FNodePool& Node = SmallPools[PoolIndex].Nodes[NumaNode];
+			std::lock_guard<std::mutex> Lock(Node.Mutex);
+			for (FFreeBlock* Block = Node.FreeList; Block; Block = Block->Next)
+			{
+				FSliceHeader* Header = GetSliceHeader(Block);
+				if (Header->Magic != FSliceHeader::SmallPoolMagic || Header->PoolIndex != PoolIndex || Header->NumaNode != NumaNode)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+uint8 FMallocBinned::RegisterTag(const TCHAR* Name)
+{
+	using namespace UE::MallocBinned::Private;
+
+	FTagRegistry& Registry = GetTagRegistry();
+	std::lock_guard<std::mutex> Lock(Registry.Mutex);
+	for (uint32 Tag = 0; Tag < Registry.NumTags; ++Tag)
+	{
+		if (FCString::Stricmp(Registry.Names[Tag], Name) == 0)
+		{
+			return (uint8)Tag;
+		}
+	}
+	if (Registry.NumTags == BINNED_MAX_TAGS)
+	{
+		return FMemory::Default;
+	}
+	Registry.Names[Registry.NumTags] = Name;
+	return (uint8)Registry.NumTags++;
+}
+
+void FMallocBinned::GetStats(FStats& OutStats)
+{
+	FMemory::Memzero(&OutStats, sizeof(OutStats));
+	for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+	{
+		OutStats.SizeClasses[PoolIndex].BlockSize = SmallPools[PoolIndex].BlockSize;
+	}
+
+#if UPDATE_MALLOC_STATS
+	auto AddThreadStats = [&OutStats](const FThreadStats& ThreadStats)
+	{
+		for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+		{
+			FStats::FSizeClass& SizeClass = OutStats.SizeClasses[PoolIndex];
+			SizeClass.CachedMallocs += ThreadStats.Mallocs[PoolIndex].load(std::memory_order_relaxed);
+			SizeClass.CachedFrees += ThreadStats.Frees[PoolIndex].load(std::memory_order_relaxed);
+			SizeClass.CachedMallocMisses += ThreadStats.MallocMisses[PoolIndex].load(std::memory_order_relaxed);
+			SizeClass.CachedFreeHandovers += ThreadStats.FreeHandovers[PoolIndex].load(std::memory_order_relaxed);
+		}
+#if BINNED_TAG_STATS
+		for (uint32 Tag = 0; Tag < BINNED_MAX_TAGS; ++Tag)
+		{
+			OutStats.TagBytesInUse[Tag] += ThreadStats.TagBytes[Tag].load(std::memory_order_relaxed);
+		}
+#endif
+	};
+
+	{
+		std::lock_guard<std::mutex> Lock(RegistrationMutex);
+		AddThreadStats(RetiredStats);
+		for (FPerThreadCache* Cache = RegisteredCaches; Cache; Cache = Cache->NextRegistered)
+		{
+			AddThreadStats(Cache->Stats);
+		}
+	}
+
+	for (uint32 PoolIndex = 0; PoolIndex < BINNED_SMALL_POOL_COUNT; ++PoolIndex)
+	{
+		const FSmallPool& Pool = SmallPools[PoolIndex];
+		FStats::FSizeClass& SizeClass = OutStats.SizeClasses[PoolIndex];
+		SizeClass.Mallocs = SizeClass.CachedMallocs;
+		SizeClass.Frees = SizeClass.CachedFrees;
+		for (uint32 NumaNode = 0; NumaNode < BINNED_MAX_NUMA_NODES; ++NumaNode)
+		{
+			const FNodePool& Node = Pool.Nodes[NumaNode];
+			const uint64 NodeBlocksCarved = Node.BlocksCarved.load(std::memory_order_relaxed);
+			SizeClass.BlocksCarved += NodeBlocksCarved;
+			SizeClass.Mallocs += Node.UncachedMallocs.load(std::memory_order_relaxed);
+			SizeClass.Frees += Node.UncachedFrees.load(std::memory_order_relaxed);
+			OutStats.NodeBytesCarved[NumaNode] += NodeBlocksCarved * Pool.BlockSize;
+		}
+		const uint64 FrozenFrees = Pool.FrozenFrees.load(std::memory_order_relaxed);
+		SizeClass.Frees += FrozenFrees;
+		OutStats.FrozenBytesFreed += FrozenFrees * Pool.BlockSize;
+		SizeClass.BlocksInUse = (int64)(SizeClass.Mallocs - SizeClass.Frees);
+
+		OutStats.SmallBytesInUse += SizeClass.BlocksInUse * SizeClass.BlockSize;
+		OutStats.SmallBytesCarved += SizeClass.BlocksCarved * SizeClass.BlockSize;
+	}
+
+	OutStats.LargeAllocationsInUse = LargeAllocationsInUse.load(std::memory_order_relaxed);
+	OutStats.LargeBytesInUse = LargeBytesInUse.load(std::memory_order_relaxed);
+	OutStats.OSCommits = OSCommits.load(std::memory_order_relaxed);
+	OutStats.OSCommittedBytes = OSCommittedBytes.load(std::memory_order_relaxed);
+	OutStats.OSDecommits = OSDecommits.load(std::memory_order_relaxed);
+	OutStats.OSDecommittedBytes = OSDecommittedBytes.load(std::memory_order_relaxed);
+	OutStats.OS = FPlatformMemory::GetOSAllocationStats();
+	OutStats.ForkGeneration = ForkGeneration;
+	OutStats.FrozenBytes = FrozenBytes;
+
+#if BINNED_TAG_STATS
+	for (uint32 Tag = 0; Tag < BINNED_MAX_TAGS; ++Tag)
+	{
+		OutStats.TagBytesInUse[Tag] += SharedTagBytes[Tag].load(std::memory_order_relaxed);
+	}
+#endif
+#endif
+}
+
+namespace UE::MallocBinned::Private
+{
+	static void ExportStats(const FMallocBinned::FStats& Stats, FGenericMemoryStats& OutStats)
+	{
+		uint64 CachedMallocs = 0;
+		uint64 CachedMallocMisses = 0;
+		uint64 CachedFrees = 0;
+		uint64 CachedFreeHandovers = 0;
+		for (const FMallocBinned::FStats::FSizeClass& SizeClass : Stats.SizeClasses)
+		{
+			CachedMallocs += SizeClass.CachedMallocs;
+			CachedMallocMisses += SizeClass.CachedMallocMisses;
+			CachedFrees += SizeClass.CachedFrees;
+			CachedFreeHandovers += SizeClass.CachedFreeHandovers;
+
+			OutStats.Add(*FString::Printf(TEXT("BinnedBlocksInUse%u"), SizeClass.BlockSize), (SIZE_T)FMath::Max<int64>(SizeClass.BlocksInUse, 0));
+			OutStats.Add(*FString::Printf(TEXT("BinnedBlocksCarved%u"), SizeClass.BlockSize), (SIZE_T)SizeClass.BlocksCarved);
+		}
+
+		OutStats.Add(TEXT("BinnedSmallBytesInUse"), (SIZE_T)FMath::Max<int64>(Stats.SmallBytesInUse, 0));
+		OutStats.Add(TEXT("BinnedSmallBytesCarved"), (SIZE_T)Stats.SmallBytesCarved);
+		OutStats.Add(TEXT("BinnedLargeAllocationsInUse"), (SIZE_T)FMath::Max<int64>(Stats.LargeAllocationsInUse, 0));
+		OutStats.Add(TEXT("BinnedLargeBytesInUse"), (SIZE_T)FMath::Max<int64>(Stats.LargeBytesInUse, 0));
+		OutStats.Add(TEXT("BinnedOSCommits"), (SIZE_T)Stats.OSCommits);
+		OutStats.Add(TEXT("BinnedOSCommittedBytes"), (SIZE_T)Stats.OSCommittedBytes);
+		OutStats.Add(TEXT("BinnedOSDecommits"), (SIZE_T)Stats.OSDecommits);
+		OutStats.Add(TEXT("BinnedOSDecommittedBytes"), (SIZE_T)Stats.OSDecommittedBytes);
+		OutStats.Add(TEXT("BinnedCachedMallocs"), (SIZE_T)CachedMallocs);
+		OutStats.Add(TEXT("BinnedCachedMallocMisses"), (SIZE_T)CachedMallocMisses);
+		OutStats.Add(TEXT("BinnedCachedFrees"), (SIZE_T)CachedFrees);
+		OutStats.Add(TEXT("BinnedCachedFreeHandovers"), (SIZE_T)CachedFreeHandovers);
+
+		OutStats.Add(TEXT("OSDefaultPageBytesInUse"), (SIZE_T)Stats.OS.BytesInUse[(uint8)EOSPageSize::Default]);
+		OutStats.Add(TEXT("OSLargePageBytesInUse"), (SIZE_T)Stats.OS.BytesInUse[(uint8)EOSPageSize::Large]);
+		OutStats.Add(TEXT("OSHugePageBytesInUse"), (SIZE_T)Stats.OS.BytesInUse[(uint8)EOSPageSize::Huge]);
+		OutStats.Add(TEXT("OSLargePageFallbacks"), (SIZE_T)Stats.OS.LargePageFallbacks);
+		OutStats.Add(TEXT("ResidentSharedBytes"), (SIZE_T)Stats.ResidentSharedBytes);
+		OutStats.Add(TEXT("ResidentPrivateBytes"), (SIZE_T)Stats.ResidentPrivateBytes);
+		if (Stats.ForkGeneration)
+		{
+			OutStats.Add(TEXT("BinnedFrozenBytes"), (SIZE_T)Stats.FrozenBytes);
+			OutStats.Add(TEXT("BinnedFrozenBytesFreed"), (SIZE_T)Stats.FrozenBytesFreed);
+		}
+		if (!!(Stats.OS.Flags & EOSAllocationFlags::NumaLocal))
+		{
+			for (uint32 NumaNode = 0; NumaNode < FMath::Min<uint32>(Stats.OS.NumNumaNodes, OS_ALLOCATION_MAX_NUMA_NODES); ++NumaNode)
+			{
+				OutStats.Add(*FString::Printf(TEXT("OSNodeBytesInUse%u"), NumaNode), (SIZE_T)Stats.OS.NodeBytesInUse[NumaNode]);
+			}
+			for (uint32 NumaNode = 0; NumaNode < BINNED_MAX_NUMA_NODES; ++NumaNode)
+			{
+				OutStats.Add(*FString::Printf(TEXT("BinnedNodeBytesCarved%u"), NumaNode), (SIZE_T)Stats.NodeBytesCarved[NumaNode]);
+			}
+		}
+
+#if BINNED_TAG_STATS
+		FTagRegistry& Registry = GetTagRegistry();
+		std::lock_guard<std::mutex> Lock(Registry.Mutex);
+		for (uint32 Tag = 0; Tag < Registry.NumTags; ++Tag)
+		{
+			OutStats.Add(*FString::Printf(TEXT("BinnedTagBytesInUse.%s"), Registry.Names[Tag]), (SIZE_T)FMath::Max<int64>(Stats.TagBytesInUse[Tag], 0));
+		}
+#endif
+	}
+}
+
+void FMallocBinned::UpdateStats()
+{
+#if UPDATE_MALLOC_STATS
+	using namespace UE::MallocBinned::Private;
+
+	FStats Stats;
+	GetStats(Stats);
+
+	TFunction<void(const FGenericMemoryStats&)> Exporter;
+	{
+		std::lock_guard<std::mutex> Lock(StatsMutex);
+
+		// A file read and parse, far too slow for every frame.
+		const double Now = FPlatformTime::Seconds();
+		if (Now - ResidentSharingUpdateTime >= BINNED_RESIDENT_SHARING_UPDATE_SECONDS)
+		{
+			ResidentSharingUpdateTime = Now;
+			FPlatformMemory::GetResidentMemorySharing(ResidentSharedBytes, ResidentPrivateBytes);
+		}
+		Stats.ResidentSharedBytes = ResidentSharedBytes;
+		Stats.ResidentPrivateBytes = ResidentPrivateBytes;
+
+		LastStats = Stats;
+		Exporter = StatsExporter;
+	}
+
+	// Outside of the lock, the exporter may well ask for the stats again.
+	if (Exporter)
+	{
+		FGenericMemoryStats GenericStats;
+		ExportStats(Stats, GenericStats);
+		Exporter(GenericStats);
+	}
+#endif
+}
+
+void FMallocBinned::GetAllocatorStats(FGenericMemoryStats& out_Stats)
+{
+#if UPDATE_MALLOC_STATS
+	using namespace UE::MallocBinned::Private;
+
+	FStats Stats;
+	{
+		std::lock_guard<std::mutex> Lock(StatsMutex);
+		Stats = LastStats;
+	}
+	ExportStats(Stats, out_Stats);
+#endif
+}
+
+void FMallocBinned::SetStatsExporter(TFunction<void(const FGenericMemoryStats&)> InStatsExporter)
+{
+#if UPDATE_MALLOC_STATS
+	std::lock_guard<std::mutex> Lock(StatsMutex);
+	StatsExporter = MoveTemp(InStatsExporter);
+#endif
+}
+
+void FMallocBinned::DumpAllocatorStats(FOutputDevice& Ar)
+{
+#if UPDATE_MALLOC_STATS
+	using namespace UE::MallocBinned::Private;
+
+	FStats Stats;
+	GetStats(Stats);
+	FPlatformMemory::GetResidentMemorySharing(Stats.ResidentSharedBytes, Stats.ResidentPrivateBytes);
+
+	uint64 CachedMallocs = 0;
+	uint64 CachedMallocMisses = 0;
+	uint64 CachedFrees = 0;
+	uint64 CachedFreeHandovers = 0;
+	for (const FStats::FSizeClass& SizeClass : Stats.SizeClasses)
+	{
+		CachedMallocs += SizeClass.CachedMallocs;
+		CachedMallocMisses += SizeClass.CachedMallocMisses;
+		CachedFrees += SizeClass.CachedFrees;
+		CachedFreeHandovers += SizeClass.CachedFreeHandovers;
+	}
+
+	Ar.Logf(TEXT("Allocator Stats for %s:"), GetDescriptiveName());
+	Ar.Logf(TEXT("  Small blocks: %.2f MB in use of %.2f MB carved (%.1f%%)"), ToMB(Stats.SmallBytesInUse), ToMB(Stats.SmallBytesCarved), GetPercent(FMath::Max<int64>(Stats.SmallBytesInUse, 0), Stats.SmallBytesCarved));
+	Ar.Logf(TEXT("  Large allocations: %lld using %.2f MB"), Stats.LargeAllocationsInUse, ToMB(Stats.LargeBytesInUse));
+	Ar.Logf(TEXT("  OS: %.2f MB committed, %llu commits, %llu decommits of %.2f MB"), ToMB(Stats.OSCommittedBytes - Stats.OSDecommittedBytes), Stats.OSCommits, Stats.OSDecommits, ToMB(Stats.OSDecommittedBytes));
+	Ar.Logf(TEXT("  TLS caches: %.1f%% malloc hits, %.1f%% free hits"), 100.0 - GetPercent(CachedMallocMisses, CachedMallocs), 100.0 - GetPercent(CachedFreeHandovers, CachedFrees));
+	Ar.Logf(TEXT("  OS pages: %.2f MB default, %.2f MB large, %.2f MB huge, %llu large page fallbacks"), ToMB(Stats.OS.BytesInUse[(uint8)EOSPageSize::Default]),
+		ToMB(Stats.OS.BytesInUse[(uint8)EOSPageSize::Large]), ToMB(Stats.OS.BytesInUse[(uint8)EOSPageSize::Huge]), Stats.OS.LargePageFallbacks);
+	Ar.Logf(TEXT("  Resident: %.2f MB shared, %.2f MB private"), ToMB(Stats.ResidentSharedBytes), ToMB(Stats.ResidentPrivateBytes));
+	if (Stats.ForkGeneration)
+	{
+		Ar.Logf(TEXT("  Fork generation %u: %.2f MB frozen at the fork, %.2f MB of it freed"), Stats.ForkGeneration, ToMB(Stats.FrozenBytes), ToMB(Stats.FrozenBytesFreed));
+	}
+	if (!!(Stats.OS.Flags & EOSAllocationFlags::NumaLocal))
+	{
+		for (uint32 NumaNode = 0; NumaNode < FMath::Min<uint32>(Stats.OS.NumNumaNodes, OS_ALLOCATION_MAX_NUMA_NODES); ++NumaNode)
+		{
+			Ar.Logf(TEXT("  Node %u: %.2f MB from the OS, %.2f MB of small blocks carved"), NumaNode, ToMB(Stats.OS.NodeBytesInUse[NumaNode]),
+				NumaNode < BINNED_MAX_NUMA_NODES ? ToMB(Stats.NodeBytesCarved[NumaNode]) : 0.0);
+		}
+	}
+
+	Ar.Logf(TEXT("  Block Size    In Use    Carved  Occupancy      Mallocs  Cache Hits"));
+	for (const FStats::FSizeClass& SizeClass : Stats.SizeClasses)
+	{
+		if (SizeClass.BlocksCarved == 0)
+		{
+			continue;
+		}
+		Ar.Logf(TEXT("  %10u %9lld %9llu %9.1f%% %12llu %10.1f%%"), SizeClass.BlockSize, SizeClass.BlocksInUse, SizeClass.BlocksCarved,
+			GetPercent(FMath::Max<int64>(SizeClass.BlocksInUse, 0), SizeClass.BlocksCarved), SizeClass.Mallocs,
+			100.0 - GetPercent(SizeClass.CachedMallocMisses, SizeClass.CachedMallocs));
+	}
+
+#if BINNED_TAG_STATS
+	FTagRegistry& Registry = GetTagRegistry();
+	std::lock_guard<std::mutex> Lock(Registry.Mutex);
+	Ar.Logf(TEXT("  Tag                      In Use"));
+	for (uint32 Tag = 0; Tag < Registry.NumTags; ++Tag)
+	{
+		Ar.Logf(TEXT("  %-20s %8.2f MB"), Registry.Names[Tag], ToMB(Stats.TagBytesInUse[Tag]));
+	}
+#endif
+#else
+	FMalloc::DumpAllocatorStats(Ar);
+#endif
+}
+
+#if UE_ALLOW_EXEC_COMMANDS
+bool FMallocBinned::Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	if (FParse::Command(&Cmd, TEXT("memstats")))
+	{
+		DumpAllocatorStats(Ar);
+		return true;
+	}
+	return false;
+}
+#endif
@@ -0,0 +1,386 @@
+#include "HAL/MallocSampledProxy.h"
+#include "HAL/UnrealMemory.h"
+#include "Misc/CoreGlobals.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Parse.h"
+
+thread_local int32 FMallocSampledProxy::SampleCountdown = 0;
+thread_local uint32 FMallocSampledProxy::SampleRandom = 0;
+
+namespace UE::MallocSampledProxy::Private
+{
+	FORCEINLINE SIZE_T AlignUp(SIZE_T Value, SIZE_T Alignment)
+	{
+		return (Value + Alignment - 1) & ~(Alignment - 1);
+	}
+
+	FORCEINLINE double ToMB(uint64 Bytes)
+	{
+		return (double)Bytes / (1024.0 * 1024.0);
+	}
+}
+
+using namespace UE::MallocSampledProxy::Private;
+
+FMallocSampledProxy::FMallocSampledProxy(FMalloc* InUsedMalloc, ESampledMallocMode InMode, uint32 InSampleRate)
+	: UsedMalloc(InUsedMalloc)
+	, Mode(InMode)
+	, SampleRate(FMath::Max<uint32>(InSampleRate, 1))
+{
+	check(UsedMalloc);
+
+	PageSize = FPlatformMemory::FPlatformVirtualMemoryBlock::GetCommitAlignment();
+	SlotUsableSize = AlignUp(SAMPLED_MALLOC_MAX_SIZE, PageSize);
+	SlotStride = SlotUsableSize + PageSize;
+
+	const SIZE_T Size = AlignUp(SlotStride * SAMPLED_MALLOC_NUM_SLOTS, FPlatformMemory::FPlatformVirtualMemoryBlock::GetVirtualSizeAlignment());
+	Block = FPlatformMemory::FPlatformVirtualMemoryBlock::AllocateVirtual(Size);
+
+	// Without the range nothing is ever sampled, IsSampled stays false.
+	ReservedSize = Block.GetVirtualPointer() ? Size : 0;
+
+	for (int32 SlotIndex = SAMPLED_MALLOC_NUM_SLOTS - 1; SlotIndex >= 0; --SlotIndex)
+	{
+		Slots[SlotIndex] = FSlot{ 0, 0, FreeHead, ESlotState::Free };
+		FreeHead = SlotIndex;
+	}
+}
+
+FMallocSampledProxy::~FMallocSampledProxy()
+{
+	if (Block.GetVirtualPointer())
+	{
+		Block.FreeVirtual();
+	}
+}
+
+int32 FMallocSampledProxy::NextSampleInterval() const
+{
+	if (SampleRate == 1)
+	{
+		return 1;
+	}
+
+	// Uniform over [1, 2 * SampleRate - 1], so the mean is the sample rate and allocation patterns do not alias with it.
+	uint32 Random = SampleRandom ? SampleRandom : (uint32)(UPTRINT)&SampleCountdown | 1;
+	Random ^= Random << 13;
+	Random ^= Random >> 17;
+	Random ^= Random << 5;
+	SampleRandom = Random;
+	return 1 + (int32)(Random % (2 * SampleRate - 1));
+}
+
+FORCEINLINE bool FMallocSampledProxy::ShouldSample() const
+{
+	if (LIKELY(--SampleCountdown > 0))
+	{
+		return false;
+	}
+
+	// A new thread starts at 0, its first allocation only draws its first interval so it is sampled 1 in SampleRate
+	// like the others instead of always.
+	const bool bFirstInterval = SampleRandom == 0 && SampleRate > 1;
+	SampleCountdown = NextSampleInterval();
+	return !bFirstInterval;
+}
+
+void* FMallocSampledProxy::Malloc(SIZE_T Count, uint32 Alignment)
+{
+	if (UNLIKELY(ShouldSample()))
+	{
+		if (void* Ptr = MallocSampled(Count, Alignment))
+		{
+			return Ptr;
+		}
+	}
+	return UsedMalloc->Malloc(Count, Alignment);
+}
+
+void* FMallocSampledProxy::TryMalloc(SIZE_T Count, uint32 Alignment)
+{
+	if (UNLIKELY(ShouldSample()))
+	{
+		if (void* Ptr = MallocSampled(Count, Alignment))
+		{
+			return Ptr;
+		}
+	}
+	return UsedMalloc->TryMalloc(Count, Alignment);
+}
+
+void* FMallocSampledProxy::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	if (!Original)
+	{
+		return Malloc(Count, Alignment);
+	}
+	if (UNLIKELY(IsSampled(Original)))
+	{
+		return ReallocSampled(Original, Count, Alignment);
+	}
+	// Growing in place is up to the wrapped allocator, reallocations are only sampled when they start from null.
+	return UsedMalloc->Realloc(Original, Count, Alignment);
+}
+
+void* FMallocSampledProxy::TryRealloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	if (!Original)
+	{
+		return TryMalloc(Count, Alignment);
+	}
+	if (UNLIKELY(IsSampled(Original)))
+	{
+		return ReallocSampled(Original, Count, Alignment);
+	}
+	return UsedMalloc->TryRealloc(Original, Count, Alignment);
+}
+
+void FMallocSampledProxy::Free(void* Original)
+{
+	if (UNLIKELY(IsSampled(Original)))
+	{
+		FreeSampled(Original);
+		return;
+	}
+	UsedMalloc->Free(Original);
+}
+
+bool FMallocSampledProxy::GetAllocationSize(void* Original, SIZE_T& SizeOut)
+{
+	if (UNLIKELY(IsSampled(Original)))
+	{
+		SizeOut = GetSampledSize(Original);
+		return true;
+	}
+	return UsedMalloc->GetAllocationSize(Original, SizeOut);
+}
+
+void* FMallocSampledProxy::MallocSampled(SIZE_T Count, uint32 Alignment)
+{
+	const SIZE_T BlockAlignment = FMath::Max<SIZE_T>(Alignment, 16);
+	if (Count == 0 || Count > SlotUsableSize || BlockAlignment > PageSize || !ReservedSize)
+	{
+		return nullptr;
+	}
+
+	std::unique_lock<std::mutex> Lock(Mutex);
+
+	if (FreeHead == INDEX_NONE)
+	{
+		// Every slot not live is in quarantine, cutting it short is better than sampling nothing.
+		FSampledError Error;
+		EvictQuarantine(Stats.NumQuarantined / 2, MAX_uint64, Error);
+		if (Error.Kind != FSampledError::EKind::None)
+		{
+			Lock.unlock();
+			ReportError(Error);
+			return nullptr;
+		}
+		if (FreeHead == INDEX_NONE)
+		{
+			++Stats.NumSkipped;
+			return nullptr;
+		}
+	}
+
+	const int32 SlotIndex = FreeHead;
+	FSlot& Slot = Slots[SlotIndex];
+	FreeHead = Slot.Next;
+
+	// Right against the guard page, overruns by more than the alignment padding fault.
+	Slot.Size = (uint32)Count;
+	Slot.Offset = (uint32)(SlotUsableSize - AlignUp(Count, BlockAlignment));
+	Slot.Next = INDEX_NONE;
+	Slot.State = ESlotState::Live;
+
+	uint8* SlotBase = GetSlotBase(SlotIndex);
+	const SIZE_T CommitOffset = GetCommitOffset(Slot);
+	Block.Commit(SlotBase - (uint8*)Block.GetVirtualPointer() + CommitOffset, SlotUsableSize - CommitOffset);
+
+	++Stats.NumSampled;
+	++Stats.NumLive;
+	Stats.LiveBytes += SlotUsableSize - CommitOffset;
+
+	uint8* Ptr = SlotBase + Slot.Offset;
+	if (Mode == ESampledMallocMode::Poison)
+	{
+		FMemory::Memset(Ptr, SAMPLED_MALLOC_FRESH_FILL, Count);
+	}
+	return Ptr;
+}
+
+void FMallocSampledProxy::FreeSampled(void* Ptr)
+{
+	std::unique_lock<std::mutex> Lock(Mutex);
+
+	FSampledError Error;
+	const int32 SlotIndex = (int32)(((uint8*)Ptr - (uint8*)Block.GetVirtualPointer()) / SlotStride);
+	FSlot& Slot = Slots[SlotIndex];
+	if (Slot.State != ESlotState::Live || GetSlotBase(SlotIndex) + Slot.Offset != Ptr)
+	{
+		Error.Kind = Slot.State == ESlotState::Quarantined ? FSampledError::EKind::DoubleFree : FSampledError::EKind::InvalidFree;
+		Error.Ptr = Ptr;
+		Lock.unlock();
+		ReportError(Error);
+		return;
+	}
+
+	const SIZE_T CommitOffset = GetCommitOffset(Slot);
+	const SIZE_T CommittedSize = SlotUsableSize - CommitOffset;
+	if (Mode == ESampledMallocMode::Purgatory)
+	{
+		FPlatformMemory::PageProtect(GetSlotBase(SlotIndex) + CommitOffset, CommittedSize, false, false);
+	}
+	else
+	{
+		FMemory::Memset(Ptr, SAMPLED_MALLOC_FREED_FILL, Slot.Size);
+	}
+
+	Slot.State = ESlotState::Quarantined;
+	if (QuarantineTail == INDEX_NONE)
+	{
+		QuarantineHead = SlotIndex;
+	}
+	else
+	{
+		Slots[QuarantineTail].Next = SlotIndex;
+	}
+	QuarantineTail = SlotIndex;
+
+	--Stats.NumLive;
+	Stats.LiveBytes -= CommittedSize;
+	++Stats.NumQuarantined;
+	Stats.QuarantinedBytes += CommittedSize;
+
+	EvictQuarantine(SAMPLED_MALLOC_NUM_SLOTS / 2, SAMPLED_MALLOC_QUARANTINE_BYTES, Error);
+	if (Error.Kind != FSampledError::EKind::None)
+	{
+		Lock.unlock();
+		ReportError(Error);
+	}
+}
+
+void FMallocSampledProxy::EvictQuarantine(int32 MaxSlots, uint64 MaxBytes, FSampledError& OutError)
+{
+	while (QuarantineHead != INDEX_NONE && (Stats.NumQuarantined > MaxSlots || Stats.QuarantinedBytes > MaxBytes))
+	{
+		const int32 SlotIndex = QuarantineHead;
+		FSlot& Slot = Slots[SlotIndex];
+		QuarantineHead = Slot.Next;
+		if (QuarantineHead == INDEX_NONE)
+		{
+			QuarantineTail = INDEX_NONE;
+		}
+
+		uint8* CommitBase = GetSlotBase(SlotIndex) + GetCommitOffset(Slot);
+		const SIZE_T CommittedSize = SlotUsableSize - GetCommitOffset(Slot);
+		if (Mode == ESampledMallocMode::Purgatory)
+		{
+			FPlatformMemory::PageProtect(CommitBase, CommittedSize, true, true);
+		}
+		else if (!CheckPoison(Slot, SlotIndex, OutError))
+		{
+			// Left out of both lists, the error is fatal.
+			return;
+		}
+		Block.Decommit(CommitBase - (uint8*)Block.GetVirtualPointer(), CommittedSize);
+
+		--Stats.NumQuarantined;
+		Stats.QuarantinedBytes -= CommittedSize;
+
+		Slot.State = ESlotState::Free;
+		Slot.Next = FreeHead;
+		FreeHead = SlotIndex;
+	}
+}
+
+bool FMallocSampledProxy::CheckPoison(const FSlot& Slot, int32 SlotIndex, FSampledError& OutError)
+{
+	const uint8* Ptr = GetSlotBase(SlotIndex) + Slot.Offset;
+	for (uint32 Index = 0; Index < Slot.Size; ++Index)
+	{
+		if (Ptr[Index] != SAMPLED_MALLOC_FREED_FILL)
+		{
+			OutError.Kind = FSampledError::EKind::WriteAfterFree;
+			OutError.Ptr = Ptr;
+			OutError.Size = Slot.Size;
+			OutError.Offset = Index;
+			return false;
+		}
+	}
+	return true;
+}
+
+void FMallocSampledProxy::ReportError(const FSampledError& Error)
+{
+	switch (Error.Kind)
+	{
+	case FSampledError::EKind::DoubleFree:
+	case FSampledError::EKind::InvalidFree:
+		UE_LOG(LogMemory, Fatal, TEXT("%s: freeing %p, which is %s."), GetDescriptiveName(), Error.Ptr,
+			Error.Kind == FSampledError::EKind::DoubleFree ? TEXT("already freed") : TEXT("not an allocation"));
+		break;
+	case FSampledError::EKind::WriteAfterFree:
+		UE_LOG(LogMemory, Fatal, TEXT("%s: allocation %p of %u bytes was written to at offset %u after it was freed."),
+			GetDescriptiveName(), Error.Ptr, Error.Size, Error.Offset);
+		break;
+	default:
+		break;
+	}
+}
+
+SIZE_T FMallocSampledProxy::GetSampledSize(void* Ptr)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	const int32 SlotIndex = (int32)(((uint8*)Ptr - (uint8*)Block.GetVirtualPointer()) / SlotStride);
+	return Slots[SlotIndex].Size;
+}
+
+void* FMallocSampledProxy::ReallocSampled(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	if (Count == 0)
+	{
+		FreeSampled(Original);
+		return nullptr;
+	}
+
+	// Always moves, so the old slot goes through the quarantine like any free.
+	void* Ptr = Malloc(Count, Alignment);
+	if (Ptr)
+	{
+		FMemory::Memcpy(Ptr, Original, FMath::Min<SIZE_T>(Count, GetSampledSize(Original)));
+		FreeSampled(Original);
+	}
+	return Ptr;
+}
+
+void FMallocSampledProxy::GetStats(FStats& OutStats)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	OutStats = Stats;
+}
+
+void FMallocSampledProxy::DumpAllocatorStats(FOutputDevice& Ar)
+{
+	FStats CurrentStats;
+	GetStats(CurrentStats);
+
+	Ar.Logf(TEXT("Allocator Stats for %s, one allocation in %u sampled:"), GetDescriptiveName(), SampleRate);
+	Ar.Logf(TEXT("  Sampled: %llu, %llu skipped with every slot in use"), CurrentStats.NumSampled, CurrentStats.NumSkipped);
+	Ar.Logf(TEXT("  Live: %d using %.2f MB"), CurrentStats.NumLive, ToMB(CurrentStats.LiveBytes));
+	Ar.Logf(TEXT("  Quarantined: %d using %.2f MB"), CurrentStats.NumQuarantined, ToMB(CurrentStats.QuarantinedBytes));
+	UsedMalloc->DumpAllocatorStats(Ar);
+}
+
+#if UE_ALLOW_EXEC_COMMANDS
+bool FMallocSampledProxy::Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	const TCHAR* Command = Cmd;
+	if (FParse::Command(&Command, TEXT("memstats")))
+	{
+		DumpAllocatorStats(Ar);
+		return true;
+	}
+	return UsedMalloc->Exec(InWorld, Cmd, Ar);
+}
+#endif
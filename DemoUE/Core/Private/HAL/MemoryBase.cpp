@@ -0,0 +1,44 @@
+#include "HAL/MemoryBase.h"
+#include "HAL/UnrealMemory.h"
+
+void* FUseSystemMallocForNew::operator new(size_t Size)
+{
+	return FMemory::SystemMalloc(Size);
+}
+
+void FUseSystemMallocForNew::operator delete(void* Ptr)
+{
+	FMemory::SystemFree(Ptr);
+}
+
+void* FUseSystemMallocForNew::operator new[](size_t Size)
+{
+	return FMemory::SystemMalloc(Size);
+}
+
+void FUseSystemMallocForNew::operator delete[](void* Ptr)
+{
+	FMemory::SystemFree(Ptr);
+}
+
+void* FMalloc::TryMalloc(SIZE_T Count, uint32 Alignment)
+{
+	return Malloc(Count, Alignment);
+}
+
+void* FMalloc::TryRealloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	return Realloc(Original, Count, Alignment);
+}
+
+void FMalloc::InitializeStatsMetadata()
+{
+}
+
+void FMalloc::UpdateStats()
+{
+}
+
+void FMalloc::GetAllocatorStats(FGenericMemoryStats& out_Stats)
+{
+}
@@ -0,0 +1,169 @@
+#include "HAL/UnrealMemory.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/MallocSampledProxy.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+FMalloc* GMalloc = nullptr;
+
+void FMemory::GCreateMalloc()
+{
+	GMalloc = FPlatformMemory::BaseAllocator();
+}
+
+namespace UE::UnrealMemory::Private
+{
+	/** Wraps GMalloc once, the mode of the first call sticks. */
+	static void EnableSampledProxy(ESampledMallocMode Mode)
+	{
+		static FMallocSampledProxy* SampledProxy = nullptr;
+		if (SampledProxy)
+		{
+			return;
+		}
+
+		uint32 SampleRate = SAMPLED_MALLOC_DEFAULT_SAMPLE_RATE;
+		FParse::Value(FCommandLine::Get(), TEXT("MallocSampleRate="), SampleRate);
+
+		// Allocations made before are freed through the proxy too, it forwards everything it did not sample.
+		SampledProxy = new FMallocSampledProxy(GMalloc, Mode, SampleRate);
+		GMalloc = SampledProxy;
+	}
+}
+
+void FMemory::EnablePurgatoryTests()
+{
+	if (!GMalloc)
+	{
+		GCreateMalloc();
+	}
+	UE::UnrealMemory::Private::EnableSampledProxy(ESampledMallocMode::Purgatory);
+}
+
+void FMemory::EnablePoisonTests()
+{
+	if (!GMalloc)
+	{
+		GCreateMalloc();
+	}
+	UE::UnrealMemory::Private::EnableSampledProxy(ESampledMallocMode::Poison);
+}
+
+void FMemory::ExplicitInit(FMalloc& Allocator)
+{
+	check(!GMalloc);
+	GMalloc = &Allocator;
+}
+
+void* FMemory::Malloc(SIZE_T Count, uint32 Alignment)
+{
+	if (!GMalloc)
+	{
+		return MallocExternal(Count, Alignment);
+	}
+	void* Ptr = GMalloc->Malloc(Count, Alignment);
+	UE_TRACE_MEMORY_ALLOC(Ptr, Count, Alignment);
+	return Ptr;
+}
+
+void* FMemory::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	if (!GMalloc)
+	{
+		return ReallocExternal(Original, Count, Alignment);
+	}
+	void* Ptr = GMalloc->Realloc(Original, Count, Alignment);
+	UE_TRACE_MEMORY_REALLOC(Original, Ptr, Count, Alignment);
+	return Ptr;
+}
+
+void FMemory::Free(void* Original)
+{
+	if (!Original)
+	{
+		return;
+	}
+	if (!GMalloc)
+	{
+		FreeExternal(Original);
+		return;
+	}
+	// Traced first, the address may be handed out again as soon as it is freed.
+	UE_TRACE_MEMORY_FREE(Original);
+	GMalloc->Free(Original);
+}
+
+SIZE_T FMemory::GetAllocSize(void* Original)
+{
+	if (!GMalloc)
+	{
+		return GetAllocSizeExternal(Original);
+	}
+	SIZE_T Size = 0;
+	return GMalloc->GetAllocationSize(Original, Size) ? Size : 0;
+}
+
+SIZE_T FMemory::QuantizeSize(SIZE_T Count, uint32 Alignment)
+{
+	if (!GMalloc)
+	{
+		return QuantizeSizeExternal(Count, Alignment);
+	}
+	return GMalloc->QuantizeSize(Count, Alignment);
+}
+
+void FMemory::Trim(bool bTrimThreadCaches)
+{
+	if (GMalloc)
+	{
+		GMalloc->Trim(bTrimThreadCaches);
+	}
+}
+
+void FMemory::SetupTLSCachesOnCurrentThread()
+{
+	if (!GMalloc)
+	{
+		GCreateMalloc();
+	}
+	GMalloc->SetupTLSCachesOnCurrentThread();
+}
+
+void FMemory::ClearAndDisableTLSCachesOnCurrentThread()
+{
+	if (GMalloc)
+	{
+		GMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+}
+
+void* FMemory::MallocExternal(SIZE_T Count, uint32 Alignment)
+{
+	GCreateMalloc();
+	return GMalloc->Malloc(Count, Alignment);
+}
+
+void* FMemory::ReallocExternal(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	GCreateMalloc();
+	return GMalloc->Realloc(Original, Count, Alignment);
+}
+
+void FMemory::FreeExternal(void* Original)
+{
+	GCreateMalloc();
+	GMalloc->Free(Original);
+}
+
+SIZE_T FMemory::GetAllocSizeExternal(void* Original)
+{
+	GCreateMalloc();
+	SIZE_T Size = 0;
+	return GMalloc->GetAllocationSize(Original, Size) ? Size : 0;
+}
+
+SIZE_T FMemory::QuantizeSizeExternal(SIZE_T Count, uint32 Alignment)
+{
+	GCreateMalloc();
+	return GMalloc->QuantizeSize(Count, Alignment);
+}
@@ -0,0 +1,302 @@
+#include "Logging/AsyncLog.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Containers/Array.h"
+#include "Containers/ContainerAllocationPolicies.h"
+#include "HAL/UnrealMemory.h"
+#include "ProfilingDebugging/CoreTrace.h"
+
+namespace UE::Logging::Private
+{
+	std::atomic<bool> GAsyncLoggingEnabled{ false };
+
+	static_assert(ASYNC_LOG_THREAD_BUFFER_SIZE % 8 == 0, "Records are 8 byte aligned.");
+
+	/** Records larger than this are logged synchronously, they would stall the thread until its buffer is nearly empty. */
+	static constexpr uint32 MaxAsyncRecordSize = ASYNC_LOG_THREAD_BUFFER_SIZE / 4;
+
+	/** Precedes every record in a ring buffer. A Size of 0 marks the end of the buffer, the next record is at its start. */
+	struct FAsyncLogRecordHeader
+	{
+		uint32 Size;
+		uint32 PayloadSize;
+		uint64 Sequence;
+		uint64 Cycles;
+		FAsyncLogDispatchFunction Dispatch;
+		const FLogCategoryBase* Category;
+		const FStaticBasicLogRecord* Log;
+	};
+
+	/**
+	 * Single producer, single consumer ring of the records of one thread. Head and Tail only grow, the position in Data
+	 * is taken modulo its size. Buffers of exited threads are reused, their remaining records are still dispatched.
+	 */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FThreadLogBuffer
+	{
+		/** End of the published records, written by the producer. */
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Head{ 0 };
+
+		/** Start of the records not dispatched yet, written by the log thread. */
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Tail{ 0 };
+
+		std::atomic<bool> bInUse{ true };
+
+		/** The list only grows. */
+		FThreadLogBuffer* Next = nullptr;
+
+		/** Record reserved by BeginAsyncLogRecord, producer only. */
+		uint64 ReservedEnd = 0;
+
+		alignas(16) uint8 Data[ASYNC_LOG_THREAD_BUFFER_SIZE];
+	};
+
+	struct FThreadLogBufferOwner
+	{
+		FThreadLogBuffer* Buffer = nullptr;
+		bool bIsLogThread = false;
+
+		~FThreadLogBufferOwner()
+		{
+			if (Buffer)
+			{
+				Buffer->bInUse.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	static std::atomic<FThreadLogBuffer*> GThreadLogBuffers{ nullptr };
+	static std::atomic<uint64> GNextSequence{ 0 };
+	static thread_local FThreadLogBufferOwner GThreadLogBufferOwner;
+
+	static std::mutex GLogThreadMutex;
+	static std::condition_variable GLogThreadWakeUp;
+	static std::condition_variable GLogThreadProgress;
+	static std::atomic<bool> GLogThreadSleeping{ false };
+
+	static void WakeUpLogThread()
+	{
+		if (GLogThreadSleeping.load(std::memory_order_seq_cst) && GLogThreadSleeping.exchange(false, std::memory_order_seq_cst))
+		{
+			std::lock_guard<std::mutex> Lock(GLogThreadMutex);
+			GLogThreadWakeUp.notify_one();
+		}
+	}
+
+	/** @return the header of the oldest record of Buffer, skipping end markers, or nullptr if it has none */
+	static const FAsyncLogRecordHeader* PeekRecord(FThreadLogBuffer& Buffer)
+	{
+		const uint64 Head = Buffer.Head.load(std::memory_order_acquire);
+		uint64 Tail = Buffer.Tail.load(std::memory_order_relaxed);
+		if (Tail == Head)
+		{
+			return nullptr;
+		}
+		uint64 Offset = Tail % ASYNC_LOG_THREAD_BUFFER_SIZE;
+		const FAsyncLogRecordHeader* Header = (const FAsyncLogRecordHeader*)(Buffer.Data + Offset);
+		if (Header->Size == 0)
+		{
+			Tail += ASYNC_LOG_THREAD_BUFFER_SIZE - Offset;
+			Buffer.Tail.store(Tail, std::memory_order_release);
+			if (Tail == Head)
+			{
+				return nullptr;
+			}
+			Header = (const FAsyncLogRecordHeader*)Buffer.Data;
+		}
+		return Header;
+	}
+
+	/**
+	 * Dispatches the oldest record of all the buffers. Records published later with a lower sequence, which were on
+	 * their way while a newer one was dispatched, go out as soon as they are seen.
+	 *
+	 * @return false if there was nothing to dispatch
+	 */
+	static bool DispatchOldestRecord()
+	{
+		FThreadLogBuffer* OldestBuffer = nullptr;
+		const FAsyncLogRecordHeader* OldestHeader = nullptr;
+		for (FThreadLogBuffer* Buffer = GThreadLogBuffers.load(std::memory_order_acquire); Buffer; Buffer = Buffer->Next)
+		{
+			const FAsyncLogRecordHeader* Header = PeekRecord(*Buffer);
+			if (Header && (!OldestHeader || Header->Sequence < OldestHeader->Sequence))
+			{
+				OldestBuffer = Buffer;
+				OldestHeader = Header;
+			}
+		}
+		if (!OldestHeader)
+		{
+			return false;
+		}
+
+		OldestHeader->Dispatch(*OldestHeader->Category, OldestHeader->Log, { (const uint8*)(OldestHeader + 1), OldestHeader->PayloadSize, OldestHeader->Cycles });
+		OldestBuffer->Tail.store(OldestBuffer->Tail.load(std::memory_order_relaxed) + OldestHeader->Size, std::memory_order_release);
+		return true;
+	}
+
+	static void RunLogThread()
+	{
+		FMemory::SetupTLSCachesOnCurrentThread();
+		GThreadLogBufferOwner.bIsLogThread = true;
+		for (;;)
+		{
+			bool bDispatched = false;
+			while (DispatchOldestRecord())
+			{
+				bDispatched = true;
+			}
+			if (bDispatched)
+			{
+				std::lock_guard<std::mutex> Lock(GLogThreadMutex);
+				GLogThreadProgress.notify_all();
+			}
+
+			// Announce the sleep before checking one last time, producers check it after publishing.
+			GLogThreadSleeping.store(true, std::memory_order_seq_cst);
+			if (DispatchOldestRecord())
+			{
+				GLogThreadSleeping.store(false, std::memory_order_relaxed);
+				continue;
+			}
+			std::unique_lock<std::mutex> Lock(GLogThreadMutex);
+			GLogThreadWakeUp.wait_for(Lock, std::chrono::milliseconds(10), []() { return !GLogThreadSleeping.load(std::memory_order_relaxed); });
+			GLogThreadSleeping.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	static FThreadLogBuffer* AcquireThreadLogBuffer()
+	{
+		// Started with the first buffer and never stopped, like the other Core worker threads it outlives static shutdown.
+		static std::thread* LogThread = new std::thread(&RunLogThread);
+		(void)LogThread;
+
+		for (FThreadLogBuffer* Buffer = GThreadLogBuffers.load(std::memory_order_acquire); Buffer; Buffer = Buffer->Next)
+		{
+			bool bExpected = false;
+			if (!Buffer->bInUse.load(std::memory_order_relaxed) && Buffer->bInUse.compare_exchange_strong(bExpected, true, std::memory_order_acquire))
+			{
+				return Buffer;
+			}
+		}
+
+		FThreadLogBuffer* Buffer = new FThreadLogBuffer();
+		Buffer->Next = GThreadLogBuffers.load(std::memory_order_relaxed);
+		while (!GThreadLogBuffers.compare_exchange_weak(Buffer->Next, Buffer, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+		return Buffer;
+	}
+
+	uint8* BeginAsyncLogRecord(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, FAsyncLogDispatchFunction Dispatch, uint32 PayloadSize)
+	{
+		FThreadLogBufferOwner& Owner = GThreadLogBufferOwner;
+		const uint32 RecordSize = sizeof(FAsyncLogRecordHeader) + ((PayloadSize + 7) & ~7u);
+		if (Owner.bIsLogThread)
+		{
+			return nullptr;
+		}
+		if (RecordSize > MaxAsyncRecordSize)
+		{
+			// Keeps the order of this thread's own records.
+			FlushAsyncLog();
+			return nullptr;
+		}
+		if (!Owner.Buffer)
+		{
+			Owner.Buffer = AcquireThreadLogBuffer();
+		}
+		FThreadLogBuffer& Buffer = *Owner.Buffer;
+
+		uint64 Start = Buffer.Head.load(std::memory_order_relaxed);
+		const uint64 Offset = Start % ASYNC_LOG_THREAD_BUFFER_SIZE;
+		const bool bWraps = Offset + RecordSize > ASYNC_LOG_THREAD_BUFFER_SIZE;
+		const uint64 End = Start + (bWraps ? ASYNC_LOG_THREAD_BUFFER_SIZE - Offset : 0) + RecordSize;
+		while (End - Buffer.Tail.load(std::memory_order_acquire) > ASYNC_LOG_THREAD_BUFFER_SIZE)
+		{
+			WakeUpLogThread();
+			std::this_thread::yield();
+		}
+
+		if (bWraps)
+		{
+			((FAsyncLogRecordHeader*)(Buffer.Data + Offset))->Size = 0;
+			Start += ASYNC_LOG_THREAD_BUFFER_SIZE - Offset;
+		}
+		FAsyncLogRecordHeader* Header = (FAsyncLogRecordHeader*)(Buffer.Data + Start % ASYNC_LOG_THREAD_BUFFER_SIZE);
+		Header->Size = RecordSize;
+		Header->PayloadSize = PayloadSize;
+		Header->Sequence = GNextSequence.fetch_add(1, std::memory_order_relaxed);
+		Header->Cycles = FPlatformTime::Cycles64();
+		Header->Dispatch = Dispatch;
+		Header->Category = &Category;
+		Header->Log = Log;
+		Buffer.ReservedEnd = End;
+		return (uint8*)(Header + 1);
+	}
+
+	void EndAsyncLogRecord()
+	{
+		FThreadLogBuffer& Buffer = *GThreadLogBufferOwner.Buffer;
+		Buffer.Head.store(Buffer.ReservedEnd, std::memory_order_seq_cst);
+		WakeUpLogThread();
+	}
+}
+
+using namespace UE::Logging::Private;
+
+void SetAsyncLoggingEnabled(bool bEnabled)
+{
+	if (GAsyncLoggingEnabled.exchange(bEnabled) && !bEnabled)
+	{
+		FlushAsyncLog();
+	}
+}
+
+void FlushAsyncLog()
+{
+	if (GThreadLogBufferOwner.bIsLogThread)
+	{
+		return;
+	}
+	TRACE_CPU_SCOPE(FlushAsyncLog);
+
+	struct FTarget
+	{
+		FThreadLogBuffer* Buffer;
+		uint64 Head;
+	};
+	TArray<FTarget, TInlineAllocator<64>> Targets;
+	for (FThreadLogBuffer* Buffer = GThreadLogBuffers.load(std::memory_order_acquire); Buffer; Buffer = Buffer->Next)
+	{
+		const uint64 Head = Buffer->Head.load(std::memory_order_acquire);
+		if (Buffer->Tail.load(std::memory_order_acquire) != Head)
+		{
+			Targets.Add({ Buffer, Head });
+		}
+	}
+
+	auto IsDispatched = [](const FTarget& Target)
+	{
+		return Target.Buffer->Tail.load(std::memory_order_acquire) >= Target.Head;
+	};
+
+	std::unique_lock<std::mutex> Lock(GLogThreadMutex);
+	while (Targets.Num())
+	{
+		Targets.RemoveAllSwap(IsDispatched);
+		if (Targets.Num())
+		{
+			GLogThreadSleeping.store(false, std::memory_order_seq_cst);
+			GLogThreadWakeUp.notify_one();
+			GLogThreadProgress.wait_for(Lock, std::chrono::milliseconds(1));
+		}
+	}
+	Lock.unlock();
+
+	if (GBinaryLogOpen.load(std::memory_order_acquire))
+	{
+		FlushBinaryLogBuffer();
+	}
+}
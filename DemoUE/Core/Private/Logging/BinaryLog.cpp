@@ -0,0 +1,646 @@
+#include "Logging/BinaryLog.h"
+#include <mutex>
+#include <stdarg.h>
+#include "Containers/Array.h"
+#include "Containers/StringConv.h"
+#include "HAL/FileManager.h"
+#include "Logging/LogCategory.h"
+#include "Logging/LogMacros.h"
+#include "Misc/Char.h"
+#include "Misc/CString.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/Archive.h"
+#include "Templates/UniquePtr.h"
+
+namespace UE::Logging::Private
+{
+	std::atomic<bool> GBinaryLogOpen{ false };
+
+	static constexpr uint32 BinaryLogMagic = 0x474C4255; // "UBLG"
+
+	enum class EBinaryLogEntry : uint8
+	{
+		/** Metadata of a log site: id, verbosity, line, category, file, format and argument types. */
+		Site,
+		/** Site id, FPlatformTime::Cycles64 of the call, payload size and the packed arguments. */
+		Record,
+	};
+
+	struct FBinaryLogWriter
+	{
+		std::mutex Mutex;
+		FArchive* File = nullptr;
+		TArray<uint8> Buffer;
+
+		/** Bumped by every Open, site ids of a previous file are told apart by it and described again. */
+		uint32 Generation = 0;
+		uint32 NextSiteId = 0;
+		bool bReplaceTextOutput = false;
+
+		void WriteBytes(const void* Data, int64 Size)
+		{
+			Buffer.Append((const uint8*)Data, Size);
+		}
+
+		template <typename ValueType>
+		void Write(const ValueType& Value)
+		{
+			WriteBytes(&Value, sizeof(ValueType));
+		}
+
+		/** Strings of the metadata are UTF-8, so a log expands the same on any platform. */
+		void WriteUtf8(const ANSICHAR* Text, int32 Len)
+		{
+			Write(Len);
+			WriteBytes(Text, Len);
+		}
+
+		void WriteString(const TCHAR* Text)
+		{
+			FTCHARToUTF8 Utf8(Text);
+			WriteUtf8(Utf8.Get(), Utf8.Length());
+		}
+
+		/** Must hold Mutex. */
+		void FlushBuffer()
+		{
+			if (File && Buffer.Num())
+			{
+				File->Serialize(Buffer.GetData(), Buffer.Num());
+				File->Flush();
+			}
+			Buffer.Reset();
+		}
+	};
+
+	static FBinaryLogWriter& GetBinaryLogWriter()
+	{
+		// Never destroyed, logs keep coming during static shutdown.
+		static FBinaryLogWriter* Writer = new FBinaryLogWriter();
+		return *Writer;
+	}
+
+	bool WriteBinaryLogRecord(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, const EBinaryLogArgType* ArgTypes, int32 NumArgs, const FCapturedLogArgs& Args)
+	{
+		FBinaryLogWriter& Writer = GetBinaryLogWriter();
+		std::lock_guard<std::mutex> Lock(Writer.Mutex);
+		if (!Writer.File)
+		{
+			return true;
+		}
+
+		uint64 SiteId = Log->DynamicData.BinaryLogSiteId.load(std::memory_order_relaxed);
+		if ((uint32)(SiteId >> 32) != Writer.Generation)
+		{
+			SiteId = ((uint64)Writer.Generation << 32) | Writer.NextSiteId++;
+			Log->DynamicData.BinaryLogSiteId.store(SiteId, std::memory_order_relaxed);
+
+			Writer.Write(EBinaryLogEntry::Site);
+			Writer.Write((uint32)SiteId);
+			Writer.Write((uint8)Log->Verbosity);
+			Writer.Write(Log->Line);
+			Writer.WriteString(*Category.GetCategoryName().ToString());
+			Writer.WriteUtf8(Log->File, FCStringAnsi::Strlen(Log->File));
+			Writer.WriteString(Log->Format);
+			Writer.Write((uint8)NumArgs);
+			Writer.WriteBytes(ArgTypes, NumArgs);
+		}
+
+		Writer.Write(EBinaryLogEntry::Record);
+		Writer.Write((uint32)SiteId);
+		Writer.Write(Args.Cycles);
+		Writer.Write(Args.PayloadSize);
+		Writer.WriteBytes(Args.Payload, Args.PayloadSize);
+		if (Writer.Buffer.Num() >= BINARY_LOG_BUFFER_SIZE)
+		{
+			Writer.FlushBuffer();
+		}
+		return !Writer.bReplaceTextOutput;
+	}
+
+	void FlushBinaryLogBuffer()
+	{
+		FBinaryLogWriter& Writer = GetBinaryLogWriter();
+		std::lock_guard<std::mutex> Lock(Writer.Mutex);
+		Writer.FlushBuffer();
+	}
+
+	struct FBinaryLogReader
+	{
+		const uint8* Cursor;
+		const uint8* End;
+		bool bError = false;
+
+		bool ReadBytes(void* Dest, int64 Size)
+		{
+			if (bError || End - Cursor < Size)
+			{
+				bError = true;
+				return false;
+			}
+			memcpy(Dest, Cursor, Size);
+			Cursor += Size;
+			return true;
+		}
+
+		template <typename ValueType>
+		ValueType Read()
+		{
+			ValueType Value{};
+			ReadBytes(&Value, sizeof(ValueType));
+			return Value;
+		}
+
+		/** @return the next Size bytes, or nullptr past the end */
+		const uint8* Skip(int64 Size)
+		{
+			if (bError || Size < 0 || End - Cursor < Size)
+			{
+				bError = true;
+				return nullptr;
+			}
+			const uint8* Start = Cursor;
+			Cursor += Size;
+			return Start;
+		}
+
+		FString ReadString()
+		{
+			const int32 Len = Read<int32>();
+			const ANSICHAR* Text = (const ANSICHAR*)Skip(Len);
+			if (!Text)
+			{
+				return FString();
+			}
+			FUTF8ToTCHAR Converted(Text, Len);
+			return FString(Converted.Length(), Converted.Get());
+		}
+	};
+
+	struct FBinaryLogSite
+	{
+		FString Category;
+		FString File;
+		FString Format;
+		int32 Line;
+		uint8 Verbosity;
+		TArray<EBinaryLogArgType> ArgTypes;
+	};
+
+	struct FDecodedLogArg
+	{
+		EBinaryLogArgType Type;
+		int64 Int = 0;
+		uint64 UInt = 0;
+		double Float = 0.0;
+		FString String;
+		bool bIsNull = false;
+	};
+
+	/** Wide strings are copied character by character, characters the expanding platform's TCHAR cannot hold are truncated. */
+	template <typename CharType>
+	static FString ConvertLoggedString(const uint8* Data, int64 Len)
+	{
+		FString Result;
+		Result.Reserve((int32)Len);
+		for (int64 Index = 0; Index < Len; ++Index)
+		{
+			CharType Char;
+			memcpy(&Char, Data + Index * sizeof(CharType), sizeof(CharType));
+			Result.AppendChar((TCHAR)Char);
+		}
+		return Result;
+	}
+
+	static int64 GetScalarSize(EBinaryLogArgType Type, uint8 PointerSize)
+	{
+		switch (Type)
+		{
+		case EBinaryLogArgType::Int8:
+		case EBinaryLogArgType::UInt8:
+			return 1;
+		case EBinaryLogArgType::Int16:
+		case EBinaryLogArgType::UInt16:
+			return 2;
+		case EBinaryLogArgType::Int32:
+		case EBinaryLogArgType::UInt32:
+		case EBinaryLogArgType::Float:
+			return 4;
+		case EBinaryLogArgType::Pointer:
+			return PointerSize;
+		default:
+			return 8;
+		}
+	}
+
+	/** Reads an argument packed by WriteAsyncLogArg. */
+	static bool DecodeLogArg(FBinaryLogReader& Payload, EBinaryLogArgType Type, uint8 PointerSize, FDecodedLogArg& OutArg)
+	{
+		OutArg.Type = Type;
+		switch (Type)
+		{
+		case EBinaryLogArgType::Int8:		OutArg.Int = Payload.Read<int8>(); break;
+		case EBinaryLogArgType::UInt8:		OutArg.Int = Payload.Read<uint8>(); break;
+		case EBinaryLogArgType::Int16:		OutArg.Int = Payload.Read<int16>(); break;
+		case EBinaryLogArgType::UInt16:		OutArg.Int = Payload.Read<uint16>(); break;
+		case EBinaryLogArgType::Int32:		OutArg.Int = Payload.Read<int32>(); break;
+		case EBinaryLogArgType::UInt32:		OutArg.Int = Payload.Read<uint32>(); break;
+		case EBinaryLogArgType::Int64:		OutArg.Int = Payload.Read<int64>(); break;
+		case EBinaryLogArgType::UInt64:		OutArg.Int = (int64)Payload.Read<uint64>(); break;
+		case EBinaryLogArgType::Float:		OutArg.Float = Payload.Read<float>(); break;
+		case EBinaryLogArgType::Double:		OutArg.Float = Payload.Read<double>(); break;
+		case EBinaryLogArgType::Pointer:	OutArg.Int = PointerSize == 4 ? (int64)Payload.Read<uint32>() : (int64)Payload.Read<uint64>(); break;
+		case EBinaryLogArgType::String8:
+		case EBinaryLogArgType::String16:
+		case EBinaryLogArgType::String32:
+		{
+			const int64 Len = Payload.Read<int64>();
+			if (Len < 0)
+			{
+				OutArg.bIsNull = true;
+				return !Payload.bError;
+			}
+			const int64 CharSize = Type == EBinaryLogArgType::String8 ? 1 : Type == EBinaryLogArgType::String16 ? 2 : 4;
+			const int64 NumBytes = (Len + 1) * CharSize;
+			const uint8* Data = Payload.Skip((NumBytes + 7) & ~7ll);
+			if (!Data)
+			{
+				return false;
+			}
+			if (CharSize == 1)
+			{
+				FUTF8ToTCHAR Converted((const ANSICHAR*)Data, (int32)Len);
+				OutArg.String = FString(Converted.Length(), Converted.Get());
+			}
+			else
+			{
+				OutArg.String = CharSize == 2 ? ConvertLoggedString<uint16>(Data, Len) : ConvertLoggedString<uint32>(Data, Len);
+			}
+			return true;
+		}
+		default:
+			return false;
+		}
+		OutArg.UInt = (uint64)OutArg.Int;
+
+		// Every scalar takes an 8 byte slot.
+		const int64 Size = GetScalarSize(Type, PointerSize);
+		Payload.Skip(((Size + 7) & ~7ll) - Size);
+		return !Payload.bError;
+	}
+
+	/** Longest output of one numeric conversion, a wider spec from a log site is cut to it. */
+	static constexpr int32 MaxFormattedLen = 1 << 20;
+
+	/**
+	 * Formats a numeric conversion. Width and precision come from the log site and have no bound, the buffer grows until
+	 * the output fits, up to MaxFormattedLen.
+	 */
+	static void AppendFormatted(FString& Out, const TCHAR* Spec, ...)
+	{
+		TCHAR InlineBuffer[1024];
+		TArray<TCHAR> HeapBuffer;
+		TCHAR* Buffer = InlineBuffer;
+		int32 BufferSize = UE_ARRAY_COUNT(InlineBuffer);
+		for (;;)
+		{
+			va_list Args;
+			va_start(Args, Spec);
+			const int32 Len = FCString::GetVarArgs(Buffer, BufferSize, Spec, Args);
+			va_end(Args);
+			if (Len >= 0 && Len < BufferSize)
+			{
+				Out.AppendChars(Buffer, Len);
+				return;
+			}
+			if (BufferSize > MaxFormattedLen)
+			{
+				Buffer[BufferSize - 1] = TEXT('\0');
+				Out.AppendChars(Buffer, FCString::Strlen(Buffer));
+				Out += TEXT("[...]");
+				return;
+			}
+			BufferSize *= 2;
+			HeapBuffer.SetNumUninitialized(BufferSize);
+			Buffer = HeapBuffer.GetData();
+		}
+	}
+
+	/** Formats a %s conversion straight into Out, with the '-' flag, the width and the precision of Spec. */
+	static void AppendFormattedString(FString& Out, const TCHAR* Spec, const TCHAR* String, int32 StringLen)
+	{
+		bool bLeftJustify = false;
+		int32 Width = 0;
+		int32 Precision = INDEX_NONE;
+
+		const TCHAR* Fmt = Spec + 1;
+		for (; *Fmt && *Fmt != TEXT('.'); ++Fmt)
+		{
+			if (*Fmt == TEXT('-'))
+			{
+				bLeftJustify = true;
+			}
+			else if (FChar::IsDigit(*Fmt))
+			{
+				Width = (int32)FMath::Min<int64>((int64)Width * 10 + (*Fmt - TEXT('0')), MAX_int32);
+			}
+		}
+		if (*Fmt == TEXT('.'))
+		{
+			// A negative precision from '*' counts as none.
+			const bool bNegative = *++Fmt == TEXT('-');
+			Precision = 0;
+			for (Fmt += bNegative; FChar::IsDigit(*Fmt); ++Fmt)
+			{
+				Precision = (int32)FMath::Min<int64>((int64)Precision * 10 + (*Fmt - TEXT('0')), MAX_int32);
+			}
+			if (bNegative)
+			{
+				Precision = INDEX_NONE;
+			}
+		}
+
+		const int32 Len = Precision != INDEX_NONE ? FMath::Min(Precision, StringLen) : StringLen;
+		const int32 Padding = FMath::Max(Width - Len, 0);
+		if (!bLeftJustify)
+		{
+			Out += FString::ChrN(Padding, TEXT(' '));
+		}
+		Out.AppendChars(String, Len);
+		if (bLeftJustify)
+		{
+			Out += FString::ChrN(Padding, TEXT(' '));
+		}
+	}
+
+	/** Formats the message of a record one conversion at a time, with the same printf rules as the text log. */
+	static bool ExpandMessage(const FBinaryLogSite& Site, FBinaryLogReader& Payload, uint8 PointerSize, FString& Message)
+	{
+		int32 ArgIndex = 0;
+		auto NextArg = [&Site, &Payload, PointerSize, &ArgIndex](FDecodedLogArg& Arg)
+		{
+			return ArgIndex < Site.ArgTypes.Num() && DecodeLogArg(Payload, Site.ArgTypes[ArgIndex++], PointerSize, Arg);
+		};
+
+		for (const TCHAR* Fmt = *Site.Format; *Fmt;)
+		{
+			if (*Fmt != TEXT('%'))
+			{
+				Message.AppendChar(*Fmt++);
+				continue;
+			}
+			if (Fmt[1] == TEXT('%'))
+			{
+				Message.AppendChar(TEXT('%'));
+				Fmt += 2;
+				continue;
+			}
+
+			// Flags, width and precision are kept, with '*' replaced by its argument. The length modifier is replaced by
+			// one that matches how the argument was decoded.
+			FString Spec(TEXT("%"));
+			for (++Fmt; *Fmt && FCString::Strchr(TEXT("-+ #0123456789.*"), *Fmt); ++Fmt)
+			{
+				if (*Fmt == TEXT('*'))
+				{
+					FDecodedLogArg Width;
+					if (!NextArg(Width))
+					{
+						return false;
+					}
+					Spec += FString::Printf(TEXT("%lld"), Width.Int);
+				}
+				else
+				{
+					Spec.AppendChar(*Fmt);
+				}
+			}
+			while (*Fmt && FCString::Strchr(TEXT("hlLqjztI"), *Fmt))
+			{
+				// %I64d
+				if (*Fmt++ == TEXT('I'))
+				{
+					while (FChar::IsDigit(*Fmt))
+					{
+						++Fmt;
+					}
+				}
+			}
+			const TCHAR Conversion = *Fmt;
+			if (!Conversion)
+			{
+				break;
+			}
+			++Fmt;
+
+			FDecodedLogArg Arg;
+			if (!NextArg(Arg))
+			{
+				return false;
+			}
+			switch (Arg.Type)
+			{
+			case EBinaryLogArgType::String8:
+			case EBinaryLogArgType::String16:
+			case EBinaryLogArgType::String32:
+				if (Arg.bIsNull)
+				{
+					AppendFormattedString(Message, *Spec, TEXT("(null)"), 6);
+				}
+				else
+				{
+					AppendFormattedString(Message, *Spec, *Arg.String, Arg.String.Len());
+				}
+				break;
+			case EBinaryLogArgType::Float:
+			case EBinaryLogArgType::Double:
+				Spec.AppendChar(Conversion);
+				AppendFormatted(Message, *Spec, Arg.Float);
+				break;
+			case EBinaryLogArgType::Pointer:
+				Spec.AppendChar(TEXT('p'));
+				AppendFormatted(Message, *Spec, (void*)(UPTRINT)Arg.UInt);
+				break;
+			default:
+				if (Conversion == TEXT('c'))
+				{
+					Spec.AppendChar(TEXT('c'));
+					AppendFormatted(Message, *Spec, (int32)Arg.Int);
+				}
+				else if (Conversion == TEXT('d') || Conversion == TEXT('i'))
+				{
+					Spec += TEXT("ll");
+					Spec.AppendChar(Conversion);
+					AppendFormatted(Message, *Spec, (long long)Arg.Int);
+				}
+				else
+				{
+					Spec += TEXT("ll");
+					Spec.AppendChar(Conversion);
+					AppendFormatted(Message, *Spec, (unsigned long long)Arg.UInt);
+				}
+				break;
+			}
+		}
+		return true;
+	}
+}
+
+using namespace UE::Logging::Private;
+
+bool FBinaryLog::Open(const TCHAR* Filename, bool bReplaceTextOutput)
+{
+	Close();
+
+	FArchive* File = IFileManager::Get().CreateFileWriter(Filename, FILEWRITE_AllowRead);
+	if (!File)
+	{
+		return false;
+	}
+
+	FBinaryLogWriter& Writer = GetBinaryLogWriter();
+	{
+		std::lock_guard<std::mutex> Lock(Writer.Mutex);
+		Writer.File = File;
+		++Writer.Generation;
+		Writer.NextSiteId = 0;
+		Writer.bReplaceTextOutput = bReplaceTextOutput;
+
+		// Timestamps are cycles, expanded relative to the time the file was opened.
+		Writer.Write(BinaryLogMagic);
+		Writer.Write((uint32)BINARY_LOG_VERSION);
+		Writer.Write((uint8)sizeof(void*));
+		Writer.Write(FPlatformTime::GetSecondsPerCycle64());
+		Writer.Write(FPlatformTime::Cycles64());
+		Writer.Write(FDateTime::UtcNow().GetTicks());
+		Writer.FlushBuffer();
+	}
+	GBinaryLogOpen.store(true, std::memory_order_release);
+	return true;
+}
+
+void FBinaryLog::Close()
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+	FlushAsyncLog();
+	GBinaryLogOpen.store(false, std::memory_order_release);
+
+	FBinaryLogWriter& Writer = GetBinaryLogWriter();
+	std::lock_guard<std::mutex> Lock(Writer.Mutex);
+	Writer.FlushBuffer();
+	delete Writer.File;
+	Writer.File = nullptr;
+}
+
+void FBinaryLog::Flush()
+{
+	FlushAsyncLog();
+}
+
+bool FBinaryLog::IsOpen()
+{
+	return GBinaryLogOpen.load(std::memory_order_acquire);
+}
+
+bool FBinaryLog::ExpandToText(const TCHAR* BinaryLogFilename, const TCHAR* TextFilename)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, BinaryLogFilename))
+	{
+		return false;
+	}
+	FBinaryLogReader Reader{ Data.GetData(), Data.GetData() + Data.Num() };
+
+	const uint32 Magic = Reader.Read<uint32>();
+	const uint32 Version = Reader.Read<uint32>();
+	const uint8 PointerSize = Reader.Read<uint8>();
+	const double SecondsPerCycle = Reader.Read<double>();
+	const uint64 StartCycles = Reader.Read<uint64>();
+	const int64 StartTicks = Reader.Read<int64>();
+	if (Reader.bError || Magic != BinaryLogMagic || Version != BINARY_LOG_VERSION)
+	{
+		return false;
+	}
+
+	TUniquePtr<FArchive> Output(IFileManager::Get().CreateFileWriter(TextFilename));
+	if (!Output)
+	{
+		return false;
+	}
+
+	TArray<FBinaryLogSite> Sites;
+	FString Text;
+	auto WriteText = [&Output, &Text]()
+	{
+		FTCHARToUTF8 Utf8(*Text);
+		Output->Serialize((void*)Utf8.Get(), Utf8.Length());
+		Text.Reset();
+	};
+
+	bool bCorrupt = false;
+	while (Reader.Cursor < Reader.End && !bCorrupt)
+	{
+		const EBinaryLogEntry Entry = Reader.Read<EBinaryLogEntry>();
+		if (Entry == EBinaryLogEntry::Site)
+		{
+			FBinaryLogSite& Site = Sites.AddDefaulted_GetRef();
+			const uint32 SiteId = Reader.Read<uint32>();
+			Site.Verbosity = Reader.Read<uint8>();
+			Site.Line = Reader.Read<int32>();
+			Site.Category = Reader.ReadString();
+			Site.File = Reader.ReadString();
+			Site.Format = Reader.ReadString();
+			Site.ArgTypes.SetNumUninitialized(Reader.Read<uint8>());
+			Reader.ReadBytes(Site.ArgTypes.GetData(), Site.ArgTypes.Num());
+			bCorrupt = SiteId != (uint32)(Sites.Num() - 1);
+		}
+		else if (Entry == EBinaryLogEntry::Record)
+		{
+			const uint32 SiteId = Reader.Read<uint32>();
+			const uint64 Cycles = Reader.Read<uint64>();
+			const uint32 PayloadSize = Reader.Read<uint32>();
+			const uint8* Payload = Reader.Skip(PayloadSize);
+			if (!Payload || SiteId >= (uint32)Sites.Num())
+			{
+				bCorrupt = true;
+				break;
+			}
+			const FBinaryLogSite& Site = Sites[SiteId];
+
+			const FDateTime Time = FDateTime(StartTicks) + FTimespan::FromSeconds((double)(int64)(Cycles - StartCycles) * SecondsPerCycle);
+			Text += FString::Printf(TEXT("[%s]%s: "), *Time.ToString(TEXT("%Y.%m.%d-%H.%M.%S:%s")), *Site.Category);
+			const ELogVerbosity::Type Verbosity = (ELogVerbosity::Type)(Site.Verbosity & ELogVerbosity::VerbosityMask);
+			if (Verbosity != ELogVerbosity::Log)
+			{
+				Text += FString::Printf(TEXT("%s: "), ToString(Verbosity));
+			}
+			FBinaryLogReader PayloadReader{ Payload, Payload + PayloadSize };
+			if (!ExpandMessage(Site, PayloadReader, PointerSize, Text))
+			{
+				Text += TEXT(" <bad arguments>");
+			}
+			Text += LINE_TERMINATOR;
+			if (Text.Len() >= BINARY_LOG_BUFFER_SIZE)
+			{
+				WriteText();
+			}
+		}
+		else
+		{
+			bCorrupt = true;
+		}
+		bCorrupt |= Reader.bError;
+	}
+
+	// A log cut short by a crash still expands up to its last complete record.
+	if (bCorrupt)
+	{
+		Text += TEXT("<binary log ends with an incomplete or corrupt entry>") LINE_TERMINATOR;
+	}
+	WriteText();
+	return Output->Close();
+}
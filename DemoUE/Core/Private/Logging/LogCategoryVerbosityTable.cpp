@@ -0,0 +1,286 @@
+#include "Logging/LogCategoryVerbosityTable.h"
+#include <mutex>
+#include "Containers/Map.h"
+#include "Containers/UnrealString.h"
+#include "Logging/LogCategory.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/CoreGlobals.h"
+#include "Misc/CoreMisc.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Optional.h"
+#include "Misc/Parse.h"
+#include "UObject/NameTypes.h"
+
+namespace UE::Logging::Private
+{
+	std::atomic<uint8> GLogCategoryVerbosity[LOG_CATEGORY_VERBOSITY_TABLE_SIZE] = { ELogVerbosity::All, ELogVerbosity::All };
+
+	/** First slot handed out to a category. */
+	static constexpr uint32 FirstLogCategorySlot = UntrackedLogCategorySlot + 1;
+
+	struct FLogCategoryVerbosityState
+	{
+		std::mutex Mutex;
+
+		/** Category of every slot, the reserved slots below FirstLogCategorySlot have none. */
+		TArray<FName> SlotNames{ FName(), FName() };
+		TArray<FLogCategoryBase*> SlotCategories{ nullptr, nullptr };
+		TMap<FName, uint32> Slots;
+
+		/** Verbosities set for categories that did not register yet. */
+		TMap<FName, ELogVerbosity::Type> PendingVerbosities;
+		TOptional<ELogVerbosity::Type> AllVerbosity;
+	};
+
+	static FLogCategoryVerbosityState& GetLogCategoryVerbosityState()
+	{
+		// Never destroyed, categories keep logging during static shutdown.
+		static FLogCategoryVerbosityState* State = new FLogCategoryVerbosityState();
+		return *State;
+	}
+
+	/** Sets the verbosity of a registered category outside the table lock, in case it calls back into OnLogCategoryVerbosityChanged. */
+	static void ApplyToCategory(FLogCategoryBase* Category, ELogVerbosity::Type Verbosity)
+	{
+		if (Category && (Category->GetVerbosity() & ELogVerbosity::VerbosityMask) != Verbosity)
+		{
+			Category->SetVerbosity(Verbosity);
+		}
+	}
+
+	bool RegisterLogSiteCategory(std::atomic<uint32>& OutSlot, const FLogCategoryBase& Category, ELogVerbosity::Type Verbosity)
+	{
+		const FName CategoryName = Category.GetCategoryName();
+
+		FLogCategoryVerbosityState& State = GetLogCategoryVerbosityState();
+		uint32 Slot;
+		ELogVerbosity::Type InitialVerbosity = ELogVerbosity::NoLogging;
+		FLogCategoryBase* NewCategory = nullptr;
+		{
+			std::lock_guard<std::mutex> Lock(State.Mutex);
+			if (const uint32* ExistingSlot = State.Slots.Find(CategoryName))
+			{
+				Slot = *ExistingSlot;
+			}
+			else if (State.SlotNames.Num() < LOG_CATEGORY_VERBOSITY_TABLE_SIZE)
+			{
+				// Log categories are mutable globals, UE_LOG only hands them out as const.
+				NewCategory = const_cast<FLogCategoryBase*>(&Category);
+				Slot = State.SlotNames.Add(CategoryName);
+				State.SlotCategories.Add(NewCategory);
+				State.Slots.Add(CategoryName, Slot);
+
+				InitialVerbosity = (ELogVerbosity::Type)(Category.GetVerbosity() & ELogVerbosity::VerbosityMask);
+				if (const ELogVerbosity::Type* PendingVerbosity = State.PendingVerbosities.Find(CategoryName))
+				{
+					InitialVerbosity = *PendingVerbosity;
+					State.PendingVerbosities.Remove(CategoryName);
+				}
+				else if (State.AllVerbosity.IsSet())
+				{
+					InitialVerbosity = State.AllVerbosity.GetValue();
+				}
+				GLogCategoryVerbosity[Slot].store((uint8)InitialVerbosity, std::memory_order_relaxed);
+			}
+			else
+			{
+				Slot = UntrackedLogCategorySlot;
+			}
+		}
+
+		OutSlot.store(Slot, std::memory_order_relaxed);
+		if (Slot == UntrackedLogCategorySlot)
+		{
+			return Category.IsSuppressed(Verbosity);
+		}
+
+		// An override set before the category registered becomes its verbosity too.
+		ApplyToCategory(NewCategory, InitialVerbosity);
+		return (Verbosity & ELogVerbosity::VerbosityMask) > GLogCategoryVerbosity[Slot].load(std::memory_order_relaxed);
+	}
+
+	void OnLogCategoryVerbosityChanged(const FLogCategoryBase& Category)
+	{
+		const FName CategoryName = Category.GetCategoryName();
+		const ELogVerbosity::Type Verbosity = (ELogVerbosity::Type)(Category.GetVerbosity() & ELogVerbosity::VerbosityMask);
+
+		FLogCategoryVerbosityState& State = GetLogCategoryVerbosityState();
+		std::lock_guard<std::mutex> Lock(State.Mutex);
+		if (const uint32* Slot = State.Slots.Find(CategoryName))
+		{
+			GLogCategoryVerbosity[*Slot].store((uint8)Verbosity, std::memory_order_relaxed);
+		}
+		else
+		{
+			// The category registers with its own verbosity, which is now newer than the override.
+			State.PendingVerbosities.Remove(CategoryName);
+		}
+	}
+
+	/** Applies "Category Verbosity", with All for every category. @return false if it could not be parsed */
+	static bool ApplyVerbosityCommand(const TCHAR* Command)
+	{
+		FString CategoryToken;
+		FString VerbosityToken;
+		ELogVerbosity::Type Verbosity;
+		if (!FParse::Token(Command, CategoryToken, false)
+			|| !FParse::Token(Command, VerbosityToken, false)
+			|| !TryParseLogVerbosityFromString(*VerbosityToken, VerbosityToken.Len(), Verbosity))
+		{
+			return false;
+		}
+
+		if (CategoryToken == TEXT("All") || CategoryToken == TEXT("Global"))
+		{
+			FLogCategoryVerbosityTable::SetAllVerbosity(Verbosity);
+		}
+		else
+		{
+			FLogCategoryVerbosityTable::SetVerbosity(FName(*CategoryToken), Verbosity);
+		}
+		return true;
+	}
+
+	class FLogCategoryVerbosityExec : public FSelfRegisteringExec
+	{
+	protected:
+		virtual bool Exec_Runtime(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override
+		{
+			if (!FParse::Command(&Cmd, TEXT("LogVerbosity")))
+			{
+				return false;
+			}
+
+			const TCHAR* Arguments = Cmd;
+			FString CategoryToken;
+			if (!FParse::Token(Cmd, CategoryToken, false))
+			{
+				Ar.Log(TEXT("Usage: LogVerbosity <Category|All> <Verbosity>, LogVerbosity <Category>, LogVerbosity List"));
+				return true;
+			}
+
+			if (CategoryToken == TEXT("List"))
+			{
+				FLogCategoryVerbosityState& State = GetLogCategoryVerbosityState();
+				std::lock_guard<std::mutex> Lock(State.Mutex);
+				for (int32 Slot = FirstLogCategorySlot; Slot < State.SlotNames.Num(); ++Slot)
+				{
+					Ar.Logf(TEXT("%s %s"), *State.SlotNames[Slot].ToString(), ToString((ELogVerbosity::Type)GLogCategoryVerbosity[Slot].load(std::memory_order_relaxed)));
+				}
+				return true;
+			}
+
+			FString VerbosityToken;
+			if (!FParse::Token(Cmd, VerbosityToken, false))
+			{
+				ELogVerbosity::Type Verbosity;
+				if (FLogCategoryVerbosityTable::GetVerbosity(FName(*CategoryToken), Verbosity))
+				{
+					Ar.Logf(TEXT("%s %s"), *CategoryToken, ToString(Verbosity));
+				}
+				else
+				{
+					Ar.Logf(TEXT("%s has not logged yet."), *CategoryToken);
+				}
+				return true;
+			}
+
+			if (!ApplyVerbosityCommand(Arguments))
+			{
+				Ar.Logf(TEXT("Unknown verbosity %s."), *VerbosityToken);
+			}
+			return true;
+		}
+	};
+	static FLogCategoryVerbosityExec GLogCategoryVerbosityExec;
+}
+
+using namespace UE::Logging::Private;
+
+void FLogCategoryVerbosityTable::SetVerbosity(const FName& CategoryName, ELogVerbosity::Type Verbosity)
+{
+	Verbosity = (ELogVerbosity::Type)(Verbosity & ELogVerbosity::VerbosityMask);
+
+	FLogCategoryVerbosityState& State = GetLogCategoryVerbosityState();
+	FLogCategoryBase* Category = nullptr;
+	{
+		std::lock_guard<std::mutex> Lock(State.Mutex);
+		if (const uint32* Slot = State.Slots.Find(CategoryName))
+		{
+			GLogCategoryVerbosity[*Slot].store((uint8)Verbosity, std::memory_order_relaxed);
+			Category = State.SlotCategories[*Slot];
+		}
+		else
+		{
+			State.PendingVerbosities.Add(CategoryName, Verbosity);
+		}
+	}
+	ApplyToCategory(Category, Verbosity);
+}
+
+void FLogCategoryVerbosityTable::SetAllVerbosity(ELogVerbosity::Type Verbosity)
+{
+	Verbosity = (ELogVerbosity::Type)(Verbosity & ELogVerbosity::VerbosityMask);
+
+	FLogCategoryVerbosityState& State = GetLogCategoryVerbosityState();
+	TArray<FLogCategoryBase*> Categories;
+	{
+		std::lock_guard<std::mutex> Lock(State.Mutex);
+		for (int32 Slot = FirstLogCategorySlot; Slot < State.SlotNames.Num(); ++Slot)
+		{
+			GLogCategoryVerbosity[Slot].store((uint8)Verbosity, std::memory_order_relaxed);
+		}
+		Categories = State.SlotCategories;
+		State.PendingVerbosities.Reset();
+		State.AllVerbosity = Verbosity;
+	}
+	for (FLogCategoryBase* Category : Categories)
+	{
+		ApplyToCategory(Category, Verbosity);
+	}
+}
+
+bool FLogCategoryVerbosityTable::GetVerbosity(const FName& CategoryName, ELogVerbosity::Type& OutVerbosity)
+{
+	FLogCategoryVerbosityState& State = GetLogCategoryVerbosityState();
+	std::lock_guard<std::mutex> Lock(State.Mutex);
+	if (const uint32* Slot = State.Slots.Find(CategoryName))
+	{
+		OutVerbosity = (ELogVerbosity::Type)GLogCategoryVerbosity[*Slot].load(std::memory_order_relaxed);
+		return true;
+	}
+	if (const ELogVerbosity::Type* PendingVerbosity = State.PendingVerbosities.Find(CategoryName))
+	{
+		OutVerbosity = *PendingVerbosity;
+		return true;
+	}
+	return false;
+}
+
+void FLogCategoryVerbosityTable::ApplyCommands(const TCHAR* Commands)
+{
+	TArray<FString> CommandList;
+	FString(Commands).ParseIntoArray(CommandList, TEXT(","), true);
+	for (const FString& Command : CommandList)
+	{
+		ApplyVerbosityCommand(*Command);
+	}
+}
+
+void FLogCategoryVerbosityTable::ApplyConfig(const FString& Filename)
+{
+	TArray<FString> Lines;
+	if (!GConfig || !GConfig->GetSection(TEXT("Core.Log"), Lines, Filename))
+	{
+		return;
+	}
+	for (const FString& Line : Lines)
+	{
+		FString Category;
+		FString Verbosity;
+		if (Line.Split(TEXT("="), &Category, &Verbosity))
+		{
+			ApplyVerbosityCommand(*FString::Printf(TEXT("%s %s"), *Category.TrimStartAndEnd(), *Verbosity.TrimStartAndEnd()));
+		}
+	}
+}
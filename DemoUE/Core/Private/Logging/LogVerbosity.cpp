@@ -1,4 +1,5 @@
 #include "Logging/LogVerbosity.h"
+#include "Misc/CString.h"
 
 const TCHAR* ToString(ELogVerbosity::Type Verbosity)
 {
@@ -24,43 +25,122 @@ const TCHAR* ToString(ELogVerbosity::Type Verbosity)
 	return TEXT("UnknownVerbosity");
 }
 
-CORE_API ELogVerbosity::Type ParseLogVerbosityFromString(const FString& VerbosityString)
+namespace UE::Logging::Private
 {
-	if (VerbosityString == TEXT("NoLogging"))
+	/** Case insensitive FNV-1a, the names are plain ASCII. */
+	constexpr uint32 HashVerbosityName(const TCHAR* Name, int32 Len)
 	{
-		return ELogVerbosity::NoLogging;
+		uint32 Hash = 0x811c9dc5;
+		for (int32 Index = 0; Index < Len; ++Index)
+		{
+			const TCHAR Char = Name[Index];
+			Hash = (Hash ^ (uint32)(Char >= TEXT('A') && Char <= TEXT('Z') ? Char + (TEXT('a') - TEXT('A')) : Char)) * 0x01000193;
+		}
+		return Hash;
 	}
-	else if (VerbosityString == TEXT("Fatal"))
+
+	constexpr int32 VerbosityNameLen(const TCHAR* Name)
 	{
-		return ELogVerbosity::Fatal;
+		int32 Len = 0;
+		while (Name[Len])
+		{
+			++Len;
+		}
+		return Len;
 	}
-	else if (VerbosityString == TEXT("Error"))
+
+	struct FVerbosityName
 	{
-		return ELogVerbosity::Error;
-	}
-	else if (VerbosityString == TEXT("Warning"))
+		const TCHAR* Name;
+		int32 Len;
+		uint32 Hash;
+		ELogVerbosity::Type Verbosity;
+
+		constexpr FVerbosityName(const TCHAR* InName, ELogVerbosity::Type InVerbosity)
+			: Name(InName)
+			, Len(VerbosityNameLen(InName))
+			, Hash(HashVerbosityName(InName, VerbosityNameLen(InName)))
+			, Verbosity(InVerbosity)
+		{
+		}
+	};
+
+	static constexpr FVerbosityName VerbosityNames[] =
 	{
-		return ELogVerbosity::Warning;
-	}
-	else if (VerbosityString == TEXT("Display"))
+		{ TEXT("NoLogging"), ELogVerbosity::NoLogging },
+		{ TEXT("Fatal"), ELogVerbosity::Fatal },
+		{ TEXT("Error"), ELogVerbosity::Error },
+		{ TEXT("Warning"), ELogVerbosity::Warning },
+		{ TEXT("Display"), ELogVerbosity::Display },
+		{ TEXT("Log"), ELogVerbosity::Log },
+		{ TEXT("Verbose"), ELogVerbosity::Verbose },
+		{ TEXT("VeryVerbose"), ELogVerbosity::VeryVerbose },
+	};
+
+	/** Every name lands in its own bucket, a lookup is one hash, one probe and one compare. */
+	static constexpr uint32 NumVerbosityBuckets = 31;
+
+	constexpr bool AreVerbosityBucketsUnique()
 	{
-		return ELogVerbosity::Display;
+		for (const FVerbosityName& A : VerbosityNames)
+		{
+			for (const FVerbosityName& B : VerbosityNames)
+			{
+				if (&A != &B && A.Hash % NumVerbosityBuckets == B.Hash % NumVerbosityBuckets)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
 	}
-	else if (VerbosityString == TEXT("Log"))
+	static_assert(AreVerbosityBucketsUnique(), "Two verbosity names share a bucket, change NumVerbosityBuckets.");
+
+	struct FVerbosityBuckets
 	{
-		return ELogVerbosity::Log;
-	}
-	else if (VerbosityString == TEXT("Verbose"))
+		int8 Index[NumVerbosityBuckets];
+
+		constexpr FVerbosityBuckets()
+			: Index()
+		{
+			for (int8& Bucket : Index)
+			{
+				Bucket = -1;
+			}
+			for (int32 NameIndex = 0; NameIndex < UE_ARRAY_COUNT(VerbosityNames); ++NameIndex)
+			{
+				Index[VerbosityNames[NameIndex].Hash % NumVerbosityBuckets] = (int8)NameIndex;
+			}
+		}
+	};
+	static constexpr FVerbosityBuckets VerbosityBuckets;
+}
+
+bool TryParseLogVerbosityFromString(const TCHAR* VerbosityString, int32 Len, ELogVerbosity::Type& OutVerbosity)
+{
+	using namespace UE::Logging::Private;
+
+	const int32 NameIndex = VerbosityBuckets.Index[HashVerbosityName(VerbosityString, Len) % NumVerbosityBuckets];
+	if (NameIndex < 0)
 	{
-		return ELogVerbosity::Verbose;
+		return false;
 	}
-	else if (VerbosityString == TEXT("VeryVerbose"))
+	const FVerbosityName& Name = VerbosityNames[NameIndex];
+	if (Name.Len != Len || FCString::Strnicmp(Name.Name, VerbosityString, Len) != 0)
 	{
-		return ELogVerbosity::VeryVerbose;
+		return false;
 	}
-	else
+	OutVerbosity = Name.Verbosity;
+	return true;
+}
+
+CORE_API ELogVerbosity::Type ParseLogVerbosityFromString(const FString& VerbosityString)
+{
+	ELogVerbosity::Type Verbosity;
+	if (TryParseLogVerbosityFromString(*VerbosityString, VerbosityString.Len(), Verbosity))
 	{
-		// An unknown value is treated as log
-		return ELogVerbosity::Log;
+		return Verbosity;
 	}
+	// An unknown value is treated as log
+	return ELogVerbosity::Log;
 }
@@ -1,5 +1,6 @@
 #include "Misc/ConfigCacheIni.h"
 #include "Misc/CoreGlobals.h"
+#include "Misc/ConfigPrecompiledCache.h"
 
 FConfigCacheIni::FConfigCacheIni(EConfigCacheType InType)
 	: bAreFileOperationsDisabled(false), bIsReadyForUse(false), Type(InType)
@@ -13,5 +14,127 @@ FConfigCacheIni::FConfigCacheIni()
 FConfigCacheIni::~FConfigCacheIni()
 {
 	// this destructor can run at file scope, static shutdown
-	Flush(1);
+	FlushAsync();
+	if (Type == EConfigCacheType::DiskBacked)
+	{
+		FConfigFlushQueue::Get().WaitForPendingWrites();
+	}
+}
+
+const FConfigFile* FConfigCacheIni::FKnownConfigFiles::GetFile(FName Name)
+{
+	return GetMutableFile(Name);
+}
+
+FConfigFile* FConfigCacheIni::FKnownConfigFiles::GetMutableFile(FName Name)
+{
+	// walk the list of files looking for matching FName (a TMap was slower than this loop)
+	for (int32 Index = 0; Index < (int32)EKnownIniFile::NumKnownFiles; ++Index)
+	{
+		if (Files[Index].IniName == Name)
+		{
+			if (PrecompiledCache)
+			{
+				PrecompiledCache->MaterializeOnce(Index, Files[Index].IniFile);
+			}
+			return &Files[Index].IniFile;
+		}
+	}
+	return nullptr;
+}
+
+bool FConfigCacheIni::CreateGConfigFromPrecompiledCache(const TCHAR* Filename)
+{
+	TSharedPtr<FConfigPrecompiledCache> PrecompiledCache(FConfigPrecompiledCache::Open(Filename, FConfigPrecompiledCache::ComputeContextKey()));
+	if (!PrecompiledCache)
+	{
+		return false;
+	}
+
+	FConfigCacheIni* NewConfig = new FConfigCacheIni(EConfigCacheType::DiskBacked);
+	for (int32 Index = 0; Index < (int32)EKnownIniFile::NumKnownFiles; ++Index)
+	{
+		FKnownConfigFiles::FKnownConfigFile& Known = NewConfig->KnownFiles.Files[Index];
+		if (Known.IniName != FName(*PrecompiledCache->GetIniName(Index)))
+		{
+			// The list of known files changed without the snapshot version being bumped.
+			delete NewConfig;
+			return false;
+		}
+		Known.IniPath = PrecompiledCache->GetIniPath(Index);
+	}
+	NewConfig->KnownFiles.PrecompiledCache = MoveTemp(PrecompiledCache);
+	NewConfig->KnownFiles.SetGlobalIniStringsFromMembers();
+	NewConfig->bIsReadyForUse = true;
+
+	GConfig = NewConfig;
+	return true;
+}
+
+bool FConfigCacheIni::SavePrecompiledCache(const TCHAR* Filename)
+{
+	return FConfigPrecompiledCache::Save(Filename, FConfigPrecompiledCache::ComputeContextKey(), KnownFiles);
+}
+
+void FConfigCacheIni::FlushAsync(const FString& Filename)
+{
+	if (Type != EConfigCacheType::DiskBacked || bAreFileOperationsDisabled)
+	{
+		return;
+	}
+
+	auto QueueFile = [this, &Filename](const FString& CacheFilename, const FString& DiskFilename, FConfigFile& File)
+	{
+		// The writer cannot touch the files, one it failed to write is marked dirty again here, whole since the sections
+		// it lost are not known anymore.
+		if (FConfigFlushQueue::Get().TakeFailedWrite(DiskFilename))
+		{
+			File.Dirty = true;
+			DirtySections.Remove(CacheFilename);
+		}
+		if ((Filename.Len() && Filename != CacheFilename) || !File.Dirty || File.NoSave)
+		{
+			return;
+		}
+		const TSet<FString>* Sections = DirtySections.Find(CacheFilename);
+		FConfigFlushQueue::Get().Enqueue(DiskFilename, File, Sections ? *Sections : TSet<FString>(), Sections == nullptr);
+		File.Dirty = false;
+		DirtySections.Remove(CacheFilename);
+	};
+
+	// Files still waiting in a precompiled cache cannot be dirty, reading IniFile directly keeps them there.
+	for (FKnownConfigFiles::FKnownConfigFile& Known : KnownFiles.Files)
+	{
+		QueueFile(Known.IniName.ToString(), Known.IniPath, Known.IniFile);
+	}
+	for (TPair<FString, FConfigFile*>& Pair : OtherFiles)
+	{
+		if (Pair.Value)
+		{
+			QueueFile(Pair.Key, Pair.Key, *Pair.Value);
+		}
+	}
+}
+
+void FConfigCacheIni::MarkSectionDirty(const FString& Filename, const TCHAR* Section)
+{
+	DirtySections.FindOrAdd(Filename).Add(Section);
+}
+
+void FConfigCacheIni::PublishReadSnapshot()
+{
+	for (FKnownConfigFiles::FKnownConfigFile& Known : KnownFiles.Files)
+	{
+		if (const FConfigFile* File = KnownFiles.GetFile(Known.IniName))
+		{
+			FConfigReadSnapshot::PublishFile(Known.IniName.ToString(), *File);
+		}
+	}
+	for (const TPair<FString, FConfigFile*>& Pair : OtherFiles)
+	{
+		if (Pair.Value)
+		{
+			FConfigReadSnapshot::PublishFile(Pair.Key, *Pair.Value);
+		}
+	}
 }
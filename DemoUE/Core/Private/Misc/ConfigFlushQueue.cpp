@@ -0,0 +1,241 @@
+#include "Misc/ConfigFlushQueue.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Containers/Map.h"
+#include "HAL/FileManager.h"
+#include "HAL/UnrealMemory.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Optional.h"
+#include "Templates/UniquePtr.h"
+
+namespace UE::ConfigFlushQueue::Private
+{
+	/** Changes to apply to the writer's copy of a file before writing it. */
+	struct FPendingWrite
+	{
+		/** Replaces the writer's copy, the sections below apply on top of it. */
+		TUniquePtr<FConfigFile> FullCopy;
+
+		/** Latest version of every section changed since the last write, unset for removed sections. */
+		TMap<FString, TOptional<FConfigSection>> Sections;
+
+		/** Drop the writer's copy once written. */
+		bool bForget = false;
+	};
+
+	class FWriterThread
+	{
+	public:
+		FWriterThread()
+			: Thread([this]() { Run(); })
+		{
+		}
+
+		void Enqueue(const FString& Filename, const FConfigFile& ConfigFile, const TSet<FString>& DirtySections, bool bAllSectionsDirty)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				FPendingWrite& Pending = PendingWrites.FindOrAdd(Filename);
+				Pending.bForget = false;
+
+				if (bAllSectionsDirty || !FilesWithCopy.Contains(Filename))
+				{
+					Pending.FullCopy = MakeUnique<FConfigFile>(ConfigFile);
+					Pending.Sections.Empty();
+					FilesWithCopy.Add(Filename);
+				}
+				else
+				{
+					for (const FString& Section : DirtySections)
+					{
+						const FConfigSection* ConfigSection = ConfigFile.Find(Section);
+						Pending.Sections.Add(Section, ConfigSection ? TOptional<FConfigSection>(*ConfigSection) : TOptional<FConfigSection>());
+					}
+				}
+			}
+			Condition.notify_one();
+		}
+
+		void Forget(const FString& Filename)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				FailedWrites.Remove(Filename);
+				if (!FilesWithCopy.Remove(Filename))
+				{
+					return;
+				}
+				PendingWrites.FindOrAdd(Filename).bForget = true;
+			}
+			Condition.notify_one();
+		}
+
+		void WaitForPendingWrites()
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Idle.wait(Lock, [this]() { return PendingWrites.Num() == 0 && !bWriting; });
+		}
+
+		bool HasPendingWrites()
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return PendingWrites.Num() > 0 || bWriting;
+		}
+
+		bool TakeFailedWrite(const FString& Filename)
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return FailedWrites.Remove(Filename) > 0;
+		}
+
+	private:
+		void Run()
+		{
+			FMemory::SetupTLSCachesOnCurrentThread();
+			for (;;)
+			{
+				FString Filename;
+				FPendingWrite Pending;
+				{
+					std::unique_lock<std::mutex> Lock(Mutex);
+					Condition.wait(Lock, [this]() { return PendingWrites.Num() > 0; });
+
+					// Oldest first, TMap keeps the insertion order as long as nothing is removed in the middle.
+					auto It = PendingWrites.CreateIterator();
+					Filename = It.Key();
+					Pending = MoveTemp(It.Value());
+					It.RemoveCurrent();
+					bWriting = true;
+				}
+
+				const bool bWritten = Write(Filename, Pending);
+
+				{
+					std::lock_guard<std::mutex> Lock(Mutex);
+					bWriting = false;
+					if (bWritten)
+					{
+						FailedWrites.Remove(Filename);
+					}
+					else if (FilesWithCopy.Contains(Filename))
+					{
+						FailedWrites.Add(Filename);
+					}
+				}
+				Idle.notify_all();
+			}
+		}
+
+		/** @return false if the file could not be written */
+		bool Write(const FString& Filename, FPendingWrite& Pending)
+		{
+			if (Pending.FullCopy)
+			{
+				Copies.Add(Filename, MoveTemp(Pending.FullCopy));
+			}
+			else if (Pending.Sections.Num() == 0)
+			{
+				// Only a Forget.
+				Copies.Remove(Filename);
+				return true;
+			}
+
+			FConfigFile& Copy = *Copies.FindChecked(Filename);
+			for (TPair<FString, TOptional<FConfigSection>>& Section : Pending.Sections)
+			{
+				if (Section.Value.IsSet())
+				{
+					Copy.Add(Section.Key, MoveTemp(Section.Value.GetValue()));
+				}
+				else
+				{
+					Copy.Remove(Section.Key);
+				}
+			}
+
+			// Write skips files that are not dirty; it may also find nothing changed on disk and not write at all. A temp
+			// file left by a crash or a failed move would then be moved over the real file, so only the one written here is.
+			const FString TempFilename = Filename + TEXT(".tmp");
+			IFileManager::Get().Delete(*TempFilename, false, false, true);
+			Copy.Dirty = true;
+			bool bWritten = true;
+			if (!Copy.Write(TempFilename, false))
+			{
+				UE_LOG(LogConfig, Warning, TEXT("Failed to write config file %s."), *Filename);
+				bWritten = false;
+			}
+			else if (IFileManager::Get().FileSize(*TempFilename) >= 0 && !IFileManager::Get().Move(*Filename, *TempFilename, true))
+			{
+				UE_LOG(LogConfig, Warning, TEXT("Failed to replace config file %s."), *Filename);
+				IFileManager::Get().Delete(*TempFilename, false, false, true);
+				bWritten = false;
+			}
+
+			if (Pending.bForget)
+			{
+				Copies.Remove(Filename);
+			}
+			return bWritten;
+		}
+
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		std::condition_variable Idle;
+
+		/** Filename to the changes not picked up by the writer yet. Guarded by Mutex. */
+		TMap<FString, FPendingWrite> PendingWrites;
+
+		/** Files the writer has, or is about to have, a copy of. Guarded by Mutex. */
+		TSet<FString> FilesWithCopy;
+
+		/** Files whose last write failed, until they are written or forgotten. Guarded by Mutex. */
+		TSet<FString> FailedWrites;
+
+		bool bWriting = false;
+
+		/** Only accessed by the writer thread. */
+		TMap<FString, TUniquePtr<FConfigFile>> Copies;
+
+		/** Declared last so the members above exist before the thread starts. */
+		std::thread Thread;
+	};
+}
+
+using namespace UE::ConfigFlushQueue::Private;
+
+FConfigFlushQueue& FConfigFlushQueue::Get()
+{
+	static FConfigFlushQueue* Queue = new FConfigFlushQueue();
+	return *Queue;
+}
+
+FConfigFlushQueue::FConfigFlushQueue()
+	: Writer(new FWriterThread())
+{
+}
+
+void FConfigFlushQueue::Enqueue(const FString& Filename, const FConfigFile& ConfigFile, const TSet<FString>& DirtySections, bool bAllSectionsDirty)
+{
+	Writer->Enqueue(Filename, ConfigFile, DirtySections, bAllSectionsDirty);
+}
+
+void FConfigFlushQueue::Forget(const FString& Filename)
+{
+	Writer->Forget(Filename);
+}
+
+void FConfigFlushQueue::WaitForPendingWrites()
+{
+	Writer->WaitForPendingWrites();
+}
+
+bool FConfigFlushQueue::HasPendingWrites() const
+{
+	return Writer->HasPendingWrites();
+}
+
+bool FConfigFlushQueue::TakeFailedWrite(const FString& Filename)
+{
+	return Writer->TakeFailedWrite(Filename);
+}
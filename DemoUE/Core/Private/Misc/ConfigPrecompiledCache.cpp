@@ -0,0 +1,263 @@
+#include "Misc/ConfigPrecompiledCache.h"
+#include "HAL/FileManager.h"
+#include "Hash/xxhash.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CString.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace UE::ConfigPrecompiledCache::Private
+{
+	static constexpr uint32 ExpectedMagic = 0x47464355; // "UCFG"
+
+	static void HashString(FXxHash64Builder& Builder, const FString& Value)
+	{
+		// The length keeps consecutive strings from hashing the same when characters move from one to the next.
+		const int32 Len = Value.Len();
+		Builder.Update(&Len, sizeof(Len));
+		Builder.Update(*Value, Len * sizeof(TCHAR));
+	}
+
+	/**
+	 * Switches that change how the hierarchies resolve, compared without their leading dash and case insensitively. The
+	 * rest of the command line, ports, session ids, log paths and other per-instance arguments alike, leaves the cache
+	 * valid.
+	 */
+	static const TCHAR* const ConfigSwitchPrefixes[] =
+	{
+		TEXT("ini:"),
+		TEXT("EngineINI="),
+		TEXT("GameINI="),
+		TEXT("InputINI="),
+		TEXT("EditorINI="),
+		TEXT("EditorPerProjectINI="),
+		TEXT("GameUserSettingsINI="),
+		TEXT("ScalabilityINI="),
+		TEXT("DeviceProfilesINI="),
+		TEXT("HardwareINI="),
+		TEXT("Platform="),
+		TEXT("TargetPlatform="),
+		TEXT("CustomConfig="),
+		TEXT("NoUserConfig"),
+	};
+
+	static bool IsConfigSwitch(const FString& Token)
+	{
+		const TCHAR* Switch = *Token;
+		while (*Switch == TCHAR('-') || *Switch == TCHAR('/'))
+		{
+			++Switch;
+		}
+		for (const TCHAR* Prefix : ConfigSwitchPrefixes)
+		{
+			if (FCString::Strnicmp(Switch, Prefix, FCString::Strlen(Prefix)) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+using namespace UE::ConfigPrecompiledCache::Private;
+
+FConfigPrecompiledCache* FConfigPrecompiledCache::Open(const TCHAR* Filename, uint64 ContextKey)
+{
+	TUniquePtr<FConfigPrecompiledCache> Cache(new FConfigPrecompiledCache());
+
+	Cache->MappedRegion = FPlatformMemory::MapFileRegion(Filename);
+	if (Cache->MappedRegion)
+	{
+		Cache->Data = Cache->MappedRegion->GetAddress();
+		Cache->Size = Cache->MappedRegion->GetSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Cache->Buffer, Filename, FILEREAD_Silent))
+	{
+		Cache->Data = Cache->Buffer.GetData();
+		Cache->Size = Cache->Buffer.Num();
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	if (!Cache->ReadTableOfContents(ContextKey))
+	{
+		UE_LOG(LogConfig, Log, TEXT("Precompiled config cache %s is out of date, the ini files will be parsed."), Filename);
+		return nullptr;
+	}
+	return Cache.Release();
+}
+
+FConfigPrecompiledCache::~FConfigPrecompiledCache()
+{
+	if (MappedRegion)
+	{
+		FPlatformMemory::UnmapFileRegion(MappedRegion);
+	}
+}
+
+bool FConfigPrecompiledCache::ReadTableOfContents(uint64 ContextKey)
+{
+	if (Size > MAX_int32)
+	{
+		return false;
+	}
+	FMemoryReaderView Reader(TArrayView<const uint8>(Data, (int32)Size), true);
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint64 SavedContextKey = 0;
+	uint64 SavedSourceKey = 0;
+	Reader.SerializeBatch(Magic, Version, SavedContextKey, SavedSourceKey);
+	if (Reader.IsError() || Magic != ExpectedMagic || Version != CONFIG_PRECOMPILED_CACHE_VERSION || SavedContextKey != ContextKey)
+	{
+		return false;
+	}
+
+	// Checking the sources only costs a stat per file, which is what makes the snapshot worth it over parsing.
+	TArray<FString> SourceFiles;
+	Reader << SourceFiles;
+	if (Reader.IsError() || ComputeSourceKey(ContextKey, SourceFiles) != SavedSourceKey)
+	{
+		return false;
+	}
+
+	int32 NumFiles = 0;
+	Reader << NumFiles;
+	if (NumFiles != (int32)EKnownIniFile::NumKnownFiles)
+	{
+		return false;
+	}
+	for (FEntry& Entry : Entries)
+	{
+		Reader << Entry.IniName << Entry.IniPath;
+		Reader.SerializeBatch(Entry.Offset, Entry.Size);
+	}
+
+	// Offsets are saved relative to the end of the table.
+	const int64 BlobsStart = Reader.Tell();
+	for (FEntry& Entry : Entries)
+	{
+		if (Entry.Offset < 0 || Entry.Size < 0 || Entry.Offset + Entry.Size > Size - BlobsStart)
+		{
+			return false;
+		}
+		Entry.Offset += BlobsStart;
+	}
+	return !Reader.IsError();
+}
+
+void FConfigPrecompiledCache::MaterializeOnce(int32 Index, FConfigFile& OutFile)
+{
+	std::call_once(MaterializedFlags[Index], [this, Index, &OutFile]()
+	{
+		const FEntry& Entry = Entries[Index];
+		FMemoryReaderView Reader(TArrayView<const uint8>(Data + Entry.Offset, (int32)Entry.Size), true);
+		Reader << OutFile;
+		if (Reader.IsError())
+		{
+			UE_LOG(LogConfig, Warning, TEXT("Failed to read %s from the precompiled config cache."), *Entry.IniName);
+		}
+	});
+}
+
+bool FConfigPrecompiledCache::Save(const TCHAR* Filename, uint64 ContextKey, FConfigCacheIni::FKnownConfigFiles& KnownFiles)
+{
+	TArray<FString> SourceFiles;
+	FEntry Entries[(uint8)EKnownIniFile::NumKnownFiles];
+
+	TArray<uint8> Blobs;
+	FMemoryWriter BlobWriter(Blobs, true);
+	for (int32 Index = 0; Index < (int32)EKnownIniFile::NumKnownFiles; ++Index)
+	{
+		FConfigCacheIni::FKnownConfigFiles::FKnownConfigFile& Known = KnownFiles.Files[Index];
+
+		// The files may themselves come from a snapshot and not be materialized yet.
+		if (KnownFiles.PrecompiledCache)
+		{
+			KnownFiles.PrecompiledCache->MaterializeOnce(Index, Known.IniFile);
+		}
+		FConfigFile& IniFile = Known.IniFile;
+		for (const TPair<int32, FString>& Source : IniFile.SourceIniHierarchy)
+		{
+			SourceFiles.AddUnique(Source.Value);
+		}
+
+		FEntry& Entry = Entries[Index];
+		Entry.IniName = Known.IniName.ToString();
+		Entry.IniPath = Known.IniPath;
+		Entry.Offset = Blobs.Num();
+		BlobWriter << IniFile;
+		Entry.Size = Blobs.Num() - Entry.Offset;
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes, true);
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = CONFIG_PRECOMPILED_CACHE_VERSION;
+	uint64 SourceKey = ComputeSourceKey(ContextKey, SourceFiles);
+	Writer.SerializeBatch(Magic, Version, ContextKey, SourceKey);
+	Writer << SourceFiles;
+
+	int32 NumFiles = (int32)EKnownIniFile::NumKnownFiles;
+	Writer << NumFiles;
+	for (FEntry& Entry : Entries)
+	{
+		Writer << Entry.IniName << Entry.IniPath;
+		Writer.SerializeBatch(Entry.Offset, Entry.Size);
+	}
+	Bytes.Append(Blobs);
+
+	const FString TempFilename = FString::Printf(TEXT("%s.%u.tmp"), Filename, FPlatformProcess::GetCurrentProcessId());
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempFilename))
+	{
+		return false;
+	}
+	if (!IFileManager::Get().Move(Filename, *TempFilename, true))
+	{
+		IFileManager::Get().Delete(*TempFilename, false, false, true);
+		return false;
+	}
+	return true;
+}
+
+uint64 FConfigPrecompiledCache::ComputeContextKey()
+{
+	FXxHash64Builder Builder;
+	HashString(Builder, FEngineVersion::Current().ToString());
+	HashString(Builder, FPlatformProperties::IniPlatformName());
+	HashString(Builder, FApp::GetProjectName());
+	HashString(Builder, FConfigCacheIni::GetCustomConfigString());
+
+	const TCHAR* Stream = FCommandLine::Get();
+	FString Token;
+	while (FParse::Token(Stream, Token, false))
+	{
+		if (IsConfigSwitch(Token))
+		{
+			HashString(Builder, Token);
+		}
+	}
+	return Builder.Finalize().Hash;
+}
+
+uint64 FConfigPrecompiledCache::ComputeSourceKey(uint64 ContextKey, const TArray<FString>& SourceFiles)
+{
+	FXxHash64Builder Builder;
+	Builder.Update(&ContextKey, sizeof(ContextKey));
+	for (const FString& SourceFile : SourceFiles)
+	{
+		// Files that do not exist are part of the key too, creating one changes the hierarchy.
+		const FFileStatData StatData = IFileManager::Get().GetStatData(*SourceFile);
+		const int64 Stamp[2] = { StatData.bIsValid ? StatData.ModificationTime.GetTicks() : 0, StatData.bIsValid ? StatData.FileSize : -1 };
+		HashString(Builder, SourceFile);
+		Builder.Update(Stamp, sizeof(Stamp));
+	}
+	return Builder.Finalize().Hash;
+}
@@ -0,0 +1,300 @@
+#include "Misc/ConfigReadSnapshot.h"
+#include <atomic>
+#include <mutex>
+#include "Containers/Map.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Templates/SharedPointer.h"
+
+namespace UE::ConfigReadSnapshot::Private
+{
+	/** First value of every key of a section, like FConfigSection::Find returns. */
+	typedef TMap<FName, FString> FSectionValues;
+
+	struct FFileValues
+	{
+		TMap<FName, TSharedRef<const FSectionValues>> Sections;
+	};
+
+	/** One immutable version. Versions share the files and sections that did not change between them. */
+	struct FSnapshot
+	{
+		TMap<FName, TSharedRef<const FFileValues>> Files;
+	};
+
+	/** Per thread slot telling writers which epoch the thread's open scope started in. */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FReaderRecord
+	{
+		/** 0 outside of a scope. */
+		std::atomic<uint64> Epoch{ 0 };
+		std::atomic<bool> bInUse{ true };
+
+		/** The list only grows, records of exited threads are reused. */
+		FReaderRecord* Next = nullptr;
+	};
+
+	struct FThreadReader
+	{
+		FReaderRecord* Record = nullptr;
+		int32 ScopeDepth = 0;
+
+		~FThreadReader()
+		{
+			if (Record)
+			{
+				Record->bInUse.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	struct FRetiredSnapshot
+	{
+		const FSnapshot* Snapshot;
+
+		/** Epoch at the time it was replaced, scopes that started later cannot see it. */
+		uint64 Epoch;
+	};
+
+	static std::atomic<const FSnapshot*> GCurrentSnapshot{ nullptr };
+	static std::atomic<uint64> GEpoch{ 1 };
+	static std::atomic<FReaderRecord*> GReaderRecords{ nullptr };
+	static thread_local FThreadReader GThreadReader;
+
+	/** Serializes writers, guards GRetiredSnapshots. */
+	static std::mutex GWriteMutex;
+	static TArray<FRetiredSnapshot> GRetiredSnapshots;
+
+	static FReaderRecord* AcquireReaderRecord()
+	{
+		for (FReaderRecord* Record = GReaderRecords.load(std::memory_order_acquire); Record; Record = Record->Next)
+		{
+			bool bExpected = false;
+			if (!Record->bInUse.load(std::memory_order_relaxed) && Record->bInUse.compare_exchange_strong(bExpected, true, std::memory_order_acquire))
+			{
+				return Record;
+			}
+		}
+
+		FReaderRecord* Record = new FReaderRecord();
+		Record->Next = GReaderRecords.load(std::memory_order_relaxed);
+		while (!GReaderRecords.compare_exchange_weak(Record->Next, Record, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+		return Record;
+	}
+
+	/** Must hold GWriteMutex. */
+	static void ReclaimRetiredSnapshots()
+	{
+		uint64 OldestActiveEpoch = MAX_uint64;
+		for (FReaderRecord* Record = GReaderRecords.load(std::memory_order_acquire); Record; Record = Record->Next)
+		{
+			const uint64 Epoch = Record->Epoch.load(std::memory_order_seq_cst);
+			if (Epoch != 0 && Epoch < OldestActiveEpoch)
+			{
+				OldestActiveEpoch = Epoch;
+			}
+		}
+
+		GRetiredSnapshots.RemoveAllSwap([OldestActiveEpoch](const FRetiredSnapshot& Retired)
+		{
+			if (Retired.Epoch < OldestActiveEpoch)
+			{
+				delete Retired.Snapshot;
+				return true;
+			}
+			return false;
+		});
+	}
+
+	/** Must hold GWriteMutex. */
+	static void Publish(const FSnapshot* NewSnapshot)
+	{
+		// The exchange comes before the epoch moves on, so a scope that reads the new epoch also reads the new version.
+		const FSnapshot* OldSnapshot = GCurrentSnapshot.exchange(NewSnapshot, std::memory_order_seq_cst);
+		if (OldSnapshot)
+		{
+			GRetiredSnapshots.Add({ OldSnapshot, GEpoch.fetch_add(1, std::memory_order_seq_cst) });
+		}
+		ReclaimRetiredSnapshots();
+	}
+
+	/** Must hold GWriteMutex. @return a copy of the current version to modify, sharing all of its files */
+	static FSnapshot* CopyCurrentSnapshot()
+	{
+		const FSnapshot* Current = GCurrentSnapshot.load(std::memory_order_relaxed);
+		return Current ? new FSnapshot(*Current) : new FSnapshot();
+	}
+
+	static TSharedRef<const FSectionValues> MakeSectionValues(const FConfigSection& ConfigSection)
+	{
+		TSharedRef<FSectionValues> Values = MakeShared<FSectionValues>();
+		for (const TPair<FName, FConfigValue>& Pair : ConfigSection)
+		{
+			if (!Values->Contains(Pair.Key))
+			{
+				Values->Add(Pair.Key, ConfigSection.Find(Pair.Key)->GetValue());
+			}
+		}
+		return Values;
+	}
+}
+
+using namespace UE::ConfigReadSnapshot::Private;
+
+FConfigReadScope::FConfigReadScope()
+{
+	FThreadReader& Reader = GThreadReader;
+	if (Reader.ScopeDepth++ == 0)
+	{
+		if (!Reader.Record)
+		{
+			Reader.Record = AcquireReaderRecord();
+		}
+		// Announce the epoch before loading the version, writers scan the records after publishing.
+		Reader.Record->Epoch.store(GEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+	}
+	Snapshot = GCurrentSnapshot.load(std::memory_order_seq_cst);
+}
+
+FConfigReadScope::~FConfigReadScope()
+{
+	FThreadReader& Reader = GThreadReader;
+	if (--Reader.ScopeDepth == 0)
+	{
+		Reader.Record->Epoch.store(0, std::memory_order_release);
+	}
+}
+
+const FString* FConfigReadScope::FindValue(const FConfigValueHandle& Handle) const
+{
+	if (!Snapshot)
+	{
+		return nullptr;
+	}
+	const TSharedRef<const FFileValues>* File = Snapshot->Files.Find(Handle.File);
+	if (!File)
+	{
+		return nullptr;
+	}
+	const TSharedRef<const FSectionValues>* Section = (*File)->Sections.Find(Handle.Section);
+	if (!Section)
+	{
+		return nullptr;
+	}
+	return (*Section)->Find(Handle.Key);
+}
+
+bool FConfigReadScope::GetString(const FConfigValueHandle& Handle, FString& Value) const
+{
+	if (const FString* Text = FindValue(Handle))
+	{
+		Value = *Text;
+		return true;
+	}
+	return false;
+}
+
+bool FConfigReadScope::GetBool(const FConfigValueHandle& Handle, bool& Value) const
+{
+	if (const FString* Text = FindValue(Handle))
+	{
+		Value = FCString::ToBool(**Text);
+		return true;
+	}
+	return false;
+}
+
+bool FConfigReadScope::GetInt(const FConfigValueHandle& Handle, int32& Value) const
+{
+	if (const FString* Text = FindValue(Handle))
+	{
+		Value = FCString::Atoi(**Text);
+		return true;
+	}
+	return false;
+}
+
+bool FConfigReadScope::GetInt64(const FConfigValueHandle& Handle, int64& Value) const
+{
+	if (const FString* Text = FindValue(Handle))
+	{
+		Value = FCString::Atoi64(**Text);
+		return true;
+	}
+	return false;
+}
+
+bool FConfigReadScope::GetFloat(const FConfigValueHandle& Handle, float& Value) const
+{
+	if (const FString* Text = FindValue(Handle))
+	{
+		Value = FCString::Atof(**Text);
+		return true;
+	}
+	return false;
+}
+
+bool FConfigReadScope::GetDouble(const FConfigValueHandle& Handle, double& Value) const
+{
+	if (const FString* Text = FindValue(Handle))
+	{
+		Value = FCString::Atod(**Text);
+		return true;
+	}
+	return false;
+}
+
+void FConfigReadSnapshot::PublishFile(const FString& Filename, const FConfigFile& ConfigFile)
+{
+	TSharedRef<FFileValues> File = MakeShared<FFileValues>();
+	for (const TPair<FString, FConfigSection>& Section : ConfigFile)
+	{
+		File->Sections.Add(FName(*Section.Key), MakeSectionValues(Section.Value));
+	}
+
+	std::lock_guard<std::mutex> Lock(GWriteMutex);
+	FSnapshot* NewSnapshot = CopyCurrentSnapshot();
+	NewSnapshot->Files.Add(FName(*Filename), File);
+	Publish(NewSnapshot);
+}
+
+void FConfigReadSnapshot::PublishSection(const FString& Filename, const TCHAR* Section, const FConfigSection* ConfigSection)
+{
+	// Built outside of the lock, only the copies of the maps leading to it are made under it.
+	TSharedPtr<const FSectionValues> Values;
+	if (ConfigSection)
+	{
+		Values = MakeSectionValues(*ConfigSection);
+	}
+	const FName FileName(*Filename);
+	const FName SectionName(Section);
+
+	std::lock_guard<std::mutex> Lock(GWriteMutex);
+	FSnapshot* NewSnapshot = CopyCurrentSnapshot();
+	const TSharedRef<const FFileValues>* OldFile = NewSnapshot->Files.Find(FileName);
+	TSharedRef<FFileValues> File = OldFile ? MakeShared<FFileValues>(**OldFile) : MakeShared<FFileValues>();
+	if (Values)
+	{
+		File->Sections.Add(SectionName, Values.ToSharedRef());
+	}
+	else
+	{
+		File->Sections.Remove(SectionName);
+	}
+	NewSnapshot->Files.Add(FileName, File);
+	Publish(NewSnapshot);
+}
+
+void FConfigReadSnapshot::UnpublishFile(const FString& Filename)
+{
+	std::lock_guard<std::mutex> Lock(GWriteMutex);
+	FSnapshot* NewSnapshot = CopyCurrentSnapshot();
+	NewSnapshot->Files.Remove(FName(*Filename));
+	Publish(NewSnapshot);
+}
+
+void FConfigReadSnapshot::ReclaimRetiredVersions()
+{
+	std::lock_guard<std::mutex> Lock(GWriteMutex);
+	ReclaimRetiredSnapshots();
+}
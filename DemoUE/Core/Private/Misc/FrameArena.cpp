@@ -0,0 +1,131 @@
+#include "Misc/FrameArena.h"
+
+namespace UE::FrameArena::Private
+{
+	/** Usable bytes of a default sized chunk. */
+	static constexpr SIZE_T DefaultChunkDataSize = FRAME_ARENA_CHUNK_SIZE - 2 * sizeof(void*);
+}
+
+FFrameArena::FFrameArena()
+{
+}
+
+FFrameArena::~FFrameArena()
+{
+	PopTo(nullptr, nullptr);
+
+	while (SpareChunks)
+	{
+		FChunk* Chunk = SpareChunks;
+		SpareChunks = Chunk->Next;
+		FMemory::Free(Chunk);
+	}
+	NumSpareChunks = 0;
+}
+
+FFrameArena& FFrameArena::Get()
+{
+	static thread_local FFrameArena Arena;
+	return Arena;
+}
+
+void* FFrameArena::AllocNewChunk(SIZE_T Size, uint32 Alignment)
+{
+	using namespace UE::FrameArena::Private;
+	static_assert(sizeof(FChunk) == 2 * sizeof(void*), "DefaultChunkDataSize assumes a two pointer chunk header");
+
+	const SIZE_T RequiredSize = Size + Alignment;
+
+	FChunk* Chunk = nullptr;
+	if (RequiredSize <= DefaultChunkDataSize && SpareChunks)
+	{
+		Chunk = SpareChunks;
+		SpareChunks = Chunk->Next;
+		--NumSpareChunks;
+	}
+	else
+	{
+		const SIZE_T DataSize = FMath::Max(RequiredSize, DefaultChunkDataSize);
+		Chunk = (FChunk*)FMemory::Malloc(sizeof(FChunk) + DataSize);
+		Chunk->Size = DataSize;
+	}
+
+	Chunk->Next = TopChunk;
+	TopChunk = Chunk;
+	Top = Chunk->GetData();
+	End = Top + Chunk->Size;
+
+	uint8* Result = (uint8*)(((UPTRINT)Top + Alignment - 1) & ~(UPTRINT)(Alignment - 1));
+	Top = Result + Size;
+	check(Top <= End);
+	return Result;
+}
+
+void FFrameArena::PopTo(FChunk* Chunk, uint8* NewTop)
+{
+	while (TopChunk != Chunk)
+	{
+		checkf(TopChunk, TEXT("FFrameArena rewound to a chunk it does not own"));
+		FChunk* Released = TopChunk;
+		TopChunk = Released->Next;
+		ReleaseChunk(Released);
+	}
+
+	if (TopChunk)
+	{
+		Top = NewTop;
+		End = TopChunk->GetData() + TopChunk->Size;
+	}
+	else
+	{
+		Top = nullptr;
+		End = nullptr;
+	}
+}
+
+void FFrameArena::ReleaseChunk(FChunk* Chunk)
+{
+	using namespace UE::FrameArena::Private;
+
+	// Oversized chunks go back to the heap right away, they are unlikely to be needed again at that size.
+	if (Chunk->Size == DefaultChunkDataSize && NumSpareChunks < FRAME_ARENA_MAX_SPARE_CHUNKS)
+	{
+		Chunk->Next = SpareChunks;
+		SpareChunks = Chunk;
+		++NumSpareChunks;
+	}
+	else
+	{
+		FMemory::Free(Chunk);
+	}
+}
+
+bool FFrameArena::Contains(const void* Ptr) const
+{
+	const uint8* Address = (const uint8*)Ptr;
+	for (FChunk* Chunk = TopChunk; Chunk; Chunk = Chunk->Next)
+	{
+		const uint8* DataEnd = Chunk == TopChunk ? Top : Chunk->GetData() + Chunk->Size;
+		if (Address >= Chunk->GetData() && Address < DataEnd)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FFrameArena::Reset()
+{
+	checkf(NumMarks == 0, TEXT("FFrameArena::Reset called with %d live marks"), NumMarks);
+	PopTo(nullptr, nullptr);
+}
+
+SIZE_T FFrameArena::GetUsedBytes() const
+{
+	SIZE_T UsedBytes = 0;
+	for (FChunk* Chunk = TopChunk; Chunk; Chunk = Chunk->Next)
+	{
+		UsedBytes += Chunk == TopChunk ? (SIZE_T)(Top - Chunk->GetData()) : Chunk->Size;
+	}
+	return UsedBytes;
+}
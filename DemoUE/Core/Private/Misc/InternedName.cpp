@@ -0,0 +1,367 @@
+#include "Misc/InternedName.h"
+#include <atomic>
+#include <mutex>
+#include "HAL/UnrealMemory.h"
+
+/** Number of independently locked parts of the hash. Lookups never lock, this only spreads out concurrent inserts. */
+#define INTERNED_NAME_SHARD_BITS 6
+
+/** Size of the blocks the entries are appended to. */
+#define INTERNED_NAME_BLOCK_SIZE (256 * 1024)
+
+/** Upper bound on the number of entry blocks, 2 GB of names. */
+#define INTERNED_NAME_MAX_BLOCKS 8192
+
+namespace UE::InternedName::Private
+{
+	/** Precedes the characters of every name, they follow null terminated. */
+	struct FEntry
+	{
+		uint32 ComparisonIndex;
+		uint16 Len;
+
+		const TCHAR* GetChars() const
+		{
+			return (const TCHAR*)(this + 1);
+		}
+	};
+
+	/** Entries start at multiples of this, so an index addresses a block with 16 bits of offset. */
+	static constexpr uint32 EntryStride = alignof(FEntry);
+	static constexpr uint32 OffsetBits = 16;
+	static_assert(INTERNED_NAME_BLOCK_SIZE / EntryStride <= (1u << OffsetBits), "Entry offsets must fit in OffsetBits");
+	static_assert(INTERNED_NAME_MAX_BLOCKS <= (1u << (32 - OffsetBits)), "Block indices must fit in the rest of the index");
+
+	static constexpr uint32 NumShards = 1u << INTERNED_NAME_SHARD_BITS;
+
+	/** The shard is picked by the top bits of the hash, the slot by the low bits of the upper half. */
+	static constexpr uint32 MaxShardCapacity = 1u << (32 - INTERNED_NAME_SHARD_BITS);
+
+	/** Locale independent, so the hash and the compares always agree on which names are the same. */
+	FORCEINLINE TCHAR ToLowerAscii(TCHAR Char)
+	{
+		return (Char >= TEXT('A') && Char <= TEXT('Z')) ? (TCHAR)(Char + (TEXT('a') - TEXT('A'))) : Char;
+	}
+
+	static uint64 HashCaseInsensitive(const TCHAR* Chars, int32 Len)
+	{
+		// FNV-1a, with the length mixed in first.
+		uint64 Hash = 0xCBF29CE484222325ull ^ (uint64)Len;
+		for (int32 Index = 0; Index < Len; ++Index)
+		{
+			Hash = (Hash ^ (uint64)(uint32)ToLowerAscii(Chars[Index])) * 0x100000001B3ull;
+		}
+		// FNV leaves the top bits poorly mixed, and those pick the shard.
+		Hash ^= Hash >> 29;
+		Hash *= 0xBF58476D1CE4E5B9ull;
+		Hash ^= Hash >> 32;
+		return Hash;
+	}
+
+	static int32 CompareCaseInsensitive(const TCHAR* A, const TCHAR* B, int32 Len)
+	{
+		for (int32 Index = 0; Index < Len; ++Index)
+		{
+			const TCHAR LowerA = ToLowerAscii(A[Index]);
+			const TCHAR LowerB = ToLowerAscii(B[Index]);
+			if (LowerA != LowerB)
+			{
+				return LowerA < LowerB ? -1 : 1;
+			}
+		}
+		return 0;
+	}
+
+	/** Open addressed slots, each the upper half of the hash and the index of the entry. 0 is free. */
+	struct FSlots
+	{
+		uint32 Capacity;
+
+		/** The slots this replaced. Never freed, a lookup may still be reading them. */
+		FSlots* Previous;
+
+		std::atomic<uint64> Slots[1];
+
+		static FSlots* Allocate(uint32 Capacity, FSlots* InPrevious)
+		{
+			const SIZE_T Size = GetSize(Capacity);
+			FSlots* Result = (FSlots*)FMemory::Malloc(Size, alignof(FSlots));
+			FMemory::Memzero(Result, Size);
+			Result->Capacity = Capacity;
+			Result->Previous = InPrevious;
+			return Result;
+		}
+
+		static SIZE_T GetSize(uint32 Capacity)
+		{
+			return sizeof(FSlots) + (Capacity - 1) * sizeof(std::atomic<uint64>);
+		}
+	};
+
+	struct alignas(64) FShard
+	{
+		/** Taken by inserts only. */
+		std::mutex Mutex;
+		std::atomic<FSlots*> Slots{ nullptr };
+		uint32 NumUsed = 0;
+	};
+
+	struct FInternedNameIndices
+	{
+		uint32 ComparisonIndex;
+		uint32 DisplayIndex;
+	};
+
+	/** Result of a probe, the entry spelled exactly like the name and the first one that only differs by case. */
+	struct FProbeResult
+	{
+		uint32 ExactIndex = 0;
+		uint32 ComparisonIndex = 0;
+	};
+
+	class FNameTable
+	{
+	public:
+		FNameTable()
+		{
+			for (FShard& Shard : Shards)
+			{
+				Shard.Slots.store(FSlots::Allocate(64, nullptr), std::memory_order_relaxed);
+			}
+
+			// Index 0 is the empty name.
+			const uint32 NoneIndex = AllocateEntry(TEXT(""), 0, 0);
+			check(NoneIndex == 0);
+		}
+
+		FORCEINLINE const FEntry& Resolve(uint32 Index) const
+		{
+			const uint8* Block = Blocks[Index >> OffsetBits].load(std::memory_order_acquire);
+			return *(const FEntry*)(Block + (SIZE_T)(Index & ((1u << OffsetBits) - 1)) * EntryStride);
+		}
+
+		FInternedNameIndices Find(const TCHAR* Chars, int32 Len) const
+		{
+			const uint64 Hash = HashCaseInsensitive(Chars, Len);
+			const FShard& Shard = Shards[Hash >> (64 - INTERNED_NAME_SHARD_BITS)];
+			const FProbeResult Result = Probe(*Shard.Slots.load(std::memory_order_acquire), Hash, Chars, Len);
+			return { Result.ComparisonIndex, Result.ExactIndex ? Result.ExactIndex : Result.ComparisonIndex };
+		}
+
+		FInternedNameIndices FindOrAdd(const TCHAR* Chars, int32 Len)
+		{
+			const uint64 Hash = HashCaseInsensitive(Chars, Len);
+			FShard& Shard = Shards[Hash >> (64 - INTERNED_NAME_SHARD_BITS)];
+
+			FProbeResult Result = Probe(*Shard.Slots.load(std::memory_order_acquire), Hash, Chars, Len);
+			if (Result.ExactIndex)
+			{
+				return { Result.ComparisonIndex, Result.ExactIndex };
+			}
+
+			std::lock_guard<std::mutex> Lock(Shard.Mutex);
+
+			// Someone may have added it since, and the slots may have been replaced.
+			FSlots* Slots = Shard.Slots.load(std::memory_order_relaxed);
+			Result = Probe(*Slots, Hash, Chars, Len);
+			if (Result.ExactIndex)
+			{
+				return { Result.ComparisonIndex, Result.ExactIndex };
+			}
+
+			if ((Shard.NumUsed + 1) * 2 > Slots->Capacity)
+			{
+				checkf(Slots->Capacity < MaxShardCapacity, TEXT("FInternedName table is full"));
+				Slots = Grow(*Slots);
+				Shard.Slots.store(Slots, std::memory_order_release);
+			}
+
+			const uint32 Index = AllocateEntry(Chars, Len, Result.ComparisonIndex);
+			const uint32 ComparisonIndex = Result.ComparisonIndex ? Result.ComparisonIndex : Index;
+			InsertSlot(*Slots, (Hash >> 32) << 32 | Index, std::memory_order_release);
+			++Shard.NumUsed;
+			NumNames.fetch_add(1, std::memory_order_relaxed);
+			return { ComparisonIndex, Index };
+		}
+
+		FInternedName::FStats GetStats()
+		{
+			FInternedName::FStats Stats;
+			Stats.NumNames = NumNames.load(std::memory_order_relaxed);
+			for (FShard& Shard : Shards)
+			{
+				std::lock_guard<std::mutex> Lock(Shard.Mutex);
+				for (const FSlots* Slots = Shard.Slots.load(std::memory_order_relaxed); Slots; Slots = Slots->Previous)
+				{
+					Stats.HashBytes += FSlots::GetSize(Slots->Capacity);
+				}
+			}
+			std::lock_guard<std::mutex> Lock(BlockMutex);
+			Stats.EntryBytes = (SIZE_T)NumBlocks * INTERNED_NAME_BLOCK_SIZE;
+			return Stats;
+		}
+
+	private:
+		FProbeResult Probe(const FSlots& Slots, uint64 Hash, const TCHAR* Chars, int32 Len) const
+		{
+			FProbeResult Result;
+			const uint32 Tag = (uint32)(Hash >> 32);
+			const uint32 Mask = Slots.Capacity - 1;
+			for (uint32 SlotIndex = Tag & Mask; ; SlotIndex = (SlotIndex + 1) & Mask)
+			{
+				const uint64 Slot = Slots.Slots[SlotIndex].load(std::memory_order_acquire);
+				if (!Slot)
+				{
+					return Result;
+				}
+				if ((uint32)(Slot >> 32) != Tag)
+				{
+					continue;
+				}
+
+				const uint32 Index = (uint32)Slot;
+				const FEntry& Entry = Resolve(Index);
+				if (Entry.Len != Len || CompareCaseInsensitive(Entry.GetChars(), Chars, Len) != 0)
+				{
+					continue;
+				}
+				if (!Result.ComparisonIndex)
+				{
+					Result.ComparisonIndex = Entry.ComparisonIndex;
+				}
+				if (FMemory::Memcmp(Entry.GetChars(), Chars, Len * sizeof(TCHAR)) == 0)
+				{
+					Result.ExactIndex = Index;
+					return Result;
+				}
+			}
+		}
+
+		static void InsertSlot(FSlots& Slots, uint64 Slot, std::memory_order Order)
+		{
+			const uint32 Mask = Slots.Capacity - 1;
+			uint32 SlotIndex = (uint32)(Slot >> 32) & Mask;
+			while (Slots.Slots[SlotIndex].load(std::memory_order_relaxed))
+			{
+				SlotIndex = (SlotIndex + 1) & Mask;
+			}
+			Slots.Slots[SlotIndex].store(Slot, Order);
+		}
+
+		/** Copies the slots into twice as many. The old ones stay valid for the lookups still going through them. */
+		static FSlots* Grow(FSlots& Slots)
+		{
+			FSlots* NewSlots = FSlots::Allocate(Slots.Capacity * 2, &Slots);
+			for (uint32 SlotIndex = 0; SlotIndex < Slots.Capacity; ++SlotIndex)
+			{
+				if (const uint64 Slot = Slots.Slots[SlotIndex].load(std::memory_order_relaxed))
+				{
+					InsertSlot(*NewSlots, Slot, std::memory_order_relaxed);
+				}
+			}
+			return NewSlots;
+		}
+
+		/** Appends an entry. A ComparisonIndex of 0 makes the entry its own. */
+		uint32 AllocateEntry(const TCHAR* Chars, int32 Len, uint32 ComparisonIndex)
+		{
+			const uint32 Size = (uint32)((sizeof(FEntry) + (Len + 1) * sizeof(TCHAR) + EntryStride - 1) & ~(SIZE_T)(EntryStride - 1));
+
+			std::lock_guard<std::mutex> Lock(BlockMutex);
+			if (NumBlocks == 0 || BlockOffset + Size > INTERNED_NAME_BLOCK_SIZE)
+			{
+				checkf(NumBlocks < INTERNED_NAME_MAX_BLOCKS, TEXT("FInternedName ran out of entry blocks"));
+				Blocks[NumBlocks].store((uint8*)FMemory::Malloc(INTERNED_NAME_BLOCK_SIZE, EntryStride), std::memory_order_release);
+				++NumBlocks;
+				BlockOffset = 0;
+			}
+
+			const uint32 Index = ((NumBlocks - 1) << OffsetBits) | (BlockOffset / EntryStride);
+			FEntry* Entry = (FEntry*)(Blocks[NumBlocks - 1].load(std::memory_order_relaxed) + BlockOffset);
+			Entry->ComparisonIndex = ComparisonIndex ? ComparisonIndex : Index;
+			Entry->Len = (uint16)Len;
+			TCHAR* EntryChars = (TCHAR*)(Entry + 1);
+			FMemory::Memcpy(EntryChars, Chars, Len * sizeof(TCHAR));
+			EntryChars[Len] = TEXT('\0');
+
+			BlockOffset += Size;
+			return Index;
+		}
+
+		FShard Shards[NumShards];
+
+		/** Guards the appends, readers only load the block pointers. */
+		mutable std::mutex BlockMutex;
+		std::atomic<uint8*> Blocks[INTERNED_NAME_MAX_BLOCKS] = {};
+		uint32 NumBlocks = 0;
+		uint32 BlockOffset = 0;
+
+		std::atomic<uint32> NumNames{ 0 };
+	};
+
+	static FNameTable& GetNameTable()
+	{
+		// Never destroyed, names are used during static shutdown.
+		static FNameTable* Table = new FNameTable();
+		return *Table;
+	}
+}
+
+using namespace UE::InternedName::Private;
+
+FInternedName::FInternedName(const TCHAR* Name)
+	: FInternedName(Name, Name ? FCString::Strlen(Name) : 0)
+{
+}
+
+FInternedName::FInternedName(const TCHAR* Name, int32 Len)
+{
+	if (Len <= 0)
+	{
+		return;
+	}
+	checkf(Len <= INTERNED_NAME_MAX_LENGTH, TEXT("FInternedName is limited to %d characters, got %d"), INTERNED_NAME_MAX_LENGTH, Len);
+
+	const FInternedNameIndices Indices = GetNameTable().FindOrAdd(Name, Len);
+	ComparisonIndex = Indices.ComparisonIndex;
+	DisplayIndex = Indices.DisplayIndex;
+}
+
+FInternedName FInternedName::Find(const TCHAR* Name, int32 Len)
+{
+	if (Len <= 0 || Len > INTERNED_NAME_MAX_LENGTH)
+	{
+		return FInternedName();
+	}
+	const FInternedNameIndices Indices = GetNameTable().Find(Name, Len);
+	return FInternedName(Indices.ComparisonIndex, Indices.DisplayIndex);
+}
+
+const TCHAR* FInternedName::GetChars() const
+{
+	return GetNameTable().Resolve(DisplayIndex).GetChars();
+}
+
+int32 FInternedName::Len() const
+{
+	return GetNameTable().Resolve(DisplayIndex).Len;
+}
+
+int32 FInternedName::Compare(const FInternedName& Other) const
+{
+	if (ComparisonIndex == Other.ComparisonIndex)
+	{
+		return 0;
+	}
+
+	FNameTable& Table = GetNameTable();
+	const FEntry& Entry = Table.Resolve(DisplayIndex);
+	const FEntry& OtherEntry = Table.Resolve(Other.DisplayIndex);
+	const int32 Result = CompareCaseInsensitive(Entry.GetChars(), OtherEntry.GetChars(), FMath::Min<int32>(Entry.Len, OtherEntry.Len));
+	return Result ? Result : (int32)Entry.Len - (int32)OtherEntry.Len;
+}
+
+FInternedName::FStats FInternedName::GetStats()
+{
+	return GetNameTable().GetStats();
+}
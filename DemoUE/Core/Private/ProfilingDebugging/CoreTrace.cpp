@@ -0,0 +1,888 @@
+#include "ProfilingDebugging/CoreTrace.h"
+
+#if UE_WITH_CORE_TRACE
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Containers/Array.h"
+#include "Containers/ContainerAllocationPolicies.h"
+#include "Containers/StringConv.h"
+#include "Containers/UnrealString.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformStackWalk.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/UnrealMemory.h"
+#include "Logging/AsyncLog.h"
+#include "Logging/LogCategory.h"
+#include "Logging/LogMacros.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CString.h"
+#include "Misc/DateTime.h"
+#include "Misc/Parse.h"
+#include "Serialization/Archive.h"
+
+/*-----------------------------------------------------------------------------
+	Layout of the trace, little endian. Var is a LEB128 varint, ZigZag a varint of a ZigZag encoded signed value and
+	Str a Var length followed by as many bytes of UTF-8.
+
+	Header:		uint32 magic "UCTR", uint32 TRACE_VERSION, uint8 pointer size, double seconds per cycle, uint64
+				cycles at the start, int64 UTC ticks at the start, uint32 channels.
+	Packets:	uint8 ETracePacket, Var buffer id, 0 for definitions, Var size and size bytes.
+
+	A Definitions packet holds the scopes, counters and log sites used by the packets after it, as ETraceDefinition and
+	Var id followed by:
+		CpuScope, Counter:	Str name.
+		LogSite:			uint8 verbosity, Var line, Str category, Str file, Str format, uint8 argument count and
+							as many EBinaryLogArgType, the arguments of the site as in the binary log.
+
+	An Events packet continues the event stream of one ring buffer, made of ETraceEvent and Var cycles since the
+	previous event of the stream, followed by:
+		ThreadBegin:		Var thread id. Its cycles are absolute, the buffer belongs to this thread from now on.
+		Dropped:			Var count, Var scope end count. Its cycles are absolute, the count events before it did not
+							fit in the buffer, scope end count of them CpuScopeEnd: that many scopes ended among them.
+		CpuScopeBegin:		Var scope id.
+		CpuScopeEnd:		nothing, ends the innermost scope. Scopes still open when the trace started end too.
+		Alloc:				Var address, Var size, Var alignment, uint8 frame count and as many Var return addresses.
+		Realloc:			Var old address, then as Alloc.
+		Free:				Var address.
+		Counter:			Var counter id, ZigZag value.
+		Log:				Var site id, Var cycles of the call, Var payload size and the arguments packed as in the
+							binary log. Logs are written by the log thread when async logging is on.
+-----------------------------------------------------------------------------*/
+
+DEFINE_LOG_CATEGORY_STATIC(LogCoreTrace, Log, All);
+
+namespace UE::Trace::Private
+{
+	std::atomic<uint32> GTraceChannels{ 0 };
+
+	static_assert((TRACE_THREAD_BUFFER_SIZE & (TRACE_THREAD_BUFFER_SIZE - 1)) == 0, "The ring buffers wrap with a mask.");
+
+	static constexpr uint32 TraceMagic = 0x52544355; // "UCTR"
+
+	/** Largest event but logs, a sampled allocation: the resync before it, the event and its callstack. */
+	static constexpr uint32 MaxEventSize = 4 * 10 + 5 * 10 + 1 + TRACE_CALLSTACK_MAX_DEPTH * 10;
+
+	/** Larger log payloads are dropped, they would stall the thread until its buffer is drained. */
+	static constexpr uint32 MaxLogPayloadSize = TRACE_THREAD_BUFFER_SIZE / 4;
+
+	enum class ETracePacket : uint8
+	{
+		Definitions,
+		Events,
+	};
+
+	enum class ETraceDefinition : uint8
+	{
+		CpuScope,
+		Counter,
+		LogSite,
+	};
+
+	enum class ETraceEvent : uint8
+	{
+		ThreadBegin,
+		Dropped,
+		CpuScopeBegin,
+		CpuScopeEnd,
+		Alloc,
+		Realloc,
+		Free,
+		Counter,
+		Log,
+	};
+
+	FORCEINLINE uint8* WriteVarUInt(uint8* Cursor, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			*Cursor++ = (uint8)(Value | 0x80);
+			Value >>= 7;
+		}
+		*Cursor++ = (uint8)Value;
+		return Cursor;
+	}
+
+	FORCEINLINE uint8* WriteVarInt(uint8* Cursor, int64 Value)
+	{
+		return WriteVarUInt(Cursor, ((uint64)Value << 1) ^ (uint64)(Value >> 63));
+	}
+
+	/** Bumped by every Start. Sites and threads are described again when they first trace in a new generation. */
+	static std::atomic<uint32> GTraceGeneration{ 0 };
+
+	static std::atomic<uint32> GCallstackSampleRate{ 0 };
+
+	/**
+	 * Single producer, single consumer ring of the events of one thread, like the buffers of the async log. Head and
+	 * Tail only grow, the position in Data is taken modulo its size. Buffers of exited threads are reused, their stream
+	 * goes on with the ThreadBegin of the next owner.
+	 */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FTraceThreadBuffer
+	{
+		/** End of the published events, written by the producer. */
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Head{ 0 };
+
+		/** Start of the events not drained yet, written by the trace thread. */
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Tail{ 0 };
+
+		std::atomic<bool> bInUse{ true };
+
+		/** The list only grows. */
+		FTraceThreadBuffer* Next = nullptr;
+
+		uint32 BufferId = 0;
+
+		/** Generation the owner last wrote its ThreadBegin in, producer only. */
+		uint32 Generation = 0;
+
+		/** Cycles of the last event, producer only. */
+		uint64 LastCycles = 0;
+
+		/** Events that did not fit since the last one that did, producer only. */
+		uint64 NumDropped = 0;
+
+		/** CpuScopeEnd among NumDropped, their scopes began in the stream, producer only. */
+		uint64 NumDroppedScopeEnds = 0;
+
+		alignas(16) uint8 Data[TRACE_THREAD_BUFFER_SIZE];
+	};
+
+	struct FTraceThreadState
+	{
+		FTraceThreadBuffer* Buffer = nullptr;
+
+		/** Allocations until the next one with a callstack. */
+		uint32 CallstackCountdown = 0;
+
+		/**
+		 * Set while the thread writes an event, what the trace itself allocates then is not traced. Always set on the
+		 * trace thread, and once the thread's locals are destroyed.
+		 */
+		bool bInTrace = false;
+
+		~FTraceThreadState()
+		{
+			if (Buffer)
+			{
+				Buffer->bInUse.store(false, std::memory_order_release);
+				Buffer = nullptr;
+			}
+			bInTrace = true;
+		}
+	};
+
+	static std::atomic<FTraceThreadBuffer*> GTraceThreadBuffers{ nullptr };
+	static std::atomic<uint32> GNextTraceBufferId{ 0 };
+	static thread_local FTraceThreadState GTraceThreadState;
+
+	static FTraceThreadBuffer* AcquireTraceThreadBuffer()
+	{
+		FTraceThreadBuffer* Buffer = nullptr;
+		for (FTraceThreadBuffer* Candidate = GTraceThreadBuffers.load(std::memory_order_acquire); Candidate; Candidate = Candidate->Next)
+		{
+			bool bExpected = false;
+			if (!Candidate->bInUse.load(std::memory_order_relaxed) && Candidate->bInUse.compare_exchange_strong(bExpected, true, std::memory_order_acquire))
+			{
+				Buffer = Candidate;
+				break;
+			}
+		}
+
+		if (!Buffer)
+		{
+			Buffer = new FTraceThreadBuffer();
+			Buffer->BufferId = GNextTraceBufferId.fetch_add(1, std::memory_order_relaxed);
+			Buffer->Next = GTraceThreadBuffers.load(std::memory_order_relaxed);
+			while (!GTraceThreadBuffers.compare_exchange_weak(Buffer->Next, Buffer, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		// The new owner starts its stream with a ThreadBegin.
+		Buffer->Generation = 0;
+		Buffer->NumDropped = 0;
+		Buffer->NumDroppedScopeEnds = 0;
+		return Buffer;
+	}
+
+	/** Marks the calling thread as inside the trace. Buffer is nullptr if it already was, the event is not traced then. */
+	struct FThreadTraceScope
+	{
+		FTraceThreadState& State;
+		FTraceThreadBuffer* Buffer = nullptr;
+
+		FORCEINLINE FThreadTraceScope()
+			: State(GTraceThreadState)
+		{
+			if (!State.bInTrace)
+			{
+				State.bInTrace = true;
+				if (UNLIKELY(!State.Buffer))
+				{
+					State.Buffer = AcquireTraceThreadBuffer();
+				}
+				Buffer = State.Buffer;
+			}
+		}
+
+		FORCEINLINE ~FThreadTraceScope()
+		{
+			if (Buffer)
+			{
+				State.bInTrace = false;
+			}
+		}
+	};
+
+	/**
+	 * Encodes one event on the stack and copies it to the ring of the thread in one go. Starts with a ThreadBegin when
+	 * the thread has not traced in this generation yet, or with a Dropped when events were lost, both of which reset
+	 * the cycles the deltas are taken from.
+	 */
+	struct FTraceEventWriter
+	{
+		FTraceThreadBuffer& Buffer;
+		uint64 Cycles;
+		uint32 Generation;
+		ETraceEvent Type;
+		uint8* Cursor;
+		uint8 Data[MaxEventSize];
+
+		FORCEINLINE FTraceEventWriter(FTraceThreadBuffer& InBuffer, ETraceEvent InType)
+			: Buffer(InBuffer)
+			, Cycles(FPlatformTime::Cycles64())
+			, Generation(GTraceGeneration.load(std::memory_order_relaxed))
+			, Type(InType)
+			, Cursor(Data)
+		{
+			uint64 BaseCycles = Buffer.LastCycles;
+			if (UNLIKELY(Buffer.Generation != Generation))
+			{
+				*Cursor++ = (uint8)ETraceEvent::ThreadBegin;
+				Cursor = WriteVarUInt(Cursor, Cycles);
+				Cursor = WriteVarUInt(Cursor, FPlatformTLS::GetCurrentThreadId());
+				BaseCycles = Cycles;
+			}
+			else if (UNLIKELY(Buffer.NumDropped))
+			{
+				*Cursor++ = (uint8)ETraceEvent::Dropped;
+				Cursor = WriteVarUInt(Cursor, Cycles);
+				Cursor = WriteVarUInt(Cursor, Buffer.NumDropped);
+				Cursor = WriteVarUInt(Cursor, Buffer.NumDroppedScopeEnds);
+				BaseCycles = Cycles;
+			}
+			*Cursor++ = (uint8)Type;
+			Cursor = WriteVarUInt(Cursor, Cycles - BaseCycles);
+		}
+
+		FORCEINLINE void WriteVar(uint64 Value)
+		{
+			Cursor = WriteVarUInt(Cursor, Value);
+		}
+
+		FORCEINLINE void WriteZigZag(int64 Value)
+		{
+			Cursor = WriteVarInt(Cursor, Value);
+		}
+
+		/** @return false if the event did not fit, it is counted as dropped */
+		bool Commit(const uint8* Payload = nullptr, uint32 PayloadSize = 0)
+		{
+			const uint32 EventSize = (uint32)(Cursor - Data);
+			const uint64 Head = Buffer.Head.load(std::memory_order_relaxed);
+			if (PayloadSize > MaxLogPayloadSize || Head + EventSize + PayloadSize - Buffer.Tail.load(std::memory_order_acquire) > TRACE_THREAD_BUFFER_SIZE)
+			{
+				// Drops before the ThreadBegin are not part of this generation's stream. A dropped end is counted apart
+				// so the reader can still pop the scope its committed begin opened.
+				if (Buffer.Generation == Generation)
+				{
+					++Buffer.NumDropped;
+					Buffer.NumDroppedScopeEnds += Type == ETraceEvent::CpuScopeEnd ? 1 : 0;
+				}
+				return false;
+			}
+			CopyToRing(Head, Data, EventSize);
+			if (PayloadSize)
+			{
+				CopyToRing(Head + EventSize, Payload, PayloadSize);
+			}
+			Buffer.Generation = Generation;
+			Buffer.NumDropped = 0;
+			Buffer.NumDroppedScopeEnds = 0;
+			Buffer.LastCycles = Cycles;
+			Buffer.Head.store(Head + EventSize + PayloadSize, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		FORCEINLINE void CopyToRing(uint64 Position, const uint8* Source, uint32 Size)
+		{
+			const uint32 Offset = (uint32)(Position & (TRACE_THREAD_BUFFER_SIZE - 1));
+			const uint32 FirstSize = FMath::Min<uint32>(Size, TRACE_THREAD_BUFFER_SIZE - Offset);
+			FMemory::Memcpy(Buffer.Data + Offset, Source, FirstSize);
+			FMemory::Memcpy(Buffer.Data, Source + FirstSize, Size - FirstSize);
+		}
+	};
+
+	/** Sites described since the last drain, and the ids handed out, which are never reused. */
+	struct FTraceDefinitions
+	{
+		std::mutex Mutex;
+		TArray<uint8> Pending;
+		uint32 NextId = 0;
+
+		void WriteVar(uint64 Value)
+		{
+			uint8 Bytes[10];
+			Pending.Append(Bytes, (int32)(WriteVarUInt(Bytes, Value) - Bytes));
+		}
+
+		void WriteUtf8(const ANSICHAR* Text, int32 Len)
+		{
+			WriteVar(Len);
+			Pending.Append((const uint8*)Text, Len);
+		}
+
+		void WriteString(const TCHAR* Text)
+		{
+			FTCHARToUTF8 Utf8(Text);
+			WriteUtf8(Utf8.Get(), Utf8.Length());
+		}
+
+		/** Must hold Mutex. @return true if Id is not of Generation, it is replaced by a new one which has to be described */
+		bool NeedsDefinition(uint64& Id, uint32 Generation)
+		{
+			if ((uint32)(Id >> 32) == Generation)
+			{
+				return false;
+			}
+			Id = ((uint64)Generation << 32) | NextId++;
+			return true;
+		}
+	};
+
+	static FTraceDefinitions& GetTraceDefinitions()
+	{
+		// Never destroyed, threads keep tracing during static shutdown.
+		static FTraceDefinitions* Definitions = new FTraceDefinitions();
+		return *Definitions;
+	}
+
+	/**
+	 * @return the id of Site in the current generation, describing it first if it has none yet. Descriptions are drained
+	 * before the events of the rings, so they always precede the events using them.
+	 */
+	static uint32 GetTraceSiteId(FTraceSite& Site)
+	{
+		uint64 Id = Site.Id.load(std::memory_order_acquire);
+		const uint32 Generation = GTraceGeneration.load(std::memory_order_relaxed);
+		if (LIKELY((uint32)(Id >> 32) == Generation))
+		{
+			return (uint32)Id;
+		}
+
+		FTraceDefinitions& Definitions = GetTraceDefinitions();
+		std::lock_guard<std::mutex> Lock(Definitions.Mutex);
+		Id = Site.Id.load(std::memory_order_relaxed);
+		if (Definitions.NeedsDefinition(Id, Generation))
+		{
+			Definitions.Pending.Add((uint8)(Site.Kind == ETraceSiteKind::CpuScope ? ETraceDefinition::CpuScope : ETraceDefinition::Counter));
+			Definitions.WriteVar((uint32)Id);
+			Definitions.WriteUtf8(Site.Name, FCStringAnsi::Strlen(Site.Name));
+			Site.Id.store(Id, std::memory_order_release);
+		}
+		return (uint32)Id;
+	}
+
+	static uint32 GetTraceLogSiteId(const FLogCategoryBase& Category, const UE::Logging::Private::FStaticBasicLogRecord* Log, const UE::Logging::Private::EBinaryLogArgType* ArgTypes, int32 NumArgs)
+	{
+		std::atomic<uint64>& SiteId = Log->DynamicData.TraceSiteId;
+		uint64 Id = SiteId.load(std::memory_order_acquire);
+		const uint32 Generation = GTraceGeneration.load(std::memory_order_relaxed);
+		if (LIKELY((uint32)(Id >> 32) == Generation))
+		{
+			return (uint32)Id;
+		}
+
+		FTraceDefinitions& Definitions = GetTraceDefinitions();
+		std::lock_guard<std::mutex> Lock(Definitions.Mutex);
+		Id = SiteId.load(std::memory_order_relaxed);
+		if (Definitions.NeedsDefinition(Id, Generation))
+		{
+			Definitions.Pending.Add((uint8)ETraceDefinition::LogSite);
+			Definitions.WriteVar((uint32)Id);
+			Definitions.Pending.Add((uint8)Log->Verbosity);
+			Definitions.WriteVar(Log->Line);
+			Definitions.WriteString(*Category.GetCategoryName().ToString());
+			Definitions.WriteUtf8(Log->File, FCStringAnsi::Strlen(Log->File));
+			Definitions.WriteString(Log->Format);
+			Definitions.Pending.Add((uint8)NumArgs);
+			Definitions.Pending.Append((const uint8*)ArgTypes, NumArgs);
+			SiteId.store(Id, std::memory_order_release);
+		}
+		return (uint32)Id;
+	}
+
+	bool TraceCpuScopeBegin(FTraceSite& Site)
+	{
+		FThreadTraceScope Scope;
+		if (!Scope.Buffer)
+		{
+			return false;
+		}
+		const uint32 SiteId = GetTraceSiteId(Site);
+		FTraceEventWriter Event(*Scope.Buffer, ETraceEvent::CpuScopeBegin);
+		Event.WriteVar(SiteId);
+		return Event.Commit();
+	}
+
+	void TraceCpuScopeEnd()
+	{
+		FThreadTraceScope Scope;
+		if (Scope.Buffer && GTraceChannels.load(std::memory_order_relaxed))
+		{
+			FTraceEventWriter Event(*Scope.Buffer, ETraceEvent::CpuScopeEnd);
+			Event.Commit();
+		}
+	}
+
+	void TraceCounterValue(FTraceCounter& Counter, int64 Value)
+	{
+		FThreadTraceScope Scope;
+		if (Scope.Buffer)
+		{
+			const uint32 CounterId = GetTraceSiteId(Counter);
+			FTraceEventWriter Event(*Scope.Buffer, ETraceEvent::Counter);
+			Event.WriteVar(CounterId);
+			Event.WriteZigZag(Value);
+			Event.Commit();
+		}
+	}
+
+	/** Writes the size, alignment and, for one allocation out of the sample rate, the callstack of an allocation. */
+	static void WriteAllocation(FTraceThreadState& State, FTraceEventWriter& Event, SIZE_T Size, uint32 Alignment)
+	{
+		Event.WriteVar(Size);
+		Event.WriteVar(Alignment);
+
+		uint64 Frames[TRACE_CALLSTACK_MAX_DEPTH];
+		uint32 NumFrames = 0;
+		const uint32 SampleRate = GCallstackSampleRate.load(std::memory_order_relaxed);
+		if (SampleRate && State.CallstackCountdown-- == 0)
+		{
+			State.CallstackCountdown = SampleRate - 1;
+			NumFrames = FMath::Min<uint32>(FPlatformStackWalk::CaptureStackBackTrace(Frames, TRACE_CALLSTACK_MAX_DEPTH), TRACE_CALLSTACK_MAX_DEPTH);
+		}
+		*Event.Cursor++ = (uint8)NumFrames;
+		for (uint32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Event.WriteVar(Frames[Frame]);
+		}
+	}
+
+	void TraceMemoryAlloc(void* Ptr, SIZE_T Size, uint32 Alignment)
+	{
+		FThreadTraceScope Scope;
+		if (Scope.Buffer && Ptr)
+		{
+			FTraceEventWriter Event(*Scope.Buffer, ETraceEvent::Alloc);
+			Event.WriteVar((UPTRINT)Ptr);
+			WriteAllocation(Scope.State, Event, Size, Alignment);
+			Event.Commit();
+		}
+	}
+
+	void TraceMemoryRealloc(void* OldPtr, void* NewPtr, SIZE_T Size, uint32 Alignment)
+	{
+		if (!OldPtr)
+		{
+			TraceMemoryAlloc(NewPtr, Size, Alignment);
+			return;
+		}
+		if (!NewPtr)
+		{
+			// Realloc to 0 bytes frees.
+			TraceMemoryFree(OldPtr);
+			return;
+		}
+
+		FThreadTraceScope Scope;
+		if (Scope.Buffer)
+		{
+			FTraceEventWriter Event(*Scope.Buffer, ETraceEvent::Realloc);
+			Event.WriteVar((UPTRINT)OldPtr);
+			Event.WriteVar((UPTRINT)NewPtr);
+			WriteAllocation(Scope.State, Event, Size, Alignment);
+			Event.Commit();
+		}
+	}
+
+	void TraceMemoryFree(void* Ptr)
+	{
+		FThreadTraceScope Scope;
+		if (Scope.Buffer && Ptr)
+		{
+			FTraceEventWriter Event(*Scope.Buffer, ETraceEvent::Free);
+			Event.WriteVar((UPTRINT)Ptr);
+			Event.Commit();
+		}
+	}
+
+	void TraceLogRecord(const FLogCategoryBase& Category, const UE::Logging::Private::FStaticBasicLogRecord* Log, const UE::Logging::Private::EBinaryLogArgType* ArgTypes, int32 NumArgs, const UE::Logging::Private::FCapturedLogArgs& Args)
+	{
+		FThreadTraceScope Scope;
+		if (Scope.Buffer)
+		{
+			const uint32 SiteId = GetTraceLogSiteId(Category, Log, ArgTypes, NumArgs);
+			FTraceEventWriter Event(*Scope.Buffer, ETraceEvent::Log);
+			Event.WriteVar(SiteId);
+			Event.WriteVar(Args.Cycles);
+			Event.WriteVar(Args.PayloadSize);
+			Event.Commit(Args.Payload, Args.PayloadSize);
+		}
+	}
+
+	struct FTraceWriter
+	{
+		/** Guards Output, held while the rings are drained to it. */
+		std::mutex Mutex;
+		std::condition_variable WakeUp;
+		FArchive* Output = nullptr;
+
+		/** Drained definitions, only used under Mutex. */
+		TArray<uint8> Definitions;
+
+		void WritePacketHeader(ETracePacket Type, uint32 BufferId, uint64 Size)
+		{
+			uint8 Header[1 + 10 + 10];
+			uint8* Cursor = Header;
+			*Cursor++ = (uint8)Type;
+			Cursor = WriteVarUInt(Cursor, BufferId);
+			Cursor = WriteVarUInt(Cursor, Size);
+			Output->Serialize(Header, Cursor - Header);
+		}
+
+		/** Must hold Mutex. Writes what the rings hold now, and the definitions of the events in there. */
+		void Drain()
+		{
+			struct FTarget
+			{
+				FTraceThreadBuffer* Buffer;
+				uint64 Head;
+			};
+			TArray<FTarget, TInlineAllocator<64>> Targets;
+			for (FTraceThreadBuffer* Buffer = GTraceThreadBuffers.load(std::memory_order_acquire); Buffer; Buffer = Buffer->Next)
+			{
+				const uint64 Head = Buffer->Head.load(std::memory_order_acquire);
+				if (Buffer->Tail.load(std::memory_order_relaxed) != Head)
+				{
+					Targets.Add({ Buffer, Head });
+				}
+			}
+
+			// Taken after the heads, so it holds the definitions of every event before them.
+			{
+				FTraceDefinitions& PendingDefinitions = GetTraceDefinitions();
+				std::lock_guard<std::mutex> Lock(PendingDefinitions.Mutex);
+				Swap(Definitions, PendingDefinitions.Pending);
+			}
+			if (Definitions.Num())
+			{
+				WritePacketHeader(ETracePacket::Definitions, 0, Definitions.Num());
+				Output->Serialize(Definitions.GetData(), Definitions.Num());
+				Definitions.Reset();
+			}
+
+			for (const FTarget& Target : Targets)
+			{
+				FTraceThreadBuffer& Buffer = *Target.Buffer;
+				const uint64 Tail = Buffer.Tail.load(std::memory_order_relaxed);
+				const uint32 Offset = (uint32)(Tail & (TRACE_THREAD_BUFFER_SIZE - 1));
+				const uint64 Size = Target.Head - Tail;
+				const uint64 FirstSize = FMath::Min<uint64>(Size, TRACE_THREAD_BUFFER_SIZE - Offset);
+				WritePacketHeader(ETracePacket::Events, Buffer.BufferId, Size);
+				Output->Serialize(Buffer.Data + Offset, FirstSize);
+				if (FirstSize < Size)
+				{
+					Output->Serialize(Buffer.Data, Size - FirstSize);
+				}
+				Buffer.Tail.store(Target.Head, std::memory_order_release);
+			}
+		}
+	};
+
+	static FTraceWriter& GetTraceWriter()
+	{
+		static FTraceWriter* Writer = new FTraceWriter();
+		return *Writer;
+	}
+
+	static void RunTraceThread()
+	{
+		FMemory::SetupTLSCachesOnCurrentThread();
+		GTraceThreadState.bInTrace = true;
+
+		FTraceWriter& Writer = GetTraceWriter();
+		std::unique_lock<std::mutex> Lock(Writer.Mutex);
+		for (;;)
+		{
+			if (Writer.Output)
+			{
+				Writer.Drain();
+				Writer.WakeUp.wait_for(Lock, std::chrono::milliseconds(TRACE_DRAIN_INTERVAL_MS));
+			}
+			else
+			{
+				Writer.WakeUp.wait(Lock);
+			}
+		}
+	}
+
+	/** Keeps the calling thread's own allocations out of the trace while it starts or stops it. */
+	struct FTraceControlScope
+	{
+		bool bWasInTrace;
+
+		FTraceControlScope()
+			: bWasInTrace(GTraceThreadState.bInTrace)
+		{
+			GTraceThreadState.bInTrace = true;
+		}
+
+		~FTraceControlScope()
+		{
+			GTraceThreadState.bInTrace = bWasInTrace;
+		}
+	};
+}
+
+using namespace UE::Trace::Private;
+
+bool FCoreTrace::Start(const TCHAR* Filename, ETraceChannel Channels)
+{
+	if (Channels == ETraceChannel::None)
+	{
+		// Checked before the file is opened, it is left as it was.
+		UE_LOG(LogCoreTrace, Warning, TEXT("Not tracing to %s, no channel is enabled."), Filename);
+		return false;
+	}
+	Stop();
+
+	FArchive* File = IFileManager::Get().CreateFileWriter(Filename, FILEWRITE_AllowRead);
+	if (!File)
+	{
+		UE_LOG(LogCoreTrace, Warning, TEXT("Could not open trace file %s."), Filename);
+		return false;
+	}
+	return Start(File, Channels);
+}
+
+bool FCoreTrace::Start(FArchive* Output, ETraceChannel Channels)
+{
+	if (!Output)
+	{
+		return false;
+	}
+	if (Channels == ETraceChannel::None)
+	{
+		// A trace with no channel would never count as active, Stop would never close its output.
+		UE_LOG(LogCoreTrace, Warning, TEXT("Not starting a trace, no channel is enabled."));
+		delete Output;
+		return false;
+	}
+	Stop();
+
+	// Started with the first trace and never stopped, like the other Core worker threads it outlives static shutdown.
+	static std::thread* TraceThread = new std::thread(&RunTraceThread);
+	(void)TraceThread;
+
+	FTraceControlScope ControlScope;
+	FTraceWriter& Writer = GetTraceWriter();
+	{
+		std::lock_guard<std::mutex> Lock(Writer.Mutex);
+		GTraceGeneration.fetch_add(1, std::memory_order_relaxed);
+
+		// Events racing with the previous Stop are not part of this trace.
+		for (FTraceThreadBuffer* Buffer = GTraceThreadBuffers.load(std::memory_order_acquire); Buffer; Buffer = Buffer->Next)
+		{
+			Buffer->Tail.store(Buffer->Head.load(std::memory_order_acquire), std::memory_order_release);
+		}
+
+		// Timestamps are cycles, expanded relative to the start of the trace.
+		uint32 Magic = TraceMagic;
+		uint32 Version = TRACE_VERSION;
+		uint8 PointerSize = sizeof(void*);
+		double SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+		uint64 StartCycles = FPlatformTime::Cycles64();
+		int64 StartTicks = FDateTime::UtcNow().GetTicks();
+		uint32 ChannelMask = (uint32)Channels;
+		*Output << Magic << Version << PointerSize << SecondsPerCycle << StartCycles << StartTicks << ChannelMask;
+
+		Writer.Output = Output;
+		GTraceChannels.store((uint32)Channels, std::memory_order_release);
+	}
+	Writer.WakeUp.notify_one();
+	UE_LOG(LogCoreTrace, Display, TEXT("Started trace, channels 0x%x."), (uint32)Channels);
+	return true;
+}
+
+bool FCoreTrace::StartFromCommandLine()
+{
+	FString Filename;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("TraceFile="), Filename))
+	{
+		return false;
+	}
+
+	ETraceChannel Channels = ETraceChannel::Default;
+	FString ChannelList;
+	if (FParse::Value(FCommandLine::Get(), TEXT("Trace="), ChannelList, false))
+	{
+		Channels = ParseChannels(*ChannelList);
+	}
+
+	uint32 SampleRate = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("TraceCallstackRate="), SampleRate))
+	{
+		SetCallstackSampleRate(SampleRate);
+	}
+	return Start(*Filename, Channels);
+}
+
+void FCoreTrace::Stop()
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	// Log records still queued in the async log belong to this trace.
+	FlushAsyncLog();
+	GTraceChannels.store(0, std::memory_order_release);
+
+	FTraceControlScope ControlScope;
+	FTraceWriter& Writer = GetTraceWriter();
+	std::lock_guard<std::mutex> Lock(Writer.Mutex);
+	if (Writer.Output)
+	{
+		Writer.Drain();
+		Writer.Output->Flush();
+		delete Writer.Output;
+		Writer.Output = nullptr;
+	}
+}
+
+void FCoreTrace::Flush()
+{
+	if (!IsActive())
+	{
+		return;
+	}
+	FlushAsyncLog();
+
+	FTraceControlScope ControlScope;
+	FTraceWriter& Writer = GetTraceWriter();
+	std::lock_guard<std::mutex> Lock(Writer.Mutex);
+	if (Writer.Output)
+	{
+		Writer.Drain();
+		Writer.Output->Flush();
+	}
+}
+
+bool FCoreTrace::IsActive()
+{
+	return GTraceChannels.load(std::memory_order_acquire) != 0;
+}
+
+void FCoreTrace::SetCallstackSampleRate(uint32 SampleRate)
+{
+	GCallstackSampleRate.store(SampleRate, std::memory_order_relaxed);
+}
+
+ETraceChannel FCoreTrace::ParseChannels(const TCHAR* Channels)
+{
+	struct FChannelName
+	{
+		const TCHAR* Name;
+		ETraceChannel Channel;
+	};
+	static const FChannelName ChannelNames[] =
+	{
+		{ TEXT("Cpu"), ETraceChannel::Cpu },
+		{ TEXT("Memory"), ETraceChannel::Memory },
+		{ TEXT("Counters"), ETraceChannel::Counters },
+		{ TEXT("Log"), ETraceChannel::Log },
+		{ TEXT("Default"), ETraceChannel::Default },
+		{ TEXT("All"), ETraceChannel::All },
+	};
+
+	TArray<FString> Names;
+	FString(Channels).ParseIntoArray(Names, TEXT(","));
+	ETraceChannel Result = ETraceChannel::None;
+	for (const FString& Name : Names)
+	{
+		const FString Trimmed = Name.TrimStartAndEnd();
+		bool bFound = false;
+		for (const FChannelName& ChannelName : ChannelNames)
+		{
+			if (Trimmed == ChannelName.Name)
+			{
+				Result |= ChannelName.Channel;
+				bFound = true;
+			}
+		}
+		if (!bFound)
+		{
+			UE_LOG(LogCoreTrace, Warning, TEXT("Unknown trace channel %s."), *Trimmed);
+		}
+	}
+	return Result;
+}
+
+#else
+
+#include "Serialization/Archive.h"
+
+bool FCoreTrace::Start(const TCHAR* Filename, ETraceChannel Channels)
+{
+	return false;
+}
+
+bool FCoreTrace::Start(FArchive* Output, ETraceChannel Channels)
+{
+	delete Output;
+	return false;
+}
+
+bool FCoreTrace::StartFromCommandLine()
+{
+	return false;
+}
+
+void FCoreTrace::Stop()
+{
+}
+
+void FCoreTrace::Flush()
+{
+}
+
+bool FCoreTrace::IsActive()
+{
+	return false;
+}
+
+void FCoreTrace::SetCallstackSampleRate(uint32 SampleRate)
+{
+}
+
+ETraceChannel FCoreTrace::ParseChannels(const TCHAR* Channels)
+{
+	return ETraceChannel::None;
+}
+
+#endif // UE_WITH_CORE_TRACE
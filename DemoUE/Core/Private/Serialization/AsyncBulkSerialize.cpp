@@ -0,0 +1,259 @@
+#include "Serialization/AsyncBulkSerialize.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "HAL/UnrealMemory.h"
+#include "Serialization/Archive.h"
+
+int64 GAsyncBulkSerializePipelineWatermark = 4 * ASYNC_BULK_SERIALIZE_CHUNK_SIZE;
+
+namespace UE::Serialization::Private
+{
+	struct FAsyncBulkRead
+	{
+		FArchive* Archive;
+		uint8* Dest;
+		int64 Offset;
+		int64 Length;
+		int64 ChunkSize;
+
+		/** Written by the I/O thread under Mutex, read without it by GetNumBytesReady. */
+		std::atomic<int64> NumBytesReady{ 0 };
+		bool bDone = false;
+		bool bFailed = false;
+
+		std::mutex Mutex;
+		std::condition_variable Condition;
+
+		/** One reference for the handle, one for the I/O thread. */
+		std::atomic<int32> NumRefs{ 2 };
+
+		FAsyncBulkRead* Next = nullptr;
+
+		void Release()
+		{
+			if (NumRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete this;
+			}
+		}
+	};
+
+	/** Single background thread that performs the reads in the order they were issued. */
+	class FAsyncBulkReadThread
+	{
+	public:
+		static FAsyncBulkReadThread& Get()
+		{
+			static FAsyncBulkReadThread Thread;
+			return Thread;
+		}
+
+		void Enqueue(FAsyncBulkRead* Read)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				if (Tail)
+				{
+					Tail->Next = Read;
+				}
+				else
+				{
+					Head = Read;
+				}
+				Tail = Read;
+			}
+			Condition.notify_one();
+		}
+
+	private:
+		FAsyncBulkReadThread()
+			: Thread([this]() { Run(); })
+		{
+		}
+
+		~FAsyncBulkReadThread()
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				bStopping = true;
+			}
+			Condition.notify_one();
+			Thread.join();
+		}
+
+		void Run()
+		{
+			FMemory::SetupTLSCachesOnCurrentThread();
+			for (;;)
+			{
+				FAsyncBulkRead* Read = nullptr;
+				{
+					std::unique_lock<std::mutex> Lock(Mutex);
+					Condition.wait(Lock, [this]() { return Head || bStopping; });
+					if (!Head)
+					{
+						break;
+					}
+					Read = Head;
+					Head = Read->Next;
+					if (!Head)
+					{
+						Tail = nullptr;
+					}
+				}
+				Process(*Read);
+				Read->Release();
+			}
+			FMemory::ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		static void Process(FAsyncBulkRead& Read)
+		{
+			bool bFailed = false;
+			for (int64 NumRead = 0; NumRead < Read.Length; )
+			{
+				const int64 NumToRead = Read.Length - NumRead < Read.ChunkSize ? Read.Length - NumRead : Read.ChunkSize;
+				if (!Read.Archive->ReadAtOffset(Read.Dest + NumRead, Read.Offset + NumRead, NumToRead))
+				{
+					bFailed = true;
+					break;
+				}
+				NumRead += NumToRead;
+
+				if (NumRead < Read.Length)
+				{
+					{
+						std::lock_guard<std::mutex> Lock(Read.Mutex);
+						Read.NumBytesReady.store(NumRead, std::memory_order_release);
+					}
+					Read.Condition.notify_all();
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> Lock(Read.Mutex);
+				if (!bFailed)
+				{
+					Read.NumBytesReady.store(Read.Length, std::memory_order_release);
+				}
+				Read.bFailed = bFailed;
+				Read.bDone = true;
+			}
+			Read.Condition.notify_all();
+		}
+
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		FAsyncBulkRead* Head = nullptr;
+		FAsyncBulkRead* Tail = nullptr;
+		bool bStopping = false;
+
+		/** Declared last so the members above exist before the thread starts. */
+		std::thread Thread;
+	};
+}
+
+using namespace UE::Serialization::Private;
+
+FAsyncBulkReadHandle::FAsyncBulkReadHandle(FAsyncBulkRead* InRead)
+	: Read(InRead)
+	, bSynchronousResult(false)
+{
+}
+
+FAsyncBulkReadHandle& FAsyncBulkReadHandle::operator=(FAsyncBulkReadHandle&& Other)
+{
+	if (this != &Other)
+	{
+		if (Read)
+		{
+			Wait();
+			Read->Release();
+		}
+		Read = Other.Read;
+		bSynchronousResult = Other.bSynchronousResult;
+		Other.Read = nullptr;
+	}
+	return *this;
+}
+
+FAsyncBulkReadHandle::~FAsyncBulkReadHandle()
+{
+	if (Read)
+	{
+		// The destination usually belongs to the caller's stack or array, the read must not outlive it.
+		Wait();
+		Read->Release();
+		Read = nullptr;
+	}
+}
+
+bool FAsyncBulkReadHandle::IsComplete() const
+{
+	if (!Read)
+	{
+		return true;
+	}
+	std::lock_guard<std::mutex> Lock(Read->Mutex);
+	return Read->bDone;
+}
+
+bool FAsyncBulkReadHandle::Wait()
+{
+	if (!Read)
+	{
+		return bSynchronousResult;
+	}
+	std::unique_lock<std::mutex> Lock(Read->Mutex);
+	Read->Condition.wait(Lock, [this]() { return Read->bDone; });
+	return !Read->bFailed;
+}
+
+bool FAsyncBulkReadHandle::WaitForBytes(int64 NumBytes)
+{
+	if (!Read)
+	{
+		return bSynchronousResult;
+	}
+	std::unique_lock<std::mutex> Lock(Read->Mutex);
+	Read->Condition.wait(Lock, [this, NumBytes]() { return Read->bDone || Read->NumBytesReady.load(std::memory_order_relaxed) >= NumBytes; });
+	return Read->NumBytesReady.load(std::memory_order_relaxed) >= NumBytes;
+}
+
+int64 FAsyncBulkReadHandle::GetNumBytesReady() const
+{
+	if (!Read)
+	{
+		return bSynchronousResult ? MAX_int64 : 0;
+	}
+	return Read->NumBytesReady.load(std::memory_order_acquire);
+}
+
+FAsyncBulkReadHandle IssueAsyncBulkRead(FArchive& Ar, void* Dest, int64 Length)
+{
+	if (Length <= 0)
+	{
+		return FAsyncBulkReadHandle(!Ar.IsError());
+	}
+
+	if (!Ar.SupportsReadAtOffset())
+	{
+		Ar.Serialize(Dest, Length);
+		return FAsyncBulkReadHandle(!Ar.IsError());
+	}
+
+	FAsyncBulkRead* Read = new FAsyncBulkRead();
+	Read->Archive = &Ar;
+	Read->Dest = (uint8*)Dest;
+	Read->Offset = Ar.Tell();
+	Read->Length = Length;
+	Read->ChunkSize = Length >= GAsyncBulkSerializePipelineWatermark ? ASYNC_BULK_SERIALIZE_CHUNK_SIZE : Length;
+
+	// Skip the block now so the caller keeps deserializing what follows while it streams in.
+	Ar.Seek(Read->Offset + Length);
+
+	FAsyncBulkReadThread::Get().Enqueue(Read);
+	return FAsyncBulkReadHandle(Read);
+}
@@ -0,0 +1,342 @@
+#include "Serialization/BlockCompressionArchive.h"
+#include <atomic>
+#include "Async/ParallelFor.h"
+#include "Compression/LZ4BlockCodec.h"
+#include "HAL/UnrealMemory.h"
+
+using UE::Serialization::Private::FBlockCompressionHeader;
+
+FArchiveBlockCompressionWriter::FArchiveBlockCompressionWriter(FArchive& InInner, EBlockCompressionMethod InMethod, int32 InBlockSize)
+	: Inner(InInner)
+	, Method(InMethod)
+	, BlockSize(InBlockSize)
+{
+	checkf(BlockSize > 0 && BlockSize <= BLOCK_COMPRESSION_MAX_BLOCK_SIZE, TEXT("Invalid compression block size %d"), BlockSize);
+
+	SetArchiveState(Inner.GetArchiveState());
+	SetIsSaving(true);
+	SetIsLoading(false);
+
+	CompressedBlockCapacity = UE::Compression::LZ4Block::GetMaxCompressedSize(BlockSize);
+	Pending.Reserve(BlockSize * BLOCK_COMPRESSION_BATCH_BLOCKS);
+
+	// Reserve room for the header, it gets the real sizes on Close.
+	StreamStart = Inner.Tell();
+	FBlockCompressionHeader Header;
+	Inner << Header;
+	StreamSize = Inner.Tell() - StreamStart;
+}
+
+FArchiveBlockCompressionWriter::~FArchiveBlockCompressionWriter()
+{
+	Close();
+}
+
+void FArchiveBlockCompressionWriter::Serialize(void* Data, int64 Length)
+{
+	if (bClosed)
+	{
+		SetError();
+		return;
+	}
+
+	const uint8* Bytes = (const uint8*)Data;
+	const int64 BatchSize = (int64)BlockSize * BLOCK_COMPRESSION_BATCH_BLOCKS;
+	while (Length > 0)
+	{
+		const int64 NumToCopy = FMath::Min<int64>(Length, BatchSize - Pending.Num());
+		Pending.Append(Bytes, (int32)NumToCopy);
+		Bytes += NumToCopy;
+		Length -= NumToCopy;
+		UncompressedSize += NumToCopy;
+
+		if (Pending.Num() == BatchSize)
+		{
+			WritePendingBlocks();
+		}
+	}
+}
+
+void FArchiveBlockCompressionWriter::WritePendingBlocks()
+{
+	const int32 NumPendingBlocks = (Pending.Num() + BlockSize - 1) / BlockSize;
+	if (NumPendingBlocks == 0)
+	{
+		return;
+	}
+
+	const int64 CompressedBlocksSize = CompressedBlockCapacity * NumPendingBlocks;
+	checkf(CompressedBlocksSize <= MAX_int32, TEXT("Compression batch of %lld bytes is too large"), CompressedBlocksSize);
+	CompressedBlocks.SetNumUninitialized((int32)CompressedBlocksSize);
+	int64 CompressedSizes[BLOCK_COMPRESSION_BATCH_BLOCKS];
+
+	ParallelFor(NumPendingBlocks, [this, &CompressedSizes](int32 Block)
+	{
+		const int64 Begin = (int64)Block * BlockSize;
+		const int64 Size = FMath::Min<int64>(BlockSize, Pending.Num() - Begin);
+		const int64 CompressedSize = Method == EBlockCompressionMethod::LZ4
+			? UE::Compression::LZ4Block::Compress(Pending.GetData() + Begin, Size, CompressedBlocks.GetData() + Block * CompressedBlockCapacity, Size - 1)
+			: 0;
+
+		// Blocks that do not shrink are stored as is; the reader tells them apart by their size.
+		CompressedSizes[Block] = CompressedSize > 0 ? CompressedSize : Size;
+	});
+
+	for (int32 Block = 0; Block < NumPendingBlocks; ++Block)
+	{
+		const int64 Begin = (int64)Block * BlockSize;
+		const int64 Size = FMath::Min<int64>(BlockSize, Pending.Num() - Begin);
+		uint8* Stored = CompressedSizes[Block] == Size ? Pending.GetData() + Begin : CompressedBlocks.GetData() + Block * CompressedBlockCapacity;
+
+		Inner.Serialize(Stored, CompressedSizes[Block]);
+		StreamSize += CompressedSizes[Block];
+		BlockSizes.Add((uint32)CompressedSizes[Block]);
+	}
+
+	Pending.Reset();
+}
+
+void FArchiveBlockCompressionWriter::Seek(int64 InPos)
+{
+	// Blocks are compressed as they fill up, rewriting earlier data is not supported.
+	if (InPos != UncompressedSize)
+	{
+		SetError();
+	}
+}
+
+int64 FArchiveBlockCompressionWriter::Tell()
+{
+	return UncompressedSize;
+}
+
+int64 FArchiveBlockCompressionWriter::TotalSize()
+{
+	return UncompressedSize;
+}
+
+void FArchiveBlockCompressionWriter::Flush()
+{
+	// Only whole blocks can be written before the end of the stream without wasting ratio, so keep the partial block around.
+	Inner.Flush();
+}
+
+bool FArchiveBlockCompressionWriter::Close()
+{
+	if (!bClosed)
+	{
+		bClosed = true;
+		WritePendingBlocks();
+
+		FBlockCompressionHeader Header;
+		Header.BlockSize = (uint32)BlockSize;
+		Header.Method = (uint8)Method;
+		Header.NumBlocks = (uint32)BlockSizes.Num();
+		Header.UncompressedSize = UncompressedSize;
+		Header.IndexOffset = StreamSize;
+
+		for (uint32& Size : BlockSizes)
+		{
+			Inner << Size;
+		}
+		const int64 StreamEnd = Inner.Tell();
+
+		Inner.Seek(StreamStart);
+		Inner << Header;
+		Inner.Seek(StreamEnd);
+
+		BlockSizes.Empty();
+		Pending.Empty();
+		CompressedBlocks.Empty();
+
+		if (Inner.IsError())
+		{
+			SetError();
+		}
+	}
+	return !IsError();
+}
+
+FString FArchiveBlockCompressionWriter::GetArchiveName() const
+{
+	return Inner.GetArchiveName();
+}
+
+FArchiveBlockCompressionReader::FArchiveBlockCompressionReader(FArchive& InInner)
+	: Inner(InInner)
+{
+	SetArchiveState(Inner.GetArchiveState());
+	SetIsLoading(true);
+	SetIsSaving(false);
+
+	StreamStart = Inner.Tell();
+	Inner << Header;
+
+	if (Inner.IsError() || Header.Magic != FBlockCompressionHeader::ExpectedMagic || Header.Version > FBlockCompressionHeader::CurrentVersion
+		|| Header.BlockSize == 0 || Header.BlockSize > BLOCK_COMPRESSION_MAX_BLOCK_SIZE || Header.Method > (uint8)EBlockCompressionMethod::LZ4
+		|| Header.UncompressedSize < 0 || (int64)Header.NumBlocks != (Header.UncompressedSize + Header.BlockSize - 1) / Header.BlockSize
+		// The index has a size per block and has to fit in the inner archive, which also bounds the offsets allocated for it.
+		|| Header.NumBlocks >= (uint32)MAX_int32 || Header.IndexOffset < 0
+		|| Header.IndexOffset + (int64)Header.NumBlocks * sizeof(uint32) > Inner.TotalSize() - StreamStart)
+	{
+		SetError();
+		Header.UncompressedSize = 0;
+		return;
+	}
+
+	const int64 DataStart = Inner.Tell() - StreamStart;
+	Inner.Seek(StreamStart + Header.IndexOffset);
+
+	BlockOffsets.SetNumUninitialized((int32)Header.NumBlocks + 1);
+	int64 Offset = DataStart;
+	for (uint32 Block = 0; Block < Header.NumBlocks; ++Block)
+	{
+		uint32 StoredSize = 0;
+		Inner << StoredSize;
+		if (StoredSize > GetBlockUncompressedSize(Block))
+		{
+			SetError();
+		}
+		BlockOffsets[Block] = Offset;
+		Offset += StoredSize;
+	}
+	BlockOffsets[Header.NumBlocks] = Offset;
+
+	if (Inner.IsError() || Offset != Header.IndexOffset)
+	{
+		SetError();
+		Header.UncompressedSize = 0;
+	}
+}
+
+bool FArchiveBlockCompressionReader::DecodeBlocks(int32 FirstBlock, int32 NumDecodeBlocks, uint8* Dest)
+{
+	const int64 StoredBegin = BlockOffsets[FirstBlock];
+	const int64 StoredSize = BlockOffsets[FirstBlock + NumDecodeBlocks] - StoredBegin;
+
+	Staging.SetNumUninitialized((int32)StoredSize, false);
+	Inner.Seek(StreamStart + StoredBegin);
+	Inner.Serialize(Staging.GetData(), StoredSize);
+	if (Inner.IsError())
+	{
+		return false;
+	}
+
+	std::atomic<bool> bFailed{ false };
+	ParallelFor(NumDecodeBlocks, [this, FirstBlock, StoredBegin, Dest, &bFailed](int32 Index)
+	{
+		const int32 Block = FirstBlock + Index;
+		const uint8* Stored = Staging.GetData() + (BlockOffsets[Block] - StoredBegin);
+		const int64 StoredBlockSize = BlockOffsets[Block + 1] - BlockOffsets[Block];
+		const int64 Size = GetBlockUncompressedSize(Block);
+		uint8* BlockDest = Dest + (int64)Index * Header.BlockSize;
+
+		if (StoredBlockSize == Size)
+		{
+			FMemory::Memcpy(BlockDest, Stored, Size);
+		}
+		else if (!UE::Compression::LZ4Block::Decompress(Stored, StoredBlockSize, BlockDest, Size))
+		{
+			bFailed.store(true, std::memory_order_relaxed);
+		}
+	});
+	return !bFailed.load(std::memory_order_relaxed);
+}
+
+void FArchiveBlockCompressionReader::Serialize(void* Data, int64 Length)
+{
+	uint8* Out = (uint8*)Data;
+	if (IsError() || Length < 0 || Length > Header.UncompressedSize - Pos)
+	{
+		SetError();
+		if (Length > 0)
+		{
+			FMemory::Memzero(Out, Length);
+		}
+		return;
+	}
+
+	const int64 BlockSize = Header.BlockSize;
+	while (Length > 0)
+	{
+		const int32 Block = (int32)(Pos / BlockSize);
+		const int64 CacheBegin = (int64)CachedFirstBlock * BlockSize;
+		const int64 CacheEnd = FMath::Min<int64>(CacheBegin + (int64)NumCachedBlocks * BlockSize, Header.UncompressedSize);
+
+		if (Pos >= CacheBegin && Pos < CacheEnd)
+		{
+			const int64 NumToCopy = FMath::Min(Length, CacheEnd - Pos);
+			FMemory::Memcpy(Out, Cache.GetData() + (Pos - CacheBegin), NumToCopy);
+			Out += NumToCopy;
+			Pos += NumToCopy;
+			Length -= NumToCopy;
+			continue;
+		}
+
+		// Whole blocks go straight to the destination, no copy through the cache.
+		int32 NumWholeBlocks = 0;
+		if (Pos % BlockSize == 0)
+		{
+			while (NumWholeBlocks < BLOCK_COMPRESSION_BATCH_BLOCKS && Block + NumWholeBlocks < (int32)Header.NumBlocks
+				&& (int64)NumWholeBlocks * BlockSize + GetBlockUncompressedSize(Block + NumWholeBlocks) <= Length)
+			{
+				++NumWholeBlocks;
+			}
+		}
+
+		if (NumWholeBlocks > 0)
+		{
+			if (!DecodeBlocks(Block, NumWholeBlocks, Out))
+			{
+				break;
+			}
+			const int64 NumDecoded = FMath::Min<int64>((int64)NumWholeBlocks * BlockSize, Header.UncompressedSize - Pos);
+			Out += NumDecoded;
+			Pos += NumDecoded;
+			Length -= NumDecoded;
+			continue;
+		}
+
+		// Small or unaligned read: decode a window of blocks ahead, in parallel, and serve the next reads from it.
+		const int32 NumWindowBlocks = FMath::Min<int32>(FMath::Max(GetParallelForNumThreads(), 1), (int32)Header.NumBlocks - Block);
+		Cache.SetNumUninitialized((int32)(NumWindowBlocks * BlockSize), false);
+		NumCachedBlocks = 0;
+		if (!DecodeBlocks(Block, NumWindowBlocks, Cache.GetData()))
+		{
+			break;
+		}
+		CachedFirstBlock = Block;
+		NumCachedBlocks = NumWindowBlocks;
+	}
+
+	if (Length > 0)
+	{
+		SetError();
+		FMemory::Memzero(Out, Length);
+	}
+}
+
+void FArchiveBlockCompressionReader::Seek(int64 InPos)
+{
+	if (InPos < 0 || InPos > Header.UncompressedSize)
+	{
+		SetError();
+		return;
+	}
+	Pos = InPos;
+}
+
+int64 FArchiveBlockCompressionReader::Tell()
+{
+	return Pos;
+}
+
+int64 FArchiveBlockCompressionReader::TotalSize()
+{
+	return Header.UncompressedSize;
+}
+
+FString FArchiveBlockCompressionReader::GetArchiveName() const
+{
+	return Inner.GetArchiveName();
+}
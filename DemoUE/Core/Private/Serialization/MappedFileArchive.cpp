@@ -0,0 +1,127 @@
+#include "Serialization/MappedFileArchive.h"
+
+FArchiveFileReaderMapped* FArchiveFileReaderMapped::Open(const TCHAR* Filename)
+{
+	FPlatformMemory::FMappedFileRegion* MappedRegion = FPlatformMemory::MapFileRegion(Filename);
+	if (!MappedRegion)
+	{
+		return nullptr;
+	}
+	return new FArchiveFileReaderMapped(MappedRegion, Filename);
+}
+
+FArchiveFileReaderMapped::FArchiveFileReaderMapped(FPlatformMemory::FMappedFileRegion* InMappedRegion, const TCHAR* InFilename)
+	: MappedRegion(InMappedRegion)
+	, Filename(InFilename)
+{
+	SetIsLoading(true);
+	SetIsPersistent(true);
+
+#if UE_ARCHIVE_FAST_PATH_LOAD
+	SetFastPathLoadBuffer(MappedRegion->GetAddress(), MappedRegion->GetAddress() + MappedRegion->GetSize());
+#else
+	Cursor = MappedRegion->GetAddress();
+#endif
+}
+
+FArchiveFileReaderMapped::~FArchiveFileReaderMapped()
+{
+	Close();
+}
+
+const uint8* FArchiveFileReaderMapped::GetCursor() const
+{
+#if UE_ARCHIVE_FAST_PATH_LOAD
+	return ActiveFPLB->StartFastPathLoadBuffer;
+#else
+	return Cursor;
+#endif
+}
+
+void FArchiveFileReaderMapped::SetCursor(const uint8* NewCursor)
+{
+#if UE_ARCHIVE_FAST_PATH_LOAD
+	ActiveFPLB->StartFastPathLoadBuffer = NewCursor;
+#else
+	Cursor = NewCursor;
+#endif
+}
+
+void FArchiveFileReaderMapped::Serialize(void* Data, int64 Length)
+{
+	// Only reached for reads the inline fast path did not take, i.e. raw blocks or reads past the end.
+	if (const uint8* View = GetView(Length))
+	{
+		FMemory::Memcpy(Data, View, Length);
+	}
+	else if (Length > 0)
+	{
+		FMemory::Memzero(Data, Length);
+	}
+}
+
+const uint8* FArchiveFileReaderMapped::GetView(int64 Length)
+{
+	const uint8* View = GetCursor();
+	if (!MappedRegion || Length < 0 || Length > TotalSize() - Tell())
+	{
+		SetError();
+		return nullptr;
+	}
+	SetCursor(View + Length);
+	return View;
+}
+
+void FArchiveFileReaderMapped::Seek(int64 InPos)
+{
+	if (!MappedRegion || InPos < 0 || InPos > TotalSize())
+	{
+		SetError();
+		return;
+	}
+	SetCursor(MappedRegion->GetAddress() + InPos);
+}
+
+int64 FArchiveFileReaderMapped::Tell()
+{
+	return MappedRegion ? GetCursor() - MappedRegion->GetAddress() : INDEX_NONE;
+}
+
+int64 FArchiveFileReaderMapped::TotalSize()
+{
+	return MappedRegion ? (int64)MappedRegion->GetSize() : INDEX_NONE;
+}
+
+bool FArchiveFileReaderMapped::Close()
+{
+	if (MappedRegion)
+	{
+#if UE_ARCHIVE_FAST_PATH_LOAD
+		ActiveFPLB->Reset();
+#else
+		Cursor = nullptr;
+#endif
+		if (!FPlatformMemory::UnmapFileRegion(MappedRegion))
+		{
+			SetError();
+		}
+		MappedRegion = nullptr;
+	}
+	return !IsError();
+}
+
+bool FArchiveFileReaderMapped::ReadAtOffset(void* Dest, int64 Offset, int64 Length)
+{
+	// The mapping is read only and stays put until Close, so this is safe from any thread.
+	if (!MappedRegion || Offset < 0 || Length < 0 || Offset > (int64)MappedRegion->GetSize() - Length)
+	{
+		return false;
+	}
+	FMemory::Memcpy(Dest, MappedRegion->GetAddress() + Offset, Length);
+	return true;
+}
+
+FString FArchiveFileReaderMapped::GetArchiveName() const
+{
+	return Filename;
+}
@@ -0,0 +1,376 @@
+#include "Tests/Benchmark.h"
+
+#if WITH_BENCHMARKS
+
+#include <cmath>
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "Logging/LogMacros.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#if PLATFORM_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogBenchmark, Log, All);
+
+namespace UE::Benchmark::Private
+{
+	void UseCharPointer(const volatile char* Pointer)
+	{
+	}
+
+	/** Counter values read around a sample, negative for those the platform does not have. */
+	struct FCounterValues
+	{
+		int64 Cycles = -1;
+		int64 Instructions = -1;
+		int64 CacheMisses = -1;
+	};
+
+	static FBenchmarkRegistration*& GetRegistrationHead()
+	{
+		static FBenchmarkRegistration* Head = nullptr;
+		return Head;
+	}
+
+	/** Nearest rank percentile of sorted samples. */
+	static double GetPercentile(const TArray<double>& Sorted, double Percentile)
+	{
+		const int32 Rank = (int32)std::ceil(Percentile * Sorted.Num()) - 1;
+		return Sorted[FMath::Clamp(Rank, 0, Sorted.Num() - 1)];
+	}
+
+	static double GetMedian(TArray<double>& Values)
+	{
+		Values.Sort();
+		const int32 Middle = Values.Num() / 2;
+		return Values.Num() % 2 ? Values[Middle] : (Values[Middle - 1] + Values[Middle]) * 0.5;
+	}
+
+	static void AppendJsonString(FString& Out, const FString& Value)
+	{
+		Out += TEXT('"');
+		for (const TCHAR Char : Value)
+		{
+			if (Char == TEXT('"') || Char == TEXT('\\'))
+			{
+				Out += TEXT('\\');
+				Out += Char;
+			}
+			else if (Char < 0x20)
+			{
+				Out += FString::Printf(TEXT("\\u%04x"), (uint32)Char);
+			}
+			else
+			{
+				Out += Char;
+			}
+		}
+		Out += TEXT('"');
+	}
+
+	static void AppendJsonNumber(FString& Out, double Value)
+	{
+		if (Value < 0.0 || !std::isfinite(Value))
+		{
+			Out += TEXT("null");
+		}
+		else
+		{
+			Out += FString::Printf(TEXT("%.4f"), Value);
+		}
+	}
+}
+
+using namespace UE::Benchmark::Private;
+
+/** Hardware counters of the thread running the benchmarks. */
+struct FBenchmarkRunner::FCounters
+{
+	FCounters()
+	{
+#if PLATFORM_LINUX
+		// Instructions lead the group so both counters are read at once. Fails without access to perf events, the
+		// counters are then reported as not available.
+		InstructionsFd = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1);
+		if (InstructionsFd >= 0)
+		{
+			CacheMissesFd = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, InstructionsFd);
+			ioctl(InstructionsFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(InstructionsFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+#endif
+	}
+
+	~FCounters()
+	{
+#if PLATFORM_LINUX
+		if (CacheMissesFd >= 0)
+		{
+			close(CacheMissesFd);
+		}
+		if (InstructionsFd >= 0)
+		{
+			close(InstructionsFd);
+		}
+#endif
+	}
+
+	FORCEINLINE FCounterValues Read() const
+	{
+		FCounterValues Values;
+#if PLATFORM_LINUX
+		if (InstructionsFd >= 0)
+		{
+			// PERF_FORMAT_GROUP: the number of counters, then their values in the order they joined the group.
+			uint64 Buffer[3] = {};
+			if (read(InstructionsFd, Buffer, sizeof(Buffer)) >= (ssize_t)(2 * sizeof(uint64)))
+			{
+				Values.Instructions = (int64)Buffer[1];
+				Values.CacheMisses = Buffer[0] > 1 ? (int64)Buffer[2] : -1;
+			}
+		}
+#endif
+#if PLATFORM_CPU_X86_FAMILY
+		Values.Cycles = (int64)__rdtsc();
+#endif
+		return Values;
+	}
+
+#if PLATFORM_LINUX
+	static int Open(uint32 Type, uint64 Config, int GroupFd)
+	{
+		perf_event_attr Attr;
+		FMemory::Memzero(&Attr, sizeof(Attr));
+		Attr.size = sizeof(Attr);
+		Attr.type = Type;
+		Attr.config = Config;
+		Attr.disabled = GroupFd < 0 ? 1 : 0;
+		Attr.exclude_kernel = 1;
+		Attr.exclude_hv = 1;
+		Attr.read_format = PERF_FORMAT_GROUP;
+		return (int)syscall(__NR_perf_event_open, &Attr, 0, -1, GroupFd, 0);
+	}
+
+	int InstructionsFd = -1;
+	int CacheMissesFd = -1;
+#endif
+};
+
+FBenchmarkRunner::FBenchmarkRunner(const FBenchmarkOptions& InOptions)
+	: Options(InOptions)
+	, Counters(new FCounters())
+{
+	Options.WarmupRuns = FMath::Max(Options.WarmupRuns, 0);
+	Options.Repetitions = FMath::Max(Options.Repetitions, 1);
+}
+
+FBenchmarkRunner::~FBenchmarkRunner()
+{
+	delete Counters;
+}
+
+void FBenchmarkRunner::Run(const TCHAR* Group, const TCHAR* Name, int64 Parameter, const FBody& Body, uint64 BytesPerIteration)
+{
+	const FString FullName = FString::Printf(TEXT("%s.%s/%lld"), Group, Name, Parameter);
+	if (!Options.Filter.IsEmpty() && !FullName.Contains(Options.Filter))
+	{
+		return;
+	}
+
+	const double SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+	auto TimeSeconds = [&Body, SecondsPerCycle](uint64 Iterations)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Body(Iterations);
+		return (double)(FPlatformTime::Cycles64() - StartCycles) * SecondsPerCycle;
+	};
+
+	// Doubling until a sample is long enough, the first runs double as warmups of the code paths.
+	uint64 Iterations = 1;
+	while (Iterations < (1ull << 40) && TimeSeconds(Iterations) < Options.MinSampleSeconds)
+	{
+		Iterations *= 2;
+	}
+
+	for (int32 Warmup = 0; Warmup < Options.WarmupRuns; ++Warmup)
+	{
+		Body(Iterations);
+	}
+
+	FBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+	Result.Group = Group;
+	Result.Name = Name;
+	Result.Parameter = Parameter;
+	Result.IterationsPerSample = Iterations;
+	Result.Samples.Reserve(Options.Repetitions);
+
+	TArray<double> Cycles;
+	TArray<double> Instructions;
+	TArray<double> CacheMisses;
+	for (int32 Repetition = 0; Repetition < Options.Repetitions; ++Repetition)
+	{
+		const FCounterValues Before = Counters->Read();
+		const double Seconds = TimeSeconds(Iterations);
+		const FCounterValues After = Counters->Read();
+
+		Result.Samples.Add(Seconds * 1e9 / (double)Iterations);
+		if (Before.Cycles >= 0)
+		{
+			Cycles.Add((double)(After.Cycles - Before.Cycles) / (double)Iterations);
+		}
+		if (Before.Instructions >= 0)
+		{
+			Instructions.Add((double)(After.Instructions - Before.Instructions) / (double)Iterations);
+		}
+		if (Before.CacheMisses >= 0)
+		{
+			CacheMisses.Add((double)(After.CacheMisses - Before.CacheMisses) / (double)Iterations);
+		}
+	}
+
+	TArray<double>& Samples = Result.Samples;
+	Result.Median = GetMedian(Samples);
+	Result.Min = Samples[0];
+	Result.Max = Samples.Last();
+	Result.P90 = GetPercentile(Samples, 0.90);
+	Result.P99 = GetPercentile(Samples, 0.99);
+
+	double Sum = 0.0;
+	for (const double Sample : Samples)
+	{
+		Sum += Sample;
+	}
+	Result.Mean = Sum / Samples.Num();
+
+	double SquaredDeviations = 0.0;
+	for (const double Sample : Samples)
+	{
+		SquaredDeviations += (Sample - Result.Mean) * (Sample - Result.Mean);
+	}
+	Result.StdDev = Samples.Num() > 1 ? std::sqrt(SquaredDeviations / (Samples.Num() - 1)) : 0.0;
+
+	if (Cycles.Num())
+	{
+		Result.Cycles = GetMedian(Cycles);
+	}
+	if (Instructions.Num())
+	{
+		Result.Instructions = GetMedian(Instructions);
+	}
+	if (CacheMisses.Num())
+	{
+		Result.CacheMisses = GetMedian(CacheMisses);
+	}
+	if (BytesPerIteration && Result.Median > 0.0)
+	{
+		Result.BytesPerSecond = (double)BytesPerIteration * 1e9 / Result.Median;
+	}
+
+	UE_LOG(LogBenchmark, Display, TEXT("%-48s median %12.2f ns  p90 %12.2f ns  p99 %12.2f ns  (%llu iterations x %d)%s"),
+		*FullName, Result.Median, Result.P90, Result.P99, Iterations, Options.Repetitions,
+		Result.BytesPerSecond > 0.0 ? *FString::Printf(TEXT("  %.2f GB/s"), Result.BytesPerSecond / 1e9) : TEXT(""));
+}
+
+FString FBenchmarkRunner::ToJson(const TCHAR* Commit) const
+{
+	FString Json;
+	Json += TEXT("{\n\t\"context\": {\n\t\t\"commit\": ");
+	AppendJsonString(Json, Commit);
+	Json += TEXT(",\n\t\t\"date\": ");
+	AppendJsonString(Json, FDateTime::UtcNow().ToIso8601());
+	Json += FString::Printf(TEXT(",\n\t\t\"num_cores\": %d"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	Json += TEXT(",\n\t\t\"malloc\": ");
+	AppendJsonString(Json, GMalloc ? GMalloc->GetDescriptiveName() : TEXT(""));
+	Json += FString::Printf(TEXT(",\n\t\t\"warmup_runs\": %d,\n\t\t\"repetitions\": %d"), Options.WarmupRuns, Options.Repetitions);
+	Json += TEXT("\n\t},\n\t\"benchmarks\": [");
+
+	for (int32 Index = 0; Index < Results.Num(); ++Index)
+	{
+		const FBenchmarkResult& Result = Results[Index];
+		Json += Index ? TEXT(",\n\t\t{") : TEXT("\n\t\t{");
+		Json += TEXT("\n\t\t\t\"group\": ");
+		AppendJsonString(Json, Result.Group);
+		Json += TEXT(",\n\t\t\t\"name\": ");
+		AppendJsonString(Json, Result.Name);
+		Json += FString::Printf(TEXT(",\n\t\t\t\"parameter\": %lld,\n\t\t\t\"iterations_per_sample\": %llu"), Result.Parameter, Result.IterationsPerSample);
+
+		struct FField
+		{
+			const TCHAR* Key;
+			double Value;
+		};
+		const FField Fields[] =
+		{
+			{ TEXT("min_ns"), Result.Min },
+			{ TEXT("median_ns"), Result.Median },
+			{ TEXT("mean_ns"), Result.Mean },
+			{ TEXT("stddev_ns"), Result.StdDev },
+			{ TEXT("p90_ns"), Result.P90 },
+			{ TEXT("p99_ns"), Result.P99 },
+			{ TEXT("max_ns"), Result.Max },
+			{ TEXT("tsc_cycles"), Result.Cycles },
+			{ TEXT("instructions"), Result.Instructions },
+			{ TEXT("cache_misses"), Result.CacheMisses },
+			{ TEXT("bytes_per_second"), Result.BytesPerSecond },
+		};
+		for (const FField& Field : Fields)
+		{
+			Json += FString::Printf(TEXT(",\n\t\t\t\"%s\": "), Field.Key);
+			AppendJsonNumber(Json, Field.Value);
+		}
+		Json += TEXT("\n\t\t}");
+	}
+	Json += TEXT("\n\t]\n}\n");
+	return Json;
+}
+
+bool FBenchmarkRunner::SaveJson(const TCHAR* Filename, const TCHAR* Commit) const
+{
+	return FFileHelper::SaveStringToFile(ToJson(Commit), Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+FBenchmarkRegistration::FBenchmarkRegistration(const TCHAR* InGroup, FRegisterFunction InFunction)
+	: Group(InGroup)
+	, Function(InFunction)
+	, Next(GetRegistrationHead())
+{
+	GetRegistrationHead() = this;
+}
+
+int32 RunRegisteredBenchmarks(FBenchmarkRunner& Runner)
+{
+	// Static registrations come in link order, sort them so every build reports in the same order.
+	TArray<FBenchmarkRegistration*> Registrations;
+	for (FBenchmarkRegistration* Registration = GetRegistrationHead(); Registration; Registration = Registration->Next)
+	{
+		Registrations.Add(Registration);
+	}
+	Registrations.Sort([](const FBenchmarkRegistration& A, const FBenchmarkRegistration& B)
+	{
+		return FCString::Strcmp(A.Group, B.Group) < 0;
+	});
+
+	const int32 NumBefore = Runner.GetResults().Num();
+	for (FBenchmarkRegistration* Registration : Registrations)
+	{
+		Registration->Function(Runner);
+	}
+	return Runner.GetResults().Num() - NumBefore;
+}
+
+#endif // WITH_BENCHMARKS
@@ -0,0 +1,54 @@
+#include "Tests/Benchmark.h"
+
+#if WITH_BENCHMARKS
+
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "ProfilingDebugging/CoreTrace.h"
+
+/**
+ * Entry point of the Benchmark configuration, which builds the benchmarks instead of the application:
+ *
+ *     DemoUE.exe -Filter=Malloc.Binned -Json=Benchmarks.json -Commit=<hash> -Repetitions=51 -Warmup=5
+ *
+ * Runs every registered benchmark whose name contains the filter and writes the results as JSON when asked to. With
+ * -TraceFile= the run is traced, see FCoreTrace::StartFromCommandLine.
+ */
+int main(int ArgC, char* ArgV[])
+{
+	FString CommandLine;
+	for (int32 Arg = 1; Arg < ArgC; ++Arg)
+	{
+		CommandLine += TEXT(" ");
+		CommandLine += UTF8_TO_TCHAR(ArgV[Arg]);
+	}
+	FCommandLine::Set(*CommandLine);
+
+	FBenchmarkOptions Options;
+	FParse::Value(*CommandLine, TEXT("-Filter="), Options.Filter);
+	FParse::Value(*CommandLine, TEXT("-Repetitions="), Options.Repetitions);
+	FParse::Value(*CommandLine, TEXT("-Warmup="), Options.WarmupRuns);
+	FParse::Value(*CommandLine, TEXT("-MinSampleSeconds="), Options.MinSampleSeconds);
+
+	FString JsonFilename;
+	FString Commit;
+	FParse::Value(*CommandLine, TEXT("-Json="), JsonFilename);
+	FParse::Value(*CommandLine, TEXT("-Commit="), Commit);
+
+	// The benchmarks compare the allocators side by side, GMalloc is only what the harness itself allocates from.
+	FMemory::SetupTLSCachesOnCurrentThread();
+
+	FCoreTrace::StartFromCommandLine();
+
+	FBenchmarkRunner Runner(Options);
+	RunRegisteredBenchmarks(Runner);
+	FCoreTrace::Stop();
+
+	if (!JsonFilename.IsEmpty() && !Runner.SaveJson(*JsonFilename, *Commit))
+	{
+		return 1;
+	}
+	return 0;
+}
+
+#endif // WITH_BENCHMARKS
@@ -0,0 +1,473 @@
+#include "Tests/Benchmark.h"
+
+#if WITH_BENCHMARKS
+
+#include "Containers/Array.h"
+#include "Containers/FlatMap.h"
+#include "Containers/FrozenMap.h"
+#include "Containers/Map.h"
+#include "Containers/SoAArray.h"
+#include "HAL/MallocBinned.h"
+#include "HAL/MallocSampledProxy.h"
+#include "HAL/UnrealMemory.h"
+#include "Serialization/BlockCompressionArchive.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace UE::Benchmark::Private
+{
+	using UE::Benchmark::DoNotOptimize;
+	using UE::Benchmark::ClobberMemory;
+
+	/** Element counts the container benchmarks run at: within L1, within L2, and well past the last level cache. */
+	static const int32 ContainerSizes[] = { 16, 1024, 65536, 1 << 20 };
+
+	/** Byte counts of the memory and serialization benchmarks, same idea. */
+	static const int32 BufferSizes[] = { 64, 4096, 256 * 1024, 16 * 1024 * 1024 };
+
+	/** Deterministic pseudo random numbers, the same sequence on every run. */
+	struct FRandomStream
+	{
+		uint32 State = 0x9E3779B9u;
+
+		FORCEINLINE uint32 Next()
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+			return State;
+		}
+	};
+
+	static TArray<int32> MakeRandomKeys(int32 Num, uint32 Seed)
+	{
+		FRandomStream Random;
+		Random.State ^= Seed;
+		TArray<int32> Keys;
+		Keys.SetNumUninitialized(Num);
+		for (int32& Key : Keys)
+		{
+			Key = (int32)(Random.Next() & 0x7FFFFFFF);
+		}
+		return Keys;
+	}
+
+	/** Every allocator, each a separate instance next to GMalloc so they are compared in the same process. */
+	static TArray<FMalloc*> GetBenchmarkedAllocators()
+	{
+		static FMalloc* Binned = new FMallocBinned();
+		static FMalloc* Purgatory = new FMallocSampledProxy(new FMallocBinned(), ESampledMallocMode::Purgatory);
+		static FMalloc* Poison = new FMallocSampledProxy(new FMallocBinned(), ESampledMallocMode::Poison);
+		return { Binned, Purgatory, Poison };
+	}
+
+	static void RegisterMallocBenchmarks(FBenchmarkRunner& Runner)
+	{
+		static const int32 FixedSizes[] = { 16, 128, 1024, 32 * 1024 };
+		constexpr int32 BatchSize = 1024;
+
+		FRandomStream Random;
+		TArray<SIZE_T> MixedSizes;
+		for (int32 Index = 0; Index < BatchSize; ++Index)
+		{
+			// Mostly small, the way gameplay code allocates, with the odd larger block.
+			MixedSizes.Add(Random.Next() % 16 ? 8 + Random.Next() % 248 : 256 + Random.Next() % 16128);
+		}
+
+		TArray<void*> Blocks;
+		Blocks.SetNumZeroed(BatchSize);
+
+		for (FMalloc* Allocator : GetBenchmarkedAllocators())
+		{
+			const TCHAR* Group = Allocator->GetDescriptiveName();
+			Allocator->SetupTLSCachesOnCurrentThread();
+
+			for (const int32 Size : FixedSizes)
+			{
+				Runner.Run(*FString::Printf(TEXT("Malloc.%s"), Group), TEXT("MallocFree"), Size, [Allocator, Size](uint64 Iterations)
+				{
+					for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+					{
+						void* Ptr = Allocator->Malloc(Size, DEFAULT_ALIGNMENT);
+						DoNotOptimize(Ptr);
+						Allocator->Free(Ptr);
+					}
+				});
+			}
+
+			Runner.Run(*FString::Printf(TEXT("Malloc.%s"), Group), TEXT("MixedBatchFifo"), BatchSize, [Allocator, &MixedSizes, &Blocks](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					for (int32 Index = 0; Index < BatchSize; ++Index)
+					{
+						Blocks[Index] = Allocator->Malloc(MixedSizes[Index], DEFAULT_ALIGNMENT);
+					}
+					ClobberMemory();
+					for (int32 Index = 0; Index < BatchSize; ++Index)
+					{
+						Allocator->Free(Blocks[Index]);
+					}
+				}
+			});
+
+			Runner.Run(*FString::Printf(TEXT("Malloc.%s"), Group), TEXT("MixedBatchLifo"), BatchSize, [Allocator, &MixedSizes, &Blocks](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					for (int32 Index = 0; Index < BatchSize; ++Index)
+					{
+						Blocks[Index] = Allocator->Malloc(MixedSizes[Index], DEFAULT_ALIGNMENT);
+					}
+					ClobberMemory();
+					for (int32 Index = BatchSize - 1; Index >= 0; --Index)
+					{
+						Allocator->Free(Blocks[Index]);
+					}
+				}
+			});
+
+			// What a TArray growing from empty does to its allocation.
+			Runner.Run(*FString::Printf(TEXT("Malloc.%s"), Group), TEXT("ReallocGrowth"), 64 * 1024, [Allocator](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					void* Ptr = nullptr;
+					for (SIZE_T Size = 16; Size <= 64 * 1024; Size = Size * 3 / 2)
+					{
+						Ptr = Allocator->Realloc(Ptr, Size, DEFAULT_ALIGNMENT);
+					}
+					DoNotOptimize(Ptr);
+					Allocator->Free(Ptr);
+				}
+			});
+		}
+	}
+
+	static void RegisterMemoryBenchmarks(FBenchmarkRunner& Runner)
+	{
+		for (const int32 Size : BufferSizes)
+		{
+			uint8* Source = (uint8*)FMemory::Malloc(Size, 64);
+			uint8* Dest = (uint8*)FMemory::Malloc(Size, 64);
+			FMemory::Memset(Source, 0x5A, Size);
+			FMemory::Memzero(Dest, Size);
+
+			Runner.Run(TEXT("Memory"), TEXT("Memcpy"), Size, [Source, Dest, Size](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					FMemory::Memcpy(Dest, Source, Size);
+					ClobberMemory();
+				}
+			}, Size);
+
+			Runner.Run(TEXT("Memory"), TEXT("BigBlockMemcpy"), Size, [Source, Dest, Size](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					FMemory::BigBlockMemcpy(Dest, Source, Size);
+					ClobberMemory();
+				}
+			}, Size);
+
+			Runner.Run(TEXT("Memory"), TEXT("StreamingMemcpy"), Size, [Source, Dest, Size](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					FMemory::StreamingMemcpy(Dest, Source, Size);
+					ClobberMemory();
+				}
+			}, Size);
+
+			Runner.Run(TEXT("Memory"), TEXT("ParallelMemcpy"), Size, [Source, Dest, Size](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					FMemory::ParallelMemcpy(Dest, Source, Size);
+					ClobberMemory();
+				}
+			}, Size);
+
+			// The whole buffer is scanned, the worst case of MemIsZero.
+			Runner.Run(TEXT("Memory"), TEXT("MemIsZero"), Size, [Dest, Size](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					DoNotOptimize(FMemory::MemIsZero(Dest, Size));
+					ClobberMemory();
+				}
+			}, Size);
+
+			FMemory::Free(Dest);
+			FMemory::Free(Source);
+		}
+	}
+
+	template <typename MapType>
+	static void RunMapBenchmarks(FBenchmarkRunner& Runner, const TCHAR* Group, int32 Num, const TArray<int32>& Keys, const TArray<int32>& MissingKeys)
+	{
+		Runner.Run(Group, TEXT("Add"), Num, [Num, &Keys](uint64 Iterations)
+		{
+			for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				MapType Map;
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					Map.Add(Keys[Index], Index);
+				}
+				DoNotOptimize(Map.Num());
+			}
+		});
+
+		MapType Map;
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Map.Add(Keys[Index], Index);
+		}
+
+		Runner.Run(Group, TEXT("FindHit"), Num, [Num, &Map, &Keys](uint64 Iterations)
+		{
+			for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				DoNotOptimize(Map.Find(Keys[(int32)(Iteration % Num)]));
+			}
+		});
+
+		Runner.Run(Group, TEXT("FindMiss"), Num, [Num, &Map, &MissingKeys](uint64 Iterations)
+		{
+			for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				DoNotOptimize(Map.Find(MissingKeys[(int32)(Iteration % Num)]));
+			}
+		});
+
+		// Steady state churn: one key out, one in, the element count stays put.
+		Runner.Run(Group, TEXT("RemoveAddMix"), Num, [Num, &Map, &Keys](uint64 Iterations)
+		{
+			for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				const int32 Index = (int32)(Iteration % Num);
+				Map.Remove(Keys[Index]);
+				Map.Add(Keys[Index], Index);
+			}
+		});
+	}
+
+	static void RegisterContainerBenchmarks(FBenchmarkRunner& Runner)
+	{
+		for (const int32 Num : ContainerSizes)
+		{
+			// Growth from empty goes through CalculateSlackGrow every time the array is full.
+			Runner.Run(TEXT("Array"), TEXT("AddGrow"), Num, [Num](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					TArray<int32> Array;
+					for (int32 Index = 0; Index < Num; ++Index)
+					{
+						Array.Add(Index);
+					}
+					DoNotOptimize(Array.GetData());
+				}
+			});
+
+			Runner.Run(TEXT("Array"), TEXT("AddReserved"), Num, [Num](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					TArray<int32> Array;
+					Array.Reserve(Num);
+					for (int32 Index = 0; Index < Num; ++Index)
+					{
+						Array.Add(Index);
+					}
+					DoNotOptimize(Array.GetData());
+				}
+			});
+
+			TArray<int32> Array;
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				Array.Add(Index);
+			}
+			Runner.Run(TEXT("Array"), TEXT("RemoveAtSwapAdd"), Num, [Num, &Array](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					Array.RemoveAtSwap((int32)(Iteration % Num), 1, false);
+					Array.Add((int32)Iteration);
+				}
+			});
+		}
+
+		// One field update over entities, array of structs against structure of arrays.
+		struct FEntity
+		{
+			float Position[3];
+			float Velocity[3];
+			float Mass;
+			uint32 Flags;
+			uint8 Payload[32];
+		};
+		for (const int32 Num : ContainerSizes)
+		{
+			TArray<FEntity> Entities;
+			Entities.SetNumZeroed(Num);
+			Runner.Run(TEXT("Array"), TEXT("StructFieldUpdate"), Num, [&Entities](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					for (FEntity& Entity : Entities)
+					{
+						Entity.Mass += 1.0f;
+					}
+					ClobberMemory();
+				}
+			}, Num * sizeof(float));
+
+			TSoAArray<TSoAFields<float, float, float, uint32>> SoAEntities;
+			SoAEntities.SetNumZeroed(Num);
+			Runner.Run(TEXT("SoAArray"), TEXT("ColumnUpdate"), Num, [&SoAEntities](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					float* Masses = SoAEntities.GetData<2>();
+					for (int32 Index = 0, NumEntities = SoAEntities.Num(); Index < NumEntities; ++Index)
+					{
+						Masses[Index] += 1.0f;
+					}
+					ClobberMemory();
+				}
+			}, Num * sizeof(float));
+		}
+
+		for (const int32 Num : ContainerSizes)
+		{
+			const TArray<int32> Keys = MakeRandomKeys(Num, 1);
+			TArray<int32> MissingKeys = MakeRandomKeys(Num, 2);
+			for (int32& Key : MissingKeys)
+			{
+				// Negative, never one of the keys.
+				Key = -Key - 1;
+			}
+
+			RunMapBenchmarks<TMap<int32, int32>>(Runner, TEXT("Map"), Num, Keys, MissingKeys);
+			RunMapBenchmarks<TFlatMap<int32, int32>>(Runner, TEXT("FlatMap"), Num, Keys, MissingKeys);
+
+			TMap<int32, int32> Source;
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				Source.Add(Keys[Index], Index);
+			}
+			const TFrozenMap<int32, int32> Frozen(Source);
+			Runner.Run(TEXT("FrozenMap"), TEXT("FindHit"), Num, [Num, &Frozen, &Keys](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					DoNotOptimize(Frozen.Find(Keys[(int32)(Iteration % Num)]));
+				}
+			});
+			Runner.Run(TEXT("FrozenMap"), TEXT("FindMiss"), Num, [Num, &Frozen, &MissingKeys](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					DoNotOptimize(Frozen.Find(MissingKeys[(int32)(Iteration % Num)]));
+				}
+			});
+		}
+	}
+
+	static void RegisterArchiveBenchmarks(FBenchmarkRunner& Runner)
+	{
+		for (const int32 Size : BufferSizes)
+		{
+			TArray<float> Values;
+			Values.SetNumUninitialized(Size / sizeof(float));
+			for (int32 Index = 0; Index < Values.Num(); ++Index)
+			{
+				Values[Index] = (float)(Index % 977);
+			}
+
+			TArray<uint8> Bytes;
+			Bytes.Reserve(Size + 64);
+
+			// operator<< of an arithmetic array, which writes the count then the elements as one byte-order aware block.
+			Runner.Run(TEXT("Archive"), TEXT("SaveOperator"), Size, [&Values, &Bytes](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					Bytes.Reset();
+					FMemoryWriter Writer(Bytes);
+					Writer << Values;
+				}
+			}, Size);
+
+			Runner.Run(TEXT("Archive"), TEXT("SaveBulk"), Size, [&Values, &Bytes](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					Bytes.Reset();
+					FMemoryWriter Writer(Bytes);
+					Writer.Serialize(Values.GetData(), Values.Num() * sizeof(float));
+				}
+			}, Size);
+
+			{
+				Bytes.Reset();
+				FMemoryWriter Writer(Bytes);
+				Values.BulkSerialize(Writer);
+			}
+			TArray<float> Loaded;
+			Runner.Run(TEXT("Archive"), TEXT("LoadBulk"), Size, [&Bytes, &Loaded](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					FMemoryReader Reader(Bytes);
+					Loaded.BulkSerialize(Reader);
+					DoNotOptimize(Loaded.GetData());
+				}
+			}, Size);
+
+			TArray<uint8> Compressed;
+			Runner.Run(TEXT("Archive"), TEXT("SaveBlockCompressed"), Size, [&Values, &Compressed](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					Compressed.Reset();
+					FMemoryWriter Writer(Compressed);
+					FArchiveBlockCompressionWriter CompressionWriter(Writer);
+					CompressionWriter.Serialize(Values.GetData(), Values.Num() * sizeof(float));
+					CompressionWriter.Close();
+				}
+			}, Size);
+
+			// Set up outside the timings again, the bodies above only run when the filter selects them.
+			{
+				Compressed.Reset();
+				FMemoryWriter Writer(Compressed);
+				FArchiveBlockCompressionWriter CompressionWriter(Writer);
+				CompressionWriter.Serialize(Values.GetData(), Values.Num() * sizeof(float));
+				CompressionWriter.Close();
+			}
+			Loaded.SetNumUninitialized(Values.Num());
+			Runner.Run(TEXT("Archive"), TEXT("LoadBlockCompressed"), Size, [&Compressed, &Loaded](uint64 Iterations)
+			{
+				for (uint64 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					FMemoryReader Reader(Compressed);
+					FArchiveBlockCompressionReader CompressionReader(Reader);
+					CompressionReader.Serialize(Loaded.GetData(), Loaded.Num() * sizeof(float));
+					DoNotOptimize(Loaded.GetData());
+				}
+			}, Size);
+		}
+	}
+
+	static FBenchmarkRegistration GMallocBenchmarks(TEXT("Malloc"), &RegisterMallocBenchmarks);
+	static FBenchmarkRegistration GMemoryBenchmarks(TEXT("Memory"), &RegisterMemoryBenchmarks);
+	static FBenchmarkRegistration GContainerBenchmarks(TEXT("Containers"), &RegisterContainerBenchmarks);
+	static FBenchmarkRegistration GArchiveBenchmarks(TEXT("Archive"), &RegisterArchiveBenchmarks);
+}
+
+#endif // WITH_BENCHMARKS
@@ -0,0 +1,318 @@
+#include "Windows/WindowsPlatformMemory.h"
+#include "HAL/MallocBinned.h"
+#include <Windows.h>
+
+namespace UE::Core::Private::WindowsPlatformMemory
+{
+	static constexpr SIZE_T HugePageSize = 1024ull * 1024 * 1024;
+
+	/** Rounding an allocation up to large or huge pages may waste at most this fraction of it. */
+	static constexpr SIZE_T MaxPageRoundingWasteDivisor = 8;
+
+	/** GetLargePageMinimum, read by ConfigureOSAllocations. Kept once read so frees account against the same size. */
+	static SIZE_T GLargePageMinimum = 0;
+
+	/**
+	 * VirtualAlloc2, the only way to ask for 1 GB pages. Resolved by ConfigureOSAllocations rather than linked, it is
+	 * exported by onecore.lib and not kernel32.lib, and Windows before 1803 does not have it; huge pages are off then.
+	 */
+	using FVirtualAlloc2 = decltype(&VirtualAlloc2);
+	static FVirtualAlloc2 GVirtualAlloc2 = nullptr;
+
+	static FVirtualAlloc2 ResolveVirtualAlloc2()
+	{
+		HMODULE KernelBase = GetModuleHandleW(L"kernelbase.dll");
+		return KernelBase ? (FVirtualAlloc2)GetProcAddress(KernelBase, "VirtualAlloc2") : nullptr;
+	}
+
+	FORCEINLINE SIZE_T AlignUp(SIZE_T Value, SIZE_T Alignment)
+	{
+		return (Value + Alignment - 1) / Alignment * Alignment;
+	}
+
+	static SIZE_T GetPageSize(EOSPageSize PageSize)
+	{
+		switch (PageSize)
+		{
+		case EOSPageSize::Large:
+			return GLargePageMinimum;
+		case EOSPageSize::Huge:
+			return HugePageSize;
+		default:
+			return 1;
+		}
+	}
+
+	/** @return whether Size is big enough to be backed by PageSize pages without wasting much of the last one */
+	static bool FitsPageSize(SIZE_T Size, SIZE_T PageSize)
+	{
+		return PageSize && Size >= PageSize && AlignUp(Size, PageSize) - Size <= Size / MaxPageRoundingWasteDivisor;
+	}
+
+	static EOSPageSize ChoosePageSize(SIZE_T Size, EOSAllocationFlags Flags, EOSPageSize Largest)
+	{
+		if (Largest >= EOSPageSize::Huge && !!(Flags & EOSAllocationFlags::HugePages) && FitsPageSize(Size, HugePageSize))
+		{
+			return EOSPageSize::Huge;
+		}
+		if (Largest >= EOSPageSize::Large && !!(Flags & EOSAllocationFlags::LargePages) && FitsPageSize(Size, GLargePageMinimum))
+		{
+			return EOSPageSize::Large;
+		}
+		return EOSPageSize::Default;
+	}
+
+	/** Large pages are locked in memory, the account needs SeLockMemoryPrivilege and the process has to enable it. */
+	static bool EnableLockMemoryPrivilege()
+	{
+		HANDLE Token;
+		if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &Token))
+		{
+			return false;
+		}
+
+		TOKEN_PRIVILEGES Privileges;
+		Privileges.PrivilegeCount = 1;
+		Privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+		// AdjustTokenPrivileges succeeds with ERROR_NOT_ALL_ASSIGNED when the account does not hold the privilege.
+		const bool bEnabled = LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME, &Privileges.Privileges[0].Luid)
+			&& AdjustTokenPrivileges(Token, FALSE, &Privileges, 0, nullptr, nullptr)
+			&& GetLastError() == ERROR_SUCCESS;
+		CloseHandle(Token);
+		return bEnabled;
+	}
+
+	static void* AllocatePages(SIZE_T Size, EOSPageSize PageSize, int32 NumaNode)
+	{
+		if (PageSize == EOSPageSize::Huge)
+		{
+			if (!GVirtualAlloc2)
+			{
+				SetLastError(ERROR_NOT_SUPPORTED);
+				return nullptr;
+			}
+			MEM_EXTENDED_PARAMETER Parameters[2] = {};
+			Parameters[0].Type = MemExtendedParameterAttributeFlags;
+			Parameters[0].ULong64 = MEM_EXTENDED_PARAMETER_NONPAGED_HUGE;
+			ULONG NumParameters = 1;
+			if (NumaNode != INDEX_NONE)
+			{
+				Parameters[1].Type = MemExtendedParameterNumaNode;
+				Parameters[1].ULong = (DWORD)NumaNode;
+				NumParameters = 2;
+			}
+			return GVirtualAlloc2(GetCurrentProcess(), nullptr, Size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, Parameters, NumParameters);
+		}
+
+		const DWORD AllocationType = MEM_RESERVE | MEM_COMMIT | (PageSize == EOSPageSize::Large ? MEM_LARGE_PAGES : 0);
+		if (NumaNode != INDEX_NONE)
+		{
+			return VirtualAllocExNuma(GetCurrentProcess(), nullptr, Size, AllocationType, PAGE_READWRITE, (DWORD)NumaNode);
+		}
+		return VirtualAlloc(nullptr, Size, AllocationType, PAGE_READWRITE);
+	}
+}
+
+FMalloc* FWindowsPlatformMemory::BaseAllocator()
+{
+	// The allocator is created before the command line is parsed, read the options straight from the OS.
+	const TCHAR* CommandLine = ::GetCommandLineW();
+	EOSAllocationFlags Flags = EOSAllocationFlags::None;
+	if (FCString::Stristr(CommandLine, TEXT("-LargePages")))
+	{
+		Flags |= EOSAllocationFlags::LargePages;
+	}
+	if (FCString::Stristr(CommandLine, TEXT("-HugePages")))
+	{
+		Flags |= EOSAllocationFlags::HugePages;
+	}
+	if (FCString::Stristr(CommandLine, TEXT("-NumaLocal")))
+	{
+		Flags |= EOSAllocationFlags::NumaLocal;
+	}
+	if (Flags != EOSAllocationFlags::None && ConfigureOSAllocations(Flags) != Flags)
+	{
+		OutputDebugStringW(TEXT("Some of -LargePages, -HugePages and -NumaLocal are not available, SeLockMemoryPrivilege, VirtualAlloc2 or a NUMA machine is missing.\n"));
+	}
+
+	return new FMallocBinned();
+}
+
+void* FWindowsPlatformMemory::BinnedAllocFromOS(SIZE_T Size)
+{
+	// VirtualAlloc hands out memory aligned to the allocation granularity (64KB), which FMallocBinned relies on.
+	void* Ptr = VirtualAlloc(nullptr, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	return Ptr;
+}
+
+void FWindowsPlatformMemory::BinnedFreeToOS(void* Ptr, SIZE_T Size)
+{
+	verify(VirtualFree(Ptr, 0, MEM_RELEASE) != 0);
+}
+
+void* FWindowsPlatformMemory::BinnedAllocFromOS(SIZE_T Size, int32 NumaNode, FOSAllocationInfo& OutInfo)
+{
+	using namespace UE::Core::Private::WindowsPlatformMemory;
+
+	EOSAllocationFlags Flags = GetOSAllocationFlags();
+	OutInfo = FOSAllocationInfo();
+	if (!!(Flags & EOSAllocationFlags::NumaLocal))
+	{
+		OutInfo.NumaNode = (int8)(NumaNode != INDEX_NONE ? NumaNode : GetCurrentNumaNode());
+	}
+
+	// Walk down the page sizes until the OS has pages left, physical memory may be too fragmented for large pages.
+	EOSPageSize PageSize = ChoosePageSize(Size, Flags, EOSPageSize::Huge);
+	for (;;)
+	{
+		const SIZE_T AllocationSize = AlignUp(Size, GetPageSize(PageSize));
+		if (void* Ptr = AllocatePages(AllocationSize, PageSize, OutInfo.NumaNode))
+		{
+			OutInfo.PageSize = PageSize;
+			TrackOSAllocation(AllocationSize, OutInfo);
+			return Ptr;
+		}
+		if (PageSize == EOSPageSize::Default)
+		{
+			return nullptr;
+		}
+
+		if (GetLastError() == ERROR_PRIVILEGE_NOT_HELD)
+		{
+			// The privilege was taken away, do not ask for large pages anymore, including for the rest of this allocation.
+			SetOSAllocationFlags(GetOSAllocationFlags() & ~(EOSAllocationFlags::LargePages | EOSAllocationFlags::HugePages));
+			Flags = GetOSAllocationFlags();
+		}
+		TrackLargePageFallback();
+		PageSize = ChoosePageSize(Size, Flags, (EOSPageSize)((uint8)PageSize - 1));
+	}
+}
+
+void FWindowsPlatformMemory::BinnedFreeToOS(void* Ptr, SIZE_T Size, const FOSAllocationInfo& Info)
+{
+	using namespace UE::Core::Private::WindowsPlatformMemory;
+
+	TrackOSFree(AlignUp(Size, GetPageSize(Info.PageSize)), Info);
+	verify(VirtualFree(Ptr, 0, MEM_RELEASE) != 0);
+}
+
+EOSAllocationFlags FWindowsPlatformMemory::ConfigureOSAllocations(EOSAllocationFlags Flags)
+{
+	using namespace UE::Core::Private::WindowsPlatformMemory;
+
+	EOSAllocationFlags Enabled = EOSAllocationFlags::None;
+	const EOSAllocationFlags PageFlags = Flags & (EOSAllocationFlags::LargePages | EOSAllocationFlags::HugePages);
+	if (PageFlags != EOSAllocationFlags::None)
+	{
+		if (!GLargePageMinimum)
+		{
+			GLargePageMinimum = GetLargePageMinimum();
+		}
+		if (GLargePageMinimum && EnableLockMemoryPrivilege())
+		{
+			Enabled |= PageFlags;
+		}
+		if (!!(Enabled & EOSAllocationFlags::HugePages))
+		{
+			if (!GVirtualAlloc2)
+			{
+				GVirtualAlloc2 = ResolveVirtualAlloc2();
+			}
+			if (!GVirtualAlloc2)
+			{
+				Enabled &= ~EOSAllocationFlags::HugePages;
+			}
+		}
+	}
+	if (!!(Flags & EOSAllocationFlags::NumaLocal) && GetNumNumaNodes() > 1)
+	{
+		Enabled |= EOSAllocationFlags::NumaLocal;
+	}
+
+	SetOSAllocationFlags(Enabled);
+	return Enabled;
+}
+
+SIZE_T FWindowsPlatformMemory::GetLargePageSize()
+{
+	using namespace UE::Core::Private::WindowsPlatformMemory;
+
+	return !!(GetOSAllocationFlags() & EOSAllocationFlags::LargePages) ? GLargePageMinimum : 0;
+}
+
+uint32 FWindowsPlatformMemory::GetNumNumaNodes()
+{
+	ULONG HighestNode = 0;
+	return GetNumaHighestNodeNumber(&HighestNode) ? (uint32)HighestNode + 1 : 1;
+}
+
+int32 FWindowsPlatformMemory::GetCurrentNumaNode()
+{
+	PROCESSOR_NUMBER Processor;
+	GetCurrentProcessorNumberEx(&Processor);
+	USHORT Node = 0;
+	return GetNumaProcessorNodeEx(&Processor, &Node) ? (int32)Node : 0;
+}
+
+FGenericPlatformMemory::FMappedFileRegion* FWindowsPlatformMemory::MapFileRegion(const TCHAR* Filename)
+{
+	HANDLE File = CreateFileW(Filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize) || (uint64)FileSize.QuadPart > (uint64)SIZE_MAX)
+	{
+		CloseHandle(File);
+		return nullptr;
+	}
+
+	// Windows refuses to map empty files, an empty view is still a valid result.
+	if (FileSize.QuadPart == 0)
+	{
+		return new FWindowsMappedFileRegion(nullptr, 0, File, nullptr);
+	}
+
+	HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!Mapping)
+	{
+		CloseHandle(File);
+		return nullptr;
+	}
+
+	const uint8* Address = (const uint8*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!Address)
+	{
+		CloseHandle(Mapping);
+		CloseHandle(File);
+		return nullptr;
+	}
+
+	return new FWindowsMappedFileRegion(Address, (SIZE_T)FileSize.QuadPart, File, Mapping);
+}
+
+bool FWindowsPlatformMemory::UnmapFileRegion(FMappedFileRegion* MappedRegion)
+{
+	bool bAllSucceeded = true;
+	if (MappedRegion)
+	{
+		FWindowsMappedFileRegion* WindowsRegion = static_cast<FWindowsMappedFileRegion*>(MappedRegion);
+		if (WindowsRegion->GetAddress() && !UnmapViewOfFile(WindowsRegion->GetAddress()))
+		{
+			bAllSucceeded = false;
+		}
+		if (WindowsRegion->Mapping && !CloseHandle(WindowsRegion->Mapping))
+		{
+			bAllSucceeded = false;
+		}
+		if (!CloseHandle(WindowsRegion->File))
+		{
+			bAllSucceeded = false;
+		}
+		delete WindowsRegion;
+	}
+	return bAllSucceeded;
+}
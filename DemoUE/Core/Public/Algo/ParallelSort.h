@@ -0,0 +1,407 @@
+#pragma once
+#include <type_traits>
+#include "CoreTypes.h"
+#include "HAL/UnrealMemory.h"
+#include "Async/ParallelFor.h"
+
+/** Ranges smaller than this are sorted on the calling thread; spinning up helpers would cost more than it saves. */
+#define PARALLEL_SORT_MIN_ELEMENTS 65536
+
+/** Smallest number of elements a sorting or merging task works on. */
+#define PARALLEL_SORT_MIN_ELEMENTS_PER_TASK 16384
+
+namespace AlgoImpl::ParallelSort
+{
+	/** @return how many chunks a range of Num elements is split over, 1 meaning it is sorted serially */
+	FORCEINLINE int32 GetNumChunks(int32 Num)
+	{
+		if (Num < PARALLEL_SORT_MIN_ELEMENTS)
+		{
+			return 1;
+		}
+		return FMath::Clamp(Num / PARALLEL_SORT_MIN_ELEMENTS_PER_TASK, 1, GetParallelForNumThreads());
+	}
+
+	/** Elements are moved bitwise, TArray already requires its elements to be relocatable. */
+	template <typename T>
+	FORCEINLINE void RelocateElement(T* Dest, const T* Source)
+	{
+		FMemory::Memcpy((void*)Dest, (const void*)Source, sizeof(T));
+	}
+
+	/** Relocates Num elements from Source to Dest, several chunks at a time for big ranges. */
+	template <typename T>
+	void ParallelRelocate(T* Dest, const T* Source, int32 Num)
+	{
+		const int32 NumChunks = GetNumChunks(Num);
+		ParallelFor(NumChunks, [Dest, Source, Num, NumChunks](int32 Chunk)
+		{
+			const int32 Begin = (int32)((int64)Num * Chunk / NumChunks);
+			const int32 End = (int32)((int64)Num * (Chunk + 1) / NumChunks);
+			FMemory::Memcpy((void*)(Dest + Begin), (const void*)(Source + Begin), (SIZE_T)(End - Begin) * sizeof(T));
+		});
+	}
+
+	/**
+	 * Finds how many elements of A come first in the stable merge of A and B that produce Diagonal elements.
+	 * Ties go to A, which keeps the merge stable.
+	 */
+	template <typename T, typename PredicateType>
+	int32 MergePathSplit(const T* A, int32 NumA, const T* B, int32 NumB, int32 Diagonal, const PredicateType& Predicate)
+	{
+		int32 Low = FMath::Max(0, Diagonal - NumB);
+		int32 High = FMath::Min(Diagonal, NumA);
+		while (Low < High)
+		{
+			const int32 IndexA = (Low + High) / 2;
+			const int32 IndexB = Diagonal - IndexA;
+
+			// Low < High keeps IndexA < NumA and IndexB > 0. If A[IndexA] does not sort after B[IndexB - 1] it is output
+			// before it, so the split lies further into A.
+			if (!Predicate(B[IndexB - 1], A[IndexA]))
+			{
+				Low = IndexA + 1;
+			}
+			else
+			{
+				High = IndexA;
+			}
+		}
+		return Low;
+	}
+
+	/** A piece of a merge round, independent from all the others. */
+	struct FMergeSegment
+	{
+		int32 BeginA;
+		int32 EndA;
+		int32 BeginB;
+		int32 EndB;
+		int32 BeginDest;
+	};
+
+	template <typename T, typename PredicateType>
+	void MergeSegment(const T* Source, T* Dest, const FMergeSegment& Segment, const PredicateType& Predicate)
+	{
+		int32 IndexA = Segment.BeginA;
+		int32 IndexB = Segment.BeginB;
+		T* Out = Dest + Segment.BeginDest;
+
+		while (IndexA < Segment.EndA && IndexB < Segment.EndB)
+		{
+			if (Predicate(Source[IndexB], Source[IndexA]))
+			{
+				RelocateElement(Out++, Source + IndexB++);
+			}
+			else
+			{
+				RelocateElement(Out++, Source + IndexA++);
+			}
+		}
+
+		FMemory::Memcpy((void*)Out, (const void*)(Source + IndexA), (SIZE_T)(Segment.EndA - IndexA) * sizeof(T));
+		Out += Segment.EndA - IndexA;
+		FMemory::Memcpy((void*)Out, (const void*)(Source + IndexB), (SIZE_T)(Segment.EndB - IndexB) * sizeof(T));
+	}
+
+	/**
+	 * Sorts one chunk per thread, then merges the sorted runs pairwise until one is left. Every merge round is split
+	 * along merge paths into segments of similar size, so all threads stay busy down to the last merge.
+	 */
+	template <bool bStable, typename T, typename PredicateType>
+	void ParallelMergeSort(T* Data, int32 Num, const PredicateType& Predicate)
+	{
+		const int32 NumChunks = GetNumChunks(Num);
+		if (NumChunks <= 1)
+		{
+			if constexpr (bStable)
+			{
+				AlgoImpl::StableSortInternal(Data, Num, FIdentityFunctor(), Predicate);
+			}
+			else
+			{
+				AlgoImpl::IntroSortInternal(Data, Num, FIdentityFunctor(), Predicate);
+			}
+			return;
+		}
+
+		int32 Bounds[PARALLELFOR_MAX_THREADS + 1];
+		int32 NumRuns = NumChunks;
+		for (int32 Chunk = 0; Chunk <= NumChunks; ++Chunk)
+		{
+			Bounds[Chunk] = (int32)((int64)Num * Chunk / NumChunks);
+		}
+
+		ParallelFor(NumChunks, [Data, &Bounds, &Predicate](int32 Chunk)
+		{
+			if constexpr (bStable)
+			{
+				AlgoImpl::StableSortInternal(Data + Bounds[Chunk], Bounds[Chunk + 1] - Bounds[Chunk], FIdentityFunctor(), Predicate);
+			}
+			else
+			{
+				AlgoImpl::IntroSortInternal(Data + Bounds[Chunk], Bounds[Chunk + 1] - Bounds[Chunk], FIdentityFunctor(), Predicate);
+			}
+		});
+
+		T* Buffer = (T*)FMemory::Malloc((SIZE_T)Num * sizeof(T), alignof(T));
+		T* Source = Data;
+		T* Dest = Buffer;
+
+		// Each pair of runs gets ceil(Total / SegmentSize) segments, and there is at most one left over run per round.
+		const int32 SegmentSize = FMath::Max(PARALLEL_SORT_MIN_ELEMENTS_PER_TASK, (Num + NumChunks - 1) / NumChunks);
+		FMergeSegment Segments[2 * PARALLELFOR_MAX_THREADS + 2];
+
+		while (NumRuns > 1)
+		{
+			int32 NumSegments = 0;
+			int32 NumNewRuns = 0;
+			for (int32 Run = 0; Run < NumRuns; Run += 2)
+			{
+				if (Run + 1 == NumRuns)
+				{
+					// Odd run out, carried over to the next round as it is.
+					Segments[NumSegments++] = { Bounds[Run], Bounds[Run + 1], Bounds[Run + 1], Bounds[Run + 1], Bounds[Run] };
+					Bounds[NumNewRuns++] = Bounds[Run];
+					continue;
+				}
+
+				const int32 BeginA = Bounds[Run];
+				const int32 BeginB = Bounds[Run + 1];
+				const int32 NumA = BeginB - BeginA;
+				const int32 NumB = Bounds[Run + 2] - BeginB;
+				const int32 Total = NumA + NumB;
+				const int32 NumPairSegments = (Total + SegmentSize - 1) / SegmentSize;
+
+				int32 SplitA = 0;
+				for (int32 Segment = 0; Segment < NumPairSegments; ++Segment)
+				{
+					const int32 DiagonalBegin = (int32)((int64)Total * Segment / NumPairSegments);
+					const int32 DiagonalEnd = (int32)((int64)Total * (Segment + 1) / NumPairSegments);
+					const int32 NextSplitA = Segment + 1 == NumPairSegments ? NumA : MergePathSplit(Source + BeginA, NumA, Source + BeginB, NumB, DiagonalEnd, Predicate);
+
+					Segments[NumSegments++] = { BeginA + SplitA, BeginA + NextSplitA, BeginB + DiagonalBegin - SplitA, BeginB + DiagonalEnd - NextSplitA, BeginA + DiagonalBegin };
+					SplitA = NextSplitA;
+				}
+				Bounds[NumNewRuns++] = BeginA;
+			}
+			Bounds[NumNewRuns] = Num;
+			NumRuns = NumNewRuns;
+
+			ParallelFor(NumSegments, [Source, Dest, &Segments, &Predicate](int32 Segment)
+			{
+				MergeSegment(Source, Dest, Segments[Segment], Predicate);
+			});
+
+			T* Swap = Source;
+			Source = Dest;
+			Dest = Swap;
+		}
+
+		if (Source != Data)
+		{
+			ParallelRelocate(Data, Source, Num);
+		}
+		FMemory::Free(Buffer);
+	}
+
+	/** Maps an arithmetic key to an unsigned integer with the same ordering. */
+	template <typename KeyType>
+	FORCEINLINE auto ToRadixKey(KeyType Key)
+	{
+		static_assert(std::is_arithmetic_v<KeyType>, "Radix sort keys must be integers or floating point values");
+
+		if constexpr (std::is_floating_point_v<KeyType>)
+		{
+			using FBits = std::conditional_t<sizeof(KeyType) == 4, uint32, uint64>;
+			constexpr FBits SignBit = (FBits)1 << (sizeof(FBits) * 8 - 1);
+
+			FBits Bits;
+			FMemory::Memcpy(&Bits, &Key, sizeof(Bits));
+
+			// Negative values sort in reverse, so flip all their bits; positive values only need to go above them.
+			return (Bits & SignBit) ? (FBits)~Bits : (FBits)(Bits | SignBit);
+		}
+		else
+		{
+			using FBits = std::make_unsigned_t<KeyType>;
+			if constexpr (std::is_signed_v<KeyType>)
+			{
+				return (FBits)((FBits)Key ^ ((FBits)1 << (sizeof(FBits) * 8 - 1)));
+			}
+			else
+			{
+				return (FBits)Key;
+			}
+		}
+	}
+
+	/**
+	 * Stable LSD radix sort on 8 bit digits. Every pass builds one histogram per chunk in parallel and scatters each chunk
+	 * to its own offsets, so the passes keep the order of equal keys. Passes over digits shared by all keys are skipped.
+	 */
+	template <typename T, typename ProjectionType>
+	void ParallelRadixSort(T* Data, int32 Num, ProjectionType Projection)
+	{
+		using FKey = std::decay_t<decltype(ToRadixKey(Invoke(Projection, *Data)))>;
+		constexpr int32 NumDigits = 256;
+
+		if (Num < 2)
+		{
+			return;
+		}
+
+		const int32 NumChunks = GetNumChunks(Num);
+		uint32* Counts = (uint32*)FMemory::Malloc((SIZE_T)NumChunks * NumDigits * sizeof(uint32));
+		T* Buffer = (T*)FMemory::Malloc((SIZE_T)Num * sizeof(T), alignof(T));
+		T* Source = Data;
+		T* Dest = Buffer;
+
+		auto GetChunkBegin = [Num, NumChunks](int32 Chunk)
+		{
+			return (int32)((int64)Num * Chunk / NumChunks);
+		};
+
+		for (int32 Shift = 0; Shift < (int32)sizeof(FKey) * 8; Shift += 8)
+		{
+			ParallelFor(NumChunks, [&](int32 Chunk)
+			{
+				uint32* ChunkCounts = Counts + Chunk * NumDigits;
+				FMemory::Memzero(ChunkCounts, NumDigits * sizeof(uint32));
+				for (int32 Index = GetChunkBegin(Chunk), End = GetChunkBegin(Chunk + 1); Index < End; ++Index)
+				{
+					++ChunkCounts[(ToRadixKey(Invoke(Projection, Source[Index])) >> Shift) & 0xFF];
+				}
+			});
+
+			// Turn the counts into scatter offsets: digits in order, chunks in order within a digit.
+			bool bSingleDigit = false;
+			uint32 Offset = 0;
+			for (int32 Digit = 0; Digit < NumDigits; ++Digit)
+			{
+				uint32 DigitTotal = 0;
+				for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+				{
+					const uint32 Count = Counts[Chunk * NumDigits + Digit];
+					Counts[Chunk * NumDigits + Digit] = Offset + DigitTotal;
+					DigitTotal += Count;
+				}
+				bSingleDigit |= DigitTotal == (uint32)Num;
+				Offset += DigitTotal;
+			}
+			if (bSingleDigit)
+			{
+				continue;
+			}
+
+			ParallelFor(NumChunks, [&](int32 Chunk)
+			{
+				uint32* ChunkOffsets = Counts + Chunk * NumDigits;
+				for (int32 Index = GetChunkBegin(Chunk), End = GetChunkBegin(Chunk + 1); Index < End; ++Index)
+				{
+					const uint32 Digit = (uint32)(ToRadixKey(Invoke(Projection, Source[Index])) >> Shift) & 0xFF;
+					RelocateElement(Dest + ChunkOffsets[Digit]++, Source + Index);
+				}
+			});
+
+			T* Swap = Source;
+			Source = Dest;
+			Dest = Swap;
+		}
+
+		if (Source != Data)
+		{
+			ParallelRelocate(Data, Source, Num);
+		}
+		FMemory::Free(Buffer);
+		FMemory::Free(Counts);
+	}
+
+	/** Element types sorted by value with the radix path when no predicate is given. */
+	template <typename T, bool bStable>
+	inline constexpr bool TUseRadixSort = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && (!bStable || std::is_integral_v<T>);
+}
+
+namespace Algo
+{
+	/**
+	 * Sort a range of elements using its operator<, spread over the worker threads for big ranges.
+	 * Integer and floating point ranges use a parallel radix sort. The sort is unstable.
+	 *
+	 * @param Range The range to sort.
+	 */
+	template <typename RangeType>
+	FORCEINLINE void ParallelSort(RangeType&& Range)
+	{
+		using ElementType = std::remove_pointer_t<decltype(GetData(Range))>;
+		if constexpr (AlgoImpl::ParallelSort::TUseRadixSort<std::remove_cv_t<ElementType>, false>)
+		{
+			if (GetNum(Range) >= PARALLEL_SORT_MIN_ELEMENTS)
+			{
+				AlgoImpl::ParallelSort::ParallelRadixSort(GetData(Range), (int32)GetNum(Range), [](ElementType Value) { return Value; });
+				return;
+			}
+		}
+		AlgoImpl::ParallelSort::ParallelMergeSort<false>(GetData(Range), (int32)GetNum(Range), TLess<>());
+	}
+
+	/**
+	 * Sort a range of elements using a user-defined predicate class, spread over the worker threads for big ranges.
+	 * The predicate is called concurrently from several threads. The sort is unstable.
+	 *
+	 * @param Range The range to sort.
+	 * @param Predicate A binary predicate object used to specify if one element should precede another.
+	 */
+	template <typename RangeType, typename PredicateType>
+	FORCEINLINE void ParallelSort(RangeType&& Range, PredicateType Pred)
+	{
+		AlgoImpl::ParallelSort::ParallelMergeSort<false>(GetData(Range), (int32)GetNum(Range), Pred);
+	}
+
+	/**
+	 * Stable sort a range of elements using its operator<, spread over the worker threads for big ranges.
+	 * Integer ranges use a parallel radix sort.
+	 *
+	 * @param Range The range to sort.
+	 */
+	template <typename RangeType>
+	FORCEINLINE void ParallelStableSort(RangeType&& Range)
+	{
+		using ElementType = std::remove_pointer_t<decltype(GetData(Range))>;
+		if constexpr (AlgoImpl::ParallelSort::TUseRadixSort<std::remove_cv_t<ElementType>, true>)
+		{
+			if (GetNum(Range) >= PARALLEL_SORT_MIN_ELEMENTS)
+			{
+				AlgoImpl::ParallelSort::ParallelRadixSort(GetData(Range), (int32)GetNum(Range), [](ElementType Value) { return Value; });
+				return;
+			}
+		}
+		AlgoImpl::ParallelSort::ParallelMergeSort<true>(GetData(Range), (int32)GetNum(Range), TLess<>());
+	}
+
+	/**
+	 * Stable sort a range of elements using a user-defined predicate class, spread over the worker threads for big ranges.
+	 * The predicate is called concurrently from several threads.
+	 *
+	 * @param Range The range to sort.
+	 * @param Predicate A binary predicate object used to specify if one element should precede another.
+	 */
+	template <typename RangeType, typename PredicateType>
+	FORCEINLINE void ParallelStableSort(RangeType&& Range, PredicateType Pred)
+	{
+		AlgoImpl::ParallelSort::ParallelMergeSort<true>(GetData(Range), (int32)GetNum(Range), Pred);
+	}
+
+	/**
+	 * Stable radix sort of a range by an integer or floating point key, spread over the worker threads for big ranges.
+	 * Meant for sort keys packed into an integer, e.g. draw list entries.
+	 *
+	 * @param Range The range to sort.
+	 * @param Proj The projection returning the key of an element. It is called several times per element.
+	 */
+	template <typename RangeType, typename ProjectionType>
+	FORCEINLINE void ParallelRadixSortBy(RangeType&& Range, ProjectionType Proj)
+	{
+		AlgoImpl::ParallelSort::ParallelRadixSort(GetData(Range), (int32)GetNum(Range), Proj);
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Async/TaskScheduler.h"
+
+/** Upper bound on the number of threads a single ParallelFor runs on, including the calling thread. */
+#define PARALLELFOR_MAX_THREADS 64
+
+/** Each thread takes indices in batches of the remaining work divided by its share of this many, so batches shrink towards the end. */
+#define PARALLELFOR_BATCHES_PER_THREAD 4
+
+/**
+ * @return the number of threads ParallelFor spreads work over, including the calling thread.
+ * Callers that split work into chunks themselves should use this as the chunk count.
+ */
+CORE_API int32 GetParallelForNumThreads();
+
+/**
+ * General purpose parallel for that uses the worker threads if it can.
+ * Body is called once for every index in [0, Num), in no particular order, and the call returns once all of them are done.
+ * The calling thread works too, alongside tasks on the shared scheduler. Indices are handed out in batches that start
+ * large and go down to single indices, so cheap bodies do not contend on the counter and uneven ones still balance.
+ * Can be called from a task, the wait helps with the queued tasks.
+ *
+ * @param Num Number of calls of Body; Body(0), Body(1)....Body(Num - 1)
+ * @param Body Function to call from multiple threads
+ * @param bForceSingleThread Mostly used for testing, if true, run single threaded instead.
+ */
+CORE_API void ParallelFor(int32 Num, TFunctionRef<void(int32)> Body, bool bForceSingleThread = false);
+
+/**
+ * Launches a ParallelFor as a task that starts once every prerequisite completed, and completes once every call of
+ * Body returned.
+ */
+CORE_API FTask LaunchParallelFor(int32 Num, TFunction<void(int32)> Body, TArrayView<const FTask> Prerequisites = TArrayView<const FTask>(), ETaskPriority Priority = ETaskPriority::Normal);
@@ -0,0 +1,91 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Containers/ArrayView.h"
+#include "Templates/Function.h"
+
+/** Upper bound on the number of worker threads of the scheduler. */
+#define TASK_SCHEDULER_MAX_WORKERS 64
+
+/** Capacity of the queues tasks launched outside of the workers go through. Launching into a full queue helps until there is room. */
+#define TASK_SCHEDULER_QUEUE_CAPACITY 65536
+
+namespace UE::Tasks::Private
+{
+	class FTaskBase;
+	struct FTaskHandleAccess;
+}
+
+enum class ETaskPriority : uint8
+{
+	Normal,
+
+	/** Runs before any normal task that has not started, wherever it was launched. */
+	High,
+};
+
+/**
+ * Handle to a task launched with LaunchTask, shared by reference counting. The task stays alive while it is queued or
+ * running, handles only need to be kept to wait for it or to depend on it.
+ */
+class FTask
+{
+public:
+	FTask() = default;
+	CORE_API FTask(const FTask& Other);
+	CORE_API FTask(FTask&& Other);
+	CORE_API FTask& operator=(const FTask& Other);
+	CORE_API FTask& operator=(FTask&& Other);
+	CORE_API ~FTask();
+
+	bool IsValid() const
+	{
+		return Task != nullptr;
+	}
+
+	/** @return true once the body returned, and for handles that do not refer to a task */
+	CORE_API bool IsCompleted() const;
+
+	/**
+	 * Returns once the task completed. Runs other queued tasks in the meantime, so tasks can wait on the tasks they
+	 * launched without tying up a worker, and only blocks once there is nothing left to help with.
+	 */
+	CORE_API void Wait() const;
+
+	static void WaitAll(TArrayView<const FTask> Tasks)
+	{
+		for (const FTask& Task : Tasks)
+		{
+			Task.Wait();
+		}
+	}
+
+private:
+	friend struct UE::Tasks::Private::FTaskHandleAccess;
+
+	explicit FTask(UE::Tasks::Private::FTaskBase* InTask)
+		: Task(InTask)
+	{
+	}
+
+	UE::Tasks::Private::FTaskBase* Task = nullptr;
+};
+
+/**
+ * Runs Body on the shared task scheduler once every prerequisite completed.
+ *
+ * The scheduler has one worker per core but the first, each with a work stealing deque: tasks launched from a worker go
+ * to the bottom of its own deque and run newest first, while idle workers steal the oldest from the others. Tasks
+ * launched from any other thread, and high priority tasks, go through lock-free queues. A worker looking for a task
+ * checks the high priority queue, then its own deque, then the normal queue, and only then steals from the others.
+ * Workers sleep when there is nothing to run or steal. They set up their TLS allocator caches when they start.
+ *
+ * Tasks must not block on anything but other tasks, use a dedicated thread for I/O.
+ */
+CORE_API FTask LaunchTask(TFunction<void()> Body, TArrayView<const FTask> Prerequisites = TArrayView<const FTask>(), ETaskPriority Priority = ETaskPriority::Normal);
+
+/** @return the number of worker threads of the scheduler, not counting the threads that wait on tasks and help */
+CORE_API int32 GetNumTaskWorkers();
+
+/** @return true on the worker threads of the scheduler */
+CORE_API bool IsInTaskWorkerThread();
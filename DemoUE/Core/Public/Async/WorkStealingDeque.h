@@ -0,0 +1,156 @@
+#pragma once
+#include <atomic>
+#include <type_traits>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/UnrealMemory.h"
+
+/**
+ * Chase-Lev work stealing deque. One owner thread pushes and pops at the bottom, newest first, while any number of
+ * thieves steal from the top, oldest first. The owner only synchronizes with thieves when they race for the last item.
+ *
+ * The ring grows when full. Rings it outgrew are kept until the deque is destroyed, a thief that loaded one just
+ * before the swap may still read from it. ElementType must be trivially copyable, usually a pointer.
+ */
+template <typename ElementType>
+class TWorkStealingDeque
+{
+	static_assert(std::is_trivially_copyable_v<ElementType>, "TWorkStealingDeque elements are copied around racily, they must be trivially copyable");
+
+public:
+	/** @param InitialCapacity rounded up to a power of two */
+	explicit TWorkStealingDeque(int64 InitialCapacity = 256)
+	{
+		int64 Capacity = 2;
+		while (Capacity < InitialCapacity)
+		{
+			Capacity *= 2;
+		}
+		Ring.store(FRing::Allocate(Capacity, nullptr), std::memory_order_relaxed);
+	}
+
+	~TWorkStealingDeque()
+	{
+		FRing* Current = Ring.load(std::memory_order_relaxed);
+		while (Current)
+		{
+			FRing* Previous = Current->Previous;
+			FMemory::Free(Current);
+			Current = Previous;
+		}
+	}
+
+	TWorkStealingDeque(const TWorkStealingDeque&) = delete;
+	TWorkStealingDeque& operator=(const TWorkStealingDeque&) = delete;
+
+	/** Owner only. */
+	void Push(ElementType Item)
+	{
+		const int64 CurrentBottom = Bottom.load(std::memory_order_relaxed);
+		const int64 CurrentTop = Top.load(std::memory_order_acquire);
+		FRing* CurrentRing = Ring.load(std::memory_order_relaxed);
+		if (CurrentBottom - CurrentTop > CurrentRing->Mask)
+		{
+			CurrentRing = CurrentRing->Grow(CurrentTop, CurrentBottom);
+			Ring.store(CurrentRing, std::memory_order_release);
+		}
+		CurrentRing->Put(CurrentBottom, Item);
+
+		// Publishes the item to the thieves that acquire Bottom.
+		Bottom.store(CurrentBottom + 1, std::memory_order_release);
+	}
+
+	/** Owner only, takes the newest item. */
+	bool Pop(ElementType& OutItem)
+	{
+		const int64 NewBottom = Bottom.load(std::memory_order_relaxed) - 1;
+		FRing* CurrentRing = Ring.load(std::memory_order_relaxed);
+		Bottom.store(NewBottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64 CurrentTop = Top.load(std::memory_order_relaxed);
+
+		if (CurrentTop > NewBottom)
+		{
+			// Empty.
+			Bottom.store(NewBottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		OutItem = CurrentRing->Get(NewBottom);
+		if (CurrentTop == NewBottom)
+		{
+			// The last item, a thief may be taking it too.
+			const bool bWon = Top.compare_exchange_strong(CurrentTop, CurrentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			Bottom.store(NewBottom + 1, std::memory_order_relaxed);
+			return bWon;
+		}
+		return true;
+	}
+
+	/** Any thread, takes the oldest item. Fails when empty or when it lost a race, callers move on to another deque. */
+	bool Steal(ElementType& OutItem)
+	{
+		int64 CurrentTop = Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64 CurrentBottom = Bottom.load(std::memory_order_acquire);
+		if (CurrentTop >= CurrentBottom)
+		{
+			return false;
+		}
+
+		const ElementType Item = Ring.load(std::memory_order_acquire)->Get(CurrentTop);
+		if (!Top.compare_exchange_strong(CurrentTop, CurrentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return false;
+		}
+		OutItem = Item;
+		return true;
+	}
+
+	/** Only a hint unless called by the owner while nobody steals. */
+	bool IsEmpty() const
+	{
+		return Top.load(std::memory_order_relaxed) >= Bottom.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct FRing
+	{
+		int64 Mask;
+		FRing* Previous;
+		std::atomic<ElementType> Items[1];
+
+		static FRing* Allocate(int64 Capacity, FRing* InPrevious)
+		{
+			FRing* Result = (FRing*)FMemory::Malloc(sizeof(FRing) + (Capacity - 1) * sizeof(std::atomic<ElementType>), alignof(FRing));
+			Result->Mask = Capacity - 1;
+			Result->Previous = InPrevious;
+			return Result;
+		}
+
+		FORCEINLINE ElementType Get(int64 Index) const
+		{
+			return Items[Index & Mask].load(std::memory_order_relaxed);
+		}
+
+		FORCEINLINE void Put(int64 Index, ElementType Item)
+		{
+			Items[Index & Mask].store(Item, std::memory_order_relaxed);
+		}
+
+		FRing* Grow(int64 InTop, int64 InBottom)
+		{
+			FRing* NewRing = Allocate((Mask + 1) * 2, this);
+			for (int64 Index = InTop; Index < InBottom; ++Index)
+			{
+				NewRing->Put(Index, Get(Index));
+			}
+			return NewRing;
+		}
+	};
+
+	/** Thieves and the owner on separate lines. */
+	alignas(64) std::atomic<int64> Top{ 0 };
+	alignas(64) std::atomic<int64> Bottom{ 0 };
+	std::atomic<FRing*> Ring{ nullptr };
+};
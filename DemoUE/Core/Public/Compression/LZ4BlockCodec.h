@@ -0,0 +1,30 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+
+/**
+ * Self contained codec for the LZ4 block format (no frame header, no checksum).
+ *
+ * Output can be decoded by any LZ4 block decoder and vice versa. The compressor is the single pass greedy matcher of
+ * the reference fast mode: it favours speed over ratio, which suits data that is decompressed on every load.
+ */
+namespace UE::Compression::LZ4Block
+{
+	/** @return the size of the buffer Compress needs so that it never fails, for SourceSize input bytes */
+	CORE_API int64 GetMaxCompressedSize(int64 SourceSize);
+
+	/**
+	 * Compresses SourceSize bytes into Dest.
+	 *
+	 * @return the compressed size, or 0 if it would not fit in DestCapacity bytes
+	 */
+	CORE_API int64 Compress(const void* Source, int64 SourceSize, void* Dest, int64 DestCapacity);
+
+	/**
+	 * Decompresses a block that decodes to exactly DestSize bytes. Malformed input is detected and never read or
+	 * written out of bounds.
+	 *
+	 * @return true if the whole block decoded to exactly DestSize bytes
+	 */
+	CORE_API bool Decompress(const void* Source, int64 SourceSize, void* Dest, int64 DestSize);
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "Templates/MakeUnsigned.h"
 #include "Misc/CoreMiscDefines.h"
+#include "Containers/VectorSearch.h"
+#include "Algo/ParallelSort.h"
+#include "Serialization/AsyncBulkSerialize.h"
 /**
  * Templated dynamic array
  *
@@ -604,6 +607,11 @@ public:
 	 */
 	SizeType Find(const ElementType& Item) const
 	{
+		if constexpr (UE::Core::Private::VectorSearch::TIsVectorSearchable<ElementType>)
+		{
+			return static_cast<SizeType>(UE::Core::Private::VectorSearch::FindFirst(GetData(), ArrayNum, Item));
+		}
+
 		const ElementType* RESTRICT Start = GetData();
 		for (const ElementType* RESTRICT Data = Start, *RESTRICT DataEnd = Data + ArrayNum; Data != DataEnd; ++Data)
 		{
@@ -637,6 +645,11 @@ public:
 	 */
 	SizeType FindLast(const ElementType& Item) const
 	{
+		if constexpr (UE::Core::Private::VectorSearch::TIsVectorSearchable<ElementType>)
+		{
+			return static_cast<SizeType>(UE::Core::Private::VectorSearch::FindLast(GetData(), ArrayNum, Item));
+		}
+
 		for (const ElementType* RESTRICT Start = GetData(), *RESTRICT Data = Start + ArrayNum; Data != Start; )
 		{
 			--Data;
@@ -692,6 +705,11 @@ public:
 	template <typename KeyType>
 	SizeType IndexOfByKey(const KeyType& Key) const
 	{
+		if constexpr (UE::Core::Private::VectorSearch::TCanVectorSearch<ElementType, KeyType>)
+		{
+			return static_cast<SizeType>(UE::Core::Private::VectorSearch::FindFirst(GetData(), ArrayNum, Key));
+		}
+
 		const ElementType* RESTRICT Start = GetData();
 		for (const ElementType* RESTRICT Data = Start, *RESTRICT DataEnd = Start + ArrayNum; Data != DataEnd; ++Data)
 		{
@@ -823,6 +841,11 @@ public:
 	template <typename ComparisonType>
 	bool Contains(const ComparisonType& Item) const
 	{
+		if constexpr (UE::Core::Private::VectorSearch::TCanVectorSearch<ElementType, ComparisonType>)
+		{
+			return UE::Core::Private::VectorSearch::FindFirst(GetData(), ArrayNum, Item) != INDEX_NONE;
+		}
+
 		for (const ElementType* RESTRICT Data = GetData(), *RESTRICT DataEnd = Data + ArrayNum; Data != DataEnd; ++Data)
 		{
 			if (*Data == Item)
@@ -856,6 +879,11 @@ public:
 	{
 		SizeType Count = Num();
 
+		if constexpr (UE::Core::Private::VectorSearch::TIsVectorSearchable<ElementType>)
+		{
+			return Count == OtherArray.Num() && UE::Core::Private::VectorSearch::Equals(GetData(), OtherArray.GetData(), Count);
+		}
+
 		return Count == OtherArray.Num() && CompareItems(GetData(), OtherArray.GetData(), Count);
 	}
 
@@ -909,7 +937,7 @@ public:
 			|| (Ar.IsSaving()			// if we are saving, we always do the ordinary serialize as a way to make sure it matches up with bulk serialization
 				&& !Ar.IsCooking()			// but cooking and transacting is performance critical, so we skip that
 				&& !Ar.IsTransacting())
-			|| Ar.IsByteSwapping()		// if we are byteswapping, we need to do that per-element
+			|| (Ar.IsByteSwapping() && !TIsArithmetic<ElementType>::Value)		// if we are byteswapping, we need to do that per-element, except for numbers which are swapped as a block
 			)
 		{
 			Ar << *this;
@@ -938,17 +966,64 @@ public:
 				}
 				Empty(NewArrayNum);
 				AddUninitialized(NewArrayNum);
-				Ar.Serialize(GetData(), (int64)NewArrayNum * (int64)ElementSize);
+
+				// Archives loading from memory, e.g. a mapped file, hand out the bytes directly and skip the virtual Serialize.
+				Ar.ByteOrderSerializeArray(GetData(), ElementSize, NewArrayNum);
 			}
 			else if (Ar.IsSaving())
 			{
 				SizeType ArrayCount = Num();
 				Ar << ArrayCount;
-				Ar.Serialize(GetData(), (int64)ArrayCount * (int64)ElementSize);
+				Ar.ByteOrderSerializeArray(GetData(), ElementSize, ArrayCount);
 			}
 		}
 	}
 
+	/**
+	 * Loading variant of BulkSerialize that reads the elements on the I/O thread, with the same format and restrictions.
+	 *
+	 * The array is sized right away and the archive position moves past the elements, so the caller can keep
+	 * deserializing the fields that follow. Elements must not be accessed until the returned handle completes, or until
+	 * WaitForBytes covers them for arrays above GAsyncBulkSerializePipelineWatermark bytes, which are read in chunks.
+	 * The array must not be resized and the archive must stay alive while the read is in flight.
+	 *
+	 * Archives that cannot read at an offset, as well as saving and byte swapping archives, are serialized
+	 * synchronously and return a completed handle.
+	 *
+	 * @param Ar	FArchive to bulk serialize this TArray from
+	 * @return the completion handle of the read
+	 */
+	[[nodiscard]] FAsyncBulkReadHandle BulkSerializeAsync(FArchive& Ar)
+	{
+		if (!Ar.IsLoading() || Ar.IsByteSwapping())
+		{
+			BulkSerialize(Ar);
+			return FAsyncBulkReadHandle(!Ar.IsError());
+		}
+
+		constexpr int32 ElementSize = sizeof(ElementType);
+		int32 SerializedElementSize = ElementSize;
+		Ar << SerializedElementSize;
+
+		CountBytes(Ar);
+		if (!ensure(SerializedElementSize == ElementSize))
+		{
+			Ar.SetError();
+			return FAsyncBulkReadHandle(false);
+		}
+
+		SizeType NewArrayNum = 0;
+		Ar << NewArrayNum;
+		if (!ensure(NewArrayNum >= 0 && std::numeric_limits<SizeType>::max() / (SizeType)ElementSize >= NewArrayNum))
+		{
+			Ar.SetError();
+			return FAsyncBulkReadHandle(false);
+		}
+		Empty(NewArrayNum);
+		AddUninitialized(NewArrayNum);
+		return IssueAsyncBulkRead(Ar, GetData(), (int64)NewArrayNum * (int64)ElementSize);
+	}
+
 	/**
 	 * Count bytes needed to serialize this array.
 	 *
@@ -2548,6 +2623,85 @@ public:
 		Algo::StableSort(*this, PredicateWrapper);
 	}
 
+	/**
+	 * Sorts the array assuming < operator is defined for the item type, splitting the work over several threads
+	 * once the array holds at least PARALLEL_SORT_MIN_ELEMENTS elements. Arrays of integers and floating point
+	 * values are radix sorted.
+	 *
+	 * @note: If your array contains raw pointers, they will be automatically dereferenced during sorting.
+	 *        Therefore, your array will be sorted by the values being pointed to, rather than the pointers' values.
+	 *        If this is not desirable, please use Algo::ParallelSort(MyArray) directly instead.
+	 *        The auto-dereferencing behavior does not occur with smart pointers.
+	 */
+	void ParallelSort()
+	{
+		if constexpr (std::is_pointer_v<ElementType>)
+		{
+			Algo::ParallelSort(*this, TDereferenceWrapper<ElementType, TLess<>>(TLess<>()));
+		}
+		else
+		{
+			Algo::ParallelSort(*this);
+		}
+	}
+
+	/**
+	 * Sorts the array using user define predicate class, splitting the work over several threads
+	 * once the array holds at least PARALLEL_SORT_MIN_ELEMENTS elements.
+	 *
+	 * @param Predicate Predicate class instance. It is called concurrently from several threads.
+	 *
+	 * @note: If your array contains raw pointers, they will be automatically dereferenced during sorting.
+	 *        Therefore, your predicate will be passed references rather than pointers.
+	 *        If this is not desirable, please use Algo::ParallelSort(MyArray, Predicate) directly instead.
+	 *        The auto-dereferencing behavior does not occur with smart pointers.
+	 */
+	template <class PREDICATE_CLASS>
+	void ParallelSort(const PREDICATE_CLASS& Predicate)
+	{
+		TDereferenceWrapper<ElementType, PREDICATE_CLASS> PredicateWrapper(Predicate);
+		Algo::ParallelSort(*this, PredicateWrapper);
+	}
+
+	/**
+	 * Stable sorts the array assuming < operator is defined for the item type, splitting the work over several threads
+	 * once the array holds at least PARALLEL_SORT_MIN_ELEMENTS elements. Arrays of integers are radix sorted.
+	 *
+	 * @note: If your array contains raw pointers, they will be automatically dereferenced during sorting.
+	 *        Therefore, your array will be sorted by the values being pointed to, rather than the pointers' values.
+	 *        If this is not desirable, please use Algo::ParallelStableSort(MyArray) directly instead.
+	 *        The auto-dereferencing behavior does not occur with smart pointers.
+	 */
+	void ParallelStableSort()
+	{
+		if constexpr (std::is_pointer_v<ElementType>)
+		{
+			Algo::ParallelStableSort(*this, TDereferenceWrapper<ElementType, TLess<>>(TLess<>()));
+		}
+		else
+		{
+			Algo::ParallelStableSort(*this);
+		}
+	}
+
+	/**
+	 * Stable sorts the array using user defined predicate class, splitting the work over several threads
+	 * once the array holds at least PARALLEL_SORT_MIN_ELEMENTS elements.
+	 *
+	 * @param Predicate Predicate class instance. It is called concurrently from several threads.
+	 *
+	 * @note: If your array contains raw pointers, they will be automatically dereferenced during sorting.
+	 *        Therefore, your predicate will be passed references rather than pointers.
+	 *        If this is not desirable, please use Algo::ParallelStableSort(MyArray, Predicate) directly instead.
+	 *        The auto-dereferencing behavior does not occur with smart pointers.
+	 */
+	template <class PREDICATE_CLASS>
+	void ParallelStableSort(const PREDICATE_CLASS& Predicate)
+	{
+		TDereferenceWrapper<ElementType, PREDICATE_CLASS> PredicateWrapper(Predicate);
+		Algo::ParallelStableSort(*this, PredicateWrapper);
+	}
+
 #if defined(_MSC_VER) && !defined(__clang__)	// Relies on MSVC-specific lazy template instantiation to support arrays of incomplete types
 private:
 	/**
@@ -3207,11 +3361,25 @@ struct TArrayPrivateFriend
 					Ar << A.AddDefaulted_GetRef();
 				}
 			}
+			else if (const uint8* View = Ar.IsLoading() ? Ar.FastPathLoadView((int64)A.Num() * sizeof(ElementType)) : nullptr)
+			{
+				FMemory::Memcpy(A.GetData(), View, (int64)A.Num() * sizeof(ElementType));
+			}
 			else
 			{
 				Ar.Serialize(A.GetData(), A.Num() * sizeof(ElementType));
 			}
 		}
+		else if constexpr (TIsArithmetic<ElementType>::Value)
+		{
+			// Numbers only need their byte order fixed, which is done for the whole array at once instead of per element.
+			A.ArrayNum = SerializeNum;
+			if ((A.ArrayNum || A.ArrayMax) && Ar.IsLoading())
+			{
+				A.ResizeForCopy(A.ArrayNum, A.ArrayMax);
+			}
+			Ar.ByteOrderSerializeArray(A.GetData(), sizeof(ElementType), A.Num());
+		}
 		else if (Ar.IsLoading())
 		{
 			// Required for resetting ArrayNum
@@ -0,0 +1,140 @@
+#pragma once
+#include <atomic>
+#include <new>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/UnrealMemory.h"
+#include "Templates/UnrealTemplate.h"
+
+/**
+ * Fixed capacity FIFO queue any number of threads can enqueue to and dequeue from at once, without locking.
+ *
+ * Every cell carries a sequence number that tells whether it is ready for the enqueue or the dequeue of the current lap
+ * around the ring, so producers and consumers only contend on their own counter, with one compare exchange per
+ * operation. A full queue fails TryEnqueue rather than growing: callers decide whether to wait, help or drop.
+ *
+ * ElementType must be default constructible and movable. Elements still queued are destroyed with the queue.
+ */
+template <typename ElementType>
+class TBoundedMPMCQueue
+{
+public:
+	/** @param InCapacity rounded up to a power of two, at least 2 */
+	explicit TBoundedMPMCQueue(uint32 InCapacity)
+	{
+		uint32 Capacity = 2;
+		while (Capacity < InCapacity)
+		{
+			Capacity *= 2;
+		}
+		Mask = Capacity - 1;
+
+		Cells = (FCell*)FMemory::Malloc(sizeof(FCell) * Capacity, alignof(FCell));
+		for (uint32 Index = 0; Index < Capacity; ++Index)
+		{
+			new (&Cells[Index]) FCell();
+			Cells[Index].Sequence.store(Index, std::memory_order_relaxed);
+		}
+	}
+
+	~TBoundedMPMCQueue()
+	{
+		for (uint64 Index = 0; Index <= Mask; ++Index)
+		{
+			Cells[Index].~FCell();
+		}
+		FMemory::Free(Cells);
+	}
+
+	TBoundedMPMCQueue(const TBoundedMPMCQueue&) = delete;
+	TBoundedMPMCQueue& operator=(const TBoundedMPMCQueue&) = delete;
+
+	/** @return false if the queue is full, Item is left untouched then */
+	bool TryEnqueue(ElementType&& Item)
+	{
+		uint64 Position = EnqueuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			FCell& Cell = Cells[Position & Mask];
+			const uint64 Sequence = Cell.Sequence.load(std::memory_order_acquire);
+			const int64 Lap = (int64)(Sequence - Position);
+			if (Lap == 0)
+			{
+				if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					Cell.Item = MoveTemp(Item);
+					Cell.Sequence.store(Position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (Lap < 0)
+			{
+				// The cell still holds the item of the previous lap.
+				return false;
+			}
+			else
+			{
+				Position = EnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool TryEnqueue(const ElementType& Item)
+	{
+		ElementType Copy(Item);
+		return TryEnqueue(MoveTemp(Copy));
+	}
+
+	/** @return false if the queue is empty */
+	bool TryDequeue(ElementType& OutItem)
+	{
+		uint64 Position = DequeuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			FCell& Cell = Cells[Position & Mask];
+			const uint64 Sequence = Cell.Sequence.load(std::memory_order_acquire);
+			const int64 Lap = (int64)(Sequence - (Position + 1));
+			if (Lap == 0)
+			{
+				if (DequeuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					OutItem = MoveTemp(Cell.Item);
+					Cell.Sequence.store(Position + Mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (Lap < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Position = DequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/** Only a hint while other threads use the queue. */
+	bool IsEmpty() const
+	{
+		return DequeuePosition.load(std::memory_order_relaxed) >= EnqueuePosition.load(std::memory_order_relaxed);
+	}
+
+	uint32 GetCapacity() const
+	{
+		return (uint32)(Mask + 1);
+	}
+
+private:
+	struct FCell
+	{
+		std::atomic<uint64> Sequence;
+		ElementType Item;
+	};
+
+	/** The two positions on lines of their own, producers and consumers do not share a line. */
+	alignas(64) std::atomic<uint64> EnqueuePosition{ 0 };
+	alignas(64) std::atomic<uint64> DequeuePosition{ 0 };
+	alignas(64) FCell* Cells;
+	uint64 Mask;
+};
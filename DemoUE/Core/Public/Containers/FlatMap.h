@@ -0,0 +1,1174 @@
+#pragma once
+#include "CoreTypes.h"
+#include "HAL/UnrealMemory.h"
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define FLATMAP_USE_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define FLATMAP_USE_NEON 1
+	#include <arm_neon.h>
+#endif
+
+#ifndef FLATMAP_USE_SSE2
+	#define FLATMAP_USE_SSE2 0
+#endif
+#ifndef FLATMAP_USE_NEON
+	#define FLATMAP_USE_NEON 0
+#endif
+
+namespace UE::Core::FlatMap::Private
+{
+	/** Number of control bytes probed at once. The table capacity is always a power of two multiple of this. */
+	static constexpr int32 GroupWidth = 16;
+
+	/** Control byte values. A full slot stores the low 7 bits of its hash (H2), so the high bit tells free from used. */
+	enum : uint8
+	{
+		CtrlEmpty	= 0x80,
+		CtrlDeleted	= 0xFE,
+	};
+
+	/** Spreads the 32 bit key hash, since GetTypeHash is often the identity for integers. */
+	FORCEINLINE uint64 MixHash(uint32 KeyHash)
+	{
+		return (uint64)KeyHash * 0x9E3779B97F4A7C15ull;
+	}
+
+	/** Selects the first group to probe. */
+	FORCEINLINE uint32 GetH1(uint64 Mixed)
+	{
+		return (uint32)(Mixed >> 32);
+	}
+
+	/** Tag stored in the control byte, compared before touching the key. */
+	FORCEINLINE uint8 GetH2(uint64 Mixed)
+	{
+		return (uint8)(Mixed >> 25) & 0x7F;
+	}
+
+	/** Set of matching slots in a group, iterated from the lowest slot up. */
+	struct FGroupMask
+	{
+#if FLATMAP_USE_NEON
+		/** NEON masks carry one bit per nibble. */
+		static constexpr uint32 Shift = 2;
+#else
+		static constexpr uint32 Shift = 0;
+#endif
+
+		uint64 Bits;
+
+		FORCEINLINE explicit operator bool() const
+		{
+			return Bits != 0;
+		}
+
+		FORCEINLINE int32 LowestSlot() const
+		{
+			return (int32)(FMath::CountTrailingZeros64(Bits) >> Shift);
+		}
+
+		FORCEINLINE void ClearLowest()
+		{
+			Bits &= Bits - 1;
+		}
+	};
+
+	/** One group of control bytes loaded into a vector register. */
+	struct FGroup
+	{
+#if FLATMAP_USE_SSE2
+		__m128i Ctrl;
+
+		FORCEINLINE explicit FGroup(const uint8* InCtrl)
+			: Ctrl(_mm_load_si128((const __m128i*)InCtrl))
+		{
+		}
+
+		FORCEINLINE FGroupMask Match(uint8 H2) const
+		{
+			return { (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)H2), Ctrl)) };
+		}
+
+		FORCEINLINE FGroupMask MatchEmptyOrDeleted() const
+		{
+			return { (uint32)_mm_movemask_epi8(Ctrl) };
+		}
+#elif FLATMAP_USE_NEON
+		uint8x16_t Ctrl;
+
+		FORCEINLINE explicit FGroup(const uint8* InCtrl)
+			: Ctrl(vld1q_u8(InCtrl))
+		{
+		}
+
+		FORCEINLINE static FGroupMask ToMask(uint8x16_t Compare)
+		{
+			// Narrow every byte to a nibble, then keep a single bit per nibble so ClearLowest steps one slot at a time.
+			const uint64 Nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(Compare), 4)), 0);
+			return { Nibbles & 0x8888888888888888ull };
+		}
+
+		FORCEINLINE FGroupMask Match(uint8 H2) const
+		{
+			return ToMask(vceqq_u8(Ctrl, vdupq_n_u8(H2)));
+		}
+
+		FORCEINLINE FGroupMask MatchEmptyOrDeleted() const
+		{
+			return ToMask(vcltq_s8(vreinterpretq_s8_u8(Ctrl), vdupq_n_s8(0)));
+		}
+#else
+		const uint8* Ctrl;
+
+		FORCEINLINE explicit FGroup(const uint8* InCtrl)
+			: Ctrl(InCtrl)
+		{
+		}
+
+		FORCEINLINE FGroupMask Match(uint8 H2) const
+		{
+			uint64 Bits = 0;
+			for (int32 Slot = 0; Slot < GroupWidth; ++Slot)
+			{
+				Bits |= (uint64)(Ctrl[Slot] == H2) << Slot;
+			}
+			return { Bits };
+		}
+
+		FORCEINLINE FGroupMask MatchEmptyOrDeleted() const
+		{
+			uint64 Bits = 0;
+			for (int32 Slot = 0; Slot < GroupWidth; ++Slot)
+			{
+				Bits |= (uint64)(Ctrl[Slot] >> 7) << Slot;
+			}
+			return { Bits };
+		}
+#endif
+
+		FORCEINLINE FGroupMask MatchEmpty() const
+		{
+			return Match(CtrlEmpty);
+		}
+	};
+}
+
+/**
+ * Hash map with the TMap interface, built as an open-addressing table.
+ *
+ * The key-value pairs live densely packed in a single array, in insertion order. A separate table maps hashes to
+ * indices in that array: every slot has a control byte holding 7 bits of the hash, and lookups compare 16 control bytes
+ * at once with SSE2 or NEON before touching any key. A Find therefore usually costs one control group load plus the
+ * matching pair, instead of the bucket, hash chain and sparse array hops of TMap.
+ *
+ * Removal moves the last pair into the hole, so removing invalidates pointers to the last pair and changes iteration
+ * order. KeySort/ValueSort reorder the pair array and rebuild the table.
+ */
+template <typename InKeyType, typename InValueType, typename KeyFuncs = TDefaultMapHashableKeyFuncs<InKeyType, InValueType, false>>
+class TFlatMap
+{
+	static_assert(!KeyFuncs::bAllowDuplicateKeys, "TFlatMap cannot be instantiated with a KeyFuncs which allows duplicate keys");
+
+public:
+	typedef InKeyType KeyType;
+	typedef InValueType ValueType;
+	typedef KeyFuncs KeyFuncsType;
+
+	typedef typename TTypeTraits<KeyType  >::ConstPointerType KeyConstPointerType;
+	typedef typename TTypeTraits<KeyType  >::ConstInitType    KeyInitType;
+	typedef typename TTypeTraits<ValueType>::ConstInitType    ValueInitType;
+	typedef TPair<KeyType, ValueType> ElementType;
+
+	TFlatMap() = default;
+
+	TFlatMap(TFlatMap&& Other)
+		: Pairs(MoveTemp(Other.Pairs))
+		, Ctrl(Other.Ctrl)
+		, Slots(Other.Slots)
+		, Capacity(Other.Capacity)
+		, NumTombstones(Other.NumTombstones)
+	{
+		Other.Ctrl = nullptr;
+		Other.Slots = nullptr;
+		Other.Capacity = 0;
+		Other.NumTombstones = 0;
+	}
+
+	TFlatMap(const TFlatMap& Other)
+		: Pairs(Other.Pairs)
+	{
+		CopyTable(Other);
+	}
+
+	TFlatMap& operator=(TFlatMap&& Other)
+	{
+		if (this != &Other)
+		{
+			FreeTable();
+			Pairs = MoveTemp(Other.Pairs);
+			Ctrl = Other.Ctrl;
+			Slots = Other.Slots;
+			Capacity = Other.Capacity;
+			NumTombstones = Other.NumTombstones;
+			Other.Ctrl = nullptr;
+			Other.Slots = nullptr;
+			Other.Capacity = 0;
+			Other.NumTombstones = 0;
+		}
+		return *this;
+	}
+
+	TFlatMap& operator=(const TFlatMap& Other)
+	{
+		if (this != &Other)
+		{
+			FreeTable();
+			Pairs = Other.Pairs;
+			CopyTable(Other);
+		}
+		return *this;
+	}
+
+	~TFlatMap()
+	{
+		FreeTable();
+	}
+
+	/**
+	 * Compare this map with another for equality. Does not make any assumptions about Key order.
+	 * NOTE: this might be a candidate for operator== but it was decided to make it an explicit function
+	 *  since it can potentially be quite slow.
+	 *
+	 * @param Other The other map to compare against
+	 * @returns True if both this and Other contain the same keys with values that compare ==
+	 */
+	bool OrderIndependentCompareEqual(const TFlatMap& Other) const
+	{
+		if (Num() != Other.Num())
+		{
+			return false;
+		}
+
+		for (const ElementType& Pair : Pairs)
+		{
+			const ValueType* OtherValue = Other.Find(Pair.Key);
+			if (!OtherValue || !(*OtherValue == Pair.Value))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Removes all elements from the map.
+	 *
+	 * This method potentially leaves space allocated for an expected
+	 * number of elements about to be added.
+	 *
+	 * @param ExpectedNumElements The number of elements about to be added to the set.
+	 */
+	void Empty(int32 ExpectedNumElements = 0)
+	{
+		Pairs.Empty(ExpectedNumElements);
+		FreeTable();
+		if (ExpectedNumElements)
+		{
+			Rehash(GetCapacityFor(ExpectedNumElements));
+		}
+	}
+
+	/** Efficiently empties out the map but preserves all allocations and capacities */
+	void Reset()
+	{
+		Pairs.Reset();
+		if (Capacity)
+		{
+			FMemory::Memset(Ctrl, UE::Core::FlatMap::Private::CtrlEmpty, Capacity);
+		}
+		NumTombstones = 0;
+	}
+
+	/** Shrinks the pair set to avoid slack. */
+	void Shrink()
+	{
+		Pairs.Shrink();
+		const int32 NewCapacity = Pairs.Num() ? GetCapacityFor(Pairs.Num()) : 0;
+		if (NewCapacity != Capacity)
+		{
+			Rehash(NewCapacity);
+		}
+	}
+
+	/** The pairs are always stored without holes, so compacting is a no-op kept for TMap parity. */
+	FORCEINLINE void Compact()
+	{
+	}
+
+	/** The pairs are always stored without holes, so compacting is a no-op kept for TMap parity. */
+	FORCEINLINE void CompactStable()
+	{
+	}
+
+	/** Preallocates enough memory to contain Number elements */
+	void Reserve(int32 Number)
+	{
+		Pairs.Reserve(Number);
+		if (Number > GetMaxLoad(Capacity))
+		{
+			Rehash(GetCapacityFor(Number));
+		}
+	}
+
+	/**
+	 * Returns true if the map is empty and contains no elements.
+	 *
+	 * @returns True if the map is empty.
+	 * @see Num
+	 */
+	bool IsEmpty() const
+	{
+		return Pairs.IsEmpty();
+	}
+
+	/** @return The number of elements in the map. */
+	FORCEINLINE int32 Num() const
+	{
+		return Pairs.Num();
+	}
+
+	/**
+	 * Get the unique keys contained within this map.
+	 *
+	 * @param OutKeys Upon return, contains the set of unique keys in this map.
+	 * @return The number of unique keys in the map.
+	 */
+	template<typename Allocator> int32 GetKeys(TArray<KeyType, Allocator>& OutKeys) const
+	{
+		OutKeys.Reset(Pairs.Num());
+		for (const ElementType& Pair : Pairs)
+		{
+			OutKeys.Add(Pair.Key);
+		}
+		return OutKeys.Num();
+	}
+
+	/**
+	 * Helper function to return the amount of memory allocated by this container.
+	 * Only returns the size of allocations made directly by the container, not the elements themselves.
+	 *
+	 * @return Number of bytes allocated by this container.
+	 * @see CountBytes
+	 */
+	FORCEINLINE SIZE_T GetAllocatedSize() const
+	{
+		return Pairs.GetAllocatedSize() + (SIZE_T)Capacity * (sizeof(uint8) + sizeof(uint32));
+	}
+
+	/**
+	 * Track the container's memory use through an archive.
+	 *
+	 * @param Ar The archive to use.
+	 * @see GetAllocatedSize
+	 */
+	FORCEINLINE void CountBytes(FArchive& Ar) const
+	{
+		Pairs.CountBytes(Ar);
+		Ar.CountBytes((SIZE_T)Capacity * (sizeof(uint8) + sizeof(uint32)), (SIZE_T)Capacity * (sizeof(uint8) + sizeof(uint32)));
+	}
+
+	/**
+	 * Set the value associated with a key.
+	 *
+	 * @param InKey The key to associate the value with.
+	 * @param InValue The value to associate with the key.
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	FORCEINLINE ValueType& Add(const KeyType& InKey, const ValueType& InValue) { return Emplace(InKey, InValue); }
+	FORCEINLINE ValueType& Add(const KeyType& InKey, ValueType&& InValue) { return Emplace(InKey, MoveTempIfPossible(InValue)); }
+	FORCEINLINE ValueType& Add(KeyType&& InKey, const ValueType& InValue) { return Emplace(MoveTempIfPossible(InKey), InValue); }
+	FORCEINLINE ValueType& Add(KeyType&& InKey, ValueType&& InValue) { return Emplace(MoveTempIfPossible(InKey), MoveTempIfPossible(InValue)); }
+
+	/** See Add() and class documentation section on ByHash() functions */
+	FORCEINLINE ValueType& AddByHash(uint32 KeyHash, const KeyType& InKey, const ValueType& InValue) { return EmplaceByHash(KeyHash, InKey, InValue); }
+	FORCEINLINE ValueType& AddByHash(uint32 KeyHash, const KeyType& InKey, ValueType&& InValue) { return EmplaceByHash(KeyHash, InKey, MoveTempIfPossible(InValue)); }
+	FORCEINLINE ValueType& AddByHash(uint32 KeyHash, KeyType&& InKey, const ValueType& InValue) { return EmplaceByHash(KeyHash, MoveTempIfPossible(InKey), InValue); }
+	FORCEINLINE ValueType& AddByHash(uint32 KeyHash, KeyType&& InKey, ValueType&& InValue) { return EmplaceByHash(KeyHash, MoveTempIfPossible(InKey), MoveTempIfPossible(InValue)); }
+
+	/**
+	 * Set a default value associated with a key.
+	 *
+	 * @param InKey The key to associate the value with.
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	FORCEINLINE ValueType& Add(const KeyType& InKey) { return Emplace(InKey); }
+	FORCEINLINE ValueType& Add(KeyType&& InKey) { return Emplace(MoveTempIfPossible(InKey)); }
+
+	/** See Add() and class documentation section on ByHash() functions */
+	FORCEINLINE ValueType& AddByHash(uint32 KeyHash, const KeyType& InKey) { return EmplaceByHash(KeyHash, InKey); }
+	FORCEINLINE ValueType& AddByHash(uint32 KeyHash, KeyType&& InKey) { return EmplaceByHash(KeyHash, MoveTempIfPossible(InKey)); }
+
+	/**
+	 * Sets the value associated with a key.
+	 *
+	 * @param InKeyValue A Tuple containing the Key and Value to associate together
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	FORCEINLINE ValueType& Add(const TTuple<KeyType, ValueType>& InKeyValue) { return Emplace(InKeyValue.Key, InKeyValue.Value); }
+	FORCEINLINE ValueType& Add(TTuple<KeyType, ValueType>&& InKeyValue) { return Emplace(MoveTempIfPossible(InKeyValue.Key), MoveTempIfPossible(InKeyValue.Value)); }
+
+	/**
+	 * Sets the value associated with a key.
+	 *
+	 * @param InKey The key to associate the value with.
+	 * @param InValue The value to associate with the key.
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	template <typename InitKeyType, typename InitValueType>
+	ValueType& Emplace(InitKeyType&& InKey, InitValueType&& InValue)
+	{
+		return EmplaceByHash(KeyFuncs::GetKeyHash(InKey), Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue));
+	}
+
+	/** See Emplace() and class documentation section on ByHash() functions */
+	template <typename InitKeyType, typename InitValueType>
+	ValueType& EmplaceByHash(uint32 KeyHash, InitKeyType&& InKey, InitValueType&& InValue)
+	{
+		const int32 Slot = FindSlotByHash(KeyHash, InKey);
+		if (Slot != INDEX_NONE)
+		{
+			ElementType& Pair = Pairs.GetData()[Slots[Slot]];
+			Pair.Value = Forward<InitValueType>(InValue);
+			return Pair.Value;
+		}
+		return AddNewByHash(KeyHash, Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue)).Value;
+	}
+
+	/**
+	 * Set a default value associated with a key.
+	 *
+	 * @param InKey The key to associate the value with.
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	template <typename InitKeyType>
+	ValueType& Emplace(InitKeyType&& InKey)
+	{
+		return EmplaceByHash(KeyFuncs::GetKeyHash(InKey), Forward<InitKeyType>(InKey));
+	}
+
+	/** See Emplace() and class documentation section on ByHash() functions */
+	template <typename InitKeyType>
+	ValueType& EmplaceByHash(uint32 KeyHash, InitKeyType&& InKey)
+	{
+		const int32 Slot = FindSlotByHash(KeyHash, InKey);
+		if (Slot != INDEX_NONE)
+		{
+			ElementType& Pair = Pairs.GetData()[Slots[Slot]];
+			Pair.Value = ValueType();
+			return Pair.Value;
+		}
+		return AddNewByHash(KeyHash, Forward<InitKeyType>(InKey), ValueType()).Value;
+	}
+
+	/**
+	 * Remove all value associations for a key.
+	 *
+	 * @param InKey The key to remove associated values for.
+	 * @return The number of values that were associated with the key.
+	 */
+	FORCEINLINE int32 Remove(KeyConstPointerType InKey)
+	{
+		return RemoveByHash(KeyFuncs::GetKeyHash(InKey), InKey);
+	}
+
+	/** See Remove() and class documentation section on ByHash() functions */
+	template<typename ComparableKey>
+	FORCEINLINE int32 RemoveByHash(uint32 KeyHash, const ComparableKey& Key)
+	{
+		const int32 Slot = FindSlotByHash(KeyHash, Key);
+		if (Slot == INDEX_NONE)
+		{
+			return 0;
+		}
+		RemoveSlot(Slot);
+		return 1;
+	}
+
+	/**
+	 * Removes the pair with the specified key and copies the value that was removed to the ref parameter
+	 *
+	 * @param Key The key to search for
+	 * @param OutRemovedValue If found, the value that was removed (not modified if the key was not found)
+	 * @return whether or not the key was found
+	 */
+	FORCEINLINE bool RemoveAndCopyValue(KeyInitType Key, ValueType& OutRemovedValue)
+	{
+		const int32 Slot = FindSlotByHash(KeyFuncs::GetKeyHash(Key), Key);
+		if (Slot == INDEX_NONE)
+		{
+			return false;
+		}
+
+		OutRemovedValue = MoveTempIfPossible(Pairs.GetData()[Slots[Slot]].Value);
+		RemoveSlot(Slot);
+		return true;
+	}
+
+	/**
+	 * Find a pair with the specified key, removes it from the map, and returns the value part of the pair.
+	 *
+	 * If no pair was found, an exception is thrown.
+	 *
+	 * @param Key the key to search for
+	 * @return whether or not the key was found
+	 */
+	FORCEINLINE ValueType FindAndRemoveChecked(KeyConstPointerType Key)
+	{
+		const int32 Slot = FindSlotByHash(KeyFuncs::GetKeyHash(Key), Key);
+		check(Slot != INDEX_NONE);
+		ValueType Result = MoveTempIfPossible(Pairs.GetData()[Slots[Slot]].Value);
+		RemoveSlot(Slot);
+		return Result;
+	}
+
+	/**
+	 * Find the key associated with the specified value.
+	 *
+	 * The time taken is O(N) in the number of pairs.
+	 *
+	 * @param Value The value to search for
+	 * @return A pointer to the key associated with the specified value,
+	 *     or nullptr if the value isn't contained in this map. The pointer
+	 *     is only valid until the next change to any key in the map.
+	 */
+	const KeyType* FindKey(ValueInitType Value) const
+	{
+		for (const ElementType& Pair : Pairs)
+		{
+			if (Pair.Value == Value)
+			{
+				return &Pair.Key;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Find the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return A pointer to the value associated with the specified key, or nullptr if the key isn't contained in this map.  The pointer
+	 *			is only valid until the next change to any key in the map.
+	 */
+	FORCEINLINE ValueType* Find(KeyConstPointerType Key)
+	{
+		return FindByHash(KeyFuncs::GetKeyHash(Key), Key);
+	}
+	FORCEINLINE const ValueType* Find(KeyConstPointerType Key) const
+	{
+		return const_cast<TFlatMap*>(this)->Find(Key);
+	}
+
+	/** See Find() and class documentation section on ByHash() functions */
+	template<typename ComparableKey>
+	FORCEINLINE ValueType* FindByHash(uint32 KeyHash, const ComparableKey& Key)
+	{
+		const int32 Slot = FindSlotByHash(KeyHash, Key);
+		return Slot != INDEX_NONE ? &Pairs.GetData()[Slots[Slot]].Value : nullptr;
+	}
+	template<typename ComparableKey>
+	FORCEINLINE const ValueType* FindByHash(uint32 KeyHash, const ComparableKey& Key) const
+	{
+		return const_cast<TFlatMap*>(this)->FindByHash(KeyHash, Key);
+	}
+
+	FORCEINLINE static uint32 HashKey(const KeyType& Key)
+	{
+		return KeyFuncs::GetKeyHash(Key);
+	}
+
+	/**
+	 * Find the value associated with a specified key, or if none exists,
+	 * adds a value using the default constructor.
+	 *
+	 * @param Key The key to search for.
+	 * @return A reference to the value associated with the specified key.
+	 */
+	FORCEINLINE ValueType& FindOrAdd(const KeyType& Key) { return FindOrAddImpl(HashKey(Key), Key); }
+	FORCEINLINE ValueType& FindOrAdd(KeyType&& Key) { return FindOrAddImpl(HashKey(Key), MoveTempIfPossible(Key)); }
+
+	/** See FindOrAdd() and class documentation section on ByHash() functions */
+	FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, const KeyType& Key) { return FindOrAddImpl(KeyHash, Key); }
+	FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, KeyType&& Key) { return FindOrAddImpl(KeyHash, MoveTempIfPossible(Key)); }
+
+	/**
+	 * Find the value associated with a specified key, or if none exists,
+	 * adds the value
+	 *
+	 * @param Key The key to search for.
+	 * @param Value The value to associate with the key.
+	 * @return A reference to the value associated with the specified key.
+	 */
+	FORCEINLINE ValueType& FindOrAdd(const KeyType& Key, const ValueType& Value) { return FindOrAddImpl(HashKey(Key), Key, Value); }
+	FORCEINLINE ValueType& FindOrAdd(const KeyType& Key, ValueType&& Value) { return FindOrAddImpl(HashKey(Key), Key, MoveTempIfPossible(Value)); }
+	FORCEINLINE ValueType& FindOrAdd(KeyType&& Key, const ValueType& Value) { return FindOrAddImpl(HashKey(Key), MoveTempIfPossible(Key), Value); }
+	FORCEINLINE ValueType& FindOrAdd(KeyType&& Key, ValueType&& Value) { return FindOrAddImpl(HashKey(Key), MoveTempIfPossible(Key), MoveTempIfPossible(Value)); }
+
+	/** See FindOrAdd() and class documentation section on ByHash() functions */
+	FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, const KeyType& Key, const ValueType& Value) { return FindOrAddImpl(KeyHash, Key, Value); }
+	FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, const KeyType& Key, ValueType&& Value) { return FindOrAddImpl(KeyHash, Key, MoveTempIfPossible(Value)); }
+	FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, KeyType&& Key, const ValueType& Value) { return FindOrAddImpl(KeyHash, MoveTempIfPossible(Key), Value); }
+	FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, KeyType&& Key, ValueType&& Value) { return FindOrAddImpl(KeyHash, MoveTempIfPossible(Key), MoveTempIfPossible(Value)); }
+
+	/**
+	 * Find the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return The value associated with the specified key, or triggers an assertion if the key does not exist.
+	 */
+	FORCEINLINE const ValueType& FindChecked(KeyConstPointerType Key) const
+	{
+		const ValueType* Value = Find(Key);
+		check(Value != nullptr);
+		return *Value;
+	}
+
+	/**
+	 * Find the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return The value associated with the specified key, or triggers an assertion if the key does not exist.
+	 */
+	FORCEINLINE ValueType& FindChecked(KeyConstPointerType Key)
+	{
+		ValueType* Value = Find(Key);
+		check(Value != nullptr);
+		return *Value;
+	}
+
+	/**
+	 * Find the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return The value associated with the specified key, or the default value for the ValueType if the key isn't contained in this map.
+	 */
+	FORCEINLINE ValueType FindRef(KeyConstPointerType Key) const
+	{
+		if (const ValueType* Value = Find(Key))
+		{
+			return *Value;
+		}
+		return ValueType();
+	}
+
+	/**
+	 * Check if map contains the specified key.
+	 *
+	 * @param Key The key to check for.
+	 * @return true if the map contains the key.
+	 */
+	FORCEINLINE bool Contains(KeyConstPointerType Key) const
+	{
+		return FindSlotByHash(KeyFuncs::GetKeyHash(Key), Key) != INDEX_NONE;
+	}
+
+	/** See Contains() and class documentation section on ByHash() functions */
+	template<typename ComparableKey>
+	FORCEINLINE bool ContainsByHash(uint32 KeyHash, const ComparableKey& Key) const
+	{
+		return FindSlotByHash(KeyHash, Key) != INDEX_NONE;
+	}
+
+	/** Copy the key/value pairs in this map into an array. */
+	TArray<ElementType> Array() const
+	{
+		return Pairs;
+	}
+
+	/**
+	 * Generate an array from the keys in this map.
+	 *
+	 * @param OutArray Will contain the collection of keys.
+	 */
+	template<typename Allocator> void GenerateKeyArray(TArray<KeyType, Allocator>& OutArray) const
+	{
+		OutArray.Empty(Pairs.Num());
+		for (const ElementType& Pair : Pairs)
+		{
+			OutArray.Add(Pair.Key);
+		}
+	}
+
+	/**
+	 * Generate an array from the values in this map.
+	 *
+	 * @param OutArray Will contain the collection of values.
+	 */
+	template<typename Allocator> void GenerateValueArray(TArray<ValueType, Allocator>& OutArray) const
+	{
+		OutArray.Empty(Pairs.Num());
+		for (const ElementType& Pair : Pairs)
+		{
+			OutArray.Add(Pair.Value);
+		}
+	}
+
+	/**
+	 * Sorts the pairs array using each pair's Key as the sort criteria, then rebuilds the map's hash.
+	 * Maps of PARALLEL_SORT_MIN_ELEMENTS pairs or more are sorted on several threads, so the predicate must be thread safe.
+	 * Invoked using "MyMapVar.KeySort( PREDICATE_CLASS() );"
+	 */
+	template<typename PREDICATE_CLASS>
+	void KeySort(const PREDICATE_CLASS& Predicate)
+	{
+		Pairs.ParallelSort(FKeyComparisonClass<PREDICATE_CLASS>(Predicate));
+		Rehash(Capacity);
+	}
+
+	/**
+	 * Stable sorts the pairs array using each pair's Key as the sort criteria, then rebuilds the map's hash.
+	 * Invoked using "MyMapVar.KeySort( PREDICATE_CLASS() );"
+	 */
+	template<typename PREDICATE_CLASS>
+	void KeyStableSort(const PREDICATE_CLASS& Predicate)
+	{
+		Pairs.ParallelStableSort(FKeyComparisonClass<PREDICATE_CLASS>(Predicate));
+		Rehash(Capacity);
+	}
+
+	/**
+	 * Sorts the pairs array using each pair's Value as the sort criteria, then rebuilds the map's hash.
+	 * Invoked using "MyMapVar.ValueSort( PREDICATE_CLASS() );"
+	 */
+	template<typename PREDICATE_CLASS>
+	void ValueSort(const PREDICATE_CLASS& Predicate)
+	{
+		Pairs.ParallelSort(FValueComparisonClass<PREDICATE_CLASS>(Predicate));
+		Rehash(Capacity);
+	}
+
+	/**
+	 * Stable sorts the pairs array using each pair's Value as the sort criteria, then rebuilds the map's hash.
+	 * Invoked using "MyMapVar.ValueSort( PREDICATE_CLASS() );"
+	 */
+	template<typename PREDICATE_CLASS>
+	void ValueStableSort(const PREDICATE_CLASS& Predicate)
+	{
+		Pairs.ParallelStableSort(FValueComparisonClass<PREDICATE_CLASS>(Predicate));
+		Rehash(Capacity);
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, TFlatMap& Map)
+	{
+		Ar << Map.Pairs;
+		if (Ar.IsLoading())
+		{
+			Map.FreeTable();
+			if (Map.Pairs.Num())
+			{
+				Map.Rehash(GetCapacityFor(Map.Pairs.Num()));
+			}
+		}
+		return Ar;
+	}
+
+protected:
+	/** The base of TFlatMap iterators. */
+	template<bool bConst>
+	class TBaseIterator
+	{
+	public:
+		typedef std::conditional_t<bConst, const TFlatMap, TFlatMap> MapType;
+		typedef std::conditional_t<bConst, const ElementType, ElementType> ItElementType;
+		typedef std::conditional_t<bConst, const KeyType, KeyType> ItKeyType;
+		typedef std::conditional_t<bConst, const ValueType, ValueType> ItValueType;
+
+		FORCEINLINE TBaseIterator(MapType& InMap)
+			: Map(InMap)
+			, Index(0)
+		{
+		}
+
+		FORCEINLINE TBaseIterator& operator++()
+		{
+			++Index;
+			return *this;
+		}
+
+		/** conversion to "bool" returning true if the iterator is valid. */
+		FORCEINLINE explicit operator bool() const
+		{
+			return Index >= 0 && Index < Map.Pairs.Num();
+		}
+		/** inverse of the "bool" operator */
+		FORCEINLINE bool operator !() const
+		{
+			return !(bool)*this;
+		}
+
+		FORCEINLINE bool operator==(const TBaseIterator& Rhs) const { return &Map == &Rhs.Map && Index == Rhs.Index; }
+		FORCEINLINE bool operator!=(const TBaseIterator& Rhs) const { return !(*this == Rhs); }
+
+		FORCEINLINE ItKeyType& Key() const { return Map.Pairs[Index].Key; }
+		FORCEINLINE ItValueType& Value() const { return Map.Pairs[Index].Value; }
+
+		FORCEINLINE ItElementType& operator* () const { return Map.Pairs[Index]; }
+		FORCEINLINE ItElementType* operator->() const { return &Map.Pairs[Index]; }
+
+	protected:
+		MapType& Map;
+		int32 Index;
+	};
+
+public:
+	/** Map iterator. */
+	class TIterator : public TBaseIterator<false>
+	{
+		typedef TBaseIterator<false> Super;
+
+	public:
+		FORCEINLINE TIterator(TFlatMap& InMap)
+			: Super(InMap)
+		{
+		}
+
+		/** Removes the current pair from the map. The last pair takes its place and is visited next. */
+		FORCEINLINE void RemoveCurrent()
+		{
+			this->Map.RemoveSlot(this->Map.FindSlotOfIndex(this->Index));
+			--this->Index;
+		}
+	};
+
+	/** Const map iterator. */
+	class TConstIterator : public TBaseIterator<true>
+	{
+		typedef TBaseIterator<true> Super;
+
+	public:
+		FORCEINLINE TConstIterator(const TFlatMap& InMap)
+			: Super(InMap)
+		{
+		}
+	};
+
+	/** Creates an iterator over all the pairs in this map */
+	FORCEINLINE TIterator CreateIterator()
+	{
+		return TIterator(*this);
+	}
+
+	/** Creates a const iterator over all the pairs in this map */
+	FORCEINLINE TConstIterator CreateConstIterator() const
+	{
+		return TConstIterator(*this);
+	}
+
+	/**
+	 * DO NOT USE DIRECTLY
+	 * STL-like iterators to enable range-based for loop support.
+	 */
+	FORCEINLINE auto begin() { return Pairs.begin(); }
+	FORCEINLINE auto begin() const { return Pairs.begin(); }
+	FORCEINLINE auto end() { return Pairs.end(); }
+	FORCEINLINE auto end() const { return Pairs.end(); }
+
+private:
+	/** Extracts the pair's key from the map's pair structure and passes it to the user provided comparison class. */
+	template<typename PREDICATE_CLASS>
+	class FKeyComparisonClass
+	{
+		TDereferenceWrapper<KeyType, PREDICATE_CLASS> Predicate;
+
+	public:
+		FORCEINLINE FKeyComparisonClass(const PREDICATE_CLASS& InPredicate)
+			: Predicate(InPredicate)
+		{}
+
+		FORCEINLINE bool operator()(const ElementType& A, const ElementType& B) const
+		{
+			return Predicate(A.Key, B.Key);
+		}
+	};
+
+	/** Extracts the pair's value from the map's pair structure and passes it to the user provided comparison class. */
+	template<typename PREDICATE_CLASS>
+	class FValueComparisonClass
+	{
+		TDereferenceWrapper<ValueType, PREDICATE_CLASS> Predicate;
+
+	public:
+		FORCEINLINE FValueComparisonClass(const PREDICATE_CLASS& InPredicate)
+			: Predicate(InPredicate)
+		{}
+
+		FORCEINLINE bool operator()(const ElementType& A, const ElementType& B) const
+		{
+			return Predicate(A.Value, B.Value);
+		}
+	};
+
+	/** Number of slots that may be used, full or deleted, before the table grows. Keeps at least one empty slot per probe sequence. */
+	FORCEINLINE static int32 GetMaxLoad(int32 InCapacity)
+	{
+		return InCapacity - InCapacity / 8;
+	}
+
+	static int32 GetCapacityFor(int32 NumElements)
+	{
+		int32 NewCapacity = UE::Core::FlatMap::Private::GroupWidth;
+		while (GetMaxLoad(NewCapacity) < NumElements)
+		{
+			NewCapacity *= 2;
+		}
+		return NewCapacity;
+	}
+
+	/** @return the slot holding the key, or INDEX_NONE */
+	template<typename ComparableKey>
+	int32 FindSlotByHash(uint32 KeyHash, const ComparableKey& Key) const
+	{
+		using namespace UE::Core::FlatMap::Private;
+
+		if (!Capacity)
+		{
+			return INDEX_NONE;
+		}
+
+		const uint64 Mixed = MixHash(KeyHash);
+		const uint8 H2 = GetH2(Mixed);
+		const uint32 GroupMask = (uint32)(Capacity / GroupWidth) - 1;
+		const ElementType* PairData = Pairs.GetData();
+
+		uint32 Group = GetH1(Mixed) & GroupMask;
+		for (uint32 Probe = 1; ; ++Probe)
+		{
+			const FGroup Ctrls(Ctrl + Group * GroupWidth);
+			for (FGroupMask Match = Ctrls.Match(H2); Match; Match.ClearLowest())
+			{
+				const int32 Slot = (int32)(Group * GroupWidth) + Match.LowestSlot();
+				if (KeyFuncs::Matches(KeyFuncs::GetSetKey(PairData[Slots[Slot]]), Key))
+				{
+					return Slot;
+				}
+			}
+
+			// A group with an empty slot was never full, so the probe sequence cannot continue past it.
+			if (Ctrls.MatchEmpty())
+			{
+				return INDEX_NONE;
+			}
+
+			// Triangular probing visits every group once when the group count is a power of two.
+			checkSlow(Probe <= GroupMask + 1);
+			Group = (Group + Probe) & GroupMask;
+		}
+	}
+
+	/** @return the slot pointing at the pair at Index, which must be in the map */
+	int32 FindSlotOfIndex(int32 Index) const
+	{
+		using namespace UE::Core::FlatMap::Private;
+
+		const uint64 Mixed = MixHash(KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Pairs[Index])));
+		const uint8 H2 = GetH2(Mixed);
+		const uint32 GroupMask = (uint32)(Capacity / GroupWidth) - 1;
+
+		uint32 Group = GetH1(Mixed) & GroupMask;
+		for (uint32 Probe = 1; ; ++Probe)
+		{
+			const FGroup Ctrls(Ctrl + Group * GroupWidth);
+			for (FGroupMask Match = Ctrls.Match(H2); Match; Match.ClearLowest())
+			{
+				const int32 Slot = (int32)(Group * GroupWidth) + Match.LowestSlot();
+				if (Slots[Slot] == (uint32)Index)
+				{
+					return Slot;
+				}
+			}
+
+			checkf(Probe <= GroupMask + 1, TEXT("TFlatMap pair %d is missing from the table"), Index);
+			Group = (Group + Probe) & GroupMask;
+		}
+	}
+
+	/** @return the first free or deleted slot on the probe sequence of the hash */
+	int32 FindInsertSlot(uint64 Mixed) const
+	{
+		using namespace UE::Core::FlatMap::Private;
+
+		const uint32 GroupMask = (uint32)(Capacity / GroupWidth) - 1;
+
+		uint32 Group = GetH1(Mixed) & GroupMask;
+		for (uint32 Probe = 1; ; ++Probe)
+		{
+			if (FGroupMask Free = FGroup(Ctrl + Group * GroupWidth).MatchEmptyOrDeleted())
+			{
+				return (int32)(Group * GroupWidth) + Free.LowestSlot();
+			}
+
+			checkSlow(Probe <= GroupMask + 1);
+			Group = (Group + Probe) & GroupMask;
+		}
+	}
+
+	template <typename InitKeyType, typename InitValueType>
+	ElementType& AddNewByHash(uint32 KeyHash, InitKeyType&& InKey, InitValueType&& InValue)
+	{
+		using namespace UE::Core::FlatMap::Private;
+
+		if (Pairs.Num() + NumTombstones + 1 > GetMaxLoad(Capacity))
+		{
+			// Reclaim tombstones in place if that leaves enough room, grow otherwise.
+			const bool bGrow = !Capacity || Pairs.Num() + 1 > GetMaxLoad(Capacity) / 2;
+			Rehash(bGrow ? FMath::Max(Capacity * 2, (int32)GroupWidth) : Capacity);
+		}
+
+		const uint64 Mixed = MixHash(KeyHash);
+		const int32 Slot = FindInsertSlot(Mixed);
+		if (Ctrl[Slot] == CtrlDeleted)
+		{
+			--NumTombstones;
+		}
+
+		const int32 Index = Pairs.Emplace(Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue));
+		Ctrl[Slot] = GetH2(Mixed);
+		Slots[Slot] = (uint32)Index;
+		return Pairs.GetData()[Index];
+	}
+
+	template <typename InitKeyType>
+	ValueType& FindOrAddImpl(uint32 KeyHash, InitKeyType&& Key)
+	{
+		const int32 Slot = FindSlotByHash(KeyHash, Key);
+		if (Slot != INDEX_NONE)
+		{
+			return Pairs.GetData()[Slots[Slot]].Value;
+		}
+		return AddNewByHash(KeyHash, Forward<InitKeyType>(Key), ValueType()).Value;
+	}
+
+	template <typename InitKeyType, typename InitValueType>
+	ValueType& FindOrAddImpl(uint32 KeyHash, InitKeyType&& Key, InitValueType&& Value)
+	{
+		const int32 Slot = FindSlotByHash(KeyHash, Key);
+		if (Slot != INDEX_NONE)
+		{
+			return Pairs.GetData()[Slots[Slot]].Value;
+		}
+		return AddNewByHash(KeyHash, Forward<InitKeyType>(Key), Forward<InitValueType>(Value)).Value;
+	}
+
+	/** Removes the pair referenced by Slot, moving the last pair into its place. */
+	void RemoveSlot(int32 Slot)
+	{
+		using namespace UE::Core::FlatMap::Private;
+
+		const int32 Index = (int32)Slots[Slot];
+		const int32 LastIndex = Pairs.Num() - 1;
+		if (Index != LastIndex)
+		{
+			Slots[FindSlotOfIndex(LastIndex)] = (uint32)Index;
+		}
+
+		// If the group still has an empty slot no probe sequence ever went through it, so no tombstone is needed.
+		const int32 GroupStart = Slot & ~(GroupWidth - 1);
+		if (FGroup(Ctrl + GroupStart).MatchEmpty())
+		{
+			Ctrl[Slot] = CtrlEmpty;
+		}
+		else
+		{
+			Ctrl[Slot] = CtrlDeleted;
+			++NumTombstones;
+		}
+
+		Pairs.RemoveAtSwap(Index, 1, false);
+	}
+
+	/** Rebuilds the table with NewCapacity slots from the pair array. */
+	void Rehash(int32 NewCapacity)
+	{
+		using namespace UE::Core::FlatMap::Private;
+
+		checkSlow(NewCapacity == 0 || (NewCapacity % GroupWidth == 0 && FMath::IsPowerOfTwo(NewCapacity)));
+		checkSlow(GetMaxLoad(NewCapacity) >= Pairs.Num());
+
+		if (NewCapacity != Capacity)
+		{
+			FreeTable();
+			if (NewCapacity)
+			{
+				Ctrl = (uint8*)FMemory::Malloc((SIZE_T)NewCapacity * (sizeof(uint8) + sizeof(uint32)), GroupWidth);
+				Slots = (uint32*)(Ctrl + NewCapacity);
+				Capacity = NewCapacity;
+			}
+		}
+
+		if (!Capacity)
+		{
+			return;
+		}
+
+		FMemory::Memset(Ctrl, CtrlEmpty, Capacity);
+		NumTombstones = 0;
+
+		const ElementType* PairData = Pairs.GetData();
+		for (int32 Index = 0, NumPairs = Pairs.Num(); Index < NumPairs; ++Index)
+		{
+			const uint64 Mixed = MixHash(KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(PairData[Index])));
+			const int32 Slot = FindInsertSlot(Mixed);
+			Ctrl[Slot] = GetH2(Mixed);
+			Slots[Slot] = (uint32)Index;
+		}
+	}
+
+	void CopyTable(const TFlatMap& Other)
+	{
+		Capacity = Other.Capacity;
+		NumTombstones = Other.NumTombstones;
+		if (Capacity)
+		{
+			const SIZE_T TableSize = (SIZE_T)Capacity * (sizeof(uint8) + sizeof(uint32));
+			Ctrl = (uint8*)FMemory::Malloc(TableSize, UE::Core::FlatMap::Private::GroupWidth);
+			Slots = (uint32*)(Ctrl + Capacity);
+			FMemory::Memcpy(Ctrl, Other.Ctrl, TableSize);
+		}
+		else
+		{
+			Ctrl = nullptr;
+			Slots = nullptr;
+		}
+	}
+
+	void FreeTable()
+	{
+		if (Ctrl)
+		{
+			FMemory::Free(Ctrl);
+		}
+		Ctrl = nullptr;
+		Slots = nullptr;
+		Capacity = 0;
+		NumTombstones = 0;
+	}
+
+	/** The key-value pairs, densely packed. */
+	TArray<ElementType> Pairs;
+
+	/** Capacity control bytes, one per slot, followed by the Slots array in the same allocation. */
+	uint8* Ctrl = nullptr;
+
+	/** Index into Pairs of the pair stored in each full slot. */
+	uint32* Slots = nullptr;
+
+	/** Number of slots in the table, zero or a power of two multiple of the group width. */
+	int32 Capacity = 0;
+
+	/** Number of deleted slots that still break probe sequences. */
+	int32 NumTombstones = 0;
+};
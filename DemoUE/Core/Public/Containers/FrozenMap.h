@@ -0,0 +1,664 @@
+#pragma once
+#include <type_traits>
+#include "CoreTypes.h"
+#include "HAL/UnrealMemory.h"
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+
+/** Average number of keys sharing a displacement bucket. Lower values build faster and use more memory. */
+#define FROZENMAP_KEYS_PER_BUCKET 4
+
+/** Number of seeds tried for a bucket before the build starts over with twice as many buckets. */
+#define FROZENMAP_MAX_SEED_ATTEMPTS (1 << 16)
+
+namespace UE::Core::FrozenMap::Private
+{
+	enum : uint32
+	{
+		ImageMagic = 0x465A4D50,	// 'FZMP'
+		ImageVersion = 1,
+
+		/** Set in a bucket entry that stores the slot of its only key instead of a seed. */
+		DirectSlotFlag = 0x80000000u,
+	};
+
+	/** Header at the start of every frozen map image. Everything in the image is addressed relative to it. */
+	struct FImageHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+
+		/** sizeof(TPair<KeyType, ValueType>), used to reject images built for another layout. */
+		uint32 ElementSize;
+
+		uint32 NumPairs;
+
+		/** Pairs reachable through the perfect hash. The remaining ones share a full 32 bit hash with another key. */
+		uint32 NumPerfectSlots;
+
+		uint32 NumBuckets;
+
+		uint64 ImageSize;
+	};
+
+	FORCEINLINE uint64 Mix64(uint64 Value)
+	{
+		Value ^= Value >> 33;
+		Value *= 0xFF51AFD7ED558CCDull;
+		Value ^= Value >> 33;
+		Value *= 0xC4CEB9FE1A85EC53ull;
+		Value ^= Value >> 33;
+		return Value;
+	}
+
+	/** Maps a 32 bit value to [0, Range) without a division. */
+	FORCEINLINE uint32 FastRange(uint32 Value, uint32 Range)
+	{
+		return (uint32)(((uint64)Value * Range) >> 32);
+	}
+
+	FORCEINLINE uint32 GetBucket(uint32 KeyHash, uint32 NumBuckets)
+	{
+		return FastRange((uint32)Mix64(KeyHash), NumBuckets);
+	}
+
+	FORCEINLINE uint32 GetSlot(uint32 KeyHash, uint32 Seed, uint32 NumSlots)
+	{
+		return FastRange((uint32)(Mix64(((uint64)Seed << 32) | KeyHash) >> 32), NumSlots);
+	}
+}
+
+/**
+ * Immutable map for tables that are built once and then only queried.
+ *
+ * The map is built from any TMap-like container into a single allocation: a small header, one 32 bit entry per
+ * displacement bucket and the key-value pairs. Keys are placed with a minimal perfect hash (hash and displace), so a
+ * lookup hashes the key, reads one bucket entry and compares a single pair. Keys whose 32 bit hashes collide with
+ * another key cannot be told apart by the perfect hash; they are kept after the perfect slots and searched linearly.
+ *
+ * The image is position independent. Maps of trivially copyable pairs can be written out with GetImage() and later
+ * wrapped with CreateView() straight from a memory mapped file, and every map can be frozen into a memory image through
+ * WriteMemoryImage().
+ */
+template <typename InKeyType, typename InValueType, typename KeyFuncs = TDefaultMapHashableKeyFuncs<InKeyType, InValueType, false>>
+class TFrozenMap
+{
+	static_assert(!KeyFuncs::bAllowDuplicateKeys, "TFrozenMap cannot be instantiated with a KeyFuncs which allows duplicate keys");
+
+	typedef UE::Core::FrozenMap::Private::FImageHeader FImageHeader;
+
+public:
+	typedef InKeyType KeyType;
+	typedef InValueType ValueType;
+	typedef KeyFuncs KeyFuncsType;
+
+	typedef typename TTypeTraits<KeyType  >::ConstPointerType KeyConstPointerType;
+	typedef TPair<KeyType, ValueType> ElementType;
+
+	/** Whether images of this map can be used in place, e.g. from a memory mapped file. */
+	static constexpr bool bSupportsImageViews = std::is_trivially_copyable_v<ElementType>;
+
+	TFrozenMap() = default;
+
+	/**
+	 * Builds the frozen map from the pairs of another map.
+	 *
+	 * @param Source Any container whose ranged for loop yields pairs with Key and Value members, e.g. TMap or TFlatMap.
+	 */
+	template <typename MapType>
+	explicit TFrozenMap(const MapType& Source)
+	{
+		Build(Source);
+	}
+
+	TFrozenMap(TFrozenMap&& Other)
+		: Image(Other.Image)
+		, bOwnsImage(Other.bOwnsImage)
+	{
+		Other.Image = nullptr;
+		Other.bOwnsImage = false;
+	}
+
+	TFrozenMap(const TFrozenMap& Other)
+	{
+		CopyFrom(Other);
+	}
+
+	TFrozenMap& operator=(TFrozenMap&& Other)
+	{
+		if (this != &Other)
+		{
+			Release();
+			Image = Other.Image;
+			bOwnsImage = Other.bOwnsImage;
+			Other.Image = nullptr;
+			Other.bOwnsImage = false;
+		}
+		return *this;
+	}
+
+	TFrozenMap& operator=(const TFrozenMap& Other)
+	{
+		if (this != &Other)
+		{
+			Release();
+			CopyFrom(Other);
+		}
+		return *this;
+	}
+
+	~TFrozenMap()
+	{
+		Release();
+	}
+
+	/**
+	 * Wraps an image previously returned by GetImage(), without copying it.
+	 * The memory must stay valid and unchanged for the lifetime of the returned map. The header and every bucket entry
+	 * are validated, which reads the whole bucket table once.
+	 *
+	 * @return the map, or an empty map if the image is not a valid frozen map of this type
+	 */
+	static TFrozenMap CreateView(const void* InImage, SIZE_T InImageSize)
+	{
+		static_assert(bSupportsImageViews, "Only maps of trivially copyable keys and values can be used in place");
+		using namespace UE::Core::FrozenMap::Private;
+
+		TFrozenMap Result;
+
+		const FImageHeader* Header = (const FImageHeader*)InImage;
+		if (!Header || InImageSize < sizeof(FImageHeader) || ((UPTRINT)InImage & (GetImageAlignment() - 1)) != 0)
+		{
+			return Result;
+		}
+		if (Header->Magic != ImageMagic || Header->Version != ImageVersion || Header->ElementSize != sizeof(ElementType))
+		{
+			return Result;
+		}
+		if (Header->ImageSize != InImageSize || Header->NumPerfectSlots > Header->NumPairs
+			|| GetImageSize(Header->NumPairs, Header->NumBuckets) != InImageSize
+			|| Header->NumBuckets == 0)
+		{
+			return Result;
+		}
+
+		// Lookups index the pairs with the bucket entries unchecked, every entry has to point inside the perfect slots.
+		const uint32* Buckets = (const uint32*)(Header + 1);
+		for (uint32 Bucket = 0; Bucket < Header->NumBuckets; ++Bucket)
+		{
+			const uint32 Entry = Buckets[Bucket];
+			const bool bValid = (Entry & DirectSlotFlag)
+				? (Entry & ~DirectSlotFlag) < Header->NumPerfectSlots
+				: Entry <= FROZENMAP_MAX_SEED_ATTEMPTS && (Entry == 0 || Header->NumPerfectSlots != 0);
+			if (!bValid)
+			{
+				return Result;
+			}
+		}
+
+		Result.Image = const_cast<FImageHeader*>(Header);
+		Result.bOwnsImage = false;
+		return Result;
+	}
+
+	/** @return the contiguous image of the map, to be stored and handed back to CreateView() */
+	const void* GetImage() const
+	{
+		return Image;
+	}
+
+	/** @return the size of the image in bytes */
+	SIZE_T GetImageSize() const
+	{
+		return Image ? (SIZE_T)Image->ImageSize : 0;
+	}
+
+	/** @return The number of elements in the map. */
+	FORCEINLINE int32 Num() const
+	{
+		return Image ? (int32)Image->NumPairs : 0;
+	}
+
+	bool IsEmpty() const
+	{
+		return Num() == 0;
+	}
+
+	/**
+	 * Helper function to return the amount of memory allocated by this container.
+	 * Only returns the size of allocations made directly by the container, not the elements themselves.
+	 */
+	FORCEINLINE SIZE_T GetAllocatedSize() const
+	{
+		return bOwnsImage ? GetImageSize() : 0;
+	}
+
+	/**
+	 * Find the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return A pointer to the value associated with the specified key, or nullptr if the key isn't contained in this map.
+	 */
+	FORCEINLINE const ValueType* Find(KeyConstPointerType Key) const
+	{
+		return FindByHash(KeyFuncs::GetKeyHash(Key), Key);
+	}
+
+	/** See Find() and class documentation section on ByHash() functions in TMapBase */
+	template<typename ComparableKey>
+	const ValueType* FindByHash(uint32 KeyHash, const ComparableKey& Key) const
+	{
+		using namespace UE::Core::FrozenMap::Private;
+
+		if (!Image)
+		{
+			return nullptr;
+		}
+
+		const ElementType* Pairs = GetPairs();
+		const uint32 Entry = GetBuckets()[GetBucket(KeyHash, Image->NumBuckets)];
+		if (Entry)
+		{
+			const uint32 Slot = (Entry & DirectSlotFlag) ? (Entry & ~DirectSlotFlag) : GetSlot(KeyHash, Entry, Image->NumPerfectSlots);
+			if (KeyFuncs::Matches(KeyFuncs::GetSetKey(Pairs[Slot]), Key))
+			{
+				return &Pairs[Slot].Value;
+			}
+		}
+
+		for (uint32 Index = Image->NumPerfectSlots; Index < Image->NumPairs; ++Index)
+		{
+			if (KeyFuncs::Matches(KeyFuncs::GetSetKey(Pairs[Index]), Key))
+			{
+				return &Pairs[Index].Value;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Find the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return The value associated with the specified key, or triggers an assertion if the key does not exist.
+	 */
+	FORCEINLINE const ValueType& FindChecked(KeyConstPointerType Key) const
+	{
+		const ValueType* Value = Find(Key);
+		check(Value != nullptr);
+		return *Value;
+	}
+
+	/**
+	 * Find the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return The value associated with the specified key, or the default value for the ValueType if the key isn't contained in this map.
+	 */
+	FORCEINLINE ValueType FindRef(KeyConstPointerType Key) const
+	{
+		if (const ValueType* Value = Find(Key))
+		{
+			return *Value;
+		}
+		return ValueType();
+	}
+
+	/**
+	 * Check if map contains the specified key.
+	 *
+	 * @param Key The key to check for.
+	 * @return true if the map contains the key.
+	 */
+	FORCEINLINE bool Contains(KeyConstPointerType Key) const
+	{
+		return Find(Key) != nullptr;
+	}
+
+	/** See Contains() and class documentation section on ByHash() functions in TMapBase */
+	template<typename ComparableKey>
+	FORCEINLINE bool ContainsByHash(uint32 KeyHash, const ComparableKey& Key) const
+	{
+		return FindByHash(KeyHash, Key) != nullptr;
+	}
+
+	/**
+	 * DO NOT USE DIRECTLY
+	 * STL-like iterators to enable range-based for loop support. Pairs are visited in slot order.
+	 */
+	FORCEINLINE const ElementType* begin() const { return Image ? GetPairs() : nullptr; }
+	FORCEINLINE const ElementType* end() const { return Image ? GetPairs() + Image->NumPairs : nullptr; }
+
+	void WriteMemoryImage(FMemoryImageWriter& Writer) const
+	{
+		if constexpr (THasTypeLayout<ElementType>::Value)
+		{
+			if (Image)
+			{
+				FMemoryImageWriter ImageWriter = Writer.WritePointer(StaticGetTypeLayoutDesc<ElementType>());
+				ImageWriter.WriteBytes(Image, (uint32)GetPairsOffset(Image->NumBuckets));
+				ImageWriter.WriteObjectArray(GetPairs(), StaticGetTypeLayoutDesc<ElementType>(), Image->NumPairs);
+			}
+			else
+			{
+				Writer.WriteMemoryImagePointerSizedBytes(0);
+			}
+
+			// A frozen image is owned by its memory image, never by the map.
+			Writer.WriteBytes(false);
+		}
+		else
+		{
+			// Writing a non-freezable TFrozenMap is only supported for 64-bit target for now, same as TArray
+			check(Writer.Is64BitTarget());
+			Writer.WriteBytes(TFrozenMap());
+		}
+	}
+
+	void CopyUnfrozen(const FMemoryUnfreezeContent& Context, void* Dst) const
+	{
+		TFrozenMap* DstMap = new(Dst) TFrozenMap();
+		if constexpr (THasTypeLayout<ElementType>::Value)
+		{
+			if (Image)
+			{
+				DstMap->Image = (FImageHeader*)FMemory::Malloc(Image->ImageSize, GetImageAlignment());
+				DstMap->bOwnsImage = true;
+				FMemory::Memcpy(DstMap->Image, Image, GetPairsOffset(Image->NumBuckets));
+
+				const ElementType* SrcPairs = GetPairs();
+				ElementType* DstPairs = DstMap->GetPairs();
+				for (uint32 Index = 0; Index < Image->NumPairs; ++Index)
+				{
+					Context.UnfreezeObject(&SrcPairs[Index], StaticGetTypeLayoutDesc<ElementType>(), &DstPairs[Index]);
+				}
+			}
+		}
+	}
+
+	static void AppendHash(const FPlatformTypeLayoutParameters& LayoutParams, FSHA1& Hasher)
+	{
+		if constexpr (THasTypeLayout<ElementType>::Value)
+		{
+			Freeze::AppendHash(StaticGetTypeLayoutDesc<ElementType>(), LayoutParams, Hasher);
+		}
+	}
+
+private:
+	FORCEINLINE static constexpr SIZE_T GetImageAlignment()
+	{
+		return alignof(ElementType) > alignof(FImageHeader) ? alignof(ElementType) : alignof(FImageHeader);
+	}
+
+	FORCEINLINE static SIZE_T GetPairsOffset(uint32 NumBuckets)
+	{
+		return Align(sizeof(FImageHeader) + NumBuckets * sizeof(uint32), alignof(ElementType));
+	}
+
+	FORCEINLINE static SIZE_T GetImageSize(uint32 NumPairs, uint32 NumBuckets)
+	{
+		return GetPairsOffset(NumBuckets) + NumPairs * sizeof(ElementType);
+	}
+
+	FORCEINLINE const uint32* GetBuckets() const
+	{
+		return (const uint32*)(Image + 1);
+	}
+
+	FORCEINLINE uint32* GetBuckets()
+	{
+		return (uint32*)(Image + 1);
+	}
+
+	FORCEINLINE const ElementType* GetPairs() const
+	{
+		return (const ElementType*)((const uint8*)Image + GetPairsOffset(Image->NumBuckets));
+	}
+
+	FORCEINLINE ElementType* GetPairs()
+	{
+		return (ElementType*)((uint8*)Image + GetPairsOffset(Image->NumBuckets));
+	}
+
+	struct FBuildEntry
+	{
+		uint32 Hash;
+		uint32 Bucket;
+		const KeyType* Key;
+		const ValueType* Value;
+	};
+
+	template <typename MapType>
+	void Build(const MapType& Source)
+	{
+		using namespace UE::Core::FrozenMap::Private;
+
+		TArray<FBuildEntry> Entries;
+		Entries.Reserve(Source.Num());
+		for (const auto& Pair : Source)
+		{
+			Entries.Add({ KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Pair)), 0, &Pair.Key, &Pair.Value });
+		}
+		if (Entries.IsEmpty())
+		{
+			return;
+		}
+
+		// Keys sharing a full hash cannot be separated by any seed; keep the first and move the others to the overflow range.
+		Entries.Sort([](const FBuildEntry& A, const FBuildEntry& B) { return A.Hash < B.Hash; });
+
+		TArray<FBuildEntry> Perfect;
+		TArray<FBuildEntry> Overflow;
+		Perfect.Reserve(Entries.Num());
+		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		{
+			if (Index > 0 && Entries[Index].Hash == Entries[Index - 1].Hash)
+			{
+				Overflow.Add(Entries[Index]);
+			}
+			else
+			{
+				Perfect.Add(Entries[Index]);
+			}
+		}
+
+		const uint32 NumPerfectSlots = (uint32)Perfect.Num();
+		const uint32 NumPairs = (uint32)Entries.Num();
+
+		TArray<uint32> Buckets;
+		TArray<int32> SlotEntries;
+		uint32 NumBuckets = FMath::Max<uint32>(1, (NumPerfectSlots + FROZENMAP_KEYS_PER_BUCKET - 1) / FROZENMAP_KEYS_PER_BUCKET);
+		while (!PlaceKeys(Perfect, NumBuckets, Buckets, SlotEntries))
+		{
+			checkf(NumBuckets < NumPerfectSlots * 2, TEXT("TFrozenMap failed to build a perfect hash for %u keys"), NumPerfectSlots);
+			NumBuckets *= 2;
+		}
+
+		const SIZE_T ImageSize = GetImageSize(NumPairs, NumBuckets);
+		Image = (FImageHeader*)FMemory::Malloc(ImageSize, GetImageAlignment());
+		bOwnsImage = true;
+
+		FMemory::Memzero(Image, GetPairsOffset(NumBuckets));
+		Image->Magic = ImageMagic;
+		Image->Version = ImageVersion;
+		Image->ElementSize = sizeof(ElementType);
+		Image->NumPairs = NumPairs;
+		Image->NumPerfectSlots = NumPerfectSlots;
+		Image->NumBuckets = NumBuckets;
+		Image->ImageSize = ImageSize;
+		FMemory::Memcpy(GetBuckets(), Buckets.GetData(), NumBuckets * sizeof(uint32));
+
+		ElementType* Pairs = GetPairs();
+		for (uint32 Slot = 0; Slot < NumPerfectSlots; ++Slot)
+		{
+			const FBuildEntry& Entry = Perfect[SlotEntries[Slot]];
+			new (&Pairs[Slot]) ElementType(*Entry.Key, *Entry.Value);
+		}
+		for (uint32 Index = 0; Index < (uint32)Overflow.Num(); ++Index)
+		{
+			new (&Pairs[NumPerfectSlots + Index]) ElementType(*Overflow[Index].Key, *Overflow[Index].Value);
+		}
+	}
+
+	/**
+	 * Finds a seed per bucket so that the keys of all buckets land in distinct slots, biggest buckets first.
+	 * Buckets with a single key are pointed straight at a free slot once the others are placed.
+	 *
+	 * @return false if some bucket could not be placed and more buckets are needed
+	 */
+	static bool PlaceKeys(TArray<FBuildEntry>& Entries, uint32 NumBuckets, TArray<uint32>& OutBuckets, TArray<int32>& OutSlotEntries)
+	{
+		using namespace UE::Core::FrozenMap::Private;
+
+		const uint32 NumSlots = (uint32)Entries.Num();
+
+		for (FBuildEntry& Entry : Entries)
+		{
+			Entry.Bucket = GetBucket(Entry.Hash, NumBuckets);
+		}
+		Entries.Sort([](const FBuildEntry& A, const FBuildEntry& B) { return A.Bucket < B.Bucket; });
+
+		// Ranges of Entries per bucket, ordered by decreasing size.
+		struct FBucketRange
+		{
+			uint32 Bucket;
+			int32 First;
+			int32 Num;
+		};
+		TArray<FBucketRange> Ranges;
+		for (int32 First = 0; First < Entries.Num(); )
+		{
+			int32 Last = First + 1;
+			while (Last < Entries.Num() && Entries[Last].Bucket == Entries[First].Bucket)
+			{
+				++Last;
+			}
+			Ranges.Add({ Entries[First].Bucket, First, Last - First });
+			First = Last;
+		}
+		Ranges.StableSort([](const FBucketRange& A, const FBucketRange& B) { return A.Num > B.Num; });
+
+		OutBuckets.Reset();
+		OutBuckets.AddZeroed(NumBuckets);
+		OutSlotEntries.Reset();
+		OutSlotEntries.Init(INDEX_NONE, NumSlots);
+
+		TArray<uint32, TInlineAllocator<16>> Candidates;
+		uint32 NextFreeSlot = 0;
+		for (const FBucketRange& Range : Ranges)
+		{
+			if (Range.Num == 1)
+			{
+				while (OutSlotEntries[NextFreeSlot] != INDEX_NONE)
+				{
+					++NextFreeSlot;
+				}
+				OutSlotEntries[NextFreeSlot] = Range.First;
+				OutBuckets[Range.Bucket] = DirectSlotFlag | NextFreeSlot;
+				continue;
+			}
+
+			bool bPlaced = false;
+			for (uint32 Seed = 1; Seed <= FROZENMAP_MAX_SEED_ATTEMPTS && !bPlaced; ++Seed)
+			{
+				Candidates.Reset();
+				bPlaced = true;
+				for (int32 Index = Range.First; Index < Range.First + Range.Num; ++Index)
+				{
+					const uint32 Slot = GetSlot(Entries[Index].Hash, Seed, NumSlots);
+					if (OutSlotEntries[Slot] != INDEX_NONE || Candidates.Contains(Slot))
+					{
+						bPlaced = false;
+						break;
+					}
+					Candidates.Add(Slot);
+				}
+
+				if (bPlaced)
+				{
+					for (int32 Index = 0; Index < Range.Num; ++Index)
+					{
+						OutSlotEntries[Candidates[Index]] = Range.First + Index;
+					}
+					OutBuckets[Range.Bucket] = Seed;
+				}
+			}
+
+			if (!bPlaced)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void CopyFrom(const TFrozenMap& Other)
+	{
+		if (!Other.Image)
+		{
+			Image = nullptr;
+			bOwnsImage = false;
+			return;
+		}
+
+		Image = (FImageHeader*)FMemory::Malloc(Other.Image->ImageSize, GetImageAlignment());
+		bOwnsImage = true;
+		FMemory::Memcpy(Image, Other.Image, GetPairsOffset(Other.Image->NumBuckets));
+
+		const ElementType* SrcPairs = Other.GetPairs();
+		ElementType* DstPairs = GetPairs();
+		for (uint32 Index = 0; Index < Image->NumPairs; ++Index)
+		{
+			new (&DstPairs[Index]) ElementType(SrcPairs[Index]);
+		}
+	}
+
+	void Release()
+	{
+		if (Image && bOwnsImage)
+		{
+			DestructItems(GetPairs(), (int32)Image->NumPairs);
+			FMemory::Free(Image);
+		}
+		Image = nullptr;
+		bOwnsImage = false;
+	}
+
+	/** Header of the image, followed by the bucket entries and the pairs. */
+	FImageHeader* Image = nullptr;
+
+	/** False for views and memory images, whose storage belongs to someone else. */
+	bool bOwnsImage = false;
+};
+
+namespace Freeze
+{
+	template<typename KeyType, typename ValueType, typename KeyFuncs>
+	void IntrinsicWriteMemoryImage(FMemoryImageWriter& Writer, const TFrozenMap<KeyType, ValueType, KeyFuncs>& Object, const FTypeLayoutDesc&)
+	{
+		Object.WriteMemoryImage(Writer);
+	}
+
+	template<typename KeyType, typename ValueType, typename KeyFuncs>
+	uint32 IntrinsicUnfrozenCopy(const FMemoryUnfreezeContent& Context, const TFrozenMap<KeyType, ValueType, KeyFuncs>& Object, void* OutDst)
+	{
+		Object.CopyUnfrozen(Context, OutDst);
+		return sizeof(Object);
+	}
+
+	template<typename KeyType, typename ValueType, typename KeyFuncs>
+	uint32 IntrinsicAppendHash(const TFrozenMap<KeyType, ValueType, KeyFuncs>* DummyObject, const FTypeLayoutDesc& TypeDesc, const FPlatformTypeLayoutParameters& LayoutParams, FSHA1& Hasher)
+	{
+		TFrozenMap<KeyType, ValueType, KeyFuncs>::AppendHash(LayoutParams, Hasher);
+		return AppendHashForNameAndSize(TypeDesc.Name, sizeof(TFrozenMap<KeyType, ValueType, KeyFuncs>), Hasher);
+	}
+
+	template<typename KeyType, typename ValueType, typename KeyFuncs>
+	uint32 IntrinsicGetTargetAlignment(const TFrozenMap<KeyType, ValueType, KeyFuncs>* DummyObject, const FTypeLayoutDesc& TypeDesc, const FPlatformTypeLayoutParameters& LayoutParams)
+	{
+		// Alignment of the map is driven by the image pointer
+		return FMath::Min(8u, LayoutParams.MaxFieldAlignment);
+	}
+}
+
+DECLARE_TEMPLATE_INTRINSIC_TYPE_LAYOUT((template <typename KeyType, typename ValueType, typename KeyFuncs>), (TFrozenMap<KeyType, ValueType, KeyFuncs>));
@@ -929,12 +929,13 @@ protected:
 public:
 	/**
 	 * Sorts the pairs array using each pair's Key as the sort criteria, then rebuilds the map's hash.
+	 * Maps of PARALLEL_SORT_MIN_ELEMENTS pairs or more are sorted on several threads, so the predicate must be thread safe.
 	 * Invoked using "MyMapVar.KeySort( PREDICATE_CLASS() );"
 	 */
 	template<typename PREDICATE_CLASS>
 	FORCEINLINE void KeySort(const PREDICATE_CLASS& Predicate)
 	{
-		Super::Pairs.Sort(FKeyComparisonClass<PREDICATE_CLASS>(Predicate));
+		SortPairs<false>(FKeyComparisonClass<PREDICATE_CLASS>(Predicate));
 	}
 
 	/**
@@ -944,7 +945,7 @@ public:
 	template<typename PREDICATE_CLASS>
 	FORCEINLINE void KeyStableSort(const PREDICATE_CLASS& Predicate)
 	{
-		Super::Pairs.StableSort(FKeyComparisonClass<PREDICATE_CLASS>(Predicate));
+		SortPairs<true>(FKeyComparisonClass<PREDICATE_CLASS>(Predicate));
 	}
 
 	/**
@@ -954,7 +955,7 @@ public:
 	template<typename PREDICATE_CLASS>
 	FORCEINLINE void ValueSort(const PREDICATE_CLASS& Predicate)
 	{
-		Super::Pairs.Sort(FValueComparisonClass<PREDICATE_CLASS>(Predicate));
+		SortPairs<false>(FValueComparisonClass<PREDICATE_CLASS>(Predicate));
 	}
 
 	/**
@@ -964,9 +965,55 @@ public:
 	template<typename PREDICATE_CLASS>
 	FORCEINLINE void ValueStableSort(const PREDICATE_CLASS& Predicate)
 	{
-		Super::Pairs.StableSort(FValueComparisonClass<PREDICATE_CLASS>(Predicate));
+		SortPairs<true>(FValueComparisonClass<PREDICATE_CLASS>(Predicate));
 	}
 
+private:
+	/**
+	 * Sorts the pairs with Comparison. Big maps are moved out to a flat array, sorted on several threads and added back
+	 * in order, which also leaves the elements compacted.
+	 */
+	template<bool bStable, typename ComparisonClass>
+	void SortPairs(const ComparisonClass& Comparison)
+	{
+		const int32 NumPairs = Super::Pairs.Num();
+		if (NumPairs < PARALLEL_SORT_MIN_ELEMENTS)
+		{
+			if constexpr (bStable)
+			{
+				Super::Pairs.StableSort(Comparison);
+			}
+			else
+			{
+				Super::Pairs.Sort(Comparison);
+			}
+			return;
+		}
+
+		TArray<typename Super::ElementType> SortedPairs;
+		SortedPairs.Reserve(NumPairs);
+		for (typename Super::ElementType& Pair : Super::Pairs)
+		{
+			SortedPairs.Add(MoveTemp(Pair));
+		}
+
+		if constexpr (bStable)
+		{
+			Algo::ParallelStableSort(SortedPairs, Comparison);
+		}
+		else
+		{
+			Algo::ParallelSort(SortedPairs, Comparison);
+		}
+
+		Super::Pairs.Empty(NumPairs);
+		for (typename Super::ElementType& Pair : SortedPairs)
+		{
+			Super::Pairs.Add(MoveTemp(Pair));
+		}
+	}
+
+public:
 	/**
 	 * Sort the free element list so that subsequent additions will occur in the lowest available
 	 * TSet index resulting in tighter packing without moving any existing items. Also useful for
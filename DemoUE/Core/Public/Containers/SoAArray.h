@@ -0,0 +1,711 @@
+#pragma once
+#include <limits>
+#include <type_traits>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Containers/ArrayView.h"
+#include "Containers/ContainerAllocationPolicies.h"
+#include "HAL/UnrealMemory.h"
+#include "Serialization/Archive.h"
+#include "Templates/IntegerSequence.h"
+#include "Templates/MemoryOps.h"
+#include "Templates/Tuple.h"
+#include "Templates/UnrealTemplate.h"
+
+/** Alignment of every column of a TSoAArray, a cache line so loops over a column start on one and can use aligned vector loads. */
+#define SOA_ARRAY_COLUMN_ALIGNMENT 64
+
+/** Field list of a TSoAArray, one column per type, addressed by its position in the list. */
+template <typename... FieldTypes>
+struct TSoAFields
+{
+	static constexpr uint32 Num = sizeof...(FieldTypes);
+};
+
+template <typename Fields, typename InAllocatorType = FDefaultAllocator>
+class TSoAArray;
+
+/**
+ * Structure of arrays: the elements of a TArray<FStruct> split into one contiguous, aligned column per field, so loops
+ * that only touch a few fields only pull those into the cache and the compiler can vectorize over a column.
+ *
+ *     TSoAArray<TSoAFields<FVector3f, FVector3f, float>> Particles;
+ *     Particles.Add(Position, Velocity, Lifetime);
+ *     float* Lifetimes = Particles.GetData<2>();
+ *
+ * Every column holds Num() elements and grows, shrinks and loses elements along with the others. Slack is worked out
+ * for the widest column. Columns use the allocator policy of TArray, one allocation each, aligned to
+ * SOA_ARRAY_COLUMN_ALIGNMENT when the policy supports element alignment. Fields must be relocatable, as for TArray.
+ */
+template <typename... FieldTypes, typename InAllocatorType>
+class TSoAArray<TSoAFields<FieldTypes...>, InAllocatorType>
+{
+public:
+	typedef typename InAllocatorType::SizeType SizeType;
+	typedef InAllocatorType AllocatorType;
+
+	/** Type of the field at FieldIndex in the field list. */
+	template <uint32 FieldIndex>
+	using TFieldType = typename TTupleElement<FieldIndex, TTuple<FieldTypes...>>::Type;
+
+	static constexpr uint32 NumFields = sizeof...(FieldTypes);
+
+	static_assert(NumFields > 0, "TSoAArray needs at least one field");
+	static_assert(TIsSigned<SizeType>::Value, "TSoAArray only supports signed index types");
+
+private:
+	using USizeType = typename TMakeUnsigned<SizeType>::Type;
+
+	template <typename InFieldType>
+	struct TColumn
+	{
+		typedef InFieldType FieldType;
+
+		typedef typename TChooseClass<
+			AllocatorType::NeedsElementType,
+			typename AllocatorType::template ForElementType<FieldType>,
+			typename AllocatorType::ForAnyElementType
+		>::Result ElementAllocatorType;
+
+		static constexpr uint32 Alignment = alignof(FieldType) > SOA_ARRAY_COLUMN_ALIGNMENT ? alignof(FieldType) : SOA_ARRAY_COLUMN_ALIGNMENT;
+
+		FORCEINLINE FieldType* GetData() const
+		{
+			return (FieldType*)AllocatorInstance.GetAllocation();
+		}
+
+		void Resize(SizeType CurrentNum, SizeType NewMax)
+		{
+			if constexpr (TAllocatorTraits<AllocatorType>::SupportsElementAlignment)
+			{
+				AllocatorInstance.ResizeAllocation(CurrentNum, NewMax, sizeof(FieldType), Alignment);
+			}
+			else
+			{
+				AllocatorInstance.ResizeAllocation(CurrentNum, NewMax, sizeof(FieldType));
+			}
+		}
+
+		ElementAllocatorType AllocatorInstance;
+	};
+
+	static constexpr SIZE_T GetWidestFieldSize()
+	{
+		SIZE_T Result = 0;
+		((Result = sizeof(FieldTypes) > Result ? sizeof(FieldTypes) : Result), ...);
+		return Result;
+	}
+
+	static constexpr uint32 GetWidestFieldAlignment()
+	{
+		uint32 Result = 0;
+		((Result = TColumn<FieldTypes>::Alignment > Result ? TColumn<FieldTypes>::Alignment : Result), ...);
+		return Result;
+	}
+
+	/** The column slack is computed for, the others get the same number of elements. */
+	static constexpr SIZE_T WidestFieldSize = GetWidestFieldSize();
+	static constexpr uint32 WidestFieldAlignment = GetWidestFieldAlignment();
+
+public:
+	TSoAArray()
+		: ArrayNum(0)
+		, ArrayMax(Columns.template Get<0>().AllocatorInstance.GetInitialCapacity())
+	{
+	}
+
+	TSoAArray(const TSoAArray& Other)
+		: TSoAArray()
+	{
+		CopyFrom(Other);
+	}
+
+	TSoAArray(TSoAArray&& Other)
+		: ArrayNum(Other.ArrayNum)
+		, ArrayMax(Other.ArrayMax)
+	{
+		ForEachColumnPair(Other, [](auto& Column, auto& OtherColumn)
+		{
+			Column.AllocatorInstance.MoveToEmpty(OtherColumn.AllocatorInstance);
+		});
+		Other.ArrayNum = 0;
+		Other.ArrayMax = Other.Columns.template Get<0>().AllocatorInstance.GetInitialCapacity();
+	}
+
+	~TSoAArray()
+	{
+		DestructRange(0, ArrayNum);
+	}
+
+	TSoAArray& operator=(const TSoAArray& Other)
+	{
+		if (this != &Other)
+		{
+			Empty(Other.ArrayNum);
+			CopyFrom(Other);
+		}
+		return *this;
+	}
+
+	TSoAArray& operator=(TSoAArray&& Other)
+	{
+		if (this != &Other)
+		{
+			DestructRange(0, ArrayNum);
+			ForEachColumnPair(Other, [](auto& Column, auto& OtherColumn)
+			{
+				Column.AllocatorInstance.MoveToEmpty(OtherColumn.AllocatorInstance);
+			});
+			ArrayNum = Other.ArrayNum;
+			ArrayMax = Other.ArrayMax;
+			Other.ArrayNum = 0;
+			Other.ArrayMax = Other.Columns.template Get<0>().AllocatorInstance.GetInitialCapacity();
+		}
+		return *this;
+	}
+
+	FORCEINLINE SizeType Num() const
+	{
+		return ArrayNum;
+	}
+
+	FORCEINLINE SizeType Max() const
+	{
+		return ArrayMax;
+	}
+
+	FORCEINLINE bool IsEmpty() const
+	{
+		return ArrayNum == 0;
+	}
+
+	FORCEINLINE bool IsValidIndex(SizeType Index) const
+	{
+		return Index >= 0 && Index < ArrayNum;
+	}
+
+	/** @return the first element of a column, only valid until the array is resized */
+	template <uint32 FieldIndex>
+	FORCEINLINE TFieldType<FieldIndex>* GetData()
+	{
+		return Columns.template Get<FieldIndex>().GetData();
+	}
+
+	template <uint32 FieldIndex>
+	FORCEINLINE const TFieldType<FieldIndex>* GetData() const
+	{
+		return Columns.template Get<FieldIndex>().GetData();
+	}
+
+	/** @return a view of a column, only valid until the array is resized */
+	template <uint32 FieldIndex>
+	FORCEINLINE TArrayView<TFieldType<FieldIndex>, SizeType> GetColumn()
+	{
+		return TArrayView<TFieldType<FieldIndex>, SizeType>(GetData<FieldIndex>(), ArrayNum);
+	}
+
+	template <uint32 FieldIndex>
+	FORCEINLINE TArrayView<const TFieldType<FieldIndex>, SizeType> GetColumn() const
+	{
+		return TArrayView<const TFieldType<FieldIndex>, SizeType>(GetData<FieldIndex>(), ArrayNum);
+	}
+
+	/** @return a field of the element at Index */
+	template <uint32 FieldIndex>
+	FORCEINLINE TFieldType<FieldIndex>& Get(SizeType Index)
+	{
+		RangeCheck(Index);
+		return GetData<FieldIndex>()[Index];
+	}
+
+	template <uint32 FieldIndex>
+	FORCEINLINE const TFieldType<FieldIndex>& Get(SizeType Index) const
+	{
+		RangeCheck(Index);
+		return GetData<FieldIndex>()[Index];
+	}
+
+	/**
+	 * Adds an element at the end, each field constructed from the argument at the same position.
+	 * Arguments may be fields of this array, e.g. Add(Get<0>(0), Get<1>(0)).
+	 *
+	 * @return the index of the new element
+	 */
+	template <typename... ArgTypes>
+	SizeType Add(ArgTypes&&... Args)
+	{
+		static_assert(sizeof...(ArgTypes) == NumFields, "TSoAArray::Add takes one argument per field");
+
+		if (ArrayNum < ArrayMax)
+		{
+			const SizeType Index = ArrayNum++;
+			ConstructFields(Index, TMakeIntegerSequence<uint32, NumFields>(), Forward<ArgTypes>(Args)...);
+			return Index;
+		}
+
+		// Growing reallocates the columns, which would leave arguments referencing them dangling.
+		TTuple<FieldTypes...> Fields(Forward<ArgTypes>(Args)...);
+		const SizeType Index = AddUninitialized();
+		MoveConstructFields(Index, TMakeIntegerSequence<uint32, NumFields>(), Fields);
+		return Index;
+	}
+
+	/**
+	 * Adds elements whose fields are left uninitialized, callers construct them in every column.
+	 *
+	 * @return the index of the first new element
+	 */
+	SizeType AddUninitialized(SizeType Count = 1)
+	{
+		checkSlow(Count >= 0);
+
+		const SizeType OldNum = ArrayNum;
+		if ((ArrayNum += Count) > ArrayMax)
+		{
+			ResizeGrow(OldNum);
+		}
+		return OldNum;
+	}
+
+	/** @return the index of the first new element, every field default constructed */
+	SizeType AddDefaulted(SizeType Count = 1)
+	{
+		const SizeType Index = AddUninitialized(Count);
+		ForEachColumn([Index, Count](auto& Column)
+		{
+			using FieldType = typename std::decay_t<decltype(Column)>::FieldType;
+			DefaultConstructItems<FieldType>(Column.GetData() + Index, Count);
+		});
+		return Index;
+	}
+
+	/** @return the index of the first new element, every field zeroed */
+	SizeType AddZeroed(SizeType Count = 1)
+	{
+		const SizeType Index = AddUninitialized(Count);
+		ForEachColumn([Index, Count](auto& Column)
+		{
+			FMemory::Memzero(Column.GetData() + Index, Count * sizeof(*Column.GetData()));
+		});
+		return Index;
+	}
+
+	/**
+	 * Removes elements by moving the last ones of every column into the hole, O(Count) but does not preserve the order.
+	 *
+	 * @param Index Location of the first element to remove.
+	 * @param Count (Optional) Number of elements to remove. Default is 1.
+	 * @param bAllowShrinking (Optional) Tells if this call can shrink the columns if suitable after remove. Default is true.
+	 */
+	void RemoveAtSwap(SizeType Index, SizeType Count = 1, bool bAllowShrinking = true)
+	{
+		if (Count)
+		{
+			checkSlow((Count >= 0) & (Index >= 0) & (Index + Count <= ArrayNum));
+
+			DestructRange(Index, Count);
+
+			const SizeType NumElementsAfterHole = ArrayNum - (Index + Count);
+			const SizeType NumElementsToMoveIntoHole = FPlatformMath::Min(Count, NumElementsAfterHole);
+			if (NumElementsToMoveIntoHole)
+			{
+				const SizeType SourceIndex = ArrayNum - NumElementsToMoveIntoHole;
+				ForEachColumn([Index, SourceIndex, NumElementsToMoveIntoHole](auto& Column)
+				{
+					FMemory::Memcpy(Column.GetData() + Index, Column.GetData() + SourceIndex, NumElementsToMoveIntoHole * sizeof(*Column.GetData()));
+				});
+			}
+			ArrayNum -= Count;
+
+			if (bAllowShrinking)
+			{
+				ResizeShrink();
+			}
+		}
+	}
+
+	/**
+	 * Resizes every column to NewNum elements, new ones default constructed.
+	 *
+	 * @param NewNum New number of elements.
+	 * @param bAllowShrinking Tell if this function can shrink the memory in-use if suitable.
+	 */
+	void SetNum(SizeType NewNum, bool bAllowShrinking = true)
+	{
+		if (NewNum < 0)
+		{
+			// Cast to USizeType first to prevent sign extension on negative sizes, producing unusually large values.
+			UE::Core::Private::OnInvalidArrayNum((unsigned long long)(USizeType)NewNum);
+		}
+		else if (NewNum > ArrayNum)
+		{
+			AddDefaulted(NewNum - ArrayNum);
+		}
+		else if (NewNum < ArrayNum)
+		{
+			SetNumDown(NewNum, bAllowShrinking);
+		}
+	}
+
+	/** Same as SetNum, new elements are zeroed. */
+	void SetNumZeroed(SizeType NewNum, bool bAllowShrinking = true)
+	{
+		if (NewNum < 0)
+		{
+			UE::Core::Private::OnInvalidArrayNum((unsigned long long)(USizeType)NewNum);
+		}
+		else if (NewNum > ArrayNum)
+		{
+			AddZeroed(NewNum - ArrayNum);
+		}
+		else if (NewNum < ArrayNum)
+		{
+			SetNumDown(NewNum, bAllowShrinking);
+		}
+	}
+
+	/** Same as SetNum, new elements are left uninitialized. */
+	void SetNumUninitialized(SizeType NewNum, bool bAllowShrinking = true)
+	{
+		if (NewNum < 0)
+		{
+			UE::Core::Private::OnInvalidArrayNum((unsigned long long)(USizeType)NewNum);
+		}
+		else if (NewNum > ArrayNum)
+		{
+			AddUninitialized(NewNum - ArrayNum);
+		}
+		else if (NewNum < ArrayNum)
+		{
+			SetNumDown(NewNum, bAllowShrinking);
+		}
+	}
+
+	/** Makes room for Number elements in every column. */
+	void Reserve(SizeType Number)
+	{
+		checkSlow(Number >= 0);
+		if (Number > ArrayMax)
+		{
+			ResizeTo(Number);
+		}
+	}
+
+	/**
+	 * Destroys every element and frees the columns, unless Slack asks to keep room.
+	 *
+	 * @param Slack (Optional) The expected usage size after empty operation. Default is 0.
+	 */
+	void Empty(SizeType Slack = 0)
+	{
+		checkSlow(Slack >= 0);
+		DestructRange(0, ArrayNum);
+		ArrayNum = 0;
+		if (ArrayMax != Slack)
+		{
+			ResizeTo(Slack);
+		}
+	}
+
+	/** Same as Empty, but keeps the allocations unless they are smaller than NewSize. */
+	void Reset(SizeType NewSize = 0)
+	{
+		if (NewSize <= ArrayMax)
+		{
+			DestructRange(0, ArrayNum);
+			ArrayNum = 0;
+		}
+		else
+		{
+			Empty(NewSize);
+		}
+	}
+
+	/** Frees the slack of every column. */
+	void Shrink()
+	{
+		if (ArrayMax != ArrayNum)
+		{
+			ResizeTo(ArrayNum);
+		}
+	}
+
+	/** @return the bytes allocated by all the columns */
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = 0;
+		ForEachColumn([this, &Size](const auto& Column)
+		{
+			Size += Column.AllocatorInstance.GetAllocatedSize(ArrayMax, sizeof(*Column.GetData()));
+		});
+		return Size;
+	}
+
+	/**
+	 * Bulk serializes one column, in the format of TArray::BulkSerialize: the element size, the element count, then the
+	 * elements as a single blob, or one by one where TArray would.
+	 *
+	 * Loading into an empty array sizes it to the loaded count, the other columns zeroed until they are loaded too.
+	 * Otherwise the count has to match Num() and the archive is set to error if it does not. The field has the
+	 * restrictions of TArray::BulkSerialize.
+	 *
+	 * @param Ar	FArchive to bulk serialize the column to/from
+	 */
+	template <uint32 FieldIndex>
+	void BulkSerializeColumn(FArchive& Ar, bool bForcePerElementSerialization = false)
+	{
+		using FieldType = TFieldType<FieldIndex>;
+		static_assert(std::is_trivially_copyable_v<FieldType>, "TSoAArray::BulkSerializeColumn only streams trivially copyable fields");
+
+		constexpr int32 ElementSize = sizeof(FieldType);
+		// Serialize element size to detect mismatch across platforms.
+		int32 SerializedElementSize = ElementSize;
+		Ar << SerializedElementSize;
+
+		if (Ar.IsLoading())
+		{
+			// Basic sanity checking to ensure that sizes match.
+			if (!ensure(SerializedElementSize == ElementSize))
+			{
+				Ar.SetError();
+				return;
+			}
+
+			SizeType NewArrayNum = 0;
+			Ar << NewArrayNum;
+			if (!ensure(NewArrayNum >= 0 && std::numeric_limits<SizeType>::max() / (SizeType)ElementSize >= NewArrayNum))
+			{
+				Ar.SetError();
+				return;
+			}
+			if (ArrayNum == 0)
+			{
+				Reserve(NewArrayNum);
+				AddZeroed(NewArrayNum);
+			}
+			else if (!ensure(NewArrayNum == ArrayNum))
+			{
+				Ar.SetError();
+				return;
+			}
+		}
+		else if (Ar.IsSaving())
+		{
+			SizeType ArrayCount = ArrayNum;
+			Ar << ArrayCount;
+		}
+		else
+		{
+			return;
+		}
+
+		FieldType* Data = GetData<FieldIndex>();
+		if (bForcePerElementSerialization
+			|| (Ar.IsSaving()			// if we are saving, we always do the ordinary serialize as a way to make sure it matches up with bulk serialization
+				&& !Ar.IsCooking()			// but cooking and transacting is performance critical, so we skip that
+				&& !Ar.IsTransacting())
+			|| (Ar.IsByteSwapping() && !TIsArithmetic<FieldType>::Value)		// if we are byteswapping, we need to do that per-element, except for numbers which are swapped as a block
+			)
+		{
+			for (SizeType Index = 0; Index < ArrayNum; ++Index)
+			{
+				Ar << Data[Index];
+			}
+		}
+		else
+		{
+			Ar.CountBytes((SIZE_T)ArrayNum * ElementSize, (SIZE_T)ArrayMax * ElementSize);
+			Ar.ByteOrderSerializeArray(Data, ElementSize, ArrayNum);
+		}
+	}
+
+	/** Bulk serializes every column in field order, see BulkSerializeColumn. */
+	void BulkSerialize(FArchive& Ar, bool bForcePerElementSerialization = false)
+	{
+		BulkSerializeColumns(Ar, bForcePerElementSerialization, TMakeIntegerSequence<uint32, NumFields>());
+	}
+
+private:
+	FORCEINLINE void RangeCheck(SizeType Index) const
+	{
+		checkf((Index >= 0) & (Index < ArrayNum), TEXT("Array index out of bounds: %lld from an array of size %lld"), (long long)Index, (long long)ArrayNum);
+	}
+
+	template <typename FuncType>
+	FORCEINLINE void ForEachColumn(FuncType&& Func)
+	{
+		ForEachColumnImpl(Func, TMakeIntegerSequence<uint32, NumFields>());
+	}
+
+	template <typename FuncType>
+	FORCEINLINE void ForEachColumn(FuncType&& Func) const
+	{
+		ForEachColumnImpl(Func, TMakeIntegerSequence<uint32, NumFields>());
+	}
+
+	template <typename FuncType, uint32... FieldIndices>
+	FORCEINLINE void ForEachColumnImpl(FuncType& Func, TIntegerSequence<uint32, FieldIndices...>)
+	{
+		(Func(Columns.template Get<FieldIndices>()), ...);
+	}
+
+	template <typename FuncType, uint32... FieldIndices>
+	FORCEINLINE void ForEachColumnImpl(FuncType& Func, TIntegerSequence<uint32, FieldIndices...>) const
+	{
+		(Func(Columns.template Get<FieldIndices>()), ...);
+	}
+
+	template <typename FuncType>
+	FORCEINLINE void ForEachColumnPair(TSoAArray& Other, FuncType&& Func)
+	{
+		ForEachColumnPairImpl(Other, Func, TMakeIntegerSequence<uint32, NumFields>());
+	}
+
+	template <typename FuncType>
+	FORCEINLINE void ForEachColumnPair(const TSoAArray& Other, FuncType&& Func)
+	{
+		ForEachColumnPairImpl(Other, Func, TMakeIntegerSequence<uint32, NumFields>());
+	}
+
+	template <typename OtherType, typename FuncType, uint32... FieldIndices>
+	FORCEINLINE void ForEachColumnPairImpl(OtherType& Other, FuncType& Func, TIntegerSequence<uint32, FieldIndices...>)
+	{
+		(Func(Columns.template Get<FieldIndices>(), Other.Columns.template Get<FieldIndices>()), ...);
+	}
+
+	template <uint32... FieldIndices, typename... ArgTypes>
+	FORCEINLINE void ConstructFields(SizeType Index, TIntegerSequence<uint32, FieldIndices...>, ArgTypes&&... Args)
+	{
+		(::new ((void*)(GetData<FieldIndices>() + Index)) TFieldType<FieldIndices>(Forward<ArgTypes>(Args)), ...);
+	}
+
+	template <uint32... FieldIndices>
+	FORCEINLINE void MoveConstructFields(SizeType Index, TIntegerSequence<uint32, FieldIndices...>, TTuple<FieldTypes...>& Fields)
+	{
+		(::new ((void*)(GetData<FieldIndices>() + Index)) TFieldType<FieldIndices>(MoveTemp(Fields.template Get<FieldIndices>())), ...);
+	}
+
+	template <uint32... FieldIndices>
+	void BulkSerializeColumns(FArchive& Ar, bool bForcePerElementSerialization, TIntegerSequence<uint32, FieldIndices...>)
+	{
+		(BulkSerializeColumn<FieldIndices>(Ar, bForcePerElementSerialization), ...);
+	}
+
+	void CopyFrom(const TSoAArray& Other)
+	{
+		Reserve(Other.ArrayNum);
+		ForEachColumnPair(Other, [&Other](auto& Column, const auto& OtherColumn)
+		{
+			using FieldType = typename std::decay_t<decltype(Column)>::FieldType;
+			ConstructItems<FieldType>(Column.GetData(), OtherColumn.GetData(), Other.ArrayNum);
+		});
+		ArrayNum = Other.ArrayNum;
+	}
+
+	void DestructRange(SizeType Index, SizeType Count)
+	{
+		ForEachColumn([Index, Count](auto& Column)
+		{
+			DestructItems(Column.GetData() + Index, Count);
+		});
+	}
+
+	void SetNumDown(SizeType NewNum, bool bAllowShrinking)
+	{
+		DestructRange(NewNum, ArrayNum - NewNum);
+		ArrayNum = NewNum;
+		if (bAllowShrinking)
+		{
+			ResizeShrink();
+		}
+	}
+
+	FORCEINLINE typename TColumn<TFieldType<0>>::ElementAllocatorType& GetSlackAllocator()
+	{
+		return Columns.template Get<0>().AllocatorInstance;
+	}
+
+	SizeType CalculateSlackGrow(SizeType NewNum, SizeType CurrentMax)
+	{
+		if constexpr (TAllocatorTraits<AllocatorType>::SupportsElementAlignment)
+		{
+			return GetSlackAllocator().CalculateSlackGrow(NewNum, CurrentMax, WidestFieldSize, WidestFieldAlignment);
+		}
+		else
+		{
+			return GetSlackAllocator().CalculateSlackGrow(NewNum, CurrentMax, WidestFieldSize);
+		}
+	}
+
+	SizeType CalculateSlackShrink(SizeType NewNum, SizeType CurrentMax)
+	{
+		if constexpr (TAllocatorTraits<AllocatorType>::SupportsElementAlignment)
+		{
+			return GetSlackAllocator().CalculateSlackShrink(NewNum, CurrentMax, WidestFieldSize, WidestFieldAlignment);
+		}
+		else
+		{
+			return GetSlackAllocator().CalculateSlackShrink(NewNum, CurrentMax, WidestFieldSize);
+		}
+	}
+
+	SizeType CalculateSlackReserve(SizeType NewMax)
+	{
+		if constexpr (TAllocatorTraits<AllocatorType>::SupportsElementAlignment)
+		{
+			return GetSlackAllocator().CalculateSlackReserve(NewMax, WidestFieldSize, WidestFieldAlignment);
+		}
+		else
+		{
+			return GetSlackAllocator().CalculateSlackReserve(NewMax, WidestFieldSize);
+		}
+	}
+
+	void ResizeColumns(SizeType CurrentNum, SizeType NewMax)
+	{
+		ForEachColumn([CurrentNum, NewMax](auto& Column)
+		{
+			Column.Resize(CurrentNum, NewMax);
+		});
+	}
+
+	FORCENOINLINE void ResizeGrow(SizeType OldNum)
+	{
+		// This should only happen when we've underflowed or overflowed SizeType in the caller
+		if (ArrayNum < OldNum)
+		{
+			// Cast to USizeType first to prevent sign extension on negative sizes, producing unusually large values.
+			UE::Core::Private::OnInvalidArrayNum((unsigned long long)(USizeType)ArrayNum);
+		}
+		ArrayMax = CalculateSlackGrow(ArrayNum, ArrayMax);
+		ResizeColumns(OldNum, ArrayMax);
+	}
+
+	FORCENOINLINE void ResizeShrink()
+	{
+		const SizeType NewArrayMax = CalculateSlackShrink(ArrayNum, ArrayMax);
+		if (NewArrayMax != ArrayMax)
+		{
+			ArrayMax = NewArrayMax;
+			check(ArrayMax >= ArrayNum);
+			ResizeColumns(ArrayNum, ArrayMax);
+		}
+	}
+
+	FORCENOINLINE void ResizeTo(SizeType NewMax)
+	{
+		if (NewMax)
+		{
+			NewMax = CalculateSlackReserve(NewMax);
+		}
+		if (NewMax != ArrayMax)
+		{
+			ArrayMax = NewMax;
+			ResizeColumns(ArrayNum, ArrayMax);
+		}
+	}
+
+	TTuple<TColumn<FieldTypes>...> Columns;
+	SizeType ArrayNum;
+	SizeType ArrayMax;
+};
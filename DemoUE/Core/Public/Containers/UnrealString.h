@@ -28,4 +28,183 @@ private:
 	struct TIsRangeOfCharType : TIsCharType<TRangeElementType<CharRangeType>>
 	{
 	};
-}
\ No newline at end of file
+};
+
+/**
+ * A string that keeps up to NumInlineChars characters, including the terminator, inside the object itself before it
+ * spills to the heap. Meant for short lived names and scratch strings built in hot loops, where FString would
+ * allocate even for a handful of characters.
+ *
+ * The character data follows the same layout as FString: a null terminated TCHAR array, empty when the string is empty.
+ */
+template <int32 NumInlineChars>
+class TInlineString
+{
+public:
+	using AllocatorType = TInlineAllocator<NumInlineChars>;
+
+private:
+	/** Array holding the character data */
+	typedef TArray<TCHAR, AllocatorType> DataType;
+	DataType Data;
+
+public:
+	TInlineString() = default;
+	TInlineString(TInlineString&&) = default;
+	TInlineString(const TInlineString&) = default;
+	TInlineString& operator=(TInlineString&&) = default;
+	TInlineString& operator=(const TInlineString&) = default;
+
+	/**
+	 * Create a copy of a null terminated string.
+	 *
+	 * @param Str The string to copy
+	 */
+	TInlineString(const TCHAR* Str)
+	{
+		if (Str && *Str)
+		{
+			AppendChars(Str, FCString::Strlen(Str));
+		}
+	}
+
+	/**
+	 * Create a string from the first InCount characters of InSrc.
+	 */
+	TInlineString(int32 InCount, const TCHAR* InSrc)
+	{
+		if (InCount > 0)
+		{
+			AppendChars(InSrc, InCount);
+		}
+	}
+
+	TInlineString& operator=(const TCHAR* Str)
+	{
+		Reset();
+		if (Str && *Str)
+		{
+			AppendChars(Str, FCString::Strlen(Str));
+		}
+		return *this;
+	}
+
+	/** Get pointer to the string, an empty string if there is no character data. */
+	FORCEINLINE const TCHAR* operator*() const
+	{
+		return Data.Num() ? Data.GetData() : TEXT("");
+	}
+
+	FORCEINLINE TCHAR& operator[](int32 Index)
+	{
+		checkf(IsValidIndex(Index), TEXT("String index out of bounds: Index %i from a string with a length of %i"), Index, Len());
+		return Data.GetData()[Index];
+	}
+
+	FORCEINLINE const TCHAR& operator[](int32 Index) const
+	{
+		checkf(IsValidIndex(Index), TEXT("String index out of bounds: Index %i from a string with a length of %i"), Index, Len());
+		return Data.GetData()[Index];
+	}
+
+	/** @return the number of characters, excluding the null terminator */
+	FORCEINLINE int32 Len() const
+	{
+		return Data.Num() ? Data.Num() - 1 : 0;
+	}
+
+	FORCEINLINE bool IsEmpty() const
+	{
+		return Data.Num() <= 1;
+	}
+
+	FORCEINLINE bool IsValidIndex(int32 Index) const
+	{
+		return Index >= 0 && Index < Len();
+	}
+
+	/** @return true if the characters still live inside the object */
+	FORCEINLINE bool IsInline() const
+	{
+		return !Data.GetAllocatorInstance().HasAllocation();
+	}
+
+	/** Get the character array, including the terminator. */
+	FORCEINLINE const DataType& GetCharArray() const
+	{
+		return Data;
+	}
+
+	/** Empties the string but keeps the current allocation, plus room for NewReservedSize characters. */
+	void Reset(int32 NewReservedSize = 0)
+	{
+		const int32 NewSizeIncludingTerminator = (NewReservedSize > 0) ? (NewReservedSize + 1) : 0;
+		Data.Reset(NewSizeIncludingTerminator);
+	}
+
+	/** Empties the string and releases any heap allocation beyond Slack characters. */
+	void Empty(int32 Slack = 0)
+	{
+		Data.Empty(Slack ? Slack + 1 : 0);
+	}
+
+	void Reserve(int32 CharacterCount)
+	{
+		Data.Reserve(CharacterCount + 1);
+	}
+
+	/** Appends Count characters from Str, which does not need to be null terminated. */
+	void AppendChars(const TCHAR* Str, int32 Count)
+	{
+		checkSlow(Count >= 0);
+		if (!Count)
+		{
+			return;
+		}
+
+		const int32 OldNum = Data.Num();
+
+		// Reserve enough space - including an extra gap for a null terminator if we don't already have a string allocated
+		Data.AddUninitialized(Count + (OldNum ? 0 : 1));
+
+		TCHAR* Dest = Data.GetData() + OldNum - (OldNum ? 1 : 0);
+		FMemory::Memcpy(Dest, Str, Count * sizeof(TCHAR));
+		Dest[Count] = TCHAR(0);
+	}
+
+	FORCEINLINE void AppendChar(TCHAR InChar)
+	{
+		AppendChars(&InChar, 1);
+	}
+
+	FORCEINLINE TInlineString& operator+=(const TCHAR* Str)
+	{
+		AppendChars(Str, FCString::Strlen(Str));
+		return *this;
+	}
+
+	FORCEINLINE TInlineString& operator+=(TCHAR InChar)
+	{
+		AppendChar(InChar);
+		return *this;
+	}
+
+	/** Case sensitive comparison with a null terminated string. */
+	FORCEINLINE bool Equals(const TCHAR* Other) const
+	{
+		return FCString::Strcmp(**this, Other) == 0;
+	}
+
+	FORCEINLINE bool operator==(const TCHAR* Other) const
+	{
+		return Equals(Other);
+	}
+
+	FORCEINLINE bool operator!=(const TCHAR* Other) const
+	{
+		return !Equals(Other);
+	}
+};
+
+/** Short string that stays allocation free up to 31 characters. */
+typedef TInlineString<32> FInlineString;
@@ -0,0 +1,206 @@
+#pragma once
+#include <type_traits>
+#include "CoreTypes.h"
+#include "HAL/UnrealMemory.h"
+
+#if defined(__AVX2__)
+	#define VECTORSEARCH_USE_AVX2 1
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define VECTORSEARCH_USE_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define VECTORSEARCH_USE_NEON 1
+	#include <arm_neon.h>
+#endif
+
+#ifndef VECTORSEARCH_USE_AVX2
+	#define VECTORSEARCH_USE_AVX2 0
+#endif
+#ifndef VECTORSEARCH_USE_SSE2
+	#define VECTORSEARCH_USE_SSE2 0
+#endif
+#ifndef VECTORSEARCH_USE_NEON
+	#define VECTORSEARCH_USE_NEON 0
+#endif
+
+/**
+ * Search and compare kernels used by TArray for element types whose operator== is a plain bitwise compare.
+ *
+ * The ISA is picked at compile time: AVX2 when the target enables it, SSE2 on any x64 target and NEON on arm64.
+ * Floating point types are excluded on purpose: +0.0 == -0.0 and NaN != NaN, so a bitwise compare would change results.
+ */
+namespace UE::Core::Private::VectorSearch
+{
+	/** Element types whose operator== can be replaced by an equality test of their bytes. */
+	template <typename T>
+	inline constexpr bool TIsVectorSearchable =
+		(std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) &&
+		(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+	/** Search values of type ComparisonType in an array of ElementType through the kernels, when both are the same searchable type. */
+	template <typename ElementType, typename ComparisonType>
+	inline constexpr bool TCanVectorSearch = TIsVectorSearchable<ElementType> && std::is_same_v<std::remove_cv_t<ElementType>, std::remove_cv_t<ComparisonType>>;
+
+	template <SIZE_T Size> struct TUnsignedOfSize;
+	template <> struct TUnsignedOfSize<1> { typedef uint8  Type; };
+	template <> struct TUnsignedOfSize<2> { typedef uint16 Type; };
+	template <> struct TUnsignedOfSize<4> { typedef uint32 Type; };
+	template <> struct TUnsignedOfSize<8> { typedef uint64 Type; };
+
+	struct FVector
+	{
+#if VECTORSEARCH_USE_AVX2
+		typedef __m256i VectorType;
+		static constexpr uint32 NumBytes = 32;
+		static constexpr uint32 MaskBitsPerByte = 1;
+
+		FORCEINLINE static VectorType Load(const void* Ptr) { return _mm256_loadu_si256((const __m256i*)Ptr); }
+
+		FORCEINLINE static VectorType Splat(uint8 Value)  { return _mm256_set1_epi8((char)Value); }
+		FORCEINLINE static VectorType Splat(uint16 Value) { return _mm256_set1_epi16((short)Value); }
+		FORCEINLINE static VectorType Splat(uint32 Value) { return _mm256_set1_epi32((int)Value); }
+		FORCEINLINE static VectorType Splat(uint64 Value) { return _mm256_set1_epi64x((long long)Value); }
+
+		template <SIZE_T Size>
+		FORCEINLINE static uint64 EqualMask(VectorType A, VectorType B)
+		{
+			if constexpr (Size == 1) { return (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(A, B)); }
+			else if constexpr (Size == 2) { return (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi16(A, B)); }
+			else if constexpr (Size == 4) { return (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi32(A, B)); }
+			else { return (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi64(A, B)); }
+		}
+#elif VECTORSEARCH_USE_SSE2
+		typedef __m128i VectorType;
+		static constexpr uint32 NumBytes = 16;
+		static constexpr uint32 MaskBitsPerByte = 1;
+
+		FORCEINLINE static VectorType Load(const void* Ptr) { return _mm_loadu_si128((const __m128i*)Ptr); }
+
+		FORCEINLINE static VectorType Splat(uint8 Value)  { return _mm_set1_epi8((char)Value); }
+		FORCEINLINE static VectorType Splat(uint16 Value) { return _mm_set1_epi16((short)Value); }
+		FORCEINLINE static VectorType Splat(uint32 Value) { return _mm_set1_epi32((int)Value); }
+		FORCEINLINE static VectorType Splat(uint64 Value) { return _mm_set1_epi64x((long long)Value); }
+
+		template <SIZE_T Size>
+		FORCEINLINE static uint64 EqualMask(VectorType A, VectorType B)
+		{
+			if constexpr (Size == 1) { return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(A, B)); }
+			else if constexpr (Size == 2) { return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi16(A, B)); }
+			else if constexpr (Size == 4) { return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi32(A, B)); }
+			else
+			{
+				// SSE2 has no 64 bit compare: both 32 bit halves have to match.
+				const __m128i Equal32 = _mm_cmpeq_epi32(A, B);
+				return (uint32)_mm_movemask_epi8(_mm_and_si128(Equal32, _mm_shuffle_epi32(Equal32, _MM_SHUFFLE(2, 3, 0, 1))));
+			}
+		}
+#elif VECTORSEARCH_USE_NEON
+		typedef uint8x16_t VectorType;
+		static constexpr uint32 NumBytes = 16;
+		static constexpr uint32 MaskBitsPerByte = 4;
+
+		FORCEINLINE static VectorType Load(const void* Ptr) { return vld1q_u8((const uint8*)Ptr); }
+
+		FORCEINLINE static VectorType Splat(uint8 Value)  { return vdupq_n_u8(Value); }
+		FORCEINLINE static VectorType Splat(uint16 Value) { return vreinterpretq_u8_u16(vdupq_n_u16(Value)); }
+		FORCEINLINE static VectorType Splat(uint32 Value) { return vreinterpretq_u8_u32(vdupq_n_u32(Value)); }
+		FORCEINLINE static VectorType Splat(uint64 Value) { return vreinterpretq_u8_u64(vdupq_n_u64(Value)); }
+
+		/** NEON has no movemask; narrowing every byte to a nibble gives a 64 bit mask with 4 bits per byte. */
+		FORCEINLINE static uint64 ToMask(uint8x16_t Compare)
+		{
+			return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(Compare), 4)), 0);
+		}
+
+		template <SIZE_T Size>
+		FORCEINLINE static uint64 EqualMask(VectorType A, VectorType B)
+		{
+			if constexpr (Size == 1) { return ToMask(vceqq_u8(A, B)); }
+			else if constexpr (Size == 2) { return ToMask(vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(A), vreinterpretq_u16_u8(B)))); }
+			else if constexpr (Size == 4) { return ToMask(vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(A), vreinterpretq_u32_u8(B)))); }
+			else { return ToMask(vreinterpretq_u8_u64(vceqq_u64(vreinterpretq_u64_u8(A), vreinterpretq_u64_u8(B)))); }
+		}
+#endif
+	};
+
+	template <typename T>
+	FORCEINLINE typename TUnsignedOfSize<sizeof(T)>::Type ToBits(const T& Value)
+	{
+		typename TUnsignedOfSize<sizeof(T)>::Type Bits;
+		FMemory::Memcpy(&Bits, &Value, sizeof(T));
+		return Bits;
+	}
+
+	/** @return the index of the first element equal to Value, or INDEX_NONE */
+	template <typename T>
+	int64 FindFirst(const T* RESTRICT Data, int64 Num, const T& Value)
+	{
+		static_assert(TIsVectorSearchable<T>, "FindFirst requires a bitwise comparable element type");
+
+		int64 Index = 0;
+#if VECTORSEARCH_USE_AVX2 || VECTORSEARCH_USE_SSE2 || VECTORSEARCH_USE_NEON
+		constexpr int64 NumLanes = FVector::NumBytes / sizeof(T);
+		constexpr uint32 BitsPerElement = sizeof(T) * FVector::MaskBitsPerByte;
+
+		const FVector::VectorType Needle = FVector::Splat(ToBits(Value));
+		for (; Index + NumLanes <= Num; Index += NumLanes)
+		{
+			if (const uint64 Mask = FVector::EqualMask<sizeof(T)>(FVector::Load(Data + Index), Needle))
+			{
+				return Index + FMath::CountTrailingZeros64(Mask) / BitsPerElement;
+			}
+		}
+#endif
+		for (; Index < Num; ++Index)
+		{
+			if (Data[Index] == Value)
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	/** @return the index of the last element equal to Value, or INDEX_NONE */
+	template <typename T>
+	int64 FindLast(const T* RESTRICT Data, int64 Num, const T& Value)
+	{
+		static_assert(TIsVectorSearchable<T>, "FindLast requires a bitwise comparable element type");
+
+		int64 Index = Num;
+#if VECTORSEARCH_USE_AVX2 || VECTORSEARCH_USE_SSE2 || VECTORSEARCH_USE_NEON
+		constexpr int64 NumLanes = FVector::NumBytes / sizeof(T);
+		constexpr uint32 BitsPerElement = sizeof(T) * FVector::MaskBitsPerByte;
+
+		const FVector::VectorType Needle = FVector::Splat(ToBits(Value));
+		while (Index >= NumLanes)
+		{
+			Index -= NumLanes;
+			if (const uint64 Mask = FVector::EqualMask<sizeof(T)>(FVector::Load(Data + Index), Needle))
+			{
+				return Index + (63 - FMath::CountLeadingZeros64(Mask)) / BitsPerElement;
+			}
+		}
+#endif
+		while (Index > 0)
+		{
+			--Index;
+			if (Data[Index] == Value)
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	/** @return true if both ranges hold the same values */
+	template <typename T>
+	FORCEINLINE bool Equals(const T* A, const T* B, int64 Num)
+	{
+		static_assert(TIsVectorSearchable<T>, "Equals requires a bitwise comparable element type");
+
+		// The CRT memcmp is already vectorized for every ISA we target.
+		return Num == 0 || FMemory::Memcmp(A, B, (SIZE_T)Num * sizeof(T)) == 0;
+	}
+}
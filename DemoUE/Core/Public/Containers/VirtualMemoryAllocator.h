@@ -0,0 +1,214 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/UnrealMemory.h"
+#include "Containers/Array.h"
+#include "Containers/ContainerAllocationPolicies.h"
+
+/** Default address space reserved by TVirtualMemoryAllocator, the largest an array using it can get. */
+#define VIRTUAL_MEMORY_ALLOCATOR_DEFAULT_RESERVE (64ull * 1024 * 1024 * 1024)
+
+/** Growing commits at least this fraction of what is already committed, so appending one element at a time does not commit page by page. */
+#define VIRTUAL_MEMORY_ALLOCATOR_GROW_DIVISOR 8
+
+/**
+ * Allocation policy for huge arrays that reserves ReserveBytes of address space on the first allocation and commits
+ * pages as the array grows, in place. The elements never move: growing costs no copy, and the old and new buffers are
+ * never held at the same time. Shrinking decommits the pages past the new size, and the reservation is released when
+ * the array is emptied or destroyed.
+ *
+ * Each array reserves its own range, which only makes sense for arrays that are expected to reach hundreds of megabytes.
+ * Growing past ReserveBytes is fatal, like running out of memory. Elements can be aligned up to the commit alignment.
+ */
+template <uint64 ReserveBytes = VIRTUAL_MEMORY_ALLOCATOR_DEFAULT_RESERVE>
+class TVirtualMemoryAllocator
+{
+public:
+	using SizeType = int64;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	class ForAnyElementType
+	{
+	public:
+		/** Default constructor. */
+		ForAnyElementType()
+			: CommittedBytes(0)
+		{}
+
+		/**
+		 * Moves the state of another allocator into this one.
+		 *
+		 * Assumes that the allocator is currently empty, i.e. memory may be allocated but any existing elements have already been destructed (if necessary).
+		 * @param Other - The allocator to move the state from.  This allocator should be left in a valid empty state.
+		 */
+		FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+		{
+			checkSlow(this != &Other);
+
+			Release();
+			Block = Other.Block;
+			CommittedBytes = Other.CommittedBytes;
+			Other.Block = FPlatformMemory::FPlatformVirtualMemoryBlock();
+			Other.CommittedBytes = 0;
+		}
+
+		/** Destructor. */
+		FORCEINLINE ~ForAnyElementType()
+		{
+			Release();
+		}
+
+		// FContainerAllocatorInterface
+		FORCEINLINE FScriptContainerElement* GetAllocation() const
+		{
+			return (FScriptContainerElement*)Block.GetVirtualPointer();
+		}
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			checkSlow(NumElements >= 0 && PreviousNumElements >= 0);
+
+			if (NumElements == 0)
+			{
+				Release();
+				return;
+			}
+
+			if ((uint64)NumElements > ReserveBytes / NumBytesPerElement)
+			{
+				FPlatformMemory::OnOutOfMemory((uint64)NumElements * NumBytesPerElement, (uint32)GetCommitAlignment());
+			}
+
+			if (!Block.GetVirtualPointer())
+			{
+				Block = FPlatformMemory::FPlatformVirtualMemoryBlock::AllocateVirtual((size_t)ReserveBytes);
+				if (!Block.GetVirtualPointer())
+				{
+					FPlatformMemory::OnOutOfMemory(ReserveBytes, (uint32)FPlatformMemory::FPlatformVirtualMemoryBlock::GetVirtualSizeAlignment());
+				}
+			}
+
+			// Whole pages only, the slack functions hand out capacity that fills them.
+			const SIZE_T NewCommittedBytes = AlignToCommit((SIZE_T)NumElements * NumBytesPerElement);
+			if (NewCommittedBytes > CommittedBytes)
+			{
+				Block.Commit(CommittedBytes, NewCommittedBytes - CommittedBytes);
+			}
+			else if (NewCommittedBytes < CommittedBytes)
+			{
+				Block.Decommit(NewCommittedBytes, CommittedBytes - NewCommittedBytes);
+			}
+			CommittedBytes = NewCommittedBytes;
+		}
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return FillCommittedPages(NumElements, NumBytesPerElement);
+		}
+		SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			// Only give pages back once a quarter of the committed memory is unused, removing elements one by one would
+			// otherwise decommit and recommit the last page over and over.
+			const SIZE_T AllocatedBytes = (SIZE_T)NumAllocatedElements * NumBytesPerElement;
+			const SIZE_T UnusedBytes = AllocatedBytes - (SIZE_T)NumElements * NumBytesPerElement;
+			if (NumElements > 0 && UnusedBytes * 4 < AllocatedBytes)
+			{
+				return NumAllocatedElements;
+			}
+			return FillCommittedPages(NumElements, NumBytesPerElement);
+		}
+		SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			const uint64 MaxElements = ReserveBytes / NumBytesPerElement;
+			SizeType Grown = NumElements + NumAllocatedElements / VIRTUAL_MEMORY_ALLOCATOR_GROW_DIVISOR;
+			if ((uint64)Grown > MaxElements)
+			{
+				// Let ResizeAllocation report the overflow if even NumElements does not fit.
+				Grown = FMath::Max<SizeType>(NumElements, (SizeType)MaxElements);
+			}
+			return FillCommittedPages(Grown, NumBytesPerElement);
+		}
+
+		SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return CommittedBytes;
+		}
+
+		bool HasAllocation() const
+		{
+			return !!Block.GetVirtualPointer();
+		}
+
+		SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+		ForAnyElementType(const ForAnyElementType&);
+		ForAnyElementType& operator=(const ForAnyElementType&);
+
+		static FORCEINLINE SIZE_T GetCommitAlignment()
+		{
+			return FPlatformMemory::FPlatformVirtualMemoryBlock::GetCommitAlignment();
+		}
+
+		static FORCEINLINE SIZE_T AlignToCommit(SIZE_T Size)
+		{
+			const SIZE_T CommitAlignment = GetCommitAlignment();
+			return (Size + CommitAlignment - 1) & ~(CommitAlignment - 1);
+		}
+
+		/** @return the number of elements that fit in the pages NumElements needs, clamped to the reservation */
+		static SizeType FillCommittedPages(SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			if (NumElements <= 0)
+			{
+				return 0;
+			}
+			const SIZE_T Bytes = FMath::Min<SIZE_T>(AlignToCommit((SIZE_T)NumElements * NumBytesPerElement), (SIZE_T)ReserveBytes);
+			return FMath::Max<SizeType>(NumElements, (SizeType)(Bytes / NumBytesPerElement));
+		}
+
+		void Release()
+		{
+			if (Block.GetVirtualPointer())
+			{
+				Block.FreeVirtual();
+				Block = FPlatformMemory::FPlatformVirtualMemoryBlock();
+			}
+			CommittedBytes = 0;
+		}
+
+		/** The reserved range, the elements start at its base. */
+		FPlatformMemory::FPlatformVirtualMemoryBlock Block;
+
+		/** Bytes committed from the base of the range, a multiple of the commit alignment. */
+		SIZE_T CommittedBytes;
+	};
+
+	template<typename ElementType>
+	class ForElementType : public ForAnyElementType
+	{
+	public:
+		/** Default constructor. */
+		ForElementType()
+		{
+			static_assert(alignof(ElementType) <= 4096, "TVirtualMemoryAllocator elements can be aligned to a page at most");
+		}
+
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return (ElementType*)ForAnyElementType::GetAllocation();
+		}
+	};
+};
+
+template <uint64 ReserveBytes>
+struct TAllocatorTraits<TVirtualMemoryAllocator<ReserveBytes>> : TAllocatorTraitsBase<TVirtualMemoryAllocator<ReserveBytes>>
+{
+};
+
+/** Array of up to VIRTUAL_MEMORY_ALLOCATOR_DEFAULT_RESERVE bytes that grows in place, see TVirtualMemoryAllocator. */
+template <typename ElementType>
+using TVirtualMemoryArray = TArray<ElementType, TVirtualMemoryAllocator<>>;
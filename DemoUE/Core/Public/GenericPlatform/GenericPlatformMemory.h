@@ -1,9 +1,79 @@
 #pragma once
 #include "Definitions.h"
 #include "CoreTypes.h"
+#include "Misc/EnumClassFlags.h"
 
 class FString;
 
+/** Whether a copy should keep the destination in cache, or bypass it because it will not be read back soon. */
+enum class EMemcpyCachePolicy : uint8
+{
+	/** Writes go through the cache, the destination is expected to be used right after the copy. */
+	StoreCached,
+
+	/** Writes use non-temporal stores where available, leaving the working set in cache. */
+	StoreUncached,
+};
+
+/** Copies smaller than this are not worth waking the worker threads for, see FGenericPlatformMemory::ParallelMemcpy. */
+#define PARALLEL_MEMCPY_MIN_SIZE (1024 * 1024)
+
+/** Upper bound on the NUMA nodes the OS allocation stats keep apart. Allocations on higher nodes count to the last one. */
+#define OS_ALLOCATION_MAX_NUMA_NODES 8
+
+/** Opt-in placement of the pages handed out by BinnedAllocFromOS, see FGenericPlatformMemory::ConfigureOSAllocations. */
+enum class EOSAllocationFlags : uint8
+{
+	None = 0,
+
+	/** Backs allocations that are big enough with large pages, 2 MB on x64, to save TLB misses. */
+	LargePages = 1 << 0,
+
+	/** Backs allocations that are big enough with 1 GB pages, where the platform has them. */
+	HugePages = 1 << 1,
+
+	/** Places the pages on the NUMA node the allocating thread runs on, instead of where the OS first touches them. */
+	NumaLocal = 1 << 2,
+};
+ENUM_CLASS_FLAGS(EOSAllocationFlags);
+
+enum class EOSPageSize : uint8
+{
+	Default,
+	Large,
+	Huge,
+	Num,
+};
+
+/** How BinnedAllocFromOS backed an allocation, to be handed back to BinnedFreeToOS. */
+struct FOSAllocationInfo
+{
+	EOSPageSize PageSize = EOSPageSize::Default;
+
+	/** Node the pages were placed on, INDEX_NONE when they were not placed. */
+	int8 NumaNode = INDEX_NONE;
+};
+
+/** Memory currently allocated through BinnedAllocFromOS, see FGenericPlatformMemory::GetOSAllocationStats. */
+struct FOSAllocationStats
+{
+	/** Bytes in use per EOSPageSize, rounded up to the page size. */
+	uint64 BytesInUse[(uint8)EOSPageSize::Num];
+
+	/** Bytes that were placed on each node. */
+	uint64 NodeBytesInUse[OS_ALLOCATION_MAX_NUMA_NODES];
+
+	/** Allocations that were meant for large or huge pages and got default pages, because the OS had none left. */
+	uint64 LargePageFallbacks;
+
+	SIZE_T LargePageSize;
+	SIZE_T HugePageSize;
+	uint32 NumNumaNodes;
+
+	/** What ConfigureOSAllocations could turn on. */
+	EOSAllocationFlags Flags;
+};
+
 /** Generic implementation for most platforms, these tend to be unused and unimplemented. */
 struct FGenericPlatformMemory
 {
@@ -111,6 +181,31 @@ struct FGenericPlatformMemory
 		SIZE_T			Size;
 	};
 
+	/**
+	 * Generic representation of a file mapped read only into process address space
+	 */
+	struct FMappedFileRegion
+	{
+		/** Returns the first byte of the file in process address space */
+		const uint8* GetAddress() const { return Address; }
+
+		/** Returns size of the file in bytes */
+		SIZE_T			GetSize() const { return Size; }
+
+		FMappedFileRegion(const uint8* InAddress, SIZE_T InSize)
+			: Address(InAddress)
+			, Size(InSize)
+		{}
+
+	protected:
+
+		/** The mapped view of the file */
+		const uint8* Address;
+
+		/** Size of the view */
+		SIZE_T			Size;
+	};
+
 
 
 	/** Initializes platform memory specific constants. */
@@ -192,6 +287,48 @@ struct FGenericPlatformMemory
 	 */
 	static CORE_API void BinnedFreeToOS(void* Ptr, SIZE_T Size);
 
+	/**
+	 * Allocates pages from the OS with the placement set by ConfigureOSAllocations. Large pages are used when the
+	 * allocation is big enough that rounding it up to them wastes little, and default pages when the OS has none left.
+	 *
+	 * @param Size Size to allocate, not necessarily aligned
+	 * @param NumaNode node to place the pages on when EOSAllocationFlags::NumaLocal is on, INDEX_NONE for the node of the calling thread
+	 * @param OutInfo how the pages were allocated, to be passed to BinnedFreeToOS
+	 * @return OS allocated pointer for use by binned allocator
+	 */
+	static CORE_API void* BinnedAllocFromOS(SIZE_T Size, int32 NumaNode, FOSAllocationInfo& OutInfo);
+
+	/** Returns pages allocated by the placed BinnedAllocFromOS to the OS. */
+	static CORE_API void BinnedFreeToOS(void* Ptr, SIZE_T Size, const FOSAllocationInfo& Info);
+
+	/**
+	 * Turns on large pages and NUMA placement for the following calls to BinnedAllocFromOS. Flags the platform or the
+	 * process cannot support, e.g. without the privilege to lock pages in memory, are left off.
+	 *
+	 * @return the flags that are on
+	 */
+	static CORE_API EOSAllocationFlags ConfigureOSAllocations(EOSAllocationFlags Flags);
+
+	static CORE_API EOSAllocationFlags GetOSAllocationFlags();
+
+	/** @return the size of the large pages in use, 0 when EOSAllocationFlags::LargePages is off */
+	static CORE_API SIZE_T GetLargePageSize();
+
+	static CORE_API uint32 GetNumNumaNodes();
+
+	/** @return the NUMA node of the processor the calling thread runs on */
+	static CORE_API int32 GetCurrentNumaNode();
+
+	static CORE_API FOSAllocationStats GetOSAllocationStats();
+
+	/**
+	 * Splits the resident memory of the process into the pages it shares with other processes, e.g. the pages of the
+	 * parent a forked child did not write to, and the ones that are its own.
+	 *
+	 * @return false if the platform cannot tell, both are set to 0 then
+	 */
+	static CORE_API bool GetResidentMemorySharing(uint64& OutSharedBytes, uint64& OutPrivateBytes);
+
 	/**
 	 * Performs initial setup for MiMalloc.
 	 * This is a noop on platforms that do not support MiMalloc, or when MIMALLOC_ENABLED is not defined.
@@ -371,29 +508,37 @@ struct FGenericPlatformMemory
 		return memset(Dest, 0, Count);
 	}
 
+	/** Returns true if Count bytes at Ptr are all zero. Scans a vector register at a time once Ptr is aligned. */
+	static CORE_API bool MemIsZero(const void* Ptr, SIZE_T Count);
+
 	static FORCEINLINE void* Memcpy(void* Dest, const void* Src, SIZE_T Count)
 	{
 		return memcpy(Dest, Src, Count);
 	}
 
-	/** Memcpy optimized for big blocks. */
+	/** Memcpy optimized for big blocks. The CRT memcpy already is, so this only exists for platforms that know better. */
 	static FORCEINLINE void* BigBlockMemcpy(void* Dest, const void* Src, SIZE_T Count)
 	{
 		return memcpy(Dest, Src, Count);
 	}
 
-	/** On some platforms memcpy optimized for big blocks that avoid L2 cache pollution are available */
-	static FORCEINLINE void* StreamingMemcpy(void* Dest, const void* Src, SIZE_T Count)
-	{
-		return memcpy(Dest, Src, Count);
-	}
+	/**
+	 * Memcpy for big blocks that are not read back soon, e.g. GPU upload buffers. Uses non-temporal stores where
+	 * the platform has them so the copy does not evict the working set from cache. The buffers must not overlap.
+	 */
+	static CORE_API void* StreamingMemcpy(void* Dest, const void* Src, SIZE_T Count);
 
-	/** On some platforms memcpy can be distributed over multiple threads for throughput. */
-	static FORCEINLINE void* ParallelMemcpy(void* Dest, const void* Src, SIZE_T Count, EMemcpyCachePolicy Policy = EMemcpyCachePolicy::StoreCached)
-	{
-		(void)Policy;
-		return memcpy(Dest, Src, Count);
-	}
+	/**
+	 * Memcpy that splits copies of PARALLEL_MEMCPY_MIN_SIZE bytes or more over the worker threads.
+	 * StoreUncached copies each slice with StreamingMemcpy. The buffers must not overlap.
+	 */
+	static CORE_API void* ParallelMemcpy(void* Dest, const void* Src, SIZE_T Count, EMemcpyCachePolicy Policy = EMemcpyCachePolicy::StoreCached);
+
+	/**
+	 * Copies Num elements of ElementSize bytes from Src to Dest, reversing the byte order of each. Dest may equal Src
+	 * to swap in place, other overlaps are not allowed. Elements of 2, 4 and 8 bytes are swapped a vector register at a time.
+	 */
+	static CORE_API void ByteSwapCopy(void* Dest, const void* Src, SIZE_T ElementSize, SIZE_T Num);
 
 private:
 	template <typename T>
@@ -513,6 +658,25 @@ public:
 	 */
 	static CORE_API bool UnmapNamedSharedMemoryRegion(FSharedMemoryRegion* MemoryRegion);
 
+	/**
+	 * Maps a whole file read only into process address space. Pages are loaded on first access and shared with the
+	 * file cache, so reading from the view neither copies nor allocates.
+	 *
+	 * @param Filename path of the file to map
+	 *
+	 * @return pointer to FMappedFileRegion (or its descendants) if successful, NULL if not or if the platform cannot map files.
+	 */
+	static CORE_API FMappedFileRegion* MapFileRegion(const TCHAR* Filename);
+
+	/**
+	 * Unmaps a file mapped by MapFileRegion
+	 *
+	 * @param MappedRegion an object that encapsulates the mapping (will be destroyed even if function fails!)
+	 *
+	 * @return true if successful
+	 */
+	static CORE_API bool UnmapFileRegion(FMappedFileRegion* MappedRegion);
+
 	/**
 	*	Gets whether this platform supports Fast VRAM memory
 	*		Ie, whether TexCreate_FastVRAM flags actually mean something or not
@@ -580,4 +744,12 @@ protected:
 
 	/** Updates platform specific stats. This method is called through FGenericStatsUpdater from the task graph thread. */
 	static CORE_API void InternalUpdateStats(const FPlatformMemoryStats& MemoryStats);
+
+	/** Stores the flags ConfigureOSAllocations turned on. */
+	static CORE_API void SetOSAllocationFlags(EOSAllocationFlags Flags);
+
+	/** Accounts the placed allocations in GetOSAllocationStats, Bytes rounded up to the pages that back them. */
+	static CORE_API void TrackOSAllocation(SIZE_T Bytes, const FOSAllocationInfo& Info);
+	static CORE_API void TrackOSFree(SIZE_T Bytes, const FOSAllocationInfo& Info);
+	static CORE_API void TrackLargePageFallback();
 };
@@ -0,0 +1,527 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "GenericPlatform/GenericPlatformMemory.h"
+#include "HAL/MemoryBase.h"
+#include "Templates/Function.h"
+
+/** Every OS allocation made by the binned allocator is carved into slices of this size, each starting with a header. BinnedAllocFromOS must return memory aligned to it. */
+#define BINNED_SLICE_SIZE (64 * 1024)
+
+/** Size of the regions requested from the OS for small block pools. Must be a multiple of BINNED_SLICE_SIZE. */
+#define BINNED_POOL_REGION_SIZE (16 * BINNED_SLICE_SIZE)
+
+/** Largest allocation served from a small block pool, anything bigger goes straight to the OS. */
+#define BINNED_MAX_SMALL_POOL_SIZE 8192
+
+/** Number of small block size classes. */
+#define BINNED_SMALL_POOL_COUNT 32
+
+/** Alignment of every block handed out by the allocator, and the granularity of the size classes. */
+#define BINNED_MINIMUM_ALIGNMENT 16
+
+/** Largest alignment that can be honored. The header of the slice must fit before the first aligned byte. */
+#define BINNED_MAX_ALIGNMENT (BINNED_SLICE_SIZE / 2)
+
+/** Upper bound on the number of bytes a thread caches per size class before handing a bundle back to the global recycler. */
+#define BINNED_PER_BUNDLE_MAX_BYTES 32768
+
+/** Upper bound on the number of blocks in one bundle. */
+#define BINNED_PER_BUNDLE_MAX_COUNT 64
+
+/**
+ * Accounts the bytes in use per tag, see FMallocBinned::FTagScope. Costs a byte of the slice per BINNED_MINIMUM_ALIGNMENT
+ * bytes of small pool memory to remember the tag of every block, so it is off by default. Requires UPDATE_MALLOC_STATS.
+ */
+#ifndef BINNED_TAG_STATS
+#define BINNED_TAG_STATS 0
+#endif
+
+#if BINNED_TAG_STATS && !UPDATE_MALLOC_STATS
+#error BINNED_TAG_STATS requires UPDATE_MALLOC_STATS
+#endif
+
+/** Number of tags, the first FMemory::AllocationHints::Max of them are the allocation hints. */
+#define BINNED_MAX_TAGS 64
+
+/** Number of NUMA nodes with pools of their own when EOSAllocationFlags::NumaLocal is on. Higher nodes wrap around, node N uses the pools of node N % BINNED_MAX_NUMA_NODES. */
+#ifndef BINNED_MAX_NUMA_NODES
+#define BINNED_MAX_NUMA_NODES 4
+#endif
+
+/** How often UpdateStats refreshes the resident memory sharing, which parses the OS's page accounting of the process. */
+#define BINNED_RESIDENT_SHARING_UPDATE_SECONDS 10.0
+
+/**
+ * Binned small-object allocator.
+ *
+ * Allocations up to BINNED_MAX_SMALL_POOL_SIZE are rounded up to one of BINNED_SMALL_POOL_COUNT size classes and served
+ * from pools carved out of FPlatformMemory::BinnedAllocFromOS. Threads that called SetupTLSCachesOnCurrentThread() keep a
+ * private free list per size class, so the common Malloc/Free pair touches no shared state at all. Full free lists are
+ * exchanged with the other threads as whole bundles through a lock-free stack per size class; only carving fresh blocks
+ * out of a pool takes a lock. Larger allocations are forwarded to the OS.
+ *
+ * Every BINNED_SLICE_SIZE aligned slice starts with an FSliceHeader, and no block ever starts at the beginning of a slice,
+ * so the owner of any pointer is found by rounding it down to the slice alignment.
+ *
+ * With EOSAllocationFlags::NumaLocal every size class keeps its pools per NUMA node. A thread caches blocks of the node it
+ * ran on when it set up its cache, blocks freed by a thread of another node go back to the pool of their own node, so
+ * small blocks stay local to the threads that use them. Pool regions are sized to be backed by large pages when
+ * EOSAllocationFlags::LargePages is on.
+ *
+ * Every lock of the allocator is held from OnPreFork until the fork is over, in OnPostFork in the child and in
+ * OnPostForkParent in the parent, so the child never inherits a lock taken by a thread it does not have.
+ *
+ * A forked child freezes everything allocated before the fork in OnPostFork: the free lists of the parent are dropped,
+ * blocks allocated before the fork are not linked back when freed, and every later allocation is carved out of fresh
+ * regions. The allocator then never writes to the pages it shares with the parent, and they stay shared copy-on-write
+ * between all the children. The frozen free blocks are the price of that.
+ *
+ * With UPDATE_MALLOC_STATS every thread cache counts its own operations, the counters are only summed up by GetStats, so
+ * the fast path stays free of shared writes. The stats are printed by DumpAllocatorStats and the "memstats" command.
+ */
+class FMallocBinned final : public FMalloc
+{
+public:
+	CORE_API FMallocBinned();
+	CORE_API virtual ~FMallocBinned();
+
+	//~ Begin FMalloc Interface
+	CORE_API virtual void* Malloc(SIZE_T Size, uint32 Alignment) override;
+	CORE_API virtual void* Realloc(void* Ptr, SIZE_T NewSize, uint32 Alignment) override;
+	CORE_API virtual void Free(void* Ptr) override;
+	CORE_API virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override;
+	CORE_API virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override;
+	CORE_API virtual void Trim(bool bTrimThreadCaches) override;
+	CORE_API virtual void SetupTLSCachesOnCurrentThread() override;
+	CORE_API virtual void ClearAndDisableTLSCachesOnCurrentThread() override;
+	CORE_API virtual bool ValidateHeap() override;
+	CORE_API virtual void OnPreFork() override;
+	CORE_API virtual void OnPostFork() override;
+	CORE_API virtual void OnPostForkParent() override;
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return true;
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return TEXT("Binned");
+	}
+
+	CORE_API virtual void UpdateStats() override;
+	CORE_API virtual void GetAllocatorStats(FGenericMemoryStats& out_Stats) override;
+	CORE_API virtual void DumpAllocatorStats(class FOutputDevice& Ar) override;
+
+#if UE_ALLOW_EXEC_COMMANDS
+	CORE_API virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override;
+#endif
+	//~ End FMalloc Interface
+
+	/** Counters summed over every thread. Threads keep counting while they are summed, so they are only consistent once idle. */
+	struct FStats
+	{
+		struct FSizeClass
+		{
+			uint32 BlockSize;
+
+			/** Blocks handed out and not freed yet. */
+			int64 BlocksInUse;
+
+			/** Blocks carved out of OS memory so far, whether in use or cached by any thread. */
+			uint64 BlocksCarved;
+
+			uint64 Mallocs;
+			uint64 Frees;
+
+			/** Operations of threads with a TLS cache, and how many of them had to leave it. */
+			uint64 CachedMallocs;
+			uint64 CachedMallocMisses;
+			uint64 CachedFrees;
+			uint64 CachedFreeHandovers;
+		};
+		FSizeClass SizeClasses[BINNED_SMALL_POOL_COUNT];
+
+		int64 SmallBytesInUse;
+		uint64 SmallBytesCarved;
+
+		/** Allocations above BINNED_MAX_SMALL_POOL_SIZE, with the size of their whole OS allocation. */
+		int64 LargeAllocationsInUse;
+		int64 LargeBytesInUse;
+
+		/** Calls to BinnedAllocFromOS and BinnedFreeToOS, for pool regions and large allocations. */
+		uint64 OSCommits;
+		uint64 OSCommittedBytes;
+		uint64 OSDecommits;
+		uint64 OSDecommittedBytes;
+
+		/** Small pool memory carved from the regions of each node. */
+		uint64 NodeBytesCarved[BINNED_MAX_NUMA_NODES];
+
+		/** Page sizes and placement of everything allocated from the OS, by the platform. */
+		FOSAllocationStats OS;
+
+		/** Number of forks this process is down from its first ancestor, the heap before the last one is frozen. */
+		uint32 ForkGeneration;
+
+		/** Memory committed by the ancestors before the last fork, and how much of it was freed since without being reused. */
+		uint64 FrozenBytes;
+		uint64 FrozenBytesFreed;
+
+		/**
+		 * Resident memory of the process shared with other processes, e.g. the pages of the parent not written since the
+		 * fork, and the rest. Left at 0 by GetStats, refreshed by UpdateStats every BINNED_RESIDENT_SHARING_UPDATE_SECONDS
+		 * and by DumpAllocatorStats.
+		 */
+		uint64 ResidentSharedBytes;
+		uint64 ResidentPrivateBytes;
+
+#if BINNED_TAG_STATS
+		int64 TagBytesInUse[BINNED_MAX_TAGS];
+#endif
+	};
+
+	/** Gathers the current counters of every thread. */
+	CORE_API void GetStats(FStats& OutStats);
+
+	/** Called with the stats gathered by every UpdateStats, once per frame, e.g. to forward them to a metrics backend. */
+	CORE_API void SetStatsExporter(TFunction<void(const FGenericMemoryStats&)> InStatsExporter);
+
+	/**
+	 * Registers a tag for FTagScope, for allocations that do not map to an FMemory::AllocationHints. Name must outlive
+	 * the allocator, registering the same name twice returns the same tag.
+	 *
+	 * @return the tag, or FMemory::Default if BINNED_MAX_TAGS are in use
+	 */
+	static CORE_API uint8 RegisterTag(const TCHAR* Name);
+
+	/**
+	 * Accounts the allocations of the calling thread to Tag while in scope, when BINNED_TAG_STATS is on. Tags are either
+	 * an FMemory::AllocationHints or from RegisterTag. Frees are accounted to the tag of the block, wherever they happen.
+	 */
+	class FTagScope
+	{
+	public:
+		explicit FTagScope(uint8 Tag)
+		{
+#if BINNED_TAG_STATS
+			PreviousTag = CurrentTag;
+			CurrentTag = Tag < BINNED_MAX_TAGS ? Tag : 0;
+#endif
+		}
+
+		~FTagScope()
+		{
+#if BINNED_TAG_STATS
+			CurrentTag = PreviousTag;
+#endif
+		}
+
+	private:
+#if BINNED_TAG_STATS
+		uint8 PreviousTag;
+#endif
+	};
+
+private:
+	/** Intrusive link stored inside free blocks. The first block of a bundle also links to the next bundle. */
+	struct FFreeBlock
+	{
+		FFreeBlock* Next;
+		FFreeBlock* NextBundle;
+	};
+	static_assert(sizeof(FFreeBlock) <= BINNED_MINIMUM_ALIGNMENT, "Free block link must fit in the smallest block");
+
+	/** Lives at the start of every slice, for both small pools and OS allocations. */
+	struct alignas(64) FSliceHeader
+	{
+		enum : uint32 { SmallPoolMagic = 0xB1DEB1DE, OSAllocationMagic = 0xB1E5B1E5 };
+
+		uint32 Magic;
+
+		/** Size class of the blocks in this slice. Unused for OS allocations. */
+		uint32 PoolIndex;
+
+		/** Size of the whole OS allocation. Unused for small pools. */
+		SIZE_T OSAllocationSize;
+
+		/** Offset of the user pointer from the slice header. Unused for small pools. */
+		SIZE_T UserOffset;
+
+		/** Tag the OS allocation is accounted to. Small pools keep the tag of every block after the header. */
+		uint32 Tag;
+
+		/** Node of the pool the blocks of this slice belong to. Unused for OS allocations. */
+		uint8 NumaNode;
+
+		/** How the OS allocation was backed. Unused for small pools. */
+		FOSAllocationInfo OSAllocationInfo;
+
+		/** FMallocBinned::ForkGeneration when the slice was made, the slice is frozen once the process forked again. */
+		uint32 ForkGeneration;
+	};
+
+	/** Offset of the first block of a small pool slice, past the header and the tag of every block. */
+	static constexpr SIZE_T SliceBlocksOffset = sizeof(FSliceHeader) + (BINNED_TAG_STATS ? BINNED_SLICE_SIZE / BINNED_MINIMUM_ALIGNMENT : 0);
+
+	/** Lock-free LIFO of bundles. Uses a tag in the high bits of the pointer to defeat ABA. */
+	class FBundleStack
+	{
+	public:
+		void Push(FFreeBlock* Bundle);
+		FFreeBlock* Pop();
+
+		/** Forgets every bundle, only while no other thread uses the stack. */
+		void Reset()
+		{
+			TaggedTop.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr uint32 TagShift = sizeof(void*) == 8 ? 48 : 32;
+		static constexpr uint64 PointerMask = (1ull << TagShift) - 1;
+
+		std::atomic<uint64> TaggedTop{ 0 };
+	};
+
+	/** Shared state of one size class on one NUMA node. */
+	struct alignas(64) FNodePool
+	{
+		/** Bundles given back by thread caches, ready to be adopted by another thread. */
+		FBundleStack Bundles;
+
+		/** Guards the members below. */
+		std::mutex Mutex;
+
+		/** Blocks freed by threads without a TLS cache. */
+		FFreeBlock* FreeList = nullptr;
+
+		/** Uncarved space in the current slice. */
+		uint8* CarveCursor = nullptr;
+		uint8* CarveEnd = nullptr;
+
+		/** Slices of the current OS region that have not been started yet. */
+		uint8* NextSlice = nullptr;
+		uint8* RegionEnd = nullptr;
+
+#if UPDATE_MALLOC_STATS
+		/** Written under Mutex, read by GetStats without it. */
+		std::atomic<uint64> BlocksCarved{ 0 };
+		std::atomic<uint64> UncachedMallocs{ 0 };
+		std::atomic<uint64> UncachedFrees{ 0 };
+#endif
+	};
+
+	/** Shared state of one size class. */
+	struct FSmallPool
+	{
+		uint32 BlockSize = 0;
+
+		/** Number of blocks a thread cache holds before it hands them over as one bundle. */
+		uint32 BundleBlockCount = 0;
+
+		/** Only the first one is used unless EOSAllocationFlags::NumaLocal is on. */
+		FNodePool Nodes[BINNED_MAX_NUMA_NODES];
+
+#if UPDATE_MALLOC_STATS
+		/** Blocks from before the last fork freed since, by any thread. */
+		std::atomic<uint64> FrozenFrees{ 0 };
+#endif
+	};
+
+#if UPDATE_MALLOC_STATS
+	/** Counters of the cached operations of one thread. Only the owner writes them, GetStats reads them from any thread. */
+	struct FThreadStats
+	{
+		std::atomic<uint64> Mallocs[BINNED_SMALL_POOL_COUNT];
+		std::atomic<uint64> Frees[BINNED_SMALL_POOL_COUNT];
+
+		/** Mallocs that found the list empty, and frees that filled it up and handed it over. */
+		std::atomic<uint64> MallocMisses[BINNED_SMALL_POOL_COUNT];
+		std::atomic<uint64> FreeHandovers[BINNED_SMALL_POOL_COUNT];
+
+#if BINNED_TAG_STATS
+		/** Frees on another thread than the malloc make single shards negative, only their sum is meaningful. */
+		std::atomic<int64> TagBytes[BINNED_MAX_TAGS];
+#endif
+	};
+#endif
+
+	/** Per thread free lists, one per size class. */
+	struct FPerThreadCache
+	{
+		FMallocBinned* Owner;
+		FFreeBlock* Lists[BINNED_SMALL_POOL_COUNT];
+		uint32 Counts[BINNED_SMALL_POOL_COUNT];
+		uint32 TrimEpoch;
+
+		/** Node of the pools the cached blocks come from. */
+		uint32 NumaNode;
+		FPerThreadCache* NextRegistered;
+#if UPDATE_MALLOC_STATS
+		FThreadStats Stats;
+#endif
+	};
+
+	FORCEINLINE static FSliceHeader* GetSliceHeader(void* Ptr)
+	{
+		return (FSliceHeader*)((UPTRINT)Ptr & ~(UPTRINT)(BINNED_SLICE_SIZE - 1));
+	}
+
+	/** @return the size class for the request or BINNED_SMALL_POOL_COUNT if it has to go to the OS */
+	FORCEINLINE uint32 GetPoolIndex(SIZE_T Size, uint32 Alignment) const
+	{
+		if (Size > BINNED_MAX_SMALL_POOL_SIZE)
+		{
+			return BINNED_SMALL_POOL_COUNT;
+		}
+		uint32 PoolIndex = SizeToPoolIndex[(Size + BINNED_MINIMUM_ALIGNMENT - 1) / BINNED_MINIMUM_ALIGNMENT];
+		if (Alignment > BINNED_MINIMUM_ALIGNMENT)
+		{
+			PoolIndex = GetAlignedPoolIndex(PoolIndex, Alignment);
+		}
+		return PoolIndex;
+	}
+
+	FORCEINLINE FPerThreadCache* GetThreadCache()
+	{
+		FPerThreadCache* Cache = ThreadCache;
+		return (Cache && Cache->Owner == this) ? Cache : nullptr;
+	}
+
+	uint32 GetAlignedPoolIndex(uint32 PoolIndex, uint32 Alignment) const;
+
+	/** @return the node whose pools serve the calling thread, 0 unless EOSAllocationFlags::NumaLocal is on */
+	FORCEINLINE static uint32 GetThreadNumaNode()
+	{
+		if (ThreadNumaNode < 0)
+		{
+			ThreadNumaNode = ComputeThreadNumaNode();
+		}
+		return (uint32)ThreadNumaNode;
+	}
+	static int8 ComputeThreadNumaNode();
+
+#if UPDATE_MALLOC_STATS
+	/** Single writer increment, cheaper than an atomic read-modify-write. */
+	template <typename CounterType>
+	FORCEINLINE static void BumpStat(std::atomic<CounterType>& Counter, CounterType Amount)
+	{
+		Counter.store(Counter.load(std::memory_order_relaxed) + Amount, std::memory_order_relaxed);
+	}
+#endif
+
+#if BINNED_TAG_STATS
+	FORCEINLINE static uint8& GetBlockTag(void* Block)
+	{
+		uint8* Tags = (uint8*)GetSliceHeader(Block) + sizeof(FSliceHeader);
+		return Tags[((UPTRINT)Block & (BINNED_SLICE_SIZE - 1)) / BINNED_MINIMUM_ALIGNMENT];
+	}
+#endif
+
+	FORCEINLINE void TrackCachedMalloc(FPerThreadCache& Cache, void* Block, uint32 PoolIndex)
+	{
+#if UPDATE_MALLOC_STATS
+		BumpStat<uint64>(Cache.Stats.Mallocs[PoolIndex], 1);
+#if BINNED_TAG_STATS
+		const uint8 Tag = CurrentTag;
+		GetBlockTag(Block) = Tag;
+		BumpStat<int64>(Cache.Stats.TagBytes[Tag], SmallPools[PoolIndex].BlockSize);
+#endif
+#endif
+	}
+
+	FORCEINLINE void TrackCachedFree(FPerThreadCache& Cache, void* Block, uint32 PoolIndex)
+	{
+#if UPDATE_MALLOC_STATS
+		BumpStat<uint64>(Cache.Stats.Frees[PoolIndex], 1);
+#if BINNED_TAG_STATS
+		BumpStat<int64>(Cache.Stats.TagBytes[GetBlockTag(Block)], -(int64)SmallPools[PoolIndex].BlockSize);
+#endif
+#endif
+	}
+
+	void* MallocSmallCached(FPerThreadCache& Cache, uint32 PoolIndex);
+	void FreeSmallCached(FPerThreadCache& Cache, FFreeBlock* Block, uint32 PoolIndex);
+	void* MallocSmallUncached(uint32 PoolIndex);
+
+	/** Returns a block to the pool of its node, from threads without a cache or from another node. */
+	void FreeSmallUncached(FFreeBlock* Block, uint32 PoolIndex, uint32 NumaNode);
+
+	/** Carves up to Count fresh blocks out of the pool of a node, linked through Next. Node.Mutex must be held. */
+	FFreeBlock* CarveBlocks(FSmallPool& Pool, FNodePool& Node, uint32 PoolIndex, uint32 NumaNode, uint32 Count);
+
+	void* MallocOS(SIZE_T Size, uint32 Alignment);
+	void FreeOS(FSliceHeader* Header);
+
+	/** Forgets a block allocated before the last fork, linking it anywhere would dirty a shared page. */
+	void FreeFrozen(void* Block, uint32 PoolIndex);
+
+#if UPDATE_MALLOC_STATS
+	/** Adds the counters of a thread cache that goes away to RetiredStats. RegistrationMutex must be held. */
+	void RetireThreadStats(const FThreadStats& ThreadStats);
+#endif
+
+	/** Hands all blocks cached by the thread back to the global recyclers. */
+	void FlushThreadCache(FPerThreadCache& Cache);
+
+	/**
+	 * Takes every lock of the allocator, so none is held by a thread that does not make it into the child. In the order
+	 * they nest: the tag registry, StatsMutex, RegistrationMutex, then the node pools by size class and node.
+	 */
+	void LockForFork();
+	void UnlockAfterFork();
+
+	FSmallPool SmallPools[BINNED_SMALL_POOL_COUNT];
+
+	/** Maps (Size + 15) / 16 to a size class. */
+	uint8 SizeToPoolIndex[BINNED_MAX_SMALL_POOL_SIZE / BINNED_MINIMUM_ALIGNMENT + 1];
+
+	/** Number of OnPostFork calls, stamped into every new slice. Only changes while the child is single threaded. */
+	uint32 ForkGeneration = 0;
+
+	/** Bumped by Trim(true), thread caches from an older epoch flush themselves the next time they hit a slow path. */
+	std::atomic<uint32> TrimEpoch{ 0 };
+
+	/** Guards RegisteredCaches and RetiredStats. */
+	std::mutex RegistrationMutex;
+	FPerThreadCache* RegisteredCaches = nullptr;
+
+#if UPDATE_MALLOC_STATS
+	/** Counters of the thread caches that were cleared. */
+	FThreadStats RetiredStats{};
+
+	std::atomic<int64> LargeAllocationsInUse{ 0 };
+	std::atomic<int64> LargeBytesInUse{ 0 };
+	std::atomic<uint64> OSCommits{ 0 };
+	std::atomic<uint64> OSCommittedBytes{ 0 };
+	std::atomic<uint64> OSDecommits{ 0 };
+	std::atomic<uint64> OSDecommittedBytes{ 0 };
+	uint64 FrozenBytes = 0;
+
+#if BINNED_TAG_STATS
+	/** Bytes of uncached small blocks and of OS allocations. */
+	std::atomic<int64> SharedTagBytes[BINNED_MAX_TAGS]{};
+#endif
+
+	/** Guards LastStats, StatsExporter and the last resident sharing. */
+	std::mutex StatsMutex;
+	FStats LastStats{};
+	double ResidentSharingUpdateTime = -BINNED_RESIDENT_SHARING_UPDATE_SECONDS;
+	uint64 ResidentSharedBytes = 0;
+	uint64 ResidentPrivateBytes = 0;
+	TFunction<void(const FGenericMemoryStats&)> StatsExporter;
+#endif
+
+	static thread_local FPerThreadCache* ThreadCache;
+
+	/** Node of the pools the thread allocates from without a cache, INDEX_NONE until first needed. */
+	static thread_local int8 ThreadNumaNode;
+
+#if BINNED_TAG_STATS
+	static thread_local uint8 CurrentTag;
+#endif
+};
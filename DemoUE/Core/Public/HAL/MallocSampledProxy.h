@@ -0,0 +1,256 @@
+#pragma once
+#include <mutex>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "GenericPlatform/GenericPlatformMemory.h"
+#include "HAL/MemoryBase.h"
+
+/** One allocation in this many is sampled on average, unless -MallocSampleRate= says otherwise. */
+#define SAMPLED_MALLOC_DEFAULT_SAMPLE_RATE 1000
+
+/** Largest allocation that can be sampled, the size of the slots sampled allocations are placed in. */
+#define SAMPLED_MALLOC_MAX_SIZE (64 * 1024)
+
+/** Number of slots, the most sampled allocations live or in quarantine at once. */
+#define SAMPLED_MALLOC_NUM_SLOTS 4096
+
+/** Freed samples are kept out of reuse until the quarantine holds more than this many bytes or half of the slots. */
+#define SAMPLED_MALLOC_QUARANTINE_BYTES (32 * 1024 * 1024)
+
+/** Fill of freed samples in ESampledMallocMode::Poison, and of fresh ones to make uninitialized reads stand out. */
+#define SAMPLED_MALLOC_FREED_FILL 0xDD
+#define SAMPLED_MALLOC_FRESH_FILL 0xCD
+
+enum class ESampledMallocMode : uint8
+{
+	/** Freed samples are page protected while in quarantine, any access to them faults at the faulty instruction. */
+	Purgatory,
+
+	/** Freed samples are filled and checked when they leave the quarantine. Catches writes only, and late, but keeps the pages accessible for debugging. */
+	Poison,
+};
+
+/**
+ * Proxy that checks a sample of the allocations for use after free and overruns, at a cost low enough for live builds.
+ *
+ * Every thread counts down to its next sample, drawn at random with a mean of the sample rate, so the allocations that
+ * are not sampled only pay for a thread local decrement and Free for a range check. A sampled allocation gets a slot of
+ * its own in a range reserved up front: it is committed right against an uncommitted guard page, so running off its end
+ * faults, and when freed it goes into a quarantine instead of being reused, protected or poisoned per the mode. Samples
+ * leave the quarantine oldest first. Allocations larger than SAMPLED_MALLOC_MAX_SIZE or aligned past a page are never
+ * sampled. Everything else is forwarded to the wrapped allocator.
+ */
+class FMallocSampledProxy final : public FMalloc
+{
+public:
+	/** @param InSampleRate sample one in this many allocations, 1 samples every allocation that fits */
+	CORE_API FMallocSampledProxy(FMalloc* InUsedMalloc, ESampledMallocMode InMode, uint32 InSampleRate = SAMPLED_MALLOC_DEFAULT_SAMPLE_RATE);
+	CORE_API virtual ~FMallocSampledProxy();
+
+	//~ Begin FMalloc Interface
+	CORE_API virtual void* Malloc(SIZE_T Count, uint32 Alignment) override;
+	CORE_API virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override;
+	CORE_API virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override;
+	CORE_API virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override;
+	CORE_API virtual void Free(void* Original) override;
+	CORE_API virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override;
+	CORE_API virtual void DumpAllocatorStats(class FOutputDevice& Ar) override;
+
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+	{
+		return UsedMalloc->QuantizeSize(Count, Alignment);
+	}
+
+	virtual void Trim(bool bTrimThreadCaches) override
+	{
+		UsedMalloc->Trim(bTrimThreadCaches);
+	}
+
+	virtual void SetupTLSCachesOnCurrentThread() override
+	{
+		UsedMalloc->SetupTLSCachesOnCurrentThread();
+	}
+
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+	{
+		UsedMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+
+	virtual void InitializeStatsMetadata() override
+	{
+		UsedMalloc->InitializeStatsMetadata();
+	}
+
+	virtual void UpdateStats() override
+	{
+		UsedMalloc->UpdateStats();
+	}
+
+	virtual void GetAllocatorStats(FGenericMemoryStats& out_Stats) override
+	{
+		UsedMalloc->GetAllocatorStats(out_Stats);
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return UsedMalloc->IsInternallyThreadSafe();
+	}
+
+	virtual bool ValidateHeap() override
+	{
+		return UsedMalloc->ValidateHeap();
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return Mode == ESampledMallocMode::Purgatory ? TEXT("SampledPurgatory") : TEXT("SampledPoison");
+	}
+
+	virtual void OnMallocInitialized() override
+	{
+		UsedMalloc->OnMallocInitialized();
+	}
+
+	virtual void OnPreFork() override
+	{
+		UsedMalloc->OnPreFork();
+	}
+
+	virtual void OnPostFork() override
+	{
+		UsedMalloc->OnPostFork();
+	}
+
+	virtual void OnPostForkParent() override
+	{
+		UsedMalloc->OnPostForkParent();
+	}
+
+#if UE_ALLOW_EXEC_COMMANDS
+	CORE_API virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override;
+#endif
+	//~ End FMalloc Interface
+
+	struct FStats
+	{
+		/** Allocations sampled, and the samples skipped because every slot was live. */
+		uint64 NumSampled;
+		uint64 NumSkipped;
+
+		int32 NumLive;
+		uint64 LiveBytes;
+
+		/** Freed samples waiting in quarantine, with the bytes they keep committed. */
+		int32 NumQuarantined;
+		uint64 QuarantinedBytes;
+	};
+	CORE_API void GetStats(FStats& OutStats);
+
+	ESampledMallocMode GetMode() const
+	{
+		return Mode;
+	}
+
+private:
+	enum class ESlotState : uint8
+	{
+		Free,
+		Live,
+		Quarantined,
+	};
+
+	struct FSlot
+	{
+		/** Requested size, and where the allocation starts in the slot. */
+		uint32 Size;
+		uint32 Offset;
+
+		/** Next slot of the free list or of the quarantine. */
+		int32 Next;
+		ESlotState State;
+	};
+
+	/** Misuse found under the lock, logged as fatal once it is released, UE_LOG may allocate. */
+	struct FSampledError
+	{
+		enum class EKind : uint8
+		{
+			None,
+			DoubleFree,
+			InvalidFree,
+			WriteAfterFree,
+		};
+
+		EKind Kind = EKind::None;
+		const void* Ptr = nullptr;
+		uint32 Size = 0;
+
+		/** First byte written to after the free. */
+		uint32 Offset = 0;
+	};
+
+	FORCEINLINE bool IsSampled(const void* Ptr) const
+	{
+		return (UPTRINT)Ptr - (UPTRINT)Block.GetVirtualPointer() < ReservedSize;
+	}
+
+	/** @return the sampled allocation, null if it cannot be sampled */
+	void* MallocSampled(SIZE_T Count, uint32 Alignment);
+	void FreeSampled(void* Ptr);
+	SIZE_T GetSampledSize(void* Ptr);
+	void* ReallocSampled(void* Original, SIZE_T Count, uint32 Alignment);
+
+	/**
+	 * Sends the oldest samples of the quarantine back to the free list until it is within its bounds.
+	 * Stops at the first sample written to after its free, and describes it in OutError.
+	 */
+	void EvictQuarantine(int32 MaxSlots, uint64 MaxBytes, FSampledError& OutError);
+
+	/** @return false if the freed allocation was written to, with the details in OutError */
+	bool CheckPoison(const FSlot& Slot, int32 SlotIndex, FSampledError& OutError);
+
+	/** Logs Error as fatal, must be called without holding Mutex. */
+	void ReportError(const FSampledError& Error);
+
+	uint8* GetSlotBase(int32 SlotIndex) const
+	{
+		return (uint8*)Block.GetVirtualPointer() + (SIZE_T)SlotIndex * SlotStride;
+	}
+
+	/** Committed part of a slot, from the page holding the start of the allocation to the guard page. */
+	SIZE_T GetCommitOffset(const FSlot& Slot) const
+	{
+		return Slot.Offset & ~(PageSize - 1);
+	}
+
+	/** Allocations until the thread samples one. */
+	static thread_local int32 SampleCountdown;
+
+	/** State of the thread's interval generator, 0 until the thread drew its first interval. */
+	static thread_local uint32 SampleRandom;
+
+	int32 NextSampleInterval() const;
+
+	/** Counts an allocation down, @return whether it is sampled */
+	bool ShouldSample() const;
+
+	FMalloc* UsedMalloc;
+	ESampledMallocMode Mode;
+	uint32 SampleRate;
+
+	FPlatformMemory::FPlatformVirtualMemoryBlock Block;
+	SIZE_T ReservedSize = 0;
+	SIZE_T PageSize;
+
+	/** Bytes of a slot that can be committed, then a guard page. */
+	SIZE_T SlotUsableSize;
+	SIZE_T SlotStride;
+
+	/** Guards everything below. Only sampled allocations take it. */
+	std::mutex Mutex;
+	FSlot Slots[SAMPLED_MALLOC_NUM_SLOTS];
+	int32 FreeHead = INDEX_NONE;
+	int32 QuarantineHead = INDEX_NONE;
+	int32 QuarantineTail = INDEX_NONE;
+	FStats Stats = {};
+};
@@ -5,6 +5,9 @@
 
 template <typename T> class TAtomic;
 
+/** The global memory allocator. */
+extern CORE_API class FMalloc* GMalloc;
+
 #ifndef UPDATE_MALLOC_STATS
 #define UPDATE_MALLOC_STATS 1
 #endif
@@ -64,6 +67,7 @@ class FMalloc :
 	public FUseSystemMallocForNew,
 	public FExec
 {
+public:
 	/**
 	 * Malloc
 	 */
@@ -203,9 +207,16 @@ class FMalloc :
 
 	/**
 	 * Notifies the malloc implementation that the process has forked so we can try and avoid dirtying pre-fork pages.
+	 * Called in the child only.
 	 */
 	virtual void OnPostFork() {}
 
+	/**
+	 * Notifies the malloc implementation that the process has forked, called in the parent. Nothing may be allocated
+	 * between OnPreFork and the call to OnPostFork or OnPostForkParent that follows the fork.
+	 */
+	virtual void OnPostForkParent() {}
+
 protected:
 	friend struct FCurrentFrameCalls;
 
@@ -214,4 +225,4 @@ public:
 	/** Limits the maximum single allocation, to this many bytes, for debugging */
 	static CORE_API TAtomic<uint64> MaxSingleAlloc;
 #endif
-}
\ No newline at end of file
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include "Definitions.h"
 #include "Windows/WindowsPlatform.h"
+#include "ProfilingDebugging/CoreTrace.h"
 
 /*-----------------------------------------------------------------------------
 	FMemory.
@@ -52,18 +53,7 @@ struct FMemory
 	/** Returns true if memory is zeroes, false otherwise. */
 	static FORCEINLINE bool MemIsZero(const void* Ptr, SIZE_T Count)
 	{
-		// first pass implementation
-		uint8* Start = (uint8*)Ptr;
-		uint8* End = Start + Count;
-		while (Start < End)
-		{
-			if ((*Start++) != 0)
-			{
-				return false;
-			}
-		}
-
-		return true;
+		return FPlatformMemory::MemIsZero(Ptr, Count);
 	}
 
 	template< class T >
@@ -110,13 +100,14 @@ struct FMemory
 	//
 	static FORCEINLINE void* SystemMalloc(SIZE_T Size)
 	{
-		/* TODO: Trace! */
-		return ::malloc(Size);
+		void* Ptr = ::malloc(Size);
+		UE_TRACE_MEMORY_ALLOC(Ptr, Size, 0);
+		return Ptr;
 	}
 
 	static FORCEINLINE void SystemFree(void* Ptr)
 	{
-		/* TODO: Trace! */
+		UE_TRACE_MEMORY_FREE(Ptr);
 		::free(Ptr);
 	}
 
@@ -169,12 +160,14 @@ struct FMemory
 	static CORE_API void TestMemory();
 	/**
 	* Called once main is started and we have -purgatorymallocproxy.
-	* This uses the purgatory malloc proxy to check if things are writing to stale pointers.
+	* This wraps GMalloc in FMallocSampledProxy, which page protects a sample of the freed allocations to catch accesses
+	* through stale pointers. One allocation in -MallocSampleRate= is sampled, SAMPLED_MALLOC_DEFAULT_SAMPLE_RATE by default.
 	*/
 	static CORE_API void EnablePurgatoryTests();
 	/**
-	* Called once main is started and we have -purgatorymallocproxy.
-	* This uses the purgatory malloc proxy to check if things are writing to stale pointers.
+	* Called once main is started and we have -poisonmallocproxy.
+	* Same as EnablePurgatoryTests, but the sampled allocations are poisoned when freed and checked for writes later.
+	* Only the first of the two calls has an effect.
 	*/
 	static CORE_API void EnablePoisonTests();
 	/**
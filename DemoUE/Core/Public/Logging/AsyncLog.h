@@ -0,0 +1,283 @@
+#pragma once
+#include <atomic>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "Logging/LogVerbosity.h"
+#include "ProfilingDebugging/CoreTrace.h"
+#include "Traits/IsCharType.h"
+
+/**
+ * Compiles in the path of UE_LOG that captures the arguments instead of formatting them, used by async logging, by
+ * the binary log and by the log channel of the trace. All still have to be turned on, see SetAsyncLoggingEnabled,
+ * FBinaryLog and FCoreTrace.
+ */
+#ifndef UE_WITH_ASYNC_LOGGING
+#define UE_WITH_ASYNC_LOGGING 1
+#endif
+
+/** Size of the ring buffer of every thread that logs asynchronously. */
+#define ASYNC_LOG_THREAD_BUFFER_SIZE (64 * 1024)
+
+class FLogCategoryBase;
+
+namespace UE::Logging::Private
+{
+	struct FStaticBasicLogRecord;
+
+	CORE_API void BasicLog(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, ...);
+
+	/** How an argument was captured, so the binary log can be expanded without the code that logged it. */
+	enum class EBinaryLogArgType : uint8
+	{
+		Int8,
+		UInt8,
+		Int16,
+		UInt16,
+		Int32,
+		UInt32,
+		Int64,
+		UInt64,
+		Float,
+		Double,
+		Pointer,
+		/** Strings by the size of their characters, ANSICHAR and UTF8CHAR are both String8. */
+		String8,
+		String16,
+		String32,
+	};
+
+	/** Arguments of one log call, packed as described by GetAsyncLogArgSize. */
+	struct FCapturedLogArgs
+	{
+		const uint8* Payload;
+		uint32 PayloadSize;
+
+		/** FPlatformTime::Cycles64 of the log call. */
+		uint64 Cycles;
+	};
+
+	/** Formats and dispatches a captured record, on the log thread for async records. */
+	typedef void (*FAsyncLogDispatchFunction)(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, const FCapturedLogArgs& Args);
+
+	extern CORE_API std::atomic<bool> GAsyncLoggingEnabled;
+
+	/** Set while a binary log is open, see FBinaryLog. */
+	extern CORE_API std::atomic<bool> GBinaryLogOpen;
+
+	/**
+	 * Writes a record to the binary log. The first record of a log site in the file is preceded by the site's metadata.
+	 *
+	 * @return false if the record goes to the binary log only and must not be formatted
+	 */
+	CORE_API bool WriteBinaryLogRecord(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, const EBinaryLogArgType* ArgTypes, int32 NumArgs, const FCapturedLogArgs& Args);
+
+	/** Writes what the binary log buffered so far to disk. */
+	void FlushBinaryLogBuffer();
+
+	/**
+	 * Reserves a record of PayloadSize bytes in the calling thread's ring buffer. Waits for the log thread when the buffer
+	 * is full.
+	 *
+	 * @return where to write the payload before calling EndAsyncLogRecord, or nullptr when the record has to be logged
+	 *         synchronously (it is too large, or this is the log thread itself)
+	 */
+	CORE_API uint8* BeginAsyncLogRecord(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, FAsyncLogDispatchFunction Dispatch, uint32 PayloadSize);
+
+	/** Publishes the record reserved by BeginAsyncLogRecord to the log thread. */
+	CORE_API void EndAsyncLogRecord();
+
+	/** Strings are copied into the record, they rarely outlive the log call. Anything else is copied by value. */
+	template <typename ArgType>
+	constexpr bool IsAsyncLogString = std::is_pointer_v<ArgType> && TIsCharType<std::remove_cv_t<std::remove_pointer_t<ArgType>>>::Value;
+
+	/** Every argument starts on an 8 byte boundary, strings are prefixed by their length or -1 for nullptr. */
+	template <typename ArgType>
+	FORCEINLINE uint32 GetAsyncLogArgSize(ArgType Arg, int64& OutLength)
+	{
+		if constexpr (IsAsyncLogString<ArgType>)
+		{
+			typedef std::remove_cv_t<std::remove_pointer_t<ArgType>> CharType;
+			OutLength = -1;
+			if (!Arg)
+			{
+				return sizeof(int64);
+			}
+			OutLength = 0;
+			while (Arg[OutLength])
+			{
+				++OutLength;
+			}
+			return sizeof(int64) + (((uint32)(OutLength + 1) * sizeof(CharType) + 7) & ~7u);
+		}
+		else
+		{
+			return (sizeof(ArgType) + 7) & ~7u;
+		}
+	}
+
+	template <typename ArgType>
+	FORCEINLINE void WriteAsyncLogArg(uint8*& Payload, ArgType Arg, int64 Length)
+	{
+		if constexpr (IsAsyncLogString<ArgType>)
+		{
+			typedef std::remove_cv_t<std::remove_pointer_t<ArgType>> CharType;
+			memcpy(Payload, &Length, sizeof(Length));
+			Payload += sizeof(int64);
+			if (Length >= 0)
+			{
+				const uint32 NumBytes = (uint32)(Length + 1) * sizeof(CharType);
+				memcpy(Payload, Arg, NumBytes);
+				Payload += (NumBytes + 7) & ~7u;
+			}
+		}
+		else
+		{
+			memcpy(Payload, &Arg, sizeof(ArgType));
+			Payload += (sizeof(ArgType) + 7) & ~7u;
+		}
+	}
+
+	template <typename ArgType>
+	FORCEINLINE ArgType ReadAsyncLogArg(const uint8*& Payload)
+	{
+		if constexpr (IsAsyncLogString<ArgType>)
+		{
+			typedef std::remove_cv_t<std::remove_pointer_t<ArgType>> CharType;
+			int64 Length;
+			memcpy(&Length, Payload, sizeof(Length));
+			Payload += sizeof(int64);
+			if (Length < 0)
+			{
+				return nullptr;
+			}
+			// The copy lives in the record, which stays untouched until the dispatch returns.
+			ArgType String = (ArgType)Payload;
+			Payload += ((uint32)(Length + 1) * sizeof(CharType) + 7) & ~7u;
+			return String;
+		}
+		else
+		{
+			ArgType Arg;
+			memcpy(&Arg, Payload, sizeof(ArgType));
+			Payload += (sizeof(ArgType) + 7) & ~7u;
+			return Arg;
+		}
+	}
+
+	template <typename ArgType>
+	constexpr EBinaryLogArgType GetBinaryLogArgType()
+	{
+		if constexpr (IsAsyncLogString<ArgType>)
+		{
+			constexpr SIZE_T CharSize = sizeof(std::remove_pointer_t<ArgType>);
+			static_assert(CharSize == 1 || CharSize == 2 || CharSize == 4, "Unsupported character type.");
+			return CharSize == 1 ? EBinaryLogArgType::String8 : CharSize == 2 ? EBinaryLogArgType::String16 : EBinaryLogArgType::String32;
+		}
+		else if constexpr (std::is_pointer_v<ArgType> || std::is_null_pointer_v<ArgType>)
+		{
+			return EBinaryLogArgType::Pointer;
+		}
+		else if constexpr (std::is_floating_point_v<ArgType>)
+		{
+			static_assert(sizeof(ArgType) <= sizeof(double), "long double cannot be logged.");
+			return sizeof(ArgType) == sizeof(float) ? EBinaryLogArgType::Float : EBinaryLogArgType::Double;
+		}
+		else if constexpr (std::is_enum_v<ArgType>)
+		{
+			return GetBinaryLogArgType<std::underlying_type_t<ArgType>>();
+		}
+		else
+		{
+			static_assert(std::is_integral_v<ArgType>, "Unsupported log argument type.");
+			constexpr bool bSigned = std::is_signed_v<ArgType>;
+			constexpr uint8 SizeIndex = sizeof(ArgType) == 1 ? 0 : sizeof(ArgType) == 2 ? 1 : sizeof(ArgType) == 4 ? 2 : 3;
+			return (EBinaryLogArgType)((uint8)EBinaryLogArgType::Int8 + SizeIndex * 2 + (bSigned ? 0 : 1));
+		}
+	}
+
+	template <typename... ArgTypes>
+	void DispatchAsyncLogRecord(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, const FCapturedLogArgs& Captured)
+	{
+		static constexpr EBinaryLogArgType BinaryArgTypes[sizeof...(ArgTypes) + 1] = { GetBinaryLogArgType<ArgTypes>()... };
+		if (UE_TRACE_LOG_ENABLED())
+		{
+			::UE::Trace::Private::TraceLogRecord(Category, Log, BinaryArgTypes, sizeof...(ArgTypes), Captured);
+		}
+		if (GBinaryLogOpen.load(std::memory_order_relaxed))
+		{
+			if (!WriteBinaryLogRecord(Category, Log, BinaryArgTypes, sizeof...(ArgTypes), Captured))
+			{
+				return;
+			}
+		}
+
+		// Braced initialization evaluates left to right, function arguments would not.
+		const uint8* Payload = Captured.Payload;
+		std::tuple<ArgTypes...> Args{ ReadAsyncLogArg<ArgTypes>(Payload)... };
+		(void)Payload;
+		std::apply([&Category, Log](ArgTypes... Values) { BasicLog(Category, Log, Values...); }, Args);
+	}
+
+	/**
+	 * Async counterpart of BasicLog: captures the record and the raw arguments into the calling thread's ring buffer,
+	 * the log thread formats them and writes them to the output devices. With async logging off, the arguments are only
+	 * captured for the binary log and the trace, on the stack, and BasicLog is called directly when neither wants them.
+	 */
+	template <typename... ArgTypes>
+	void AsyncLog(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, ArgTypes... Args)
+	{
+		static_assert((std::is_trivially_copyable_v<ArgTypes> && ...), "Log arguments must be trivially copyable.");
+
+		const bool bAsync = GAsyncLoggingEnabled.load(std::memory_order_relaxed);
+		if (bAsync || GBinaryLogOpen.load(std::memory_order_relaxed) || UE_TRACE_LOG_ENABLED())
+		{
+			int64 Lengths[sizeof...(ArgTypes) + 1];
+			int32 Index = 0;
+			uint32 PayloadSize = 0;
+			((PayloadSize += GetAsyncLogArgSize(Args, Lengths[Index++])), ...);
+
+			if (bAsync)
+			{
+				if (uint8* Payload = BeginAsyncLogRecord(Category, Log, &DispatchAsyncLogRecord<ArgTypes...>, PayloadSize))
+				{
+					Index = 0;
+					(WriteAsyncLogArg(Payload, Args, Lengths[Index++]), ...);
+					EndAsyncLogRecord();
+					return;
+				}
+			}
+			else
+			{
+				alignas(8) uint8 StackPayload[512];
+				uint8* const Payload = PayloadSize <= sizeof(StackPayload) ? StackPayload : (uint8*)FMemory::Malloc(PayloadSize, 8);
+				uint8* Cursor = Payload;
+				Index = 0;
+				(WriteAsyncLogArg(Cursor, Args, Lengths[Index++]), ...);
+				DispatchAsyncLogRecord<ArgTypes...>(Category, Log, { Payload, PayloadSize, FPlatformTime::Cycles64() });
+				if (Payload != StackPayload)
+				{
+					FMemory::Free(Payload);
+				}
+				return;
+			}
+		}
+		BasicLog(Category, Log, Args...);
+	}
+}
+
+/**
+ * Turns the async path of UE_LOG on or off. Turning it off flushes it first. Fatal logs are always synchronous, they
+ * flush the records still queued before they are written.
+ */
+CORE_API void SetAsyncLoggingEnabled(bool bEnabled);
+
+/**
+ * Blocks until every record queued so far by any thread is dispatched, and the binary log, if open, is written to disk.
+ * Does nothing on the log thread itself.
+ */
+CORE_API void FlushAsyncLog();
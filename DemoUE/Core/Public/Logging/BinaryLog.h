@@ -0,0 +1,43 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Logging/AsyncLog.h"
+
+/** Bump when the layout of the binary log changes, ExpandToText only reads its own version. */
+#define BINARY_LOG_VERSION 1
+
+/** Buffered records are written to disk once they reach this size, or on Flush. */
+#define BINARY_LOG_BUFFER_SIZE (64 * 1024)
+
+/**
+ * Compact log sink. Every UE_LOG site is described once per file, the first time it logs: its category, verbosity,
+ * file, line, format string and argument types. Its records after that only carry the site id, a timestamp and the
+ * packed arguments, nothing is formatted at runtime. ExpandToText turns the file back into a text log offline.
+ *
+ * Records are written by the log thread when async logging is on, by the logging thread under a lock otherwise.
+ * Fatal logs always go to the text output devices as well. Requires UE_WITH_ASYNC_LOGGING.
+ */
+class FBinaryLog
+{
+public:
+	/**
+	 * Starts writing the records of every UE_LOG site to Filename, closing the previous binary log if any.
+	 *
+	 * @param bReplaceTextOutput records only go to the binary log, they are not formatted for the output devices
+	 */
+	static CORE_API bool Open(const TCHAR* Filename, bool bReplaceTextOutput = false);
+
+	/** Writes the remaining records and closes the file. */
+	static CORE_API void Close();
+
+	/** Writes the records logged so far to disk, including the ones still queued for the log thread. */
+	static CORE_API void Flush();
+
+	static CORE_API bool IsOpen();
+
+	/**
+	 * Expands a binary log to a UTF-8 text log with one line per record, "[time]Category: Verbosity: Message" like the
+	 * text output devices format them. For offline tools, it does not need the code that wrote the log.
+	 */
+	static CORE_API bool ExpandToText(const TCHAR* BinaryLogFilename, const TCHAR* TextFilename);
+};
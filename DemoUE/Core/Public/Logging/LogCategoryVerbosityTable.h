@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Logging/LogVerbosity.h"
+
+/** Number of slots of the table, the categories past it are checked with FLogCategoryBase::IsSuppressed. */
+#define LOG_CATEGORY_VERBOSITY_TABLE_SIZE 4096
+
+class FLogCategoryBase;
+class FName;
+class FString;
+
+namespace UE::Logging::Private
+{
+	/** Slot of the sites that did not run yet. */
+	inline constexpr uint32 UnregisteredLogCategorySlot = 0;
+
+	/** Slot of the sites whose category found the table full, they ask the category. */
+	inline constexpr uint32 UntrackedLogCategorySlot = 1;
+
+	/**
+	 * Verbosity of every category that logged at least once, by slot, what the log macros compare against. The two
+	 * reserved slots hold ELogVerbosity::All so they never suppress, the macros take their slow path instead.
+	 */
+	extern CORE_API std::atomic<uint8> GLogCategoryVerbosity[LOG_CATEGORY_VERBOSITY_TABLE_SIZE];
+
+	/**
+	 * Slow path of the first statement of a log site: registers Category with the table, with its pending override or
+	 * its current verbosity, and stores its slot in OutSlot, UntrackedLogCategorySlot if the table is full.
+	 *
+	 * @return whether the statement is suppressed
+	 */
+	CORE_API bool RegisterLogSiteCategory(std::atomic<uint32>& OutSlot, const FLogCategoryBase& Category, ELogVerbosity::Type Verbosity);
+
+	/**
+	 * Copies the current verbosity of Category to its slot. Code that calls FLogCategoryBase::SetVerbosity directly
+	 * calls this after it, or the log macros keep the previous verbosity. Replaces the pending override of a category
+	 * that did not register yet.
+	 */
+	CORE_API void OnLogCategoryVerbosityChanged(const FLogCategoryBase& Category);
+}
+
+/**
+ * Patchable per category verbosity used by UE_LOG. Once a category logged, its slot of the table is what the log macros
+ * compare against, a suppressed statement costs a load and a compare. Verbosities can be set before a category registers,
+ * they are applied when it first logs. Setting a verbosity here sets it on the registered category too, so the category
+ * reports what the macros check; see OnLogCategoryVerbosityChanged for verbosities set on the category directly.
+ *
+ * Available as the "LogVerbosity" console command:
+ *   LogVerbosity <Category|All> <Verbosity>   sets the verbosity
+ *   LogVerbosity <Category>                   prints it
+ *   LogVerbosity List                         prints every registered category
+ */
+class FLogCategoryVerbosityTable
+{
+public:
+	static CORE_API void SetVerbosity(const FName& CategoryName, ELogVerbosity::Type Verbosity);
+
+	/** Sets every category, including the ones that register later. Replaces the overrides set before it. */
+	static CORE_API void SetAllVerbosity(ELogVerbosity::Type Verbosity);
+
+	/** @return the verbosity a registered category logs at, or its pending override, or false if it has neither */
+	static CORE_API bool GetVerbosity(const FName& CategoryName, ELogVerbosity::Type& OutVerbosity);
+
+	/**
+	 * Applies a list of "Category Verbosity" pairs, separated by commas, in the format of -LogCmds:
+	 * "LogTemp Verbose, LogNet Warning, All Log". Unknown verbosities are skipped.
+	 */
+	static CORE_API void ApplyCommands(const TCHAR* Commands);
+
+	/** Applies the Category=Verbosity entries of the [Core.Log] section of a config file, e.g. GEngineIni. */
+	static CORE_API void ApplyConfig(const FString& Filename);
+};
@@ -3,6 +3,8 @@
 #include "CoreTypes.h"
 #include "Definitions.h"
 #include "LogMacros.h"
+#include "Logging/AsyncLog.h"
+#include "Logging/LogCategoryVerbosityTable.h"
 
 namespace UE::Logging::Private
 {
@@ -11,6 +13,15 @@ namespace UE::Logging::Private
 	struct FStaticBasicLogDynamicData
 	{
 		std::atomic<bool> bInitialized = false;
+
+		/** Id of the site in the open binary log, in the low 32 bits, and the generation of that log, see FBinaryLog. */
+		std::atomic<uint64> BinaryLogSiteId = 0;
+
+		/** Id of the site in the running trace, in the low 32 bits, and the generation of that trace, see FCoreTrace. */
+		std::atomic<uint64> TraceSiteId = 0;
+
+		/** Slot of the category of the site in GLogCategoryVerbosity, UnregisteredLogCategorySlot until the site first runs. */
+		std::atomic<uint32> CategorySlot = 0;
 	};
 
 	/** Data about a static basic log that is constant for every occurrence. */
@@ -38,12 +49,45 @@ namespace UE::Logging::Private
 		}
 	};
 
+	/**
+	 * Runtime verbosity check of the log macros, see FLogCategoryVerbosityTable. A suppressed statement costs a load of
+	 * the slot and a load and compare of its verbosity; the reserved slots never suppress, so the first statement of a
+	 * site and the sites the table has no room for only branch off once the compare passed. A template so the category
+	 * type only has to be complete where UE_LOG expands.
+	 */
+	template <typename CategoryType>
+	FORCEINLINE bool IsLogSuppressed(FStaticBasicLogDynamicData& DynamicData, const CategoryType& Category, ELogVerbosity::Type Verbosity)
+	{
+		const uint32 Slot = DynamicData.CategorySlot.load(std::memory_order_relaxed);
+		if ((Verbosity & ELogVerbosity::VerbosityMask) > GLogCategoryVerbosity[Slot].load(std::memory_order_relaxed))
+		{
+			return true;
+		}
+		if (UNLIKELY(Slot == UnregisteredLogCategorySlot))
+		{
+			return RegisterLogSiteCategory(DynamicData.CategorySlot, Category, Verbosity);
+		}
+		if (UNLIKELY(Slot == UntrackedLogCategorySlot))
+		{
+			return Category.IsSuppressed(Verbosity);
+		}
+		return false;
+	}
+
 	CORE_API void BasicLog(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, ...);
 	CORE_API void BasicFatalLog(const FLogCategoryBase& Category, const FStaticBasicLogRecord* Log, ...);
 
 } // UE::Logging::Private
 
 
+#if UE_WITH_ASYNC_LOGGING
+#define UE_PRIVATE_BASIC_LOG ::UE::Logging::Private::AsyncLog
+#define UE_PRIVATE_FLUSH_ASYNC_LOG() ::FlushAsyncLog()
+#else
+#define UE_PRIVATE_BASIC_LOG ::UE::Logging::Private::BasicLog
+#define UE_PRIVATE_FLUSH_ASYNC_LOG()
+#endif
+
 #if UE_VALIDATE_FORMAT_STRINGS
 #define UE_VALIDATE_FORMAT_STRING UE_CHECK_FORMAT_STRING
 #else
@@ -76,6 +120,7 @@ namespace UE::Logging::Private
 		{ \
 			Condition \
 			{ \
+				UE_PRIVATE_FLUSH_ASYNC_LOG(); \
 				::UE::Logging::Private::BasicFatalLog(Category, &LOG_Static, ##__VA_ARGS__); \
 				CA_ASSUME(false); \
 			} \
@@ -84,11 +129,11 @@ namespace UE::Logging::Private
 		{ \
 			if CategoryConst ((::ELogVerbosity::Verbosity & ::ELogVerbosity::VerbosityMask) <= Category.GetCompileTimeVerbosity()) \
 			{ \
-				if (!Category.IsSuppressed(::ELogVerbosity::Verbosity)) \
+				if (!::UE::Logging::Private::IsLogSuppressed(LOG_Dynamic, Category, ::ELogVerbosity::Verbosity)) \
 				{ \
 					Condition \
 					{ \
-						::UE::Logging::Private::BasicLog(Category, &LOG_Static, ##__VA_ARGS__); \
+						UE_PRIVATE_BASIC_LOG(Category, &LOG_Static, ##__VA_ARGS__); \
 					} \
 				} \
 			} \
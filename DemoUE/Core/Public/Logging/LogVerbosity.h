@@ -73,3 +73,11 @@ CORE_API const TCHAR* ToString(ELogVerbosity::Type Verbosity);
  */
 extern CORE_API ELogVerbosity::Type ParseLogVerbosityFromString(const FString& VerbosityString);
 
+/**
+ * Converts a string to verbosity, case insensitive like ParseLogVerbosityFromString, with a single hashed probe
+ * @param VerbosityString verbosity in string form, does not need to be null terminated
+ * @param Len number of characters of VerbosityString
+ * @returns false if the string is not a verbosity name, OutVerbosity is left untouched
+ */
+CORE_API bool TryParseLogVerbosityFromString(const TCHAR* VerbosityString, int32 Len, ELogVerbosity::Type& OutVerbosity);
+
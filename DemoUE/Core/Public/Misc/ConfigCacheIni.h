@@ -2,6 +2,11 @@
 #include "Definitions.h"
 #include "CoreTypes.h"s
 
+#include "Misc/ConfigFlushQueue.h"
+#include "Misc/ConfigReadSnapshot.h"
+
+class FConfigPrecompiledCache;
+
 enum class EConfigCacheType : uint8
 {
 	// this type of config cache will write its files to disk during Flush (i.e. GConfig)
@@ -119,10 +124,24 @@ public:
 
 	FConfigFile& Add(const FString& Filename, const FConfigFile& File)
 	{
-		return *OtherFiles.Add(Filename, new FConfigFile(File));
+		FConfigFile& NewFile = *OtherFiles.Add(Filename, new FConfigFile(File));
+		if (this == GConfig)
+		{
+			FConfigReadSnapshot::PublishFile(Filename, NewFile);
+		}
+		return NewFile;
 	}
 	int32 Remove(const FString& Filename)
 	{
+		if (this == GConfig)
+		{
+			FConfigReadSnapshot::UnpublishFile(Filename);
+		}
+		if (Type == EConfigCacheType::DiskBacked)
+		{
+			FConfigFlushQueue::Get().Forget(Filename);
+		}
+		DirtySections.Remove(Filename);
 		delete OtherFiles.FindRef(Filename);
 		return OtherFiles.Remove(Filename);
 	}
@@ -131,6 +150,28 @@ public:
 
 	CORE_API void Flush(bool bRemoveFromCache, const FString& Filename = TEXT(""));
 
+	/**
+	 * Like Flush(false, Filename), without waiting for the files to be written: the dirty files are handed to
+	 * FConfigFlushQueue, which writes them on its own thread. Only the sections recorded with MarkSectionDirty are copied,
+	 * a dirty file with none recorded is copied whole. A file the writer failed to write is queued again, whole, by the
+	 * next call. Call FConfigFlushQueue::Get().WaitForPendingWrites() when the files have to be on disk, e.g. before
+	 * another process reads them.
+	 */
+	CORE_API void FlushAsync(const FString& Filename = TEXT(""));
+
+	/**
+	 * Records that Section of Filename changed, for FlushAsync. Writers mark the file Dirty as before and call this along
+	 * with it; once one section of a file is recorded, every change to that file has to be.
+	 */
+	CORE_API void MarkSectionDirty(const FString& Filename, const TCHAR* Section);
+
+	/**
+	 * Publishes every file to FConfigReadSnapshot so other threads can read them with FConfigReadScope. Called on GConfig once
+	 * it is ready for use; from then on writers keep it up to date with FConfigReadSnapshot::PublishSection or PublishFile.
+	 * Materializes the files still waiting in a precompiled cache.
+	 */
+	CORE_API void PublishReadSnapshot();
+
 	CORE_API void LoadFile(const FString& InFilename, const FConfigFile* Fallback = NULL, const TCHAR* PlatformString = NULL);
 	CORE_API void SetFile(const FString& InFilename, const FConfigFile* NewConfigFile);
 	CORE_API void UnloadFile(const FString& Filename);
@@ -644,6 +685,9 @@ public:
 
 		// array of all known filesd
 		FKnownConfigFile Files[(uint8)EKnownIniFile::NumKnownFiles];
+
+		// snapshot the files are deserialized from on their first GetFile, when the config system started from a precompiled cache
+		TSharedPtr<FConfigPrecompiledCache> PrecompiledCache;
 	};
 
 	/**
@@ -666,6 +710,19 @@ public:
 	 */
 	static CORE_API bool CreateGConfigFromSaved(const TCHAR* Filename);
 
+	/**
+	 * Create GConfig from a snapshot written by SavePrecompiledCache, without parsing the ini hierarchies. Meant to be tried
+	 * by InitializeConfigSystem before InitializeKnownConfigFiles. The known files are deserialized on first access.
+	 *
+	 * @return false if there is no snapshot or it is out of date, GConfig is left untouched then
+	 */
+	static CORE_API bool CreateGConfigFromPrecompiledCache(const TCHAR* Filename);
+
+	/**
+	 * Save the known files, as resolved for this launch, to a snapshot the next launches can start from. See FConfigPrecompiledCache.
+	 */
+	CORE_API bool SavePrecompiledCache(const TCHAR* Filename);
+
 	/**
 	 * Retrieve the fully processed ini system for another platform. The editor will start loading these
 	 * in the background on startup
@@ -700,5 +757,8 @@ private:
 
 	TMap<FString, FConfigFile*> OtherFiles;
 
+	/** Config cache filename to the sections changed since it was last flushed, see MarkSectionDirty */
+	TMap<FString, TSet<FString>> DirtySections;
+
 	friend FConfigContext;
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Containers/Set.h"
+#include "Containers/UnrealString.h"
+
+class FConfigFile;
+
+namespace UE::ConfigFlushQueue::Private
+{
+	class FWriterThread;
+}
+
+/**
+ * Background writer for FConfigCacheIni::FlushAsync.
+ *
+ * The writer keeps its own copy of every file it wrote. Queuing a write only copies the sections that changed since the
+ * previous one into it, and FConfigFile::Write runs on the writer thread. Writes of a file that is still waiting are
+ * merged, so flushing the same file repeatedly only writes it once. Files are written next to their destination and
+ * renamed over it, a crash in the middle of a write leaves the previous version in place.
+ */
+class FConfigFlushQueue
+{
+public:
+	/** The queue is never destroyed, config caches destroyed during static shutdown can still wait on it. */
+	static CORE_API FConfigFlushQueue& Get();
+
+	/**
+	 * Queues a write of ConfigFile to Filename.
+	 *
+	 * @param DirtySections sections added, changed or removed since the previous write of the file
+	 * @param bAllSectionsDirty copy the whole file instead, e.g. when nobody tracked what changed. Always the case the
+	 *        first time a file is queued.
+	 */
+	CORE_API void Enqueue(const FString& Filename, const FConfigFile& ConfigFile, const TSet<FString>& DirtySections, bool bAllSectionsDirty);
+
+	/** Drops the writer's copy of Filename, e.g. once the file is unloaded, after any write of it still waiting. */
+	CORE_API void Forget(const FString& Filename);
+
+	/** Blocks until every queued write is on disk. */
+	CORE_API void WaitForPendingWrites();
+
+	CORE_API bool HasPendingWrites() const;
+
+	/**
+	 * @return whether the last write or rename of Filename failed, and forgets it. The caller marks the file dirty again so
+	 *         it is queued whole on its next flush, the failure itself is logged by the writer.
+	 */
+	CORE_API bool TakeFailedWrite(const FString& Filename);
+
+private:
+	FConfigFlushQueue();
+
+	UE::ConfigFlushQueue::Private::FWriterThread* Writer;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/UnrealMemory.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "Misc/ConfigCacheIni.h"
+#include <mutex>
+
+/** Bump whenever the layout of the snapshot, or the way FConfigFile serializes, changes. */
+#define CONFIG_PRECOMPILED_CACHE_VERSION 1
+
+/**
+ * Binary snapshot of the fully resolved known config files (Engine, Game, Input, ...), which lets startup skip
+ * parsing the .ini hierarchies.
+ *
+ * The snapshot lists every file of the hierarchies, including the optional ones that did not exist, and is keyed by a
+ * hash of their sizes and timestamps: editing, adding or removing any of them invalidates it. It is mapped in memory
+ * when the platform can map files, and each FConfigFile is only deserialized the first time it is accessed.
+ */
+class FConfigPrecompiledCache
+{
+public:
+	/**
+	 * Opens the snapshot at Filename.
+	 *
+	 * @param ContextKey identifies what the files were resolved for, see ComputeContextKey
+	 * @return the snapshot, or nullptr if there is none or it was written by another version, for another context or
+	 *         from source files that changed since
+	 */
+	static CORE_API FConfigPrecompiledCache* Open(const TCHAR* Filename, uint64 ContextKey);
+
+	/**
+	 * Writes a snapshot of KnownFiles, whose hierarchies must have been loaded. The file is written next to Filename
+	 * and moved over it, so processes starting at the same time never see a partial snapshot.
+	 */
+	static CORE_API bool Save(const TCHAR* Filename, uint64 ContextKey, FConfigCacheIni::FKnownConfigFiles& KnownFiles);
+
+	/**
+	 * @return a key of the inputs that change how the hierarchies resolve besides the files: platform, project, custom
+	 * config and the config switches of the command line, -ini:, -EngineINI= and the like, listed in the implementation
+	 */
+	static CORE_API uint64 ComputeContextKey();
+
+	CORE_API ~FConfigPrecompiledCache();
+
+	FConfigPrecompiledCache(const FConfigPrecompiledCache&) = delete;
+	FConfigPrecompiledCache& operator=(const FConfigPrecompiledCache&) = delete;
+
+	const FString& GetIniName(int32 Index) const
+	{
+		return Entries[Index].IniName;
+	}
+
+	const FString& GetIniPath(int32 Index) const
+	{
+		return Entries[Index].IniPath;
+	}
+
+	/**
+	 * Deserializes the known file Index into OutFile the first time it is called for that index, later calls return
+	 * right away. Safe to call from any thread.
+	 */
+	CORE_API void MaterializeOnce(int32 Index, FConfigFile& OutFile);
+
+private:
+	struct FEntry
+	{
+		FString IniName;
+		FString IniPath;
+		int64 Offset = 0;
+		int64 Size = 0;
+	};
+
+	FConfigPrecompiledCache() = default;
+
+	/** Reads the header and the file table, @return false if the snapshot cannot be used */
+	bool ReadTableOfContents(uint64 ContextKey);
+
+	/** @return the hash of the current size and timestamp of every file in SourceFiles */
+	static uint64 ComputeSourceKey(uint64 ContextKey, const TArray<FString>& SourceFiles);
+
+	/** Either the mapping or the bytes loaded into Buffer when the platform cannot map files. */
+	FPlatformMemory::FMappedFileRegion* MappedRegion = nullptr;
+	TArray<uint8> Buffer;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+
+	FEntry Entries[(uint8)EKnownIniFile::NumKnownFiles];
+	std::once_flag MaterializedFlags[(uint8)EKnownIniFile::NumKnownFiles];
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Containers/UnrealString.h"
+
+class FConfigFile;
+class FConfigSection;
+
+namespace UE::ConfigReadSnapshot::Private
+{
+	struct FSnapshot;
+}
+
+/**
+ * Location of a config value with its names already turned into FNames, so lookups through FConfigReadScope only
+ * hash three FNames instead of three strings. Build it once, e.g. as a function local static, and reuse it.
+ */
+struct FConfigValueHandle
+{
+	FConfigValueHandle(const TCHAR* InSection, const TCHAR* InKey, const FString& Filename)
+		: File(*Filename)
+		, Section(InSection)
+		, Key(InKey)
+	{
+	}
+
+	/** Config cache filename, e.g. GEngineIni. */
+	FName File;
+	FName Section;
+	FName Key;
+};
+
+/**
+ * Lock free, read only view of the config values, for threads other than the one that owns GConfig.
+ *
+ * GConfig itself is not thread safe. Writers publish immutable versions of its values with FConfigReadSnapshot instead
+ * (only the section that changed is copied), and a scope pins the version that was current when it was opened. Entering
+ * and leaving a scope costs a couple of atomic stores to a slot owned by the thread: versions are reclaimed by epoch,
+ * once no scope that could see them is still open. Keep scopes short, a long lived one holds on to every later version.
+ *
+ * The typed getters parse values the same way as their FConfigCacheIni counterparts.
+ */
+class FConfigReadScope
+{
+public:
+	CORE_API FConfigReadScope();
+	CORE_API ~FConfigReadScope();
+
+	FConfigReadScope(const FConfigReadScope&) = delete;
+	FConfigReadScope& operator=(const FConfigReadScope&) = delete;
+
+	/** @return the first value of the key, valid until the scope closes, or nullptr if it is not in the pinned version */
+	CORE_API const FString* FindValue(const FConfigValueHandle& Handle) const;
+
+	CORE_API bool GetString(const FConfigValueHandle& Handle, FString& Value) const;
+	CORE_API bool GetBool(const FConfigValueHandle& Handle, bool& Value) const;
+	CORE_API bool GetInt(const FConfigValueHandle& Handle, int32& Value) const;
+	CORE_API bool GetInt64(const FConfigValueHandle& Handle, int64& Value) const;
+	CORE_API bool GetFloat(const FConfigValueHandle& Handle, float& Value) const;
+	CORE_API bool GetDouble(const FConfigValueHandle& Handle, double& Value) const;
+
+	bool GetBoolOrDefault(const FConfigValueHandle& Handle, const bool DefaultValue) const
+	{
+		bool Value = DefaultValue;
+		GetBool(Handle, Value);
+		return Value;
+	}
+	int32 GetIntOrDefault(const FConfigValueHandle& Handle, const int32 DefaultValue) const
+	{
+		int32 Value = DefaultValue;
+		GetInt(Handle, Value);
+		return Value;
+	}
+	float GetFloatOrDefault(const FConfigValueHandle& Handle, const float DefaultValue) const
+	{
+		float Value = DefaultValue;
+		GetFloat(Handle, Value);
+		return Value;
+	}
+
+private:
+	const UE::ConfigReadSnapshot::Private::FSnapshot* Snapshot;
+};
+
+/**
+ * Write side of FConfigReadScope. Every call publishes a new version, writers are serialized by a lock and never wait
+ * for readers. Filenames are the config cache filenames (GEngineIni, ...).
+ */
+class FConfigReadSnapshot
+{
+public:
+	/** Publishes all the sections of ConfigFile as the values of Filename, replacing the previous ones. */
+	static CORE_API void PublishFile(const FString& Filename, const FConfigFile& ConfigFile);
+
+	/** Publishes a version where only Section of Filename changed, for writers such as SetString. A null ConfigSection removes it. */
+	static CORE_API void PublishSection(const FString& Filename, const TCHAR* Section, const FConfigSection* ConfigSection);
+
+	/** Publishes a version without Filename. */
+	static CORE_API void UnpublishFile(const FString& Filename);
+
+	/** Frees the versions no open scope can see anymore. Publishing does it too, this is for when writes stop. */
+	static CORE_API void ReclaimRetiredVersions();
+};
@@ -0,0 +1,322 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/UnrealMemory.h"
+#include "Containers/ContainerAllocationPolicies.h"
+
+/** Size of the chunks the arena requests from GMalloc. Allocations that do not fit get a dedicated chunk. */
+#define FRAME_ARENA_CHUNK_SIZE (64 * 1024)
+
+/** Number of released default sized chunks each arena keeps around for reuse. */
+#define FRAME_ARENA_MAX_SPARE_CHUNKS 4
+
+/**
+ * Per thread bump pointer arena for transient allocations.
+ *
+ * Memory is never freed individually. It is released all at once by Reset(), which is meant to be called once per
+ * frame, or back to a point recorded by an FFrameArenaMark when that goes out of scope. Anything allocated from the arena
+ * must not outlive the frame or the innermost live mark.
+ */
+class FFrameArena
+{
+public:
+	CORE_API FFrameArena();
+	CORE_API ~FFrameArena();
+
+	/** @return the arena of the calling thread */
+	static CORE_API FFrameArena& Get();
+
+	FORCEINLINE void* Alloc(SIZE_T Size, uint32 Alignment = DEFAULT_ALIGNMENT)
+	{
+		Alignment = FMath::Max<uint32>(Alignment, MIN_ALIGNMENT);
+		uint8* Result = (uint8*)(((UPTRINT)Top + Alignment - 1) & ~(UPTRINT)(Alignment - 1));
+		if (Result + Size <= End)
+		{
+			Top = Result + Size;
+			return Result;
+		}
+		return AllocNewChunk(Size, Alignment);
+	}
+
+	template <typename T>
+	FORCEINLINE T* Alloc(int32 Count = 1)
+	{
+		return (T*)Alloc(Count * sizeof(T), alignof(T));
+	}
+
+	/**
+	 * Grows or shrinks an allocation without moving it. Only possible for the most recent allocation.
+	 *
+	 * @return true if the block now spans NewSize bytes
+	 */
+	FORCEINLINE bool TryResizeInPlace(void* Ptr, SIZE_T OldSize, SIZE_T NewSize)
+	{
+		uint8* Block = (uint8*)Ptr;
+		if (Block + OldSize != Top || Block + NewSize > End)
+		{
+			return false;
+		}
+		Top = Block + NewSize;
+		return true;
+	}
+
+	/** @return true if Ptr points into memory currently handed out by this arena */
+	CORE_API bool Contains(const void* Ptr) const;
+
+	/** Releases everything allocated from the arena. Must not be called while a mark is alive. */
+	CORE_API void Reset();
+
+	/** @return the number of bytes in use since the last reset, counting the unused tail of every chunk but the current one */
+	CORE_API SIZE_T GetUsedBytes() const;
+
+	int32 GetNumMarks() const
+	{
+		return NumMarks;
+	}
+
+private:
+	friend class FFrameArenaMark;
+
+	struct FChunk
+	{
+		FChunk* Next;
+		SIZE_T Size;
+
+		uint8* GetData()
+		{
+			return (uint8*)(this + 1);
+		}
+	};
+
+	CORE_API void* AllocNewChunk(SIZE_T Size, uint32 Alignment);
+
+	/** Releases all chunks pushed after Chunk and rewinds the top to NewTop inside Chunk. */
+	CORE_API void PopTo(FChunk* Chunk, uint8* NewTop);
+
+	void ReleaseChunk(FChunk* Chunk);
+
+	FFrameArena(const FFrameArena&) = delete;
+	FFrameArena& operator=(const FFrameArena&) = delete;
+
+	/** Current chunk, linked to the previous ones. */
+	FChunk* TopChunk = nullptr;
+
+	/** Default sized chunks waiting to be reused. */
+	FChunk* SpareChunks = nullptr;
+	int32 NumSpareChunks = 0;
+
+	uint8* Top = nullptr;
+	uint8* End = nullptr;
+
+	int32 NumMarks = 0;
+};
+
+/**
+ * Records the top of the arena on construction and rewinds to it on destruction.
+ * Marks must be destroyed in the reverse order of their creation, on the thread that created them.
+ */
+class FFrameArenaMark
+{
+public:
+	explicit FFrameArenaMark(FFrameArena& InArena = FFrameArena::Get())
+		: Arena(InArena)
+		, SavedChunk(InArena.TopChunk)
+		, SavedTop(InArena.Top)
+		, SavedNumMarks(InArena.NumMarks++)
+	{
+	}
+
+	~FFrameArenaMark()
+	{
+		Pop();
+		Arena.NumMarks = SavedNumMarks;
+	}
+
+	/** Rewinds the arena early. The mark stays alive and rewinds again on destruction. */
+	void Pop()
+	{
+		checkf(Arena.NumMarks == SavedNumMarks + 1, TEXT("FFrameArenaMark popped out of order"));
+		Arena.PopTo(SavedChunk, SavedTop);
+	}
+
+private:
+	FFrameArena& Arena;
+	FFrameArena::FChunk* SavedChunk;
+	uint8* SavedTop;
+	int32 SavedNumMarks;
+};
+
+/**
+ * Allocator policy that places container elements in the frame arena of the thread that constructed the container.
+ *
+ * Freeing is a no-op, and growing is done in place while the elements are the most recent allocation of the arena,
+ * which is the common case for a scratch array filled in a loop. The container must be destroyed before the arena is
+ * reset or rewound past it.
+ */
+template <uint32 Alignment = DEFAULT_ALIGNMENT>
+class TArenaAllocator
+{
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	class ForAnyElementType
+	{
+	public:
+		/** Default constructor. */
+		ForAnyElementType()
+			: Data(nullptr)
+			, AllocatedBytes(0)
+			, Arena(&FFrameArena::Get())
+		{}
+
+		/**
+		 * Moves the state of another allocator into this one.
+		 *
+		 * Assumes that the allocator is currently empty, i.e. memory may be allocated but any existing elements have already been destructed (if necessary).
+		 * @param Other - The allocator to move the state from.  This allocator should be left in a valid empty state.
+		 */
+		FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+		{
+			checkSlow(this != &Other);
+
+			Data = Other.Data;
+			AllocatedBytes = Other.AllocatedBytes;
+			Arena = Other.Arena;
+			Other.Data = nullptr;
+			Other.AllocatedBytes = 0;
+		}
+
+		/** Destructor. The memory is reclaimed when the arena is reset. */
+		FORCEINLINE ~ForAnyElementType()
+		{
+		}
+
+		// FContainerAllocatorInterface
+		FORCEINLINE FScriptContainerElement* GetAllocation() const
+		{
+			return Data;
+		}
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			ResizeAllocation(PreviousNumElements, NumElements, NumBytesPerElement, Alignment);
+		}
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement)
+		{
+			checkSlow(NumElements >= 0 && PreviousNumElements >= 0);
+
+			// PreviousNumElements is the number of live elements, the block may be larger.
+			const SIZE_T PreviousBytes = (SIZE_T)PreviousNumElements * NumBytesPerElement;
+			const SIZE_T NewBytes = (SIZE_T)NumElements * NumBytesPerElement;
+
+			if (Data && Arena->TryResizeInPlace(Data, AllocatedBytes, NewBytes))
+			{
+				AllocatedBytes = NewBytes;
+				if (NumElements == 0)
+				{
+					Data = nullptr;
+				}
+				return;
+			}
+
+			if (NumElements == 0)
+			{
+				Data = nullptr;
+				AllocatedBytes = 0;
+				return;
+			}
+
+			// The block is already large enough, a copy would only strand it until the arena is reset.
+			if (Data && NewBytes <= AllocatedBytes)
+			{
+				return;
+			}
+
+			FScriptContainerElement* NewData = (FScriptContainerElement*)Arena->Alloc(NewBytes, FMath::Max(Alignment, AlignmentOfElement));
+			if (Data && PreviousNumElements)
+			{
+				FMemory::Memcpy(NewData, Data, FMath::Min(PreviousBytes, NewBytes));
+			}
+			Data = NewData;
+			AllocatedBytes = NewBytes;
+		}
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, Alignment);
+		}
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, FMath::Max(Alignment, AlignmentOfElement));
+		}
+		FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+		FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, FMath::Max(Alignment, AlignmentOfElement));
+		}
+		FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+		FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, FMath::Max(Alignment, AlignmentOfElement));
+		}
+
+		SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		bool HasAllocation() const
+		{
+			return !!Data;
+		}
+
+		SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+		ForAnyElementType(const ForAnyElementType&);
+		ForAnyElementType& operator=(const ForAnyElementType&);
+
+		/** A pointer to the container's elements. */
+		FScriptContainerElement* Data;
+
+		/** Size of the block at Data, which can be more than the capacity of the container after it shrank. */
+		SIZE_T AllocatedBytes;
+
+		/** The arena the elements live in. */
+		FFrameArena* Arena;
+	};
+
+	template<typename ElementType>
+	class ForElementType : public ForAnyElementType
+	{
+	public:
+		/** Default constructor. */
+		ForElementType()
+		{
+		}
+
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return (ElementType*)ForAnyElementType::GetAllocation();
+		}
+	};
+};
+
+template <uint32 Alignment>
+struct TAllocatorTraits<TArenaAllocator<Alignment>> : TAllocatorTraitsBase<TArenaAllocator<Alignment>>
+{
+	enum { SupportsElementAlignment = true };
+};
+
+/** Set allocator that keeps the elements, the allocation flags and the hash of a TSet/TMap in the frame arena. */
+typedef TSetAllocator<TSparseArrayAllocator<TArenaAllocator<>, TArenaAllocator<>>, TArenaAllocator<>> FArenaSetAllocator;
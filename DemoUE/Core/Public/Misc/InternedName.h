@@ -0,0 +1,115 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Containers/UnrealString.h"
+
+/** Longest string that can be interned, in characters. */
+#define INTERNED_NAME_MAX_LENGTH 1023
+
+/**
+ * Handle to a string stored once in a global, append-only name table.
+ *
+ * Interning hashes the string once, after that copies are two integers and comparisons are integer compares. Every
+ * spelling of a name is kept, so ToString gives back the casing it was created with, but all the spellings that only
+ * differ by case share a comparison index: operator== is case-insensitive like comparing the strings with Stricmp, and
+ * the case-sensitive compare is just as cheap.
+ *
+ * Looking up a name that is already in the table takes no lock. Names are never removed, their characters stay valid
+ * and in place until the process exits, so GetChars can be held on to.
+ */
+class FInternedName
+{
+public:
+	/** The empty name. */
+	FInternedName() = default;
+
+	/** Interns Name, adding it to the table if needed. Empty strings give the empty name. */
+	CORE_API explicit FInternedName(const TCHAR* Name);
+	CORE_API FInternedName(const TCHAR* Name, int32 Len);
+
+	explicit FInternedName(const FString& Name)
+		: FInternedName(*Name, Name.Len())
+	{
+	}
+
+	/** @return the name if someone interned it already, the empty name otherwise. Never adds to the table. */
+	static CORE_API FInternedName Find(const TCHAR* Name, int32 Len);
+
+	static FInternedName Find(const TCHAR* Name)
+	{
+		return Find(Name, Name ? FCString::Strlen(Name) : 0);
+	}
+
+	bool IsNone() const
+	{
+		return DisplayIndex == 0;
+	}
+
+	/** @return the null terminated characters of the name, valid for the lifetime of the process */
+	CORE_API const TCHAR* GetChars() const;
+	CORE_API int32 Len() const;
+
+	FString ToString() const
+	{
+		return FString(Len(), GetChars());
+	}
+
+	/** Case-insensitive. */
+	bool operator==(const FInternedName& Other) const
+	{
+		return ComparisonIndex == Other.ComparisonIndex;
+	}
+
+	bool operator!=(const FInternedName& Other) const
+	{
+		return ComparisonIndex != Other.ComparisonIndex;
+	}
+
+	bool IsEqualCaseSensitive(const FInternedName& Other) const
+	{
+		return DisplayIndex == Other.DisplayIndex;
+	}
+
+	/** Orders by the characters, case-insensitive. Slower than ==, only for sorting into a stable order. */
+	CORE_API int32 Compare(const FInternedName& Other) const;
+
+	/** Same for every spelling, for containers keyed with the case-insensitive ==. Stable within a process only. */
+	uint32 GetComparisonIndex() const
+	{
+		return ComparisonIndex;
+	}
+
+	uint32 GetDisplayIndex() const
+	{
+		return DisplayIndex;
+	}
+
+	friend uint32 GetTypeHash(const FInternedName& Name)
+	{
+		// Indices are handed out in sequence, spread them over the buckets.
+		return Name.ComparisonIndex * 0x9E3779B1u;
+	}
+
+	struct FStats
+	{
+		uint32 NumNames = 0;
+
+		/** Memory of the entries and of the hash of the table. */
+		SIZE_T EntryBytes = 0;
+		SIZE_T HashBytes = 0;
+	};
+	static CORE_API FStats GetStats();
+
+private:
+	FInternedName(uint32 InComparisonIndex, uint32 InDisplayIndex)
+		: ComparisonIndex(InComparisonIndex)
+		, DisplayIndex(InDisplayIndex)
+	{
+	}
+
+	/** Entry of the first spelling of the name, the one every spelling compares with. */
+	uint32 ComparisonIndex = 0;
+
+	/** Entry of this spelling. */
+	uint32 DisplayIndex = 0;
+};
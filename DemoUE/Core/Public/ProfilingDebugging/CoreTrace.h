@@ -0,0 +1,266 @@
+#pragma once
+#include <atomic>
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/PreprocessorHelpers.h"
+#include "Misc/EnumClassFlags.h"
+
+/**
+ * Compiles in the trace macros and the memory and log hooks. With it at 0 every macro expands to nothing, and the
+ * hooks in FMemory and UE_LOG are gone. With it at 1 they cost a relaxed load and a branch until a trace is started.
+ */
+#ifndef UE_WITH_CORE_TRACE
+#define UE_WITH_CORE_TRACE 1
+#endif
+
+/** Size of the ring buffer of every thread that traces, a power of two. Events that do not fit are dropped and counted. */
+#define TRACE_THREAD_BUFFER_SIZE (256 * 1024)
+
+/** How often the trace thread drains the buffers of the other threads to the file. */
+#define TRACE_DRAIN_INTERVAL_MS 10
+
+/** Frames captured with a sampled allocation. */
+#define TRACE_CALLSTACK_MAX_DEPTH 24
+
+/** Bump when the layout of the trace stream changes. */
+#define TRACE_VERSION 2
+
+class FArchive;
+
+enum class ETraceChannel : uint32
+{
+	None = 0,
+
+	/** TRACE_CPU_SCOPE. */
+	Cpu = 1 << 0,
+
+	/** FMemory::Malloc, Realloc, Free and the system allocations, with sampled callstacks. */
+	Memory = 1 << 1,
+
+	/** TRACE_COUNTER_SET and TRACE_COUNTER_ADD. */
+	Counters = 1 << 2,
+
+	/** Every UE_LOG that is not suppressed, with its raw arguments as in the binary log. Requires UE_WITH_ASYNC_LOGGING. */
+	Log = 1 << 3,
+
+	Default = Cpu | Counters | Log,
+	All = Cpu | Memory | Counters | Log,
+};
+ENUM_CLASS_FLAGS(ETraceChannel);
+
+/**
+ * Low overhead trace of a running process, for profiling servers without an external profiler attached.
+ *
+ * Threads write their events, a few bytes each with timestamps as deltas, to a ring buffer of their own without any
+ * lock. The trace thread drains every ring into the output in packets, together with the names of the scopes,
+ * counters and log sites seen for the first time. A thread whose ring is full drops its events rather than waiting,
+ * the number dropped goes into the stream once there is room again.
+ */
+class FCoreTrace
+{
+public:
+	/** Starts writing the enabled channels to Filename, stopping the current trace if any. Fails if Channels is None. */
+	static CORE_API bool Start(const TCHAR* Filename, ETraceChannel Channels = ETraceChannel::Default);
+
+	/**
+	 * Same as Start, to any archive, such as one that sends what it is given over a socket. The trace owns the archive
+	 * and deletes it when it stops.
+	 */
+	static CORE_API bool Start(FArchive* Output, ETraceChannel Channels = ETraceChannel::Default);
+
+	/**
+	 * Starts a trace if the command line asks for one, with -TraceFile=<path> and optionally -Trace=<channels>, a comma
+	 * separated list of Cpu, Memory, Counters, Log, Default or All. -TraceCallstackRate=<N> samples every Nth allocation.
+	 */
+	static CORE_API bool StartFromCommandLine();
+
+	/** Writes the events traced so far and closes the output. Events racing with it may be lost. */
+	static CORE_API void Stop();
+
+	/** Writes the events traced so far by any thread to the output. */
+	static CORE_API void Flush();
+
+	static CORE_API bool IsActive();
+
+	/** Captures the callstack of one allocation out of SampleRate on every thread, 0 to capture none. */
+	static CORE_API void SetCallstackSampleRate(uint32 SampleRate);
+
+	/** @return the channels named in a comma separated list, see StartFromCommandLine */
+	static CORE_API ETraceChannel ParseChannels(const TCHAR* Channels);
+};
+
+namespace UE::Logging::Private
+{
+	struct FStaticBasicLogRecord;
+	struct FCapturedLogArgs;
+	enum class EBinaryLogArgType : uint8;
+}
+
+class FLogCategoryBase;
+
+namespace UE::Trace::Private
+{
+	/** Channels of the running trace, None while none is. */
+	extern CORE_API std::atomic<uint32> GTraceChannels;
+
+	FORCEINLINE bool IsTraceChannelEnabled(ETraceChannel Channel)
+	{
+		return (GTraceChannels.load(std::memory_order_relaxed) & (uint32)Channel) != 0;
+	}
+
+	enum class ETraceSiteKind : uint8
+	{
+		CpuScope,
+		Counter,
+	};
+
+	/**
+	 * A scope or counter of the source, a static of its macro. Its id is handed out the first time it is traced, with
+	 * the generation of the trace in the high bits so the next trace describes it again.
+	 */
+	struct FTraceSite
+	{
+		constexpr FTraceSite(const ANSICHAR* InName, ETraceSiteKind InKind)
+			: Name(InName)
+			, Kind(InKind)
+		{
+		}
+
+		const ANSICHAR* Name;
+		ETraceSiteKind Kind;
+		std::atomic<uint64> Id{ 0 };
+	};
+
+	/** Value of a counter, kept up to date while no trace runs so a trace shows it from its first change on. */
+	struct FTraceCounter : FTraceSite
+	{
+		constexpr explicit FTraceCounter(const ANSICHAR* InName)
+			: FTraceSite(InName, ETraceSiteKind::Counter)
+		{
+		}
+
+		std::atomic<int64> Value{ 0 };
+	};
+
+	CORE_API bool TraceCpuScopeBegin(FTraceSite& Site);
+	CORE_API void TraceCpuScopeEnd();
+	CORE_API void TraceCounterValue(FTraceCounter& Counter, int64 Value);
+	CORE_API void TraceMemoryAlloc(void* Ptr, SIZE_T Size, uint32 Alignment);
+	CORE_API void TraceMemoryRealloc(void* OldPtr, void* NewPtr, SIZE_T Size, uint32 Alignment);
+	CORE_API void TraceMemoryFree(void* Ptr);
+	CORE_API void TraceLogRecord(const FLogCategoryBase& Category, const UE::Logging::Private::FStaticBasicLogRecord* Log, const UE::Logging::Private::EBinaryLogArgType* ArgTypes, int32 NumArgs, const UE::Logging::Private::FCapturedLogArgs& Args);
+
+	class FTraceCpuScope
+	{
+	public:
+		FORCEINLINE explicit FTraceCpuScope(FTraceSite& Site)
+		{
+			if (UNLIKELY(IsTraceChannelEnabled(ETraceChannel::Cpu)))
+			{
+				bActive = TraceCpuScopeBegin(Site);
+			}
+		}
+
+		FORCEINLINE ~FTraceCpuScope()
+		{
+			if (UNLIKELY(bActive))
+			{
+				TraceCpuScopeEnd();
+			}
+		}
+
+		FTraceCpuScope(const FTraceCpuScope&) = delete;
+		FTraceCpuScope& operator=(const FTraceCpuScope&) = delete;
+
+	private:
+		bool bActive = false;
+	};
+
+	FORCEINLINE void SetTraceCounter(FTraceCounter& Counter, int64 Value)
+	{
+		Counter.Value.store(Value, std::memory_order_relaxed);
+		if (UNLIKELY(IsTraceChannelEnabled(ETraceChannel::Counters)))
+		{
+			TraceCounterValue(Counter, Value);
+		}
+	}
+
+	FORCEINLINE void AddTraceCounter(FTraceCounter& Counter, int64 Delta)
+	{
+		const int64 Value = Counter.Value.fetch_add(Delta, std::memory_order_relaxed) + Delta;
+		if (UNLIKELY(IsTraceChannelEnabled(ETraceChannel::Counters)))
+		{
+			TraceCounterValue(Counter, Value);
+		}
+	}
+}
+
+#if UE_WITH_CORE_TRACE
+
+/** Times the rest of the enclosing scope under Name, an identifier such as TRACE_CPU_SCOPE(FlushAsyncLog). */
+#define TRACE_CPU_SCOPE(Name) \
+	static ::UE::Trace::Private::FTraceSite PREPROCESSOR_JOIN(TraceCpuSite_, __LINE__)(#Name, ::UE::Trace::Private::ETraceSiteKind::CpuScope); \
+	::UE::Trace::Private::FTraceCpuScope PREPROCESSOR_JOIN(TraceCpuScope_, __LINE__)(PREPROCESSOR_JOIN(TraceCpuSite_, __LINE__))
+
+/** Sets the counter Name, an identifier, to Value. Every site with the same name is a separate counter. */
+#define TRACE_COUNTER_SET(Name, Value) \
+	do \
+	{ \
+		static ::UE::Trace::Private::FTraceCounter TraceCounter_##Name(#Name); \
+		::UE::Trace::Private::SetTraceCounter(TraceCounter_##Name, (int64)(Value)); \
+	} \
+	while (0)
+
+/** Adds Delta to the counter Name. Declare the counter once with TRACE_DECLARE_COUNTER to share it between sites. */
+#define TRACE_COUNTER_ADD(Name, Delta) \
+	::UE::Trace::Private::AddTraceCounter(TraceCounter_##Name, (int64)(Delta))
+
+/** Defines the counter Name, at file scope, for TRACE_COUNTER_ADD. */
+#define TRACE_DECLARE_COUNTER(Name) \
+	static ::UE::Trace::Private::FTraceCounter TraceCounter_##Name(#Name)
+
+/** True while the log channel is traced, the log arguments are captured for the trace then. */
+#define UE_TRACE_LOG_ENABLED() ::UE::Trace::Private::IsTraceChannelEnabled(ETraceChannel::Log)
+
+#define UE_TRACE_MEMORY_ALLOC(Ptr, Size, Alignment) \
+	do \
+	{ \
+		if (UNLIKELY(::UE::Trace::Private::IsTraceChannelEnabled(ETraceChannel::Memory))) \
+		{ \
+			::UE::Trace::Private::TraceMemoryAlloc(Ptr, Size, Alignment); \
+		} \
+	} \
+	while (0)
+
+#define UE_TRACE_MEMORY_REALLOC(OldPtr, NewPtr, Size, Alignment) \
+	do \
+	{ \
+		if (UNLIKELY(::UE::Trace::Private::IsTraceChannelEnabled(ETraceChannel::Memory))) \
+		{ \
+			::UE::Trace::Private::TraceMemoryRealloc(OldPtr, NewPtr, Size, Alignment); \
+		} \
+	} \
+	while (0)
+
+#define UE_TRACE_MEMORY_FREE(Ptr) \
+	do \
+	{ \
+		if (UNLIKELY(::UE::Trace::Private::IsTraceChannelEnabled(ETraceChannel::Memory))) \
+		{ \
+			::UE::Trace::Private::TraceMemoryFree(Ptr); \
+		} \
+	} \
+	while (0)
+
+#else
+
+#define TRACE_CPU_SCOPE(Name)
+#define TRACE_COUNTER_SET(Name, Value) do { } while (0)
+#define TRACE_COUNTER_ADD(Name, Delta)
+#define TRACE_DECLARE_COUNTER(Name)
+#define UE_TRACE_LOG_ENABLED() false
+#define UE_TRACE_MEMORY_ALLOC(Ptr, Size, Alignment) do { } while (0)
+#define UE_TRACE_MEMORY_REALLOC(OldPtr, NewPtr, Size, Alignment) do { } while (0)
+#define UE_TRACE_MEMORY_FREE(Ptr) do { } while (0)
+
+#endif
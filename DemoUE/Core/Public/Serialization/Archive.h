@@ -13,7 +13,13 @@ class FString;
 #define EVENT_DRIVEN_ASYNC_LOAD_ACTIVE_AT_RUNTIME (!GIsInitialLoad) 
 #endif
 
-#define DEVIRTUALIZE_FLinkerLoad_Serialize (!WITH_EDITORONLY_DATA)
+// Inline serializers read from the fast path load buffer of any archive that exposes one (see FArchive::SetFastPathLoadBuffer)
+// instead of calling the virtual Serialize. This used to be limited to FLinkerLoad in cooked builds.
+#ifndef UE_ARCHIVE_FAST_PATH_LOAD
+#define UE_ARCHIVE_FAST_PATH_LOAD 1
+#endif
+
+#define DEVIRTUALIZE_FLinkerLoad_Serialize UE_ARCHIVE_FAST_PATH_LOAD
 
 // Helper macro to make serializing a bitpacked boolean in an archive easier. 
 // NOTE: The condition is there to avoid overwriting a value that is the same, especially important to make saving an immutable operation and avoid dirtying cachelines for nothing.
@@ -708,7 +714,7 @@ public:
 			OriginalFastPathLoadBuffer = nullptr;
 		}
 	};
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 	//@todoio FArchive is really a horrible class and the way it is proxied by FLinkerLoad is double terrible. It makes the fast path really hacky and slower than it would need to be.
 	FFastPathLoadBuffer* ActiveFPLB;
 	FFastPathLoadBuffer InlineFPLB;
@@ -1256,7 +1262,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, ANSICHAR& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1273,7 +1279,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, WIDECHAR& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1290,7 +1296,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, uint8& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1307,7 +1313,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, int8& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1324,7 +1330,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, uint16& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1341,7 +1347,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, int16& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1358,7 +1364,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, uint32& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1386,7 +1392,7 @@ public:
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, bool& D)
 	{
 		// Serialize bool as if it were UBOOL (legacy, 32 bit int).
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		const uint8* RESTRICT Src = Ar.ActiveFPLB->StartFastPathLoadBuffer;
 		if (Src + sizeof(uint32) <= Ar.ActiveFPLB->EndFastPathLoadBuffer)
 		{
@@ -1418,7 +1424,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, int32& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1436,7 +1442,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, long& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1454,7 +1460,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, float& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1472,7 +1478,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, double& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1490,7 +1496,7 @@ public:
 	 */
 	FORCEINLINE friend FArchive& operator<<(FArchive& Ar, uint64& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1507,7 +1513,7 @@ public:
 	 */
 	/*FORCEINLINE*/friend FArchive& operator<<(FArchive& Ar, int64& Value)
 	{
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 		if (!Ar.FastPathLoad<sizeof(Value)>(&Value))
 #endif
 		{
@@ -1661,6 +1667,24 @@ public:
 	 */
 	virtual void FlushCache() { }
 
+	/**
+	 * Reads Length bytes at Offset of the backing data storage without moving the archive position.
+	 * Called from the I/O thread by async bulk serialization while the owning thread keeps using the archive,
+	 * so implementations must be thread safe against the rest of the interface.
+	 *
+	 * @return true if the read succeeded, false if it failed or the archive cannot do positional reads
+	 */
+	virtual bool ReadAtOffset(void* Dest, int64 Offset, int64 Length)
+	{
+		return false;
+	}
+
+	/** Returns true if ReadAtOffset is implemented. */
+	virtual bool SupportsReadAtOffset() const
+	{
+		return false;
+	}
+
 	/**
 	 * Sets mapping from offsets/ sizes that are going to be used for seeking and serialization to what
 	 * is actually stored on disk. If the archive supports dealing with compression in this way it is
@@ -1752,6 +1776,40 @@ public:
 		return SerializeByteOrderSwapped(V, Length); // Slowest and unlikely path (should not be inlined)
 	}
 
+	/**
+	 * Serializes Num elements of ElementSize bytes, e.g. an array of numbers, to the same bytes as ByteOrderSerialize on
+	 * each of them but as one block. Loads come straight from the fast path buffer when it holds them all, and byte
+	 * swapping archives convert the whole block with FPlatformMemory::ByteSwapCopy.
+	 */
+	FArchive& ByteOrderSerializeArray(void* V, int32 ElementSize, int64 Num)
+	{
+		const int64 Length = (int64)ElementSize * Num;
+		if (!IsByteSwapping()) // Most likely case (hot path)
+		{
+			if (const uint8* Src = IsLoading() ? FastPathLoadView(Length) : nullptr)
+			{
+				FPlatformMemory::Memcpy(V, Src, Length);
+			}
+			else
+			{
+				Serialize(V, Length);
+			}
+		}
+		else if (IsLoading())
+		{
+			Serialize(V, Length);
+			FPlatformMemory::ByteSwapCopy(V, V, ElementSize, Num);
+		}
+		else
+		{
+			// Like SerializeByteOrderSwapped, swap the source back once written so the caller never observes it swapped.
+			FPlatformMemory::ByteSwapCopy(V, V, ElementSize, Num);
+			Serialize(V, Length);
+			FPlatformMemory::ByteSwapCopy(V, V, ElementSize, Num);
+		}
+		return *this;
+	}
+
 	using FArchiveState::ThisContainsCode;
 	using FArchiveState::ThisContainsMap;
 	using FArchiveState::ThisRequiresLocalizationGather;
@@ -1923,7 +1981,7 @@ public:
 	using FArchiveState::Reset;
 
 public:
-#if DEVIRTUALIZE_FLinkerLoad_Serialize
+#if UE_ARCHIVE_FAST_PATH_LOAD
 	template<SIZE_T Size>
 	FORCEINLINE bool FastPathLoad(void* InDest)
 	{
@@ -1959,6 +2017,34 @@ public:
 		return false;
 	}
 
+	/**
+	 * Returns the next Length bytes of the fast path buffer and skips them, or nullptr if they are not all buffered.
+	 * The bytes stay valid as long as the buffer does, which for archives loading from a mapped file is their lifetime.
+	 */
+	FORCEINLINE const uint8* FastPathLoadView(int64 Length)
+	{
+		const uint8* Src = ActiveFPLB->StartFastPathLoadBuffer;
+		if (Length >= 0 && Length <= ActiveFPLB->EndFastPathLoadBuffer - Src)
+		{
+			ActiveFPLB->StartFastPathLoadBuffer += Length;
+			return Src;
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Exposes [Begin, End) as the bytes that follow the current position, for archives that load from memory. The inline
+	 * serializers, SerializeBatch and BulkSerialize then read from it without calling Serialize, so the archive must keep
+	 * its position in sync with StartFastPathLoadBuffer. The bytes are copied as they are: do not expose a buffer while
+	 * byte swapping.
+	 */
+	FORCEINLINE void SetFastPathLoadBuffer(const uint8* Begin, const uint8* End)
+	{
+		ActiveFPLB->OriginalFastPathLoadBuffer = Begin;
+		ActiveFPLB->StartFastPathLoadBuffer = Begin;
+		ActiveFPLB->EndFastPathLoadBuffer = End;
+	}
+
 	//@todoio FArchive is really a horrible class and the way it is proxied by FLinkerLoad is double terrible. It makes the fast path really hacky and slower than it would need to be.
 	using FArchiveState::ActiveFPLB;
 	using FArchiveState::InlineFPLB;
@@ -1969,8 +2055,60 @@ public:
 	{
 		return false;
 	}
+
+	FORCEINLINE const uint8* FastPathLoadView(int64 Length)
+	{
+		return nullptr;
+	}
 #endif
 
+	/**
+	 * Serializes a run of arithmetic values, e.g. the fields of a struct of PODs, to the same bytes as Ar << A << B << ...
+	 * but with a single bounds check against the fast path load buffer, or a single call to Serialize when there is none,
+	 * instead of one per value. bool is left out as operator<< stores it as a 32 bit integer.
+	 */
+	template<typename... ValueTypes>
+	FArchive& SerializeBatch(ValueTypes&... Values)
+	{
+		static_assert(((TIsArithmetic<ValueTypes>::Value && !std::is_same_v<ValueTypes, bool>) && ...), "SerializeBatch only takes arithmetic values other than bool, cast enums to their underlying type.");
+		constexpr SIZE_T BatchSize = (sizeof(ValueTypes) + ...);
+
+		SIZE_T Offset = 0;
+		if (IsLoading())
+		{
+			const uint8* Src = FastPathLoadView(BatchSize);
+			uint8 Buffer[BatchSize];
+			if (!Src)
+			{
+				Serialize(Buffer, BatchSize);
+				if (IsByteSwapping())
+				{
+					((ByteSwap(Buffer + Offset, sizeof(ValueTypes)), Offset += sizeof(ValueTypes)), ...);
+					Offset = 0;
+				}
+				Src = Buffer;
+			}
+			((FPlatformMemory::Memcpy(&Values, Src + Offset, sizeof(ValueTypes)), Offset += sizeof(ValueTypes)), ...);
+		}
+		else if (IsSaving())
+		{
+			uint8 Buffer[BatchSize];
+			((FPlatformMemory::Memcpy(Buffer + Offset, &Values, sizeof(ValueTypes)), Offset += sizeof(ValueTypes)), ...);
+			if (IsByteSwapping())
+			{
+				Offset = 0;
+				((ByteSwap(Buffer + Offset, sizeof(ValueTypes)), Offset += sizeof(ValueTypes)), ...);
+			}
+			Serialize(Buffer, BatchSize);
+		}
+		else
+		{
+			// Other archives, e.g. counters or reference collectors, may expect to see every value.
+			(*this << ... << Values);
+		}
+		return *this;
+	}
+
 private:
 	// Used internally only to control the amount of generated code/type under control.
 	template<typename T>
@@ -0,0 +1,80 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+
+class FArchive;
+
+/** Default size of the pieces a pipelined bulk read is issued in. */
+#define ASYNC_BULK_SERIALIZE_CHUNK_SIZE (1024 * 1024)
+
+/**
+ * Bulk reads of at least this many bytes are issued in ASYNC_BULK_SERIALIZE_CHUNK_SIZE pieces, so the caller can
+ * consume the front of the array with WaitForBytes while the rest is still being read. Smaller reads are issued whole.
+ */
+extern CORE_API int64 GAsyncBulkSerializePipelineWatermark;
+
+namespace UE::Serialization::Private
+{
+	struct FAsyncBulkRead;
+}
+
+/**
+ * Completion handle of a bulk read running on the I/O thread, as returned by TArray::BulkSerializeAsync.
+ *
+ * The destination must not be resized, freed or read past GetNumBytesReady() until the read completes, and the
+ * archive it reads from must outlive it. Destroying a handle waits for its read.
+ */
+class FAsyncBulkReadHandle
+{
+public:
+	/** Creates a handle for a read that already finished, e.g. one done synchronously. */
+	explicit FAsyncBulkReadHandle(bool bSucceeded = true)
+		: Read(nullptr)
+		, bSynchronousResult(bSucceeded)
+	{
+	}
+
+	CORE_API explicit FAsyncBulkReadHandle(UE::Serialization::Private::FAsyncBulkRead* InRead);
+
+	FAsyncBulkReadHandle(FAsyncBulkReadHandle&& Other)
+		: Read(Other.Read)
+		, bSynchronousResult(Other.bSynchronousResult)
+	{
+		Other.Read = nullptr;
+	}
+
+	CORE_API FAsyncBulkReadHandle& operator=(FAsyncBulkReadHandle&& Other);
+
+	CORE_API ~FAsyncBulkReadHandle();
+
+	/** @return true once the whole read finished, successfully or not */
+	CORE_API bool IsComplete() const;
+
+	/** Blocks until the read is done. @return true if all the bytes were read */
+	CORE_API bool Wait();
+
+	/**
+	 * Blocks until the first NumBytes bytes of the destination are valid, which lets pipelined reads be consumed as
+	 * they stream in. @return false if the read failed before getting there
+	 */
+	CORE_API bool WaitForBytes(int64 NumBytes);
+
+	/** @return how many bytes at the front of the destination are valid right now */
+	CORE_API int64 GetNumBytesReady() const;
+
+private:
+	FAsyncBulkReadHandle(const FAsyncBulkReadHandle&) = delete;
+	FAsyncBulkReadHandle& operator=(const FAsyncBulkReadHandle&) = delete;
+
+	/** The read in flight, shared with the I/O thread. Null for reads done synchronously. */
+	UE::Serialization::Private::FAsyncBulkRead* Read;
+
+	/** Outcome of a read done synchronously. */
+	bool bSynchronousResult;
+};
+
+/**
+ * Reads the next Length bytes of Ar into Dest on the I/O thread. The archive position is moved past the block right
+ * away, so the caller can go on reading whatever follows. Archives that do not support ReadAtOffset are read synchronously.
+ */
+CORE_API FAsyncBulkReadHandle IssueAsyncBulkRead(FArchive& Ar, void* Dest, int64 Length);
@@ -0,0 +1,149 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Serialization/Archive.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+
+/** Uncompressed size of a block, each block is compressed independently so it can be decoded on any thread. */
+#define BLOCK_COMPRESSION_DEFAULT_BLOCK_SIZE (256 * 1024)
+
+/** Largest block either side accepts, a batch of them has to fit in a TArray. */
+#define BLOCK_COMPRESSION_MAX_BLOCK_SIZE (16 * 1024 * 1024)
+
+/** Blocks compressed or decompressed together, which bounds both the parallelism and the memory in flight. */
+#define BLOCK_COMPRESSION_BATCH_BLOCKS 32
+
+enum class EBlockCompressionMethod : uint8
+{
+	/** Blocks are stored as is, the archive only adds the block index. */
+	None,
+
+	/** LZ4 block format, fast to decode. */
+	LZ4,
+};
+
+namespace UE::Serialization::Private
+{
+	/** Stream header, written before the first block and patched with the final sizes on close. */
+	struct FBlockCompressionHeader
+	{
+		static constexpr uint32 ExpectedMagic = 0x41434C42; // "BLCA"
+		static constexpr uint32 CurrentVersion = 1;
+
+		uint32 Magic = ExpectedMagic;
+		uint32 Version = CurrentVersion;
+		uint32 BlockSize = 0;
+		uint8 Method = 0;
+		uint32 NumBlocks = 0;
+		int64 UncompressedSize = 0;
+
+		/** Offset of the block index from the start of the stream. */
+		int64 IndexOffset = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FBlockCompressionHeader& Header)
+		{
+			Ar.SerializeBatch(Header.Magic, Header.Version, Header.BlockSize, Header.Method, Header.NumBlocks, Header.UncompressedSize, Header.IndexOffset);
+			return Ar;
+		}
+	};
+}
+
+/**
+ * Proxy archive that splits everything serialized through it into fixed size blocks and writes them compressed to
+ * the inner archive. Batches of blocks are compressed in parallel. The inner archive must be seekable: the header is
+ * patched when the archive is closed. Blocks that do not shrink are stored uncompressed.
+ */
+class FArchiveBlockCompressionWriter final : public FArchive
+{
+public:
+	CORE_API FArchiveBlockCompressionWriter(FArchive& InInner, EBlockCompressionMethod InMethod = EBlockCompressionMethod::LZ4, int32 InBlockSize = BLOCK_COMPRESSION_DEFAULT_BLOCK_SIZE);
+	CORE_API virtual ~FArchiveBlockCompressionWriter();
+
+	//~ Begin FArchive Interface
+	CORE_API virtual void Serialize(void* Data, int64 Length) override;
+	CORE_API virtual void Seek(int64 InPos) override;
+	CORE_API virtual int64 Tell() override;
+	CORE_API virtual int64 TotalSize() override;
+	CORE_API virtual void Flush() override;
+	CORE_API virtual bool Close() override;
+	CORE_API virtual FString GetArchiveName() const override;
+	//~ End FArchive Interface
+
+private:
+	/** Compresses and writes the pending blocks, the last one may be partial only when closing. */
+	void WritePendingBlocks();
+
+	FArchive& Inner;
+	EBlockCompressionMethod Method;
+	int32 BlockSize;
+
+	/** Inner archive offset of the header. */
+	int64 StreamStart;
+
+	/** Bytes written to the inner archive so far, from StreamStart. */
+	int64 StreamSize;
+
+	int64 UncompressedSize = 0;
+
+	/** Uncompressed bytes not written yet, up to BLOCK_COMPRESSION_BATCH_BLOCKS blocks. */
+	TArray<uint8> Pending;
+
+	/** One output buffer per block of a batch. */
+	TArray<uint8> CompressedBlocks;
+	int64 CompressedBlockCapacity;
+
+	/** Stored size of every block written, equal to BlockSize (or the remainder) for blocks stored uncompressed. */
+	TArray<uint32> BlockSizes;
+
+	bool bClosed = false;
+};
+
+/**
+ * Proxy archive that reads a stream written by FArchiveBlockCompressionWriter. Tell, Seek and TotalSize work in
+ * uncompressed bytes and seeking goes through the block index.
+ *
+ * Reads that cover whole blocks, such as the payload of a BulkSerialize from a cooked package, are decompressed
+ * in parallel straight into the destination. Smaller reads are served from a window of blocks decompressed in
+ * parallel ahead of the read position.
+ */
+class FArchiveBlockCompressionReader final : public FArchive
+{
+public:
+	CORE_API explicit FArchiveBlockCompressionReader(FArchive& InInner);
+
+	//~ Begin FArchive Interface
+	CORE_API virtual void Serialize(void* Data, int64 Length) override;
+	CORE_API virtual void Seek(int64 InPos) override;
+	CORE_API virtual int64 Tell() override;
+	CORE_API virtual int64 TotalSize() override;
+	CORE_API virtual FString GetArchiveName() const override;
+	//~ End FArchive Interface
+
+private:
+	/** Decompresses NumDecodeBlocks consecutive blocks starting at FirstBlock to Dest. */
+	bool DecodeBlocks(int32 FirstBlock, int32 NumDecodeBlocks, uint8* Dest);
+
+	FORCEINLINE int64 GetBlockUncompressedSize(int32 Block) const
+	{
+		const int64 Begin = (int64)Block * Header.BlockSize;
+		return FMath::Min<int64>(Header.BlockSize, Header.UncompressedSize - Begin);
+	}
+
+	FArchive& Inner;
+	UE::Serialization::Private::FBlockCompressionHeader Header;
+	int64 StreamStart;
+
+	/** Stream offset of every block followed by the offset of the index. */
+	TArray<int64> BlockOffsets;
+
+	int64 Pos = 0;
+
+	/** Decoded blocks [CachedFirstBlock, CachedFirstBlock + NumCachedBlocks). */
+	TArray<uint8> Cache;
+	int32 CachedFirstBlock = 0;
+	int32 NumCachedBlocks = 0;
+
+	/** Compressed bytes of the blocks being decoded. */
+	TArray<uint8> Staging;
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "HAL/UnrealMemory.h"
+#include "Serialization/Archive.h"
+#include "Containers/UnrealString.h"
+
+/**
+ * Loading archive that reads a whole file through a read only memory mapping.
+ *
+ * The fast path load buffer covers the entire mapping, so the inline operator<< overloads read straight from the
+ * mapped pages without calling Serialize, and TArray::BulkSerialize copies its payload in a single Memcpy. Data that
+ * can be used in place is aliased with GetView/BulkSerializeView, in which case it lives as long as the archive.
+ */
+class FArchiveFileReaderMapped final : public FArchive
+{
+public:
+	/** @return a reader for Filename, or nullptr if the file cannot be opened or the platform cannot map files */
+	static CORE_API FArchiveFileReaderMapped* Open(const TCHAR* Filename);
+
+	CORE_API virtual ~FArchiveFileReaderMapped();
+
+	//~ Begin FArchive Interface
+	CORE_API virtual void Serialize(void* Data, int64 Length) override;
+	CORE_API virtual void Seek(int64 InPos) override;
+	CORE_API virtual int64 Tell() override;
+	CORE_API virtual int64 TotalSize() override;
+	CORE_API virtual bool Close() override;
+	CORE_API virtual FString GetArchiveName() const override;
+	CORE_API virtual bool ReadAtOffset(void* Dest, int64 Offset, int64 Length) override;
+	virtual bool SupportsReadAtOffset() const override
+	{
+		return true;
+	}
+	//~ End FArchive Interface
+
+	/**
+	 * Returns the next Length bytes of the file and skips them, without copying.
+	 * Sets the error flag and returns nullptr if the file is too short.
+	 */
+	CORE_API const uint8* GetView(int64 Length);
+
+	/**
+	 * Reads an array written by TArray::BulkSerialize without copying it.
+	 *
+	 * The elements are aliased only if they are suitably aligned in the file. Otherwise nullptr is returned with the
+	 * position unchanged, and the caller should fall back to TArray::BulkSerialize.
+	 *
+	 * @param OutNum receives the number of elements
+	 * @return the first element, valid until the archive is closed
+	 */
+	template <typename ElementType>
+	const ElementType* BulkSerializeView(int32& OutNum)
+	{
+		const int64 StartPos = Tell();
+
+		int32 SerializedElementSize = 0;
+		int32 SerializedNum = 0;
+		*this << SerializedElementSize;
+		*this << SerializedNum;
+
+		const int64 NumBytes = (int64)SerializedNum * (int64)sizeof(ElementType);
+		if (IsError() || SerializedElementSize != (int32)sizeof(ElementType) || SerializedNum < 0 || NumBytes > TotalSize() - Tell())
+		{
+			SetError();
+			OutNum = 0;
+			return nullptr;
+		}
+
+		const uint8* Elements = GetData() + Tell();
+		if ((UPTRINT)Elements % alignof(ElementType) != 0)
+		{
+			Seek(StartPos);
+			OutNum = 0;
+			return nullptr;
+		}
+
+		Seek(Tell() + NumBytes);
+		OutNum = SerializedNum;
+		return (const ElementType*)Elements;
+	}
+
+	/** @return the first byte of the mapping */
+	const uint8* GetData() const
+	{
+		return MappedRegion ? MappedRegion->GetAddress() : nullptr;
+	}
+
+private:
+	FArchiveFileReaderMapped(FPlatformMemory::FMappedFileRegion* InMappedRegion, const TCHAR* InFilename);
+
+	/** Current read position, in the fast path buffer when it is compiled in. */
+	const uint8* GetCursor() const;
+	void SetCursor(const uint8* NewCursor);
+
+	FPlatformMemory::FMappedFileRegion* MappedRegion;
+	FString Filename;
+
+#if !UE_ARCHIVE_FAST_PATH_LOAD
+	const uint8* Cursor;
+#endif
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include "CoreTypes.h"
+#include "Definitions.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "Templates/Function.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/** Builds the benchmarks and their entry point, set by the Benchmark configuration of the project. */
+#ifndef WITH_BENCHMARKS
+#define WITH_BENCHMARKS 0
+#endif
+
+/** Untimed runs of every benchmark before its samples are taken, to warm the caches, the allocators and the branch predictors. */
+#define BENCHMARK_DEFAULT_WARMUP_RUNS 3
+
+/** Timed samples per benchmark, the percentiles are taken over them. */
+#define BENCHMARK_DEFAULT_REPETITIONS 31
+
+/** Shortest sample, iterations per sample are doubled until one takes this long so the timer resolution does not matter. */
+#define BENCHMARK_MIN_SAMPLE_SECONDS 0.002
+
+struct FBenchmarkOptions
+{
+	int32 WarmupRuns = BENCHMARK_DEFAULT_WARMUP_RUNS;
+	int32 Repetitions = BENCHMARK_DEFAULT_REPETITIONS;
+	double MinSampleSeconds = BENCHMARK_MIN_SAMPLE_SECONDS;
+
+	/** Only runs the benchmarks whose "Group.Name/Parameter" contains it, all of them when empty. */
+	FString Filter;
+};
+
+/** Timings of one benchmark, per iteration of its body. */
+struct FBenchmarkResult
+{
+	FString Group;
+	FString Name;
+
+	/** Size the body was set up for, the number of elements or bytes it works on. */
+	int64 Parameter = 0;
+
+	uint64 IterationsPerSample = 0;
+
+	/** Nanoseconds per iteration of every sample, sorted. */
+	TArray<double> Samples;
+
+	double Min = 0.0;
+	double Median = 0.0;
+	double Mean = 0.0;
+	double StdDev = 0.0;
+	double P90 = 0.0;
+	double P99 = 0.0;
+	double Max = 0.0;
+
+	/** Medians per iteration of the CPU counters, negative when the counter is not available. Cycles are time stamp counter ticks. */
+	double Cycles = -1.0;
+	double Instructions = -1.0;
+	double CacheMisses = -1.0;
+
+	/** Bytes per second at the median, 0 for bodies that do not declare how many bytes they move. */
+	double BytesPerSecond = 0.0;
+};
+
+/**
+ * Runs benchmark bodies and collects their timings.
+ *
+ * A body runs the operation under test Iterations times in a loop of its own, so the harness adds nothing to the
+ * iterations it times. It is first calibrated to the number of iterations that takes MinSampleSeconds, then run for the
+ * warmups and the timed samples. The time stamp counter, and on Linux the instruction and last level cache miss
+ * counters, are read around every sample where available.
+ *
+ * Bodies must feed what they compute to DoNotOptimize, or the compiler may drop the work they time.
+ */
+class FBenchmarkRunner
+{
+public:
+	typedef TFunction<void(uint64 Iterations)> FBody;
+
+	CORE_API explicit FBenchmarkRunner(const FBenchmarkOptions& InOptions = FBenchmarkOptions());
+	CORE_API ~FBenchmarkRunner();
+
+	/**
+	 * Runs one benchmark now, unless the filter excludes it. Whatever the body works on is set up by the caller, outside
+	 * of the timings.
+	 *
+	 * @param BytesPerIteration		bytes the body moves per iteration, to compute the throughput
+	 */
+	CORE_API void Run(const TCHAR* Group, const TCHAR* Name, int64 Parameter, const FBody& Body, uint64 BytesPerIteration = 0);
+
+	const TArray<FBenchmarkResult>& GetResults() const
+	{
+		return Results;
+	}
+
+	/** @return the results and the context they were taken in as JSON, Commit is recorded as is to track results over time */
+	CORE_API FString ToJson(const TCHAR* Commit = TEXT("")) const;
+
+	CORE_API bool SaveJson(const TCHAR* Filename, const TCHAR* Commit = TEXT("")) const;
+
+private:
+	FBenchmarkOptions Options;
+	TArray<FBenchmarkResult> Results;
+
+	struct FCounters;
+	FCounters* Counters;
+};
+
+/**
+ * Registers a function adding benchmarks to the runner, from a static object:
+ *
+ *     static FBenchmarkRegistration GArrayBenchmarks(TEXT("Array"), [](FBenchmarkRunner& Runner) { ... });
+ */
+struct FBenchmarkRegistration
+{
+	typedef void (*FRegisterFunction)(FBenchmarkRunner& Runner);
+
+	CORE_API FBenchmarkRegistration(const TCHAR* InGroup, FRegisterFunction InFunction);
+
+	const TCHAR* Group;
+	FRegisterFunction Function;
+	FBenchmarkRegistration* Next;
+};
+
+/** Runs every registered benchmark. @return the number of benchmarks that ran */
+CORE_API int32 RunRegisteredBenchmarks(FBenchmarkRunner& Runner);
+
+namespace UE::Benchmark
+{
+	namespace Private
+	{
+		CORE_API void UseCharPointer(const volatile char* Pointer);
+	}
+
+	/** Makes the compiler assume Value is read, so the code computing it is kept. */
+	template <typename T>
+	FORCEINLINE void DoNotOptimize(const T& Value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		Private::UseCharPointer(&reinterpret_cast<const volatile char&>(Value));
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(Value) : "memory");
+#endif
+	}
+
+	/** Makes the compiler assume all memory is read and written, so stores to buffers that are never read again are kept. */
+	FORCEINLINE void ClobberMemory()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : : "memory");
+#endif
+	}
+}
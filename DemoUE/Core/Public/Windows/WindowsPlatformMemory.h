@@ -41,6 +41,24 @@ struct FWindowsPlatformMemory : public FGenericPlatformMemory
 		Windows::HANDLE				Mapping;
 	};
 
+	/**
+	 * Windows representation of a mapped file
+	 */
+	struct FWindowsMappedFileRegion : public FMappedFileRegion
+	{
+		FWindowsMappedFileRegion(const uint8* InAddress, SIZE_T InSize, Windows::HANDLE InFile, Windows::HANDLE InMapping)
+			: FMappedFileRegion(InAddress, InSize)
+			, File(InFile)
+			, Mapping(InMapping)
+		{}
+
+		/** Handle of the mapped file */
+		Windows::HANDLE				File;
+
+		/** Handle of a file mapping object, null for empty files */
+		Windows::HANDLE				Mapping;
+	};
+
 	//~ Begin FGenericPlatformMemory Interface
 	static CORE_API void Init();
 	static uint32 GetBackMemoryPoolSize()
@@ -62,6 +80,12 @@ struct FWindowsPlatformMemory : public FGenericPlatformMemory
 	static CORE_API bool PageProtect(void* const Ptr, const SIZE_T Size, const bool bCanRead, const bool bCanWrite);
 	static CORE_API void* BinnedAllocFromOS(SIZE_T Size);
 	static CORE_API void BinnedFreeToOS(void* Ptr, SIZE_T Size);
+	static CORE_API void* BinnedAllocFromOS(SIZE_T Size, int32 NumaNode, FOSAllocationInfo& OutInfo);
+	static CORE_API void BinnedFreeToOS(void* Ptr, SIZE_T Size, const FOSAllocationInfo& Info);
+	static CORE_API EOSAllocationFlags ConfigureOSAllocations(EOSAllocationFlags Flags);
+	static CORE_API SIZE_T GetLargePageSize();
+	static CORE_API uint32 GetNumNumaNodes();
+	static CORE_API int32 GetCurrentNumaNode();
 	static CORE_API void MiMallocInit();
 
 	class FPlatformVirtualMemoryBlock : public FBasicVirtualMemoryBlock
@@ -115,6 +139,8 @@ struct FWindowsPlatformMemory : public FGenericPlatformMemory
 
 	static CORE_API FSharedMemoryRegion* MapNamedSharedMemoryRegion(const FString& InName, bool bCreate, uint32 AccessMode, SIZE_T Size, const void* pSecurityAttributes = nullptr);
 	static CORE_API bool UnmapNamedSharedMemoryRegion(FSharedMemoryRegion* MemoryRegion);
+	static CORE_API FMappedFileRegion* MapFileRegion(const TCHAR* Filename);
+	static CORE_API bool UnmapFileRegion(FMappedFileRegion* MappedRegion);
 	static CORE_API bool GetLLMAllocFunctions(void* (*&OutAllocFunction)(size_t), void(*&OutFreeFunction)(void*, size_t), int32& OutAlignment);
 protected:
 	friend struct FGenericStatsUpdater;
@@ -0,0 +1,107 @@
+#pragma once
+#include "HAL/Platform.h"
+#include "RHIFeatureLevel.h"
+#include "RHIShaderPlatform.h"
+
+/** Format of the compiled shaders of a platform. */
+enum class EShaderBytecodeFormat : uint8
+{
+	Unknown,
+	DXBC,
+	DXIL,
+	SPIRV,
+	MetalLib,
+	GLSL,
+};
+
+enum class EShaderPlatformAPI : uint8
+{
+	Unknown,
+	D3D,
+	Vulkan,
+	Metal,
+	OpenGL,
+};
+
+/** What is known about a shader platform at compile time. */
+struct FShaderPlatformProperties
+{
+	ERHIFeatureLevel::Type MaxFeatureLevel = ERHIFeatureLevel::Num;
+	EShaderBytecodeFormat BytecodeFormat = EShaderBytecodeFormat::Unknown;
+	EShaderPlatformAPI API = EShaderPlatformAPI::Unknown;
+
+	/** False for the values of EShaderPlatform that are not a platform, and for the custom and extension platforms. */
+	bool bIsValid = false;
+	bool bIsMobile = false;
+	bool bIsAndroid = false;
+
+	/** Desktop platforms the editor runs on, the ones that can load shaders with editor-only data. */
+	bool bSupportsEditorOnlyData = false;
+};
+
+namespace UE::RHI::Private
+{
+	constexpr FShaderPlatformProperties MakeShaderPlatformProperties(ERHIFeatureLevel::Type MaxFeatureLevel, EShaderBytecodeFormat BytecodeFormat, EShaderPlatformAPI API, bool bIsAndroid = false, bool bSupportsEditorOnlyData = false)
+	{
+		FShaderPlatformProperties Properties;
+		Properties.MaxFeatureLevel = MaxFeatureLevel;
+		Properties.BytecodeFormat = BytecodeFormat;
+		Properties.API = API;
+		Properties.bIsValid = true;
+		Properties.bIsMobile = MaxFeatureLevel == ERHIFeatureLevel::ES3_1;
+		Properties.bIsAndroid = bIsAndroid;
+		Properties.bSupportsEditorOnlyData = bSupportsEditorOnlyData;
+		return Properties;
+	}
+
+	/** Indexed by EShaderPlatform, the sparse values are few enough to leave holes. The last entry answers out of range values. */
+	struct FShaderPlatformPropertyTable
+	{
+		FShaderPlatformProperties Entries[SP_NumPlatforms + 1];
+	};
+
+	constexpr FShaderPlatformPropertyTable MakeShaderPlatformPropertyTable()
+	{
+		using ERHIFeatureLevel::ES3_1;
+		using ERHIFeatureLevel::SM5;
+		using ERHIFeatureLevel::SM6;
+
+		FShaderPlatformPropertyTable Table;
+		FShaderPlatformProperties* Entries = Table.Entries;
+		Entries[SP_PCD3D_SM5]            = MakeShaderPlatformProperties(SM5,   EShaderBytecodeFormat::DXBC,     EShaderPlatformAPI::D3D,    false, true);
+		Entries[SP_METAL]                = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal);
+		Entries[SP_METAL_MRT]            = MakeShaderPlatformProperties(SM5,   EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal);
+		Entries[SP_PCD3D_ES3_1]          = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::DXBC,     EShaderPlatformAPI::D3D);
+		Entries[SP_OPENGL_PCES3_1]       = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::GLSL,     EShaderPlatformAPI::OpenGL);
+		Entries[SP_METAL_SM5]            = MakeShaderPlatformProperties(SM5,   EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal,  false, true);
+		Entries[SP_VULKAN_PCES3_1]       = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::SPIRV,    EShaderPlatformAPI::Vulkan);
+		Entries[SP_VULKAN_SM5]           = MakeShaderPlatformProperties(SM5,   EShaderBytecodeFormat::SPIRV,    EShaderPlatformAPI::Vulkan, false, true);
+		Entries[SP_VULKAN_ES3_1_ANDROID] = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::SPIRV,    EShaderPlatformAPI::Vulkan, true);
+		Entries[SP_METAL_MACES3_1]       = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal);
+		Entries[SP_OPENGL_ES3_1_ANDROID] = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::GLSL,     EShaderPlatformAPI::OpenGL, true);
+		Entries[SP_METAL_MRT_MAC]        = MakeShaderPlatformProperties(SM5,   EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal);
+		Entries[SP_METAL_TVOS]           = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal);
+		Entries[SP_METAL_MRT_TVOS]       = MakeShaderPlatformProperties(SM5,   EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal);
+		Entries[SP_VULKAN_SM5_ANDROID]   = MakeShaderPlatformProperties(SM5,   EShaderBytecodeFormat::SPIRV,    EShaderPlatformAPI::Vulkan, true);
+		Entries[SP_PCD3D_SM6]            = MakeShaderPlatformProperties(SM6,   EShaderBytecodeFormat::DXIL,     EShaderPlatformAPI::D3D,    false, true);
+		Entries[SP_VULKAN_SM6]           = MakeShaderPlatformProperties(SM6,   EShaderBytecodeFormat::SPIRV,    EShaderPlatformAPI::Vulkan, false, true);
+		Entries[SP_METAL_SM6]            = MakeShaderPlatformProperties(SM6,   EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal,  false, true);
+		Entries[SP_METAL_SIM]            = MakeShaderPlatformProperties(ES3_1, EShaderBytecodeFormat::MetalLib, EShaderPlatformAPI::Metal);
+		return Table;
+	}
+
+	inline constexpr FShaderPlatformPropertyTable GShaderPlatformPropertyTable = MakeShaderPlatformPropertyTable();
+}
+
+/**
+ * Properties of any shader platform in a single indexed load, usable in constant expressions. The platforms of the
+ * extensions and the custom range are only known at runtime, they come back as not valid.
+ */
+FORCEINLINE constexpr const FShaderPlatformProperties& GetShaderPlatformProperties(EShaderPlatform Platform)
+{
+	return UE::RHI::Private::GShaderPlatformPropertyTable.Entries[Platform < SP_NumPlatforms ? Platform : SP_NumPlatforms];
+}
+
+static_assert(GetShaderPlatformProperties(SP_PCD3D_SM6).MaxFeatureLevel == ERHIFeatureLevel::SM6, "Shader platform table is out of sync with EShaderPlatform");
+static_assert(!GetShaderPlatformProperties(SP_StaticPlatform_First).bIsValid, "Extension platforms are not known at compile time");
+static_assert(!GetShaderPlatformProperties(SP_NumPlatforms).bIsValid, "Out of range platforms must not be valid");
@@ -1,19 +1,22 @@
 #include "RenderCore/Shader.h"
 
-
-EShaderPermutationFlags GetShaderPermutationFlags(const FPlatformTypeLayoutParameters& LayoutParams)
+namespace UE::Shader::Private
 {
-	EShaderPermutationFlags Result = EShaderPermutationFlags::None;
+	std::atomic<uint32> GShaderPermutationFlagsCache[2] = { ShaderPermutationFlagsUnset, ShaderPermutationFlagsUnset };
 
-	static bool bProjectSupportsCookedEditor = []()
-		{
-			bool bSupportCookedEditorConfigValue = false;
-			return GConfig->GetBool(TEXT("CookedEditorSettings"), TEXT("bSupportCookedEditor"), bSupportCookedEditorConfigValue, GGameIni) && bSupportCookedEditorConfigValue;
-		}();
+	EShaderPermutationFlags ComputeShaderPermutationFlags(bool bWithEditorOnly)
+	{
+		EShaderPermutationFlags Result = EShaderPermutationFlags::None;
 
-		if (bProjectSupportsCookedEditor || LayoutParams.WithEditorOnly())
+		bool bSupportCookedEditorConfigValue = false;
+		const bool bProjectSupportsCookedEditor = GConfig->GetBool(TEXT("CookedEditorSettings"), TEXT("bSupportCookedEditor"), bSupportCookedEditorConfigValue, GGameIni) && bSupportCookedEditorConfigValue;
+		if (bProjectSupportsCookedEditor || bWithEditorOnly)
 		{
 			Result |= EShaderPermutationFlags::HasEditorOnlyData;
 		}
+
+		// Racing threads compute the same value, whichever store lands last is as good.
+		GShaderPermutationFlagsCache[bWithEditorOnly ? 1 : 0].store((uint32)Result, std::memory_order_relaxed);
 		return Result;
-}
\ No newline at end of file
+	}
+}
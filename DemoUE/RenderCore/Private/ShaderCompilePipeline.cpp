@@ -0,0 +1,469 @@
+#include "RenderCore/ShaderCompilePipeline.h"
+#include "Async/ParallelFor.h"
+#include "HAL/UnrealMemory.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "ShaderCore.h"
+
+namespace UE::ShaderCompilePipeline::Private
+{
+	/** Chunks per thread of the prune pass, permutations vary a lot in how long ModifyCompilationEnvironment takes. */
+	static constexpr int32 PrepareChunksPerThread = 8;
+
+	static FString GetPermutationName(const TCHAR* TypeName, EShaderPlatform Platform, int32 PermutationId)
+	{
+		return FString::Printf(TEXT("%s/%u/%d"), TypeName, (uint32)Platform, PermutationId);
+	}
+}
+
+using namespace UE::ShaderCompilePipeline::Private;
+
+struct FShaderCompilePipeline::FJob
+{
+	/** A distinct type, platform and cache key merged into the job, each is validated and cached on its own. */
+	struct FMember
+	{
+		const FShaderCompileTypeDesc* Type;
+		EShaderPlatform Platform;
+		FShaderPermutationCacheKey Key;
+
+		/** Found in the cache, it was validated when it was added. */
+		bool bCached = false;
+		bool bSucceeded = false;
+	};
+
+	const FShaderCompileTypeDesc* Type;
+	EShaderPlatform Platform;
+	int32 PermutationId;
+	EShaderPermutationFlags Flags;
+	EShaderCompilePriority Priority;
+
+	FShaderCompilerEnvironment Environment;
+	FShaderPermutationCacheKey Key;
+
+	/** Key of what the compiler is given, permutations sharing it share the job. */
+	FShaderPermutationCacheKey CompileInputKey;
+	FShaderCompileOutput Output;
+
+	/** The first permutation of the job comes first. */
+	TArray<FMember, TInlineAllocator<1>> Members;
+
+	/** @return the index of the member of Type, Platform and Key, added if it is new */
+	int32 FindOrAddMember(const FShaderCompileTypeDesc* InType, EShaderPlatform InPlatform, const FShaderPermutationCacheKey& InKey)
+	{
+		for (int32 Index = 0; Index < Members.Num(); ++Index)
+		{
+			const FMember& Member = Members[Index];
+			if (Member.Type == InType && Member.Platform == InPlatform && Member.Key == InKey)
+			{
+				return Index;
+			}
+		}
+		return Members.Add({ InType, InPlatform, InKey });
+	}
+
+	/** Claimed by the first of the queued copies to run, Prioritize queues a second one. */
+	std::atomic<bool> bStarted{ false };
+	std::atomic<bool> bPrioritized{ false };
+};
+
+FShaderCompilePipeline::FShaderCompilePipeline(FShaderCompileFunction InCompileFunction, uint64 InCompilerVersion, int32 InNumWorkers)
+	: CompileFunction(MoveTemp(InCompileFunction))
+	, CompilerVersion(InCompilerVersion)
+	, NumWorkers(InNumWorkers)
+{
+	if (NumWorkers <= 0)
+	{
+		NumWorkers = GetNumTaskWorkers();
+	}
+	NumWorkers = FMath::Clamp(NumWorkers, 1, SHADER_COMPILE_PIPELINE_MAX_WORKERS);
+}
+
+FShaderCompilePipeline::~FShaderCompilePipeline()
+{
+	if (Workers.Num() > 0)
+	{
+		Wait();
+	}
+}
+
+void FShaderCompilePipeline::AddShaderType(const FShaderCompileTypeDesc& Type, TArrayView<const EShaderPlatform> Platforms, EShaderPermutationFlags Flags, EShaderCompilePriority Priority)
+{
+	check(Workers.Num() == 0);
+	FPendingType& Pending = PendingTypes.AddDefaulted_GetRef();
+	Pending.Type = &Type;
+	Pending.Platforms.Append(Platforms.GetData(), Platforms.Num());
+	Pending.Flags = Flags;
+	Pending.Priority = Priority;
+
+	// Every permutation of the type shares the source, it is hashed once.
+	Pending.SourceHash = FShaderPermutationCacheKey::HashSource(Type.Source);
+}
+
+void FShaderCompilePipeline::PrepareJobs()
+{
+	struct FCandidate
+	{
+		const FPendingType* Pending;
+		EShaderPlatform Platform;
+		int32 PermutationId;
+		TUniquePtr<FJob> Job;
+	};
+
+	TArray<FCandidate> Candidates;
+	for (const FPendingType& Pending : PendingTypes)
+	{
+		for (EShaderPlatform Platform : Pending.Platforms)
+		{
+			for (int32 PermutationId = 0; PermutationId < Pending.Type->NumPermutations; ++PermutationId)
+			{
+				Candidates.Add({ &Pending, Platform, PermutationId, nullptr });
+			}
+		}
+	}
+	Stats.NumPermutations = Candidates.Num();
+
+	// The hooks are static functions of the shader types, free of side effects, so they can run anywhere.
+	const int32 NumChunks = FMath::Min(Candidates.Num(), GetParallelForNumThreads() * PrepareChunksPerThread);
+	ParallelFor(NumChunks, [this, &Candidates, NumChunks](int32 ChunkIndex)
+	{
+		const int32 Begin = (int32)((int64)Candidates.Num() * ChunkIndex / NumChunks);
+		const int32 End = (int32)((int64)Candidates.Num() * (ChunkIndex + 1) / NumChunks);
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			FCandidate& Candidate = Candidates[Index];
+			const FShaderCompileTypeDesc& Type = *Candidate.Pending->Type;
+			const FShaderPermutationParameters Parameters(Candidate.Platform, Candidate.PermutationId, Candidate.Pending->Flags);
+			if (Type.ShouldCompilePermutation && !Type.ShouldCompilePermutation(Parameters))
+			{
+				continue;
+			}
+
+			TUniquePtr<FJob> Job = MakeUnique<FJob>();
+			Job->Type = &Type;
+			Job->Platform = Candidate.Platform;
+			Job->PermutationId = Candidate.PermutationId;
+			Job->Flags = Candidate.Pending->Flags;
+			Job->Priority = Candidate.Pending->Priority;
+			if (Type.ModifyCompilationEnvironment)
+			{
+				Type.ModifyCompilationEnvironment(Parameters, Job->Environment);
+			}
+			Job->Key = FShaderPermutationCacheKey::Make(Type.Name, Parameters, Job->Environment, Candidate.Pending->SourceHash, CompilerVersion);
+			Job->CompileInputKey = FShaderPermutationCacheKey::MakeCompileInput(Candidate.Platform, Job->Environment, Candidate.Pending->SourceHash, CompilerVersion);
+			Candidate.Job = MoveTemp(Job);
+		}
+	});
+
+	TMap<FShaderPermutationCacheKey, int32> JobsByKey;
+	for (FCandidate& Candidate : Candidates)
+	{
+		if (!Candidate.Job)
+		{
+			++Stats.NumPruned;
+			continue;
+		}
+
+		int32 JobIndex;
+		const FShaderPermutationCacheKey Key = Candidate.Job->Key;
+		if (const int32* ExistingJob = JobsByKey.Find(Candidate.Job->CompileInputKey))
+		{
+			// Same environment, source and bytecode format, whatever the type or the platform: compile once, the outputs
+			// are the same. Each permutation is still validated for its type and platform and cached under its own key.
+			JobIndex = *ExistingJob;
+			if (Candidate.Job->Priority == EShaderCompilePriority::High)
+			{
+				Jobs[JobIndex]->Priority = EShaderCompilePriority::High;
+			}
+			++Stats.NumDeduplicated;
+		}
+		else
+		{
+			JobIndex = Jobs.Add(MoveTemp(Candidate.Job));
+			JobsByKey.Add(Jobs[JobIndex]->CompileInputKey, JobIndex);
+		}
+
+		const int32 MemberIndex = Jobs[JobIndex]->FindOrAddMember(Candidate.Pending->Type, Candidate.Platform, Key);
+		Results.Add({ Candidate.Pending->Type, Candidate.Platform, Candidate.PermutationId, Key, JobIndex, MemberIndex });
+		JobsByPermutation.Add(GetPermutationName(Candidate.Pending->Type->Name, Candidate.Platform, Candidate.PermutationId), JobIndex);
+	}
+	PendingTypes.Reset();
+}
+
+void FShaderCompilePipeline::Start()
+{
+	check(Workers.Num() == 0);
+	PrepareJobs();
+
+	Queues.Reset();
+	for (int32 QueueIndex = 0; QueueIndex <= NumWorkers; ++QueueIndex)
+	{
+		Queues.Add(MakeUnique<FWorkerQueue>());
+	}
+
+	NumRemainingJobs = Jobs.Num();
+	for (int32 JobIndex = 0; JobIndex < Jobs.Num(); ++JobIndex)
+	{
+		FJob& Job = *Jobs[JobIndex];
+		if (Job.Priority == EShaderCompilePriority::High)
+		{
+			Job.bPrioritized = true;
+			PushHighPriorityTask({ &Job, EStage::Compile });
+		}
+		else
+		{
+			PushTask(JobIndex % NumWorkers, { &Job, EStage::Compile });
+		}
+	}
+
+	Workers.Reserve(NumWorkers);
+	for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; ++WorkerIndex)
+	{
+		Workers.Add(LaunchTask([this, WorkerIndex]() { WorkerMain(WorkerIndex); }));
+	}
+}
+
+bool FShaderCompilePipeline::Prioritize(const TCHAR* TypeName, EShaderPlatform Platform, int32 PermutationId)
+{
+	const int32* JobIndex = JobsByPermutation.Find(GetPermutationName(TypeName, Platform, PermutationId));
+	if (!JobIndex)
+	{
+		return false;
+	}
+
+	FJob& Job = *Jobs[*JobIndex];
+	if (!Job.bStarted.load(std::memory_order_relaxed) && !Job.bPrioritized.exchange(true))
+	{
+		// The copy in the normal queues stays there and is skipped when it comes up.
+		PushHighPriorityTask({ &Job, EStage::Compile });
+	}
+	return true;
+}
+
+void FShaderCompilePipeline::Wait()
+{
+	const int32 QueueIndex = NumWorkers;
+	while (NumRemainingJobs.load(std::memory_order_acquire) > 0)
+	{
+		FTask Task;
+		if (TryPopTask(QueueIndex, Task))
+		{
+			RunTask(QueueIndex, Task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> Lock(WakeMutex);
+		WakeCondition.wait_for(Lock, std::chrono::milliseconds(10), [this]()
+		{
+			return NumQueuedTasks.load(std::memory_order_relaxed) > 0 || NumRemainingJobs.load(std::memory_order_relaxed) == 0;
+		});
+	}
+
+	// Only skipped copies of prioritized jobs can still be queued, the worker tasks drop them and return.
+	::FTask::WaitAll(Workers);
+	Workers.Reset();
+
+	Stats.NumCacheHits = NumCacheHits.load(std::memory_order_relaxed);
+	Stats.NumCompiled = Jobs.Num() - Stats.NumCacheHits;
+	Stats.NumFailed = NumFailed.load(std::memory_order_relaxed);
+}
+
+const FShaderCompileOutput& FShaderCompilePipeline::GetOutput(const FResult& Result) const
+{
+	return Jobs[Result.JobIndex]->Output;
+}
+
+bool FShaderCompilePipeline::Succeeded(const FResult& Result) const
+{
+	return Jobs[Result.JobIndex]->Members[Result.MemberIndex].bSucceeded;
+}
+
+void FShaderCompilePipeline::PushTask(int32 QueueIndex, const FTask& Task)
+{
+	{
+		FWorkerQueue& Queue = *Queues[QueueIndex];
+		std::lock_guard<std::mutex> Lock(Queue.Mutex);
+		Queue.Tasks.push_back(Task);
+	}
+	NumQueuedTasks.fetch_add(1, std::memory_order_release);
+	WakeCondition.notify_one();
+}
+
+void FShaderCompilePipeline::PushHighPriorityTask(const FTask& Task)
+{
+	{
+		std::lock_guard<std::mutex> Lock(HighPriorityMutex);
+		HighPriorityTasks.push_back(Task);
+	}
+	NumHighPriorityTasks.fetch_add(1, std::memory_order_release);
+	NumQueuedTasks.fetch_add(1, std::memory_order_release);
+	WakeCondition.notify_one();
+}
+
+bool FShaderCompilePipeline::TryPopTask(int32 QueueIndex, FTask& OutTask)
+{
+	auto PopFrom = [this, &OutTask](std::mutex& Mutex, std::deque<FTask>& Tasks, bool bFront)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (Tasks.empty())
+		{
+			return false;
+		}
+		if (bFront)
+		{
+			OutTask = Tasks.front();
+			Tasks.pop_front();
+		}
+		else
+		{
+			OutTask = Tasks.back();
+			Tasks.pop_back();
+		}
+		NumQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	};
+
+	if (NumHighPriorityTasks.load(std::memory_order_acquire) > 0 && PopFrom(HighPriorityMutex, HighPriorityTasks, true))
+	{
+		NumHighPriorityTasks.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Newest first from our own queue, that is the validation of what we just compiled.
+	FWorkerQueue& Own = *Queues[QueueIndex];
+	if (PopFrom(Own.Mutex, Own.Tasks, false))
+	{
+		return true;
+	}
+
+	// Oldest first from the others, they are the furthest from being picked up by their owner.
+	const int32 NumQueues = Queues.Num();
+	for (int32 Offset = 1; Offset < NumQueues; ++Offset)
+	{
+		FWorkerQueue& Victim = *Queues[(QueueIndex + Offset) % NumQueues];
+		if (PopFrom(Victim.Mutex, Victim.Tasks, true))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FShaderCompilePipeline::RunTask(int32 QueueIndex, const FTask& Task)
+{
+	FJob& Job = *Task.Job;
+	FShaderCompileOutput& Output = Job.Output;
+
+	if (Task.Stage == EStage::Compile)
+	{
+		if (Job.bStarted.exchange(true))
+		{
+			return;
+		}
+
+		// Any member found in the cache gives the output of the job, the others only need validating.
+		int32 NumCached = 0;
+		for (FJob::FMember& Member : Job.Members)
+		{
+			TArray<uint8> Payload;
+			if (!FShaderPermutationCache::Get().Find(Member.Key, Payload))
+			{
+				continue;
+			}
+			if (NumCached == 0)
+			{
+				FMemoryReader Reader(Payload);
+				Reader << Output.Code << Output.ParameterMap;
+				if (Reader.IsError())
+				{
+					Output = FShaderCompileOutput();
+					continue;
+				}
+				Output.bSucceeded = true;
+			}
+
+			// Only validated outputs are cached.
+			Member.bCached = true;
+			Member.bSucceeded = true;
+			++NumCached;
+		}
+
+		if (NumCached > 0)
+		{
+			NumCacheHits.fetch_add(1, std::memory_order_relaxed);
+			if (NumCached == Job.Members.Num())
+			{
+				CompleteJob(Job);
+				return;
+			}
+		}
+		else
+		{
+			const FShaderCompileInput Input{ Job.Type, Job.Platform, Job.PermutationId, Job.Flags, &Job.Environment };
+			CompileFunction(Input, Output);
+			if (!Output.bSucceeded)
+			{
+				NumFailed.fetch_add(1, std::memory_order_relaxed);
+				CompleteJob(Job);
+				return;
+			}
+		}
+
+		if (Job.bPrioritized.load(std::memory_order_relaxed))
+		{
+			PushHighPriorityTask({ &Job, EStage::Validate });
+		}
+		else
+		{
+			PushTask(QueueIndex, { &Job, EStage::Validate });
+		}
+		return;
+	}
+
+	TArray<uint8> Payload;
+	int32 NumSucceeded = 0;
+	for (FJob::FMember& Member : Job.Members)
+	{
+		if (!Member.bCached)
+		{
+			Member.bSucceeded = !Member.Type->ValidateCompiledResult || Member.Type->ValidateCompiledResult(Member.Platform, Output.ParameterMap, Output.Errors);
+			if (!Member.bSucceeded)
+			{
+				NumFailed.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+
+			if (Payload.IsEmpty())
+			{
+				FMemoryWriter Writer(Payload);
+				Writer << Output.Code << Output.ParameterMap;
+			}
+			FShaderPermutationCache::Get().Add(Member.Key, Payload);
+		}
+		++NumSucceeded;
+	}
+
+	// The output stays usable by the members that passed, see Succeeded.
+	Output.bSucceeded = NumSucceeded > 0;
+	CompleteJob(Job);
+}
+
+void FShaderCompilePipeline::CompleteJob(FJob& Job)
+{
+	if (NumRemainingJobs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		std::lock_guard<std::mutex> Lock(WakeMutex);
+		WakeCondition.notify_all();
+	}
+}
+
+void FShaderCompilePipeline::WorkerMain(int32 QueueIndex)
+{
+	// Nothing queued means what is left is in flight, and whoever runs it queues the validation on its own queue. The
+	// scheduler worker is better off running other tasks than sleeping here.
+	FTask Task;
+	while (TryPopTask(QueueIndex, Task))
+	{
+		RunTask(QueueIndex, Task);
+	}
+}
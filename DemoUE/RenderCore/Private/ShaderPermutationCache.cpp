@@ -0,0 +1,567 @@
+#include "RenderCore/ShaderPermutationCache.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTLS.h"
+#include "Hash/xxhash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RHIShaderPlatformProperties.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "ShaderCore.h"
+
+namespace UE::ShaderPermutationCache::Private
+{
+	static constexpr uint32 IndexMagic = 0x49435053; // "SPCI"
+	static constexpr uint32 EntryMagic = 0x42435053; // "SPCB"
+
+	/** Eviction goes this far below the budget, so that it does not run again on the next add. */
+	static constexpr double EvictionSlack = 0.9;
+
+	static void HashString(FXxHash128Builder& Builder, const TCHAR* Value, int32 Len)
+	{
+		// The length keeps consecutive strings from hashing the same when characters move from one to the next.
+		Builder.Update(&Len, sizeof(Len));
+		Builder.Update(Value, Len * sizeof(TCHAR));
+	}
+
+	static void HashCompileInputs(FXxHash128Builder& Builder, const FShaderCompilerEnvironment& Environment, const FShaderPermutationCacheKey& SourceHash)
+	{
+		// The serialized form covers the definitions, the compiler flags and the virtual include contents alike.
+		TArray<uint8> EnvironmentBytes;
+		FMemoryWriter Writer(EnvironmentBytes);
+		Writer << const_cast<FShaderCompilerEnvironment&>(Environment);
+		Builder.Update(EnvironmentBytes.GetData(), EnvironmentBytes.Num());
+
+		Builder.Update(&SourceHash.HashLow, sizeof(SourceHash.HashLow));
+		Builder.Update(&SourceHash.HashHigh, sizeof(SourceHash.HashHigh));
+	}
+
+	static FShaderPermutationCacheKey FinalizeKey(FXxHash128Builder& Builder)
+	{
+		const FXxHash128 Hash = Builder.Finalize();
+		FShaderPermutationCacheKey Key;
+		Key.HashLow = Hash.HashLow;
+		Key.HashHigh = Hash.HashHigh;
+		return Key;
+	}
+}
+
+using namespace UE::ShaderPermutationCache::Private;
+
+FShaderPermutationCacheKey FShaderPermutationCacheKey::Make(const TCHAR* ShaderTypeName, const FShaderPermutationParameters& Parameters,
+	const FShaderCompilerEnvironment& Environment, const FString& Source, uint64 CompilerVersion)
+{
+	return Make(ShaderTypeName, Parameters, Environment, HashSource(Source), CompilerVersion);
+}
+
+FShaderPermutationCacheKey FShaderPermutationCacheKey::HashSource(const FString& Source)
+{
+	FXxHash128Builder Builder;
+	HashString(Builder, *Source, Source.Len());
+	return FinalizeKey(Builder);
+}
+
+FShaderPermutationCacheKey FShaderPermutationCacheKey::Make(const TCHAR* ShaderTypeName, const FShaderPermutationParameters& Parameters,
+	const FShaderCompilerEnvironment& Environment, const FShaderPermutationCacheKey& SourceHash, uint64 CompilerVersion)
+{
+	FXxHash128Builder Builder;
+
+	const uint32 Version = SHADER_PERMUTATION_CACHE_VERSION;
+	const uint32 Platform = (uint32)Parameters.Platform;
+	const int32 PermutationId = Parameters.PermutationId;
+	const uint32 Flags = (uint32)Parameters.Flags;
+	Builder.Update(&Version, sizeof(Version));
+	Builder.Update(&Platform, sizeof(Platform));
+	Builder.Update(&PermutationId, sizeof(PermutationId));
+	Builder.Update(&Flags, sizeof(Flags));
+	Builder.Update(&CompilerVersion, sizeof(CompilerVersion));
+	HashString(Builder, ShaderTypeName, FCString::Strlen(ShaderTypeName));
+	HashCompileInputs(Builder, Environment, SourceHash);
+	return FinalizeKey(Builder);
+}
+
+FShaderPermutationCacheKey FShaderPermutationCacheKey::MakeCompileInput(EShaderPlatform Platform, const FShaderCompilerEnvironment& Environment,
+	const FShaderPermutationCacheKey& SourceHash, uint64 CompilerVersion)
+{
+	FXxHash128Builder Builder;
+
+	// Salted apart from Make, the two kinds of key never compare equal.
+	const uint32 Salt = 0x4E495043; // "CPIN"
+	const uint32 Version = SHADER_PERMUTATION_CACHE_VERSION;
+	const EShaderBytecodeFormat BytecodeFormat = GetShaderPlatformProperties(Platform).BytecodeFormat;
+
+	// Custom and extension platforms have no known format, nothing says two of them compile alike. The platform goes
+	// above the range of the formats so it never matches one.
+	const uint32 Target = BytecodeFormat != EShaderBytecodeFormat::Unknown ? (uint32)BytecodeFormat : 0x100 | (uint32)Platform;
+	Builder.Update(&Salt, sizeof(Salt));
+	Builder.Update(&Version, sizeof(Version));
+	Builder.Update(&Target, sizeof(Target));
+	Builder.Update(&CompilerVersion, sizeof(CompilerVersion));
+	HashCompileInputs(Builder, Environment, SourceHash);
+	return FinalizeKey(Builder);
+}
+
+FString FShaderPermutationCacheKey::ToString() const
+{
+	return FString::Printf(TEXT("%016llx%016llx"), HashHigh, HashLow);
+}
+
+FShaderPermutationCache& FShaderPermutationCache::Get()
+{
+	// Never destroyed, compile threads may still be running during static shutdown.
+	static FShaderPermutationCache* Cache = new FShaderPermutationCache();
+	return *Cache;
+}
+
+bool FShaderPermutationCache::Initialize(const FString& InDirectory, int64 InMaxDiskBytes, int64 InMaxMemoryBytes)
+{
+	Shutdown();
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	MaxMemoryBytes = InMaxMemoryBytes;
+	if (InMaxDiskBytes <= 0 || InDirectory.IsEmpty())
+	{
+		return true;
+	}
+	if (!IFileManager::Get().MakeDirectory(*InDirectory, true))
+	{
+		UE_LOG(LogShaders, Warning, TEXT("Cannot create the shader permutation cache in %s, it will only be kept in memory."), *InDirectory);
+		return false;
+	}
+
+	Directory = InDirectory;
+	MaxDiskBytes = InMaxDiskBytes;
+	if (!ReadIndex())
+	{
+		UE_LOG(LogShaders, Log, TEXT("Shader permutation cache index %s is missing or out of date, starting empty."), *GetIndexFilename());
+		DiskEntries.Reset();
+		AccessClock = 0;
+		Stats.DiskBytes = 0;
+	}
+	return true;
+}
+
+void FShaderPermutationCache::Shutdown()
+{
+	Flush();
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Directory.Reset();
+	MaxDiskBytes = 0;
+	DiskEntries.Reset();
+	AccessClock = 0;
+	bIndexDirty = false;
+
+	MemoryEntries.Reset();
+	FreeMemoryEntries.Reset();
+	MemoryIndex.Reset();
+	MostRecent = INDEX_NONE;
+	LeastRecent = INDEX_NONE;
+
+	Stats = FStats();
+}
+
+void FShaderPermutationCache::SetSharedStore(IShaderPermutationCacheStore* InSharedStore)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	SharedStore = InSharedStore;
+}
+
+bool FShaderPermutationCache::Find(const FShaderPermutationCacheKey& Key, TArray<uint8>& OutCode)
+{
+	bool bUseDisk;
+	IShaderPermutationCacheStore* Store;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (const int32* Index = MemoryIndex.Find(Key))
+		{
+			OutCode = MemoryEntries[*Index].Code;
+			Unlink(*Index);
+			LinkFront(*Index);
+			if (FDiskEntry* DiskEntry = DiskEntries.Find(Key))
+			{
+				DiskEntry->LastAccess = ++AccessClock;
+				bIndexDirty = true;
+			}
+			++Stats.MemoryHits;
+			return true;
+		}
+		bUseDisk = MaxDiskBytes > 0;
+		Store = SharedStore;
+	}
+
+	// Files are looked up even if the index does not list them, another process may have added them.
+	TArray<FShaderPermutationCacheKey> Evicted;
+	if (bUseDisk && ReadEntryFile(Key, OutCode))
+	{
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			AddToMemory(Key, OutCode);
+			Evicted = TouchDiskEntry(Key, OutCode.Num());
+			++Stats.DiskHits;
+		}
+		DeleteEntryFiles(Evicted);
+		return true;
+	}
+
+	if (Store && Store->Get(Key, OutCode))
+	{
+		const bool bWritten = bUseDisk && WriteEntryFile(Key, OutCode);
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			AddToMemory(Key, OutCode);
+			if (bWritten)
+			{
+				Evicted = TouchDiskEntry(Key, OutCode.Num());
+			}
+			++Stats.SharedHits;
+		}
+		DeleteEntryFiles(Evicted);
+		return true;
+	}
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	if (const FDiskEntry* DiskEntry = DiskEntries.Find(Key))
+	{
+		// Deleted or corrupted behind our back.
+		Stats.DiskBytes -= DiskEntry->Size;
+		DiskEntries.Remove(Key);
+		bIndexDirty = true;
+	}
+	++Stats.Misses;
+	return false;
+}
+
+void FShaderPermutationCache::Add(const FShaderPermutationCacheKey& Key, const TArray<uint8>& Code)
+{
+	bool bUseDisk;
+	IShaderPermutationCacheStore* Store;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		AddToMemory(Key, Code);
+		bUseDisk = MaxDiskBytes > 0;
+		Store = SharedStore;
+	}
+
+	if (bUseDisk && WriteEntryFile(Key, Code))
+	{
+		TArray<FShaderPermutationCacheKey> Evicted;
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Evicted = TouchDiskEntry(Key, Code.Num());
+		}
+		DeleteEntryFiles(Evicted);
+	}
+
+	if (Store)
+	{
+		Store->Put(Key, Code);
+	}
+}
+
+void FShaderPermutationCache::Flush()
+{
+	std::lock_guard<std::mutex> WriteLock(IndexWriteMutex);
+
+	FString IndexFilename;
+	TArray<uint8> Bytes;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (!bIndexDirty || Directory.IsEmpty())
+		{
+			return;
+		}
+		bIndexDirty = false;
+		IndexFilename = GetIndexFilename();
+
+		FMemoryWriter Writer(Bytes, true);
+		uint32 Magic = IndexMagic;
+		uint32 Version = SHADER_PERMUTATION_CACHE_VERSION;
+		int32 NumEntries = DiskEntries.Num();
+		Writer.SerializeBatch(Magic, Version, AccessClock, NumEntries);
+		for (TPair<FShaderPermutationCacheKey, FDiskEntry>& Pair : DiskEntries)
+		{
+			Writer.SerializeBatch(Pair.Key.HashLow, Pair.Key.HashHigh, Pair.Value.Size, Pair.Value.LastAccess);
+		}
+	}
+
+	const FString TempFilename = FString::Printf(TEXT("%s.%u.tmp"), *IndexFilename, FPlatformProcess::GetCurrentProcessId());
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempFilename) || !IFileManager::Get().Move(*IndexFilename, *TempFilename, true))
+	{
+		IFileManager::Get().Delete(*TempFilename, false, false, true);
+		UE_LOG(LogShaders, Warning, TEXT("Failed to write the shader permutation cache index %s."), *IndexFilename);
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bIndexDirty = true;
+	}
+}
+
+FShaderPermutationCache::FStats FShaderPermutationCache::GetStats() const
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	return Stats;
+}
+
+FString FShaderPermutationCache::GetEntryFilename(const FShaderPermutationCacheKey& Key) const
+{
+	// Spread over 256 directories, some file systems slow down with hundreds of thousands of files in one.
+	const FString Name = Key.ToString();
+	return Directory / Name.Left(2) / Name + TEXT(".spc");
+}
+
+FString FShaderPermutationCache::GetIndexFilename() const
+{
+	return Directory / TEXT("Index.spci");
+}
+
+bool FShaderPermutationCache::ReadIndex()
+{
+	const FString IndexFilename = GetIndexFilename();
+
+	TArray<uint8> Buffer;
+	const uint8* Data = nullptr;
+	SIZE_T Size = 0;
+	FPlatformMemory::FMappedFileRegion* MappedRegion = FPlatformMemory::MapFileRegion(*IndexFilename);
+	if (MappedRegion)
+	{
+		Data = MappedRegion->GetAddress();
+		Size = MappedRegion->GetSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Buffer, *IndexFilename, FILEREAD_Silent))
+	{
+		Data = Buffer.GetData();
+		Size = Buffer.Num();
+	}
+	else
+	{
+		return false;
+	}
+
+	bool bResult = false;
+	if (Size <= MAX_int32)
+	{
+		FMemoryReaderView Reader(TArrayView<const uint8>(Data, (int32)Size), true);
+
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		int32 NumEntries = 0;
+		Reader.SerializeBatch(Magic, Version, AccessClock, NumEntries);
+		// The count is checked against the bytes left before reserving for it, a corrupt index is rebuilt, not trusted.
+		constexpr int64 EntrySize = sizeof(FShaderPermutationCacheKey::HashLow) + sizeof(FShaderPermutationCacheKey::HashHigh)
+			+ sizeof(FDiskEntry::Size) + sizeof(FDiskEntry::LastAccess);
+		if (!Reader.IsError() && Magic == IndexMagic && Version == SHADER_PERMUTATION_CACHE_VERSION && NumEntries >= 0
+			&& NumEntries <= ((int64)Size - Reader.Tell()) / EntrySize)
+		{
+			DiskEntries.Reserve(NumEntries);
+			for (int32 Index = 0; Index < NumEntries && !Reader.IsError(); ++Index)
+			{
+				FShaderPermutationCacheKey Key;
+				FDiskEntry Entry;
+				Reader.SerializeBatch(Key.HashLow, Key.HashHigh, Entry.Size, Entry.LastAccess);
+				DiskEntries.Add(Key, Entry);
+				Stats.DiskBytes += Entry.Size;
+			}
+			bResult = !Reader.IsError();
+		}
+	}
+
+	if (MappedRegion)
+	{
+		FPlatformMemory::UnmapFileRegion(MappedRegion);
+	}
+	return bResult;
+}
+
+void FShaderPermutationCache::AddToMemory(const FShaderPermutationCacheKey& Key, const TArray<uint8>& Code)
+{
+	if (const int32* Existing = MemoryIndex.Find(Key))
+	{
+		Unlink(*Existing);
+		LinkFront(*Existing);
+		return;
+	}
+	if (MaxMemoryBytes <= 0 || Code.Num() > MaxMemoryBytes)
+	{
+		return;
+	}
+
+	int32 Index;
+	if (FreeMemoryEntries.Num() > 0)
+	{
+		Index = FreeMemoryEntries.Pop(false);
+	}
+	else
+	{
+		Index = MemoryEntries.AddDefaulted();
+	}
+	FMemoryEntry& Entry = MemoryEntries[Index];
+	Entry.Key = Key;
+	Entry.Code = Code;
+	LinkFront(Index);
+	MemoryIndex.Add(Key, Index);
+	Stats.MemoryBytes += Code.Num();
+
+	while (Stats.MemoryBytes > MaxMemoryBytes)
+	{
+		const int32 Victim = LeastRecent;
+		FMemoryEntry& VictimEntry = MemoryEntries[Victim];
+		Stats.MemoryBytes -= VictimEntry.Code.Num();
+		MemoryIndex.Remove(VictimEntry.Key);
+		VictimEntry.Code.Empty();
+		Unlink(Victim);
+		FreeMemoryEntries.Add(Victim);
+	}
+}
+
+void FShaderPermutationCache::LinkFront(int32 Index)
+{
+	FMemoryEntry& Entry = MemoryEntries[Index];
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = MostRecent;
+	if (MostRecent != INDEX_NONE)
+	{
+		MemoryEntries[MostRecent].Prev = Index;
+	}
+	MostRecent = Index;
+	if (LeastRecent == INDEX_NONE)
+	{
+		LeastRecent = Index;
+	}
+}
+
+void FShaderPermutationCache::Unlink(int32 Index)
+{
+	FMemoryEntry& Entry = MemoryEntries[Index];
+	if (Entry.Prev != INDEX_NONE)
+	{
+		MemoryEntries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		MostRecent = Entry.Next;
+	}
+	if (Entry.Next != INDEX_NONE)
+	{
+		MemoryEntries[Entry.Next].Prev = Entry.Prev;
+	}
+	else
+	{
+		LeastRecent = Entry.Prev;
+	}
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+TArray<FShaderPermutationCacheKey> FShaderPermutationCache::TouchDiskEntry(const FShaderPermutationCacheKey& Key, int64 Size)
+{
+	TArray<FShaderPermutationCacheKey> Evicted;
+	if (MaxDiskBytes <= 0)
+	{
+		return Evicted;
+	}
+
+	FDiskEntry& Entry = DiskEntries.FindOrAdd(Key);
+	Stats.DiskBytes += Size - Entry.Size;
+	Entry.Size = Size;
+	Entry.LastAccess = ++AccessClock;
+	bIndexDirty = true;
+
+	if (Stats.DiskBytes <= MaxDiskBytes)
+	{
+		return Evicted;
+	}
+
+	TArray<TPair<uint64, FShaderPermutationCacheKey>> ByAge;
+	ByAge.Reserve(DiskEntries.Num());
+	for (const TPair<FShaderPermutationCacheKey, FDiskEntry>& Pair : DiskEntries)
+	{
+		ByAge.Emplace(Pair.Value.LastAccess, Pair.Key);
+	}
+	ByAge.Sort([](const TPair<uint64, FShaderPermutationCacheKey>& A, const TPair<uint64, FShaderPermutationCacheKey>& B) { return A.Key < B.Key; });
+
+	const int64 TargetBytes = (int64)((double)MaxDiskBytes * EvictionSlack);
+	for (const TPair<uint64, FShaderPermutationCacheKey>& Pair : ByAge)
+	{
+		if (Stats.DiskBytes <= TargetBytes || Pair.Value == Key)
+		{
+			break;
+		}
+		Stats.DiskBytes -= DiskEntries.FindChecked(Pair.Value).Size;
+		DiskEntries.Remove(Pair.Value);
+		Evicted.Add(Pair.Value);
+	}
+	return Evicted;
+}
+
+bool FShaderPermutationCache::ReadEntryFile(const FShaderPermutationCacheKey& Key, TArray<uint8>& OutCode) const
+{
+	const FString Filename = GetEntryFilename(Key);
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename, FILEREAD_Silent));
+	if (!Reader)
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int64 Size = 0;
+	uint64 CodeHash = 0;
+	Reader->SerializeBatch(Magic, Version, Size, CodeHash);
+	if (Reader->IsError() || Magic != EntryMagic || Version != SHADER_PERMUTATION_CACHE_VERSION || Size < 0 || Size != Reader->TotalSize() - Reader->Tell())
+	{
+		return false;
+	}
+
+	OutCode.SetNumUninitialized((int32)Size);
+	Reader->Serialize(OutCode.GetData(), Size);
+	if (Reader->IsError() || FXxHash64::HashBuffer(OutCode.GetData(), Size).Hash != CodeHash)
+	{
+		UE_LOG(LogShaders, Warning, TEXT("Shader permutation cache entry %s is corrupted, it will be compiled again."), *Filename);
+		OutCode.Reset();
+		return false;
+	}
+	return true;
+}
+
+bool FShaderPermutationCache::WriteEntryFile(const FShaderPermutationCacheKey& Key, const TArray<uint8>& Code) const
+{
+	FString Filename;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Filename = GetEntryFilename(Key);
+	}
+
+	TArray<uint8> Bytes;
+	Bytes.Reserve(Code.Num() + 32);
+	FMemoryWriter Writer(Bytes, true);
+	uint32 Magic = EntryMagic;
+	uint32 Version = SHADER_PERMUTATION_CACHE_VERSION;
+	int64 Size = Code.Num();
+	uint64 CodeHash = FXxHash64::HashBuffer(Code.GetData(), Code.Num()).Hash;
+	Writer.SerializeBatch(Magic, Version, Size, CodeHash);
+	Writer.Serialize(const_cast<uint8*>(Code.GetData()), Code.Num());
+
+	// The content is the same whoever writes it, racing another writer or process is harmless.
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+	const FString TempFilename = FString::Printf(TEXT("%s.%u.%u.tmp"), *Filename, FPlatformProcess::GetCurrentProcessId(), FPlatformTLS::GetCurrentThreadId());
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempFilename) || !IFileManager::Get().Move(*Filename, *TempFilename, true))
+	{
+		IFileManager::Get().Delete(*TempFilename, false, false, true);
+		return false;
+	}
+	return true;
+}
+
+void FShaderPermutationCache::DeleteEntryFiles(const TArray<FShaderPermutationCacheKey>& Keys) const
+{
+	for (const FShaderPermutationCacheKey& Key : Keys)
+	{
+		FString Filename;
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Filename = GetEntryFilename(Key);
+		}
+		IFileManager::Get().Delete(*Filename, false, false, true);
+	}
+}
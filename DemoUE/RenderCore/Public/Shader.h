@@ -1,5 +1,7 @@
 #pragma once
+#include <atomic>
 #include "RHIShaderPlatform.h"
+#include "RHIShaderPlatformProperties.h"
 #include "Misc/EnumClassFlags.h"
 
 // Flags that can specialize shader permutations compiled for specific platforms
@@ -10,7 +12,29 @@ enum class EShaderPermutationFlags : uint32
 };
 ENUM_CLASS_FLAGS(EShaderPermutationFlags);
 
-RENDERCORE_API EShaderPermutationFlags GetShaderPermutationFlags(const FPlatformTypeLayoutParameters& LayoutParams);
+namespace UE::Shader::Private
+{
+	/** Marks an entry of GShaderPermutationFlagsCache that was not computed yet. */
+	inline constexpr uint32 ShaderPermutationFlagsUnset = ~0u;
+
+	/**
+	 * Permutation flags by whether the layout has editor-only data, the only part of FPlatformTypeLayoutParameters they
+	 * depend on. Filled on first use, once the config is loaded, and kept for the process: bSupportCookedEditor is
+	 * read from GGameIni only then.
+	 */
+	extern RENDERCORE_API std::atomic<uint32> GShaderPermutationFlagsCache[2];
+
+	RENDERCORE_API EShaderPermutationFlags ComputeShaderPermutationFlags(bool bWithEditorOnly);
+}
+
+/** Called in permutation loops, a relaxed load once the flags are cached. */
+FORCEINLINE EShaderPermutationFlags GetShaderPermutationFlags(const FPlatformTypeLayoutParameters& LayoutParams)
+{
+	using namespace UE::Shader::Private;
+	const bool bWithEditorOnly = LayoutParams.WithEditorOnly();
+	const uint32 Flags = GShaderPermutationFlagsCache[bWithEditorOnly ? 1 : 0].load(std::memory_order_relaxed);
+	return Flags != ShaderPermutationFlagsUnset ? (EShaderPermutationFlags)Flags : ComputeShaderPermutationFlags(bWithEditorOnly);
+}
 
 struct FShaderPermutationParameters
 {
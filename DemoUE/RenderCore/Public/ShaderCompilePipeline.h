@@ -0,0 +1,228 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include "CoreTypes.h"
+#include "Async/TaskScheduler.h"
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "Containers/UnrealString.h"
+#include "RenderCore/Shader.h"
+#include "RenderCore/ShaderPermutationCache.h"
+#include "Templates/Function.h"
+#include "Templates/UniquePtr.h"
+
+/** Upper bound on the number of tasks a pipeline runs on the task scheduler, the thread waiting on it works too. */
+#define SHADER_COMPILE_PIPELINE_MAX_WORKERS 64
+
+/** The permutation hooks of a shader type, and what its permutations are compiled from. */
+struct FShaderCompileTypeDesc
+{
+	const TCHAR* Name = nullptr;
+	int32 NumPermutations = 1;
+
+	/** Fully expanded source, part of the cache key. */
+	FString Source;
+
+	TFunction<bool(const FShaderPermutationParameters&)> ShouldCompilePermutation;
+	TFunction<void(const FShaderPermutationParameters&, FShaderCompilerEnvironment&)> ModifyCompilationEnvironment;
+	TFunction<bool(EShaderPlatform, const FShaderParameterMap&, TArray<FString>&)> ValidateCompiledResult;
+
+	/** Describes a shader class by its static hooks, see FShader. */
+	template <typename ShaderType>
+	static FShaderCompileTypeDesc Make(const TCHAR* InName, int32 InNumPermutations, FString InSource)
+	{
+		FShaderCompileTypeDesc Desc;
+		Desc.Name = InName;
+		Desc.NumPermutations = InNumPermutations;
+		Desc.Source = MoveTemp(InSource);
+		Desc.ShouldCompilePermutation = &ShaderType::ShouldCompilePermutation;
+		Desc.ModifyCompilationEnvironment = &ShaderType::ModifyCompilationEnvironment;
+		Desc.ValidateCompiledResult = &ShaderType::ValidateCompiledResult;
+		return Desc;
+	}
+};
+
+struct FShaderCompileOutput
+{
+	TArray<uint8> Code;
+	FShaderParameterMap ParameterMap;
+	TArray<FString> Errors;
+	bool bSucceeded = false;
+};
+
+/**
+ * What the compiler is handed for one permutation. Type, Platform and PermutationId are the first permutation of the job
+ * and only tell it apart, the output must only depend on Environment, the source of Type and the bytecode format of
+ * Platform.
+ */
+struct FShaderCompileInput
+{
+	const FShaderCompileTypeDesc* Type;
+	EShaderPlatform Platform;
+	int32 PermutationId;
+	EShaderPermutationFlags Flags;
+	const FShaderCompilerEnvironment* Environment;
+};
+
+/** Compiles one permutation, called from every worker at once. */
+typedef TFunction<void(const FShaderCompileInput&, FShaderCompileOutput&)> FShaderCompileFunction;
+
+enum class EShaderCompilePriority : uint8
+{
+	Normal,
+
+	/** Needed by the frame being rendered, runs before any normal job that has not started. */
+	High,
+};
+
+/**
+ * Compiles every permutation of a set of shader types for a set of platforms, in parallel.
+ *
+ * Start prunes the permutations with ShouldCompilePermutation and prepares their environments with
+ * ModifyCompilationEnvironment, both spread over ParallelFor. Permutations that hand the compiler the same environment,
+ * source and bytecode format, see FShaderPermutationCacheKey::MakeCompileInput, are compiled once and share the output
+ * whatever their type or platform. The compile function must therefore not depend on anything else of its input. The jobs then go through two stages, run by a task per
+ * worker on the shared task scheduler: the lookup in FShaderPermutationCache and the compile on a miss, then
+ * ValidateCompiledResult. Each worker task keeps its own queue and steals from the others when it runs dry, and returns
+ * to the scheduler once every queue is empty; validation is queued on the worker that compiled, so it runs with the
+ * output hot or gets stolen while that worker is busy.
+ * A shared compile is validated once per distinct type, platform and cache key merged into it, and every one that passes
+ * is added to the cache under its own key.
+ *
+ * Not thread safe itself, except for Prioritize which can be called while the pipeline runs.
+ */
+class FShaderCompilePipeline
+{
+public:
+	/** @param InNumWorkers tasks compiling besides the thread waiting, 0 for one per worker of the task scheduler */
+	RENDERCORE_API explicit FShaderCompilePipeline(FShaderCompileFunction InCompileFunction, uint64 InCompilerVersion = 0, int32 InNumWorkers = 0);
+	RENDERCORE_API ~FShaderCompilePipeline();
+
+	/** Queues every permutation of Type for every platform. Type must outlive the pipeline. */
+	RENDERCORE_API void AddShaderType(const FShaderCompileTypeDesc& Type, TArrayView<const EShaderPlatform> Platforms,
+		EShaderPermutationFlags Flags = EShaderPermutationFlags::HasEditorOnlyData, EShaderCompilePriority Priority = EShaderCompilePriority::Normal);
+
+	/** Prunes, dedups and dispatches everything added so far. Returns once the workers started. */
+	RENDERCORE_API void Start();
+
+	/** Moves a permutation ahead of the normal jobs, if it was not started yet. @return false if it is not compiled at all */
+	RENDERCORE_API bool Prioritize(const TCHAR* TypeName, EShaderPlatform Platform, int32 PermutationId);
+
+	/** Helps with the remaining jobs until every one is done, then waits for the worker tasks to return. */
+	RENDERCORE_API void Wait();
+
+	struct FResult
+	{
+		const FShaderCompileTypeDesc* Type;
+		EShaderPlatform Platform;
+		int32 PermutationId;
+		FShaderPermutationCacheKey Key;
+		int32 JobIndex;
+
+		/** Type, platform and key of the result within its job, see Succeeded. */
+		int32 MemberIndex;
+	};
+
+	/** One result per permutation that passed ShouldCompilePermutation, valid after Wait. */
+	const TArray<FResult>& GetResults() const
+	{
+		return Results;
+	}
+
+	/**
+	 * @return the output of a result, shared with every permutation compiled from the same input. Its bSucceeded is set
+	 * if any of them passed validation, use Succeeded for a given result.
+	 */
+	RENDERCORE_API const FShaderCompileOutput& GetOutput(const FResult& Result) const;
+
+	/** @return whether the output of a result compiled and passed ValidateCompiledResult of its own type and platform */
+	RENDERCORE_API bool Succeeded(const FResult& Result) const;
+
+	struct FStats
+	{
+		int32 NumPermutations = 0;
+		int32 NumPruned = 0;
+		int32 NumDeduplicated = 0;
+		int32 NumCacheHits = 0;
+		int32 NumCompiled = 0;
+		int32 NumFailed = 0;
+	};
+	const FStats& GetStats() const
+	{
+		return Stats;
+	}
+
+private:
+	struct FJob;
+
+	enum class EStage : uint8
+	{
+		/** Looks the job up in the cache and compiles it on a miss. */
+		Compile,
+		Validate,
+	};
+
+	struct FTask
+	{
+		FJob* Job;
+		EStage Stage;
+	};
+
+	/** Queue of one worker: the owner works at the back, thieves take from the front. */
+	struct alignas(64) FWorkerQueue
+	{
+		std::mutex Mutex;
+		std::deque<FTask> Tasks;
+	};
+
+	struct FPendingType
+	{
+		const FShaderCompileTypeDesc* Type;
+		TArray<EShaderPlatform> Platforms;
+		EShaderPermutationFlags Flags;
+		EShaderCompilePriority Priority;
+		FShaderPermutationCacheKey SourceHash;
+	};
+
+	void PrepareJobs();
+
+	void PushTask(int32 QueueIndex, const FTask& Task);
+	void PushHighPriorityTask(const FTask& Task);
+	bool TryPopTask(int32 QueueIndex, FTask& OutTask);
+	void RunTask(int32 QueueIndex, const FTask& Task);
+	void CompleteJob(FJob& Job);
+	void WorkerMain(int32 QueueIndex);
+
+	FShaderCompileFunction CompileFunction;
+	uint64 CompilerVersion;
+	int32 NumWorkers;
+
+	TArray<FPendingType> PendingTypes;
+	TArray<TUniquePtr<FJob>> Jobs;
+	TArray<FResult> Results;
+	FStats Stats;
+
+	/** Job of every permutation, for Prioritize. Written by Start only. */
+	TMap<FString, int32> JobsByPermutation;
+
+	/** One queue per worker and a last one for the thread in Wait. */
+	TArray<TUniquePtr<FWorkerQueue>> Queues;
+
+	std::mutex HighPriorityMutex;
+	std::deque<FTask> HighPriorityTasks;
+	std::atomic<int32> NumHighPriorityTasks{ 0 };
+
+	std::atomic<int32> NumQueuedTasks{ 0 };
+	std::atomic<int32> NumRemainingJobs{ 0 };
+	std::atomic<int32> NumCacheHits{ 0 };
+	std::atomic<int32> NumFailed{ 0 };
+
+	/** Wakes the thread in Wait when a task is queued or the last job completes. */
+	std::mutex WakeMutex;
+	std::condition_variable WakeCondition;
+
+	/** The scheduler task of every worker, the nested FTask is a stage of a job. */
+	TArray<::FTask> Workers;
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include <mutex>
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "Containers/UnrealString.h"
+#include "RenderCore/Shader.h"
+
+/** Bump whenever the layout of the cache files, or what goes into a key, changes. Older caches are discarded. */
+#define SHADER_PERMUTATION_CACHE_VERSION 1
+
+/** Content hash of everything that goes into compiling one permutation. */
+struct FShaderPermutationCacheKey
+{
+	uint64 HashLow = 0;
+	uint64 HashHigh = 0;
+
+	/**
+	 * Hashes a permutation of a shader type. Environment must be the one ModifyCompilationEnvironment produced, Source
+	 * the fully expanded source, so that an edit of any include changes the key.
+	 *
+	 * @param CompilerVersion identifies the shader compiler and its options, for the format the permutation compiles to
+	 */
+	static RENDERCORE_API FShaderPermutationCacheKey Make(const TCHAR* ShaderTypeName, const FShaderPermutationParameters& Parameters,
+		const FShaderCompilerEnvironment& Environment, const FString& Source, uint64 CompilerVersion = 0);
+
+	/** Same as above with the source hashed once by HashSource, for loops over the permutations of one shader type. */
+	static RENDERCORE_API FShaderPermutationCacheKey Make(const TCHAR* ShaderTypeName, const FShaderPermutationParameters& Parameters,
+		const FShaderCompilerEnvironment& Environment, const FShaderPermutationCacheKey& SourceHash, uint64 CompilerVersion = 0);
+
+	static RENDERCORE_API FShaderPermutationCacheKey HashSource(const FString& Source);
+
+	/**
+	 * Hashes only what reaches the compiler: the environment, the source, the compiler version and the bytecode format of
+	 * the platform, or the platform itself when its format is unknown. Permutations of different types, or of platforms
+	 * sharing a format, that would compile to the same output get the same key.
+	 */
+	static RENDERCORE_API FShaderPermutationCacheKey MakeCompileInput(EShaderPlatform Platform, const FShaderCompilerEnvironment& Environment,
+		const FShaderPermutationCacheKey& SourceHash, uint64 CompilerVersion = 0);
+
+	/** @return the hash as 32 hex digits, the name of the entry on disk */
+	RENDERCORE_API FString ToString() const;
+
+	bool operator==(const FShaderPermutationCacheKey& Other) const
+	{
+		return HashLow == Other.HashLow && HashHigh == Other.HashHigh;
+	}
+
+	bool operator!=(const FShaderPermutationCacheKey& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	friend uint32 GetTypeHash(const FShaderPermutationCacheKey& Key)
+	{
+		return (uint32)Key.HashLow;
+	}
+};
+
+/**
+ * Shared tier of the permutation cache, e.g. a network share or an HTTP service the build machines fill for everyone.
+ * Called from the compiling threads, implementations must be thread safe.
+ */
+class IShaderPermutationCacheStore
+{
+public:
+	virtual ~IShaderPermutationCacheStore() = default;
+
+	/** @return true with the compiled permutation in OutCode if the store has it */
+	virtual bool Get(const FShaderPermutationCacheKey& Key, TArray<uint8>& OutCode) = 0;
+
+	virtual void Put(const FShaderPermutationCacheKey& Key, const TArray<uint8>& Code) = 0;
+};
+
+/**
+ * Persistent, content-addressed cache of compiled shader permutations.
+ *
+ * Lookups go through three tiers: compiled code kept in memory, one file per permutation in the cache directory and the
+ * optional shared store. Hits in a lower tier are copied to the tiers above. The memory and disk tiers are bounded in
+ * bytes and evict the least recently used permutations; recency survives restarts through the index.
+ *
+ * Files are named after their key and written next to their final name and moved over it, so several processes can share
+ * the directory: a file another process added is found on the next lookup. The index lists the entries with their size
+ * and last use for eviction. It is mapped in memory at startup when the platform can map files, and written by Flush.
+ *
+ * All functions are thread safe, file IO happens outside of the lock.
+ */
+class FShaderPermutationCache
+{
+public:
+	static RENDERCORE_API FShaderPermutationCache& Get();
+
+	/**
+	 * Opens the disk tier in Directory, created if needed, and reads its index.
+	 *
+	 * @param MaxDiskBytes size the files of the cache are evicted down to, 0 to disable the disk tier
+	 * @param MaxMemoryBytes size of the compiled code kept in memory, 0 to disable the memory tier
+	 */
+	RENDERCORE_API bool Initialize(const FString& InDirectory, int64 InMaxDiskBytes, int64 InMaxMemoryBytes);
+
+	/** Writes the index and closes the disk tier. The memory tier is emptied. */
+	RENDERCORE_API void Shutdown();
+
+	/** Sets the shared tier, nullptr to go local only. The store must outlive the cache or be replaced first. */
+	RENDERCORE_API void SetSharedStore(IShaderPermutationCacheStore* InSharedStore);
+
+	/** @return true with the compiled permutation in OutCode if one of the tiers has it */
+	RENDERCORE_API bool Find(const FShaderPermutationCacheKey& Key, TArray<uint8>& OutCode);
+
+	/** Stores a compiled permutation in every tier. */
+	RENDERCORE_API void Add(const FShaderPermutationCacheKey& Key, const TArray<uint8>& Code);
+
+	/** Writes the index if entries were added or used since the last time. */
+	RENDERCORE_API void Flush();
+
+	struct FStats
+	{
+		uint64 MemoryHits = 0;
+		uint64 DiskHits = 0;
+		uint64 SharedHits = 0;
+		uint64 Misses = 0;
+		int64 MemoryBytes = 0;
+		int64 DiskBytes = 0;
+	};
+	RENDERCORE_API FStats GetStats() const;
+
+private:
+	/** Entry of the memory tier, linked in most recently used order. */
+	struct FMemoryEntry
+	{
+		FShaderPermutationCacheKey Key;
+		TArray<uint8> Code;
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+	};
+
+	/** Entry of the disk tier, as saved in the index. */
+	struct FDiskEntry
+	{
+		int64 Size = 0;
+
+		/** Value of AccessClock when the entry was last added or found. */
+		uint64 LastAccess = 0;
+	};
+
+	FString GetEntryFilename(const FShaderPermutationCacheKey& Key) const;
+	FString GetIndexFilename() const;
+
+	/** Loads the index into DiskEntries. Mutex must be held. */
+	bool ReadIndex();
+
+	/** Adds or refreshes Key in the memory tier, evicting as needed. Mutex must be held. */
+	void AddToMemory(const FShaderPermutationCacheKey& Key, const TArray<uint8>& Code);
+	void LinkFront(int32 Index);
+	void Unlink(int32 Index);
+
+	/** Adds or refreshes Key in the disk tier. @return the entries to delete to get back under budget. Mutex must be held. */
+	TArray<FShaderPermutationCacheKey> TouchDiskEntry(const FShaderPermutationCacheKey& Key, int64 Size);
+
+	bool ReadEntryFile(const FShaderPermutationCacheKey& Key, TArray<uint8>& OutCode) const;
+	bool WriteEntryFile(const FShaderPermutationCacheKey& Key, const TArray<uint8>& Code) const;
+	void DeleteEntryFiles(const TArray<FShaderPermutationCacheKey>& Keys) const;
+
+	mutable std::mutex Mutex;
+
+	/** Serializes the writes of the index, taken before Mutex. */
+	std::mutex IndexWriteMutex;
+
+	FString Directory;
+	int64 MaxDiskBytes = 0;
+	int64 MaxMemoryBytes = 0;
+	IShaderPermutationCacheStore* SharedStore = nullptr;
+
+	TArray<FMemoryEntry> MemoryEntries;
+	TArray<int32> FreeMemoryEntries;
+	TMap<FShaderPermutationCacheKey, int32> MemoryIndex;
+	int32 MostRecent = INDEX_NONE;
+	int32 LeastRecent = INDEX_NONE;
+
+	TMap<FShaderPermutationCacheKey, FDiskEntry> DiskEntries;
+	uint64 AccessClock = 0;
+	bool bIndexDirty = false;
+
+	FStats Stats;
+};